@@ -0,0 +1,68 @@
+#pragma once
+
+#include <luna/detail/common.hpp>
+#include <luna/detail/resources.hpp>
+
+namespace luna {
+
+/// <summary>
+/// Plays a sound resource on the default audio device.
+/// Fully decoded sounds are fed to the device straight from memory. Streamed sounds are
+/// decoded a chunk at a time on a background thread into a lock-free ring buffer, which
+/// the audio device drains from its own thread.
+/// </summary>
+class Sound {
+public:
+	LUNA_API Sound() = default;
+	LUNA_API Sound(ResourceID soundID, bool loop = false);
+	LUNA_API ~Sound();
+	Sound(const Sound&) = delete;
+	Sound& operator=(const Sound&) = delete;
+
+	LUNA_API bool IsValid() const;
+	LUNA_API bool Open(ResourceID soundID, bool loop = false);
+	LUNA_API void Close();
+
+	LUNA_API void Play();
+	LUNA_API void Pause();
+	LUNA_API void Stop();
+	LUNA_API bool IsPlaying() const;
+
+	LUNA_API bool GetLoop() const;
+	LUNA_API float GetGain() const;
+	LUNA_API void SetLoop(bool loop);
+	LUNA_API void SetGain(float gain);
+
+	/// <summary>
+	/// Get the logical audio device the sound plays on, e.g. to attach a postmix callback, or 0 if it isn't open.
+	/// </summary>
+	LUNA_API SDL_AudioDeviceID GetDeviceID() const;
+
+private:
+	static void SDLCALL AudioStreamCallback(void* userdata, SDL_AudioStream* stream, int additionalAmount, int totalAmount);
+	void Feed(SDL_AudioStream* stream, int amount);
+	void StartDecoder();
+	void StopDecoder();
+	void DecodeThread();
+
+	const ResourceSound* m_sound = nullptr;
+	SDL_AudioStream* m_sdlAudioStream = nullptr;
+	std::atomic<bool> m_loop = false;
+	std::atomic<bool> m_finished = false;
+	bool m_playing = false;
+	float m_gain = 1.f;
+
+	// Fully decoded playback
+	std::uint64_t m_cursor = 0;
+
+	// Streamed playback
+	detail::RingBuffer m_ring;
+	std::thread m_decodeThread;
+	std::mutex m_decodeMutex;
+	std::condition_variable m_decodeCondition;
+	std::atomic<bool> m_decodeQuit = false;
+	std::atomic<bool> m_decodeFinished = false;
+	std::size_t m_nextChunk = 0;
+};
+
+} // luna
@@ -2,6 +2,7 @@
 
 #include <luna/detail/common.hpp>
 #include <luna/detail/shapes.hpp>
+#include <luna/detail/sprite.hpp>
 
 namespace luna {
 
@@ -19,6 +20,13 @@ public:
 	LUNA_API std::int32_t GetRightEdge() const;
 	LUNA_API std::int32_t GetTopEdge() const;
 	LUNA_API std::int32_t GetBottomEdge() const;
+	LUNA_API const ShapeAABB& GetBoundingBox() const;
+	LUNA_API bool IsEnabled() const;
+	LUNA_API std::uint32_t GetViewportX() const;
+	LUNA_API std::uint32_t GetViewportY() const;
+	LUNA_API std::uint32_t GetViewportWidth() const;
+	LUNA_API std::uint32_t GetViewportHeight() const;
+	LUNA_API RenderTargetID GetRenderTarget() const;
 	LUNA_API bool PointOnCamera(float x, float y) const;
 	LUNA_API bool RegionOnCamera(const ShapeLine& shape) const;
 	LUNA_API bool RegionOnCamera(const ShapeAABB& shape) const;
@@ -32,6 +40,24 @@ public:
 	LUNA_API void SetNearPlane(std::int32_t zNear);
 	LUNA_API void SetFarPlane(std::int32_t zFar);
 
+	/// <summary>
+	/// Choose whether the camera is drawn. Every enabled camera in the room is drawn each frame, in order.
+	/// </summary>
+	LUNA_API void SetEnabled(bool enabled);
+
+	/// <summary>
+	/// Set the region of the window the camera is drawn into, in pixels from the top left corner.
+	/// A width or height of 0 stretches the viewport to the edge of the window. A viewport overlapping
+	/// another camera's on the same target is drawn over it, in a render pass of its own.
+	/// </summary>
+	LUNA_API void SetViewport(std::uint32_t x, std::uint32_t y, std::uint32_t width, std::uint32_t height);
+
+	/// <summary>
+	/// Draw the camera into a render target instead of the window. The viewport is then relative to the target.
+	/// </summary>
+	/// <param name="renderTarget">Render target, or RENDER_TARGET_ID_NULL to draw into the window</param>
+	LUNA_API void SetRenderTarget(RenderTargetID renderTarget);
+
 	LUNA_API glm::mat4 ProjectionOrtho() const;
 private:
 	void CalculateBoundingBox();
@@ -48,6 +74,8 @@ private:
 	
 	std::int32_t m_zNear = 0;
 	std::int32_t m_zFar = 0;
+	bool m_enabled = true;
+	RenderTargetID m_renderTarget = RENDER_TARGET_ID_NULL;
 };
 
 } // luna
\ No newline at end of file
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <luna/detail/common.hpp>
+#include <luna/detail/camera.hpp>
+#include <luna/detail/sprite.hpp>
+#include <luna/detail/shapes.hpp>
+
+namespace luna {
+
+/// <summary>
+/// Index of a captured sprite's texture for sprites that show a render target instead.
+/// </summary>
+constexpr std::uint32_t CAPTURED_TEXTURE_NONE = 0xFFFFFFFF;
+
+/// <summary>
+/// How a captured sprite was handed to the renderer.
+/// </summary>
+enum class CapturedSpriteKind : std::uint8_t {
+	Dynamic,
+	Instance,
+	Static
+};
+
+/// <summary>
+/// Texture referenced by a captured frame. Resource IDs are handed out in load order, so the
+/// texture is also named by its resource file & name to find it again in another run.
+/// </summary>
+struct CapturedTexture {
+	ResourceID textureID = RESOURCE_ID_NULL;
+	std::string file;
+	std::string name;
+};
+
+/// <summary>
+/// Render target alive when a frame was captured.
+/// </summary>
+struct CapturedRenderTarget {
+	RenderTargetID renderTarget = RENDER_TARGET_ID_NULL;
+	std::uint32_t width = 0;
+	std::uint32_t height = 0;
+};
+
+/// <summary>
+/// Sprite as it was submitted in a captured frame.
+/// </summary>
+struct CapturedSprite {
+	CapturedSpriteKind kind = CapturedSpriteKind::Dynamic;
+	SpriteBlendMode blendMode = SpriteBlendMode::Normal;
+	std::uint32_t texture = CAPTURED_TEXTURE_NONE;
+	RenderTargetID renderTarget = RENDER_TARGET_ID_NULL;
+	std::int32_t image = 0;
+	std::int32_t depth = 0;
+	float x = 0.f;
+	float y = 0.f;
+	float width = 0.f;
+	float height = 0.f;
+	float scaleX = 1.f;
+	float scaleY = 1.f;
+	float rotation = 0.f;
+	float originX = 0.f;
+	float originY = 0.f;
+	SDL_Color blend = LunaColorWhite;
+
+	LUNA_API bool operator==(const CapturedSprite& other) const;
+};
+
+/// <summary>
+/// Everything a renderer was asked to draw in one frame.
+/// </summary>
+struct CapturedFrame {
+	std::uint32_t windowWidth = 0;
+	std::uint32_t windowHeight = 0;
+	SDL_Color clearColor = LunaColorWhite;
+	std::vector<Camera> cameras;
+	std::vector<CapturedRenderTarget> renderTargets;
+	std::vector<CapturedTexture> textures;
+	std::vector<CapturedSprite> sprites;
+	std::vector<Primitive> primitives;
+
+	LUNA_API void Clear();
+};
+
+/// <summary>
+/// Read every frame out of a capture file.
+/// </summary>
+/// <param name="filename">File written by SpriteRenderer::StartCapture</param>
+/// <param name="frames">Frames read from the file</param>
+/// <returns>False if the file could not be opened or is malformed</returns>
+LUNA_API bool ReadRenderCapture(const std::string& filename, std::vector<CapturedFrame>& frames);
+
+namespace detail {
+
+/// <summary>
+/// Appends captured frames to a file, each as its own LZ4 block.
+/// <para/>File: "LRCP" | u32 version | frames...
+/// <para/>Frame: u32 size | u32 compressed size | compressed frame data
+/// </summary>
+class RenderCaptureWriter {
+public:
+	RenderCaptureWriter(const std::string& filename);
+
+	bool IsOpen() const;
+	bool WriteFrame(const CapturedFrame& frame);
+
+private:
+	std::ofstream m_file;
+	Buffer m_frameBuffer;
+	std::vector<char> m_compressedBuffer;
+};
+
+} // detail
+
+} // luna
\ No newline at end of file
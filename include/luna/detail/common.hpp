@@ -17,6 +17,10 @@
 #include <queue>
 #include <unordered_map>
 #include <unordered_set>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 
 // SDL includes
 #include <SDL3/SDL.h>
@@ -40,6 +44,16 @@
 #include <luna/detail/std/itsort.hpp>
 #include <luna/detail/std/buffer.hpp>
 #include <luna/detail/std/sorted_list.hpp>
+#include <luna/detail/std/ring_buffer.hpp>
+#include <luna/detail/std/thread_pool.hpp>
+#include <luna/detail/std/spatial_grid.hpp>
+
+// SIMD includes
+#if defined(LUNA_SIMD_AVX)
+#include <immintrin.h>
+#elif defined(LUNA_SIMD_NEON)
+#include <arm_neon.h>
+#endif
 
 namespace luna {
 
@@ -101,6 +115,24 @@ LUNA_API std::uint32_t Crc32Calculate(const void* data, std::size_t length, std:
 /// <returns></returns>
 LUNA_API SDL_FColor ConvertToFColor(SDL_Color color);
 
+/// <summary>
+/// Multiply the color channels of each 32-bit pixel by its alpha channel, in place.
+/// </summary>
+/// <param name="pixels">Pixel data (4 bytes per pixel)</param>
+/// <param name="pixelCount">Number of pixels</param>
+/// <param name="alphaIndex">Byte index of the alpha channel within each pixel [0, 3]</param>
+LUNA_API void PremultiplyAlpha(std::uint8_t* pixels, std::size_t pixelCount, std::uint32_t alphaIndex);
+
+/// <summary>
+/// Downsample a 32-bit image to half size using a 2x2 box filter.
+/// Destination size is (max(1, srcWidth / 2), max(1, srcHeight / 2)).
+/// </summary>
+/// <param name="src">Source pixel data (4 bytes per pixel)</param>
+/// <param name="srcWidth">Source width in pixels</param>
+/// <param name="srcHeight">Source height in pixels</param>
+/// <param name="dst">Destination pixel data</param>
+LUNA_API void DownsampleBox(const std::uint8_t* src, std::uint32_t srcWidth, std::uint32_t srcHeight, std::uint8_t* dst);
+
 // =========================================================================== Global Definitions
 constexpr SDL_Color LunaColorClear = { 0, 0, 0, 255 };
 constexpr SDL_Color LunaColorWhite = {255, 255, 255, 255};
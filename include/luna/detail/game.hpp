@@ -3,6 +3,7 @@
 #include <luna/detail/common.hpp>
 #include <luna/detail/resources.hpp>
 #include <luna/detail/render.hpp>
+#include <luna/detail/stats.hpp>
 
 namespace luna {
 
@@ -10,13 +11,20 @@ struct GameInit {
 	unsigned int ticksPerSecond = 120;
 	unsigned int windowW = 1366;
 	unsigned int windowH = 768;
+	unsigned int maxFrameLatency = 2;
 	bool enableGraphicsDebugging = false;
 	bool enableVsync = false;
 	bool enableHDR = false;
+	bool enableTrilinearFiltering = false;
+	bool enableCompactVertexFormats = true;
+	bool enableAnalyticPrimitives = true;
+	bool headless = false;
+	bool enableStatsOverlay = false;
 	std::string windowTitle = "luna";
 	std::string appName = "luna";
 	std::string appVersion = "1.0.0";
 	std::string appIdentifier = "com.luna";
+	std::string audioDriver = "";
 	std::function<void()> startFunc = []() {};
 	std::function<void()> endFunc =   []() {};
 	std::function<void(float)> preTickFunc =  [](float) {};
@@ -44,6 +52,39 @@ public:
 	LUNA_API static void SetVsyncEnabled(bool enableVsync);
 	LUNA_API static bool GetHDREnabled();
 	LUNA_API static void SetHDREnabled(bool enableHDR);
+	LUNA_API static bool GetTrilinearFilteringEnabled();
+	LUNA_API static void SetTrilinearFilteringEnabled(bool enableTrilinearFiltering);
+	LUNA_API static bool GetCompactVertexFormatsEnabled();
+	LUNA_API static bool GetAnalyticPrimitivesEnabled();
+
+	/// <summary>
+	/// True if the game runs without a window, drawing every frame into the renderer's frame target instead.
+	/// </summary>
+	LUNA_API static bool GetHeadless();
+
+	/// <summary>
+	/// Most frames the GPU may still be working on while the next one is drawn, in [1, RENDER_FRAMES_IN_FLIGHT].
+	/// Once that many are in flight, a game with a window does no work on the next frame until one finishes,
+	/// rather than blocking on the GPU, and the time is carried into the next frame's ticks; headless games wait.
+	/// </summary>
+	LUNA_API static unsigned int GetMaxFrameLatency();
+	LUNA_API static void SetMaxFrameLatency(unsigned int maxFrameLatency);
+
+	/// <summary>
+	/// Get the time spent on each stage of the last frame, and the renderer's counts for it.
+	/// </summary>
+	LUNA_API static const FrameStats& GetFrameStats();
+
+	/// <summary>
+	/// Get the times of the most recent frames.
+	/// </summary>
+	LUNA_API static const FrameTimeHistogram& GetFrameTimeHistogram();
+
+	/// <summary>
+	/// True if a frame time graph & stage breakdown are drawn over the room every frame; see detail::DrawStatsOverlay.
+	/// </summary>
+	LUNA_API static bool GetStatsOverlayEnabled();
+	LUNA_API static void SetStatsOverlayEnabled(bool enableStatsOverlay);
 
 private:
 	static void SetSwapchainParameters();
@@ -59,16 +100,24 @@ private:
 	static bool m_enableGraphicsDebugging;
 	static bool m_enableVsync;
 	static bool m_enableHDR;
+	static bool m_enableTrilinearFiltering;
+	static bool m_enableCompactVertexFormats;
+	static bool m_enableAnalyticPrimitives;
+	static bool m_headless;
+	static bool m_enableStatsOverlay;
 	static bool m_updateSwapchainParametersFlag;
 	static bool m_quitFlag;
 	static unsigned int m_windowW;
 	static unsigned int m_windowH;
 	static unsigned int m_ticksPerSecond;
+	static unsigned int m_maxFrameLatency;
 	static SDL_Window* m_sdlWindow;
 	static SDL_GPUDevice* m_sdlGPUDevice;
 	static SDL_GPUPresentMode m_sdlGPUPresentMode;
 	static SDL_GPUSwapchainComposition m_sdlGPUSwapchainComposition;
 	static Renderer* m_renderer;
+	static FrameStats m_frameStats;
+	static FrameTimeHistogram m_frameTimeHistogram;
 };
 
 } // luna
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <luna/detail/common.hpp>
+
+namespace luna {
+
+/// <summary>
+/// Most frames the CPU may record ahead of the GPU; Game::GetMaxFrameLatency sets how many it actually does.
+/// </summary>
+constexpr std::uint32_t RENDER_FRAMES_IN_FLIGHT = 3;
+
+namespace detail {
+
+/// <summary>
+/// GPU buffer paired with an upload buffer, sub-allocated front to back over the course of a frame.
+/// Every frame in flight gets its own pair, so the CPU never writes into memory the GPU may still
+/// be reading. Buffers only ever grow, so once the largest frame has been seen no more GPU
+/// allocations are made. A usage of 0 makes an upload-only ring, whose regions are copied
+/// into other buffers with UploadTo. A host memory ring is laid out the same way in plain
+/// memory and never touches the GPU; its uploads do nothing.
+/// </summary>
+class GPURingBuffer {
+public:
+	GPURingBuffer(SDL_GPUBufferUsageFlags usage, std::uint32_t framesInFlight = RENDER_FRAMES_IN_FLIGHT, bool hostMemory = false);
+	~GPURingBuffer();
+	GPURingBuffer(const GPURingBuffer&) = delete;
+	GPURingBuffer& operator=(const GPURingBuffer&) = delete;
+
+	/// <summary>
+	/// Move on to the buffers for the given frame and rewind them.
+	/// The caller is responsible for making sure the GPU has finished with that frame.
+	/// </summary>
+	/// <param name="frameIndex">Index of the frame being recorded</param>
+	void BeginFrame(std::uint64_t frameIndex);
+
+	/// <summary>
+	/// Reserve a region of the current frame's buffers and map it for writing.
+	/// If the region does not fit, the buffers are replaced with larger ones; regions handed
+	/// out earlier in the frame stay valid until the GPU has consumed them.
+	/// </summary>
+	/// <param name="size">Size of the region in bytes</param>
+	/// <param name="alignment">Required alignment of the region's offset in bytes</param>
+	/// <param name="offset">Offset of the region in the buffer</param>
+	/// <returns>Pointer to write the region's data to, or nullptr on failure</returns>
+	std::uint8_t* Map(std::uint32_t size, std::uint32_t alignment, std::uint32_t& offset);
+
+	/// <summary>
+	/// Unmap the region returned by the last call to Map.
+	/// </summary>
+	void Unmap();
+
+	/// <summary>
+	/// Record a copy of a region from the upload buffer to the GPU buffer.
+	/// </summary>
+	void Upload(SDL_GPUCopyPass* copyPass, std::uint32_t offset, std::uint32_t size);
+
+	/// <summary>
+	/// Record a copy of a region from the upload buffer to some other GPU buffer.
+	/// </summary>
+	void UploadTo(SDL_GPUCopyPass* copyPass, std::uint32_t offset, std::uint32_t size, SDL_GPUBuffer* buffer, std::uint32_t bufferOffset);
+
+	SDL_GPUBuffer* GetBuffer() const;
+	std::uint32_t GetCapacity() const;
+
+private:
+	struct Frame {
+		SDL_GPUTransferBuffer* m_sdlTransferBuffer = nullptr;
+		SDL_GPUBuffer* m_sdlBuffer = nullptr;
+		std::vector<std::uint8_t> m_hostMemory;
+		std::uint32_t m_capacity = 0;
+	};
+
+	bool Grow(Frame& frame, std::uint32_t capacity);
+
+	std::vector<Frame> m_frames;
+	SDL_GPUBufferUsageFlags m_usage = 0;
+	std::uint32_t m_currentFrame = 0;
+	std::uint32_t m_offset = 0;
+	std::uint32_t m_frameUsage = 0;
+	std::uint32_t m_peakUsage = 0;
+	bool m_mapped = false;
+	bool m_hostMemory = false;
+};
+
+} // detail
+
+} // luna
\ No newline at end of file
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <luna/detail/common.hpp>
+#include <luna/detail/resources.hpp>
+#include <luna/detail/sprite.hpp>
+#include <luna/detail/shapes.hpp>
+
+namespace luna {
+
+typedef std::uint32_t ParticleEmitterID;
+constexpr ParticleEmitterID PARTICLE_EMITTER_ID_NULL = 0;
+
+// Forward declarations
+class SpriteRenderer;
+
+/// <summary>
+/// How an emitter spawns its particles, and how they move & fade over their lifetime.
+/// Ranges are sampled uniformly for every particle.
+/// </summary>
+struct ParticleEmitterSettings {
+	ResourceID textureID = RESOURCE_ID_NULL;
+	std::int32_t image = 0;
+	std::int32_t depth = 0;
+	SpriteBlendMode blendMode = SpriteBlendMode::Normal;
+
+	/// <summary>
+	/// Particles alive at once; spawning stops while the emitter is full.
+	/// </summary>
+	std::uint32_t maxParticles = 10000;
+
+	/// <summary>
+	/// Particles spawned per second.
+	/// </summary>
+	float emitRate = 0.f;
+
+	/// <summary>
+	/// Radius of the disc around the emitter that particles spawn in.
+	/// </summary>
+	float spawnRadius = 0.f;
+
+	float lifetimeMin = 1.f;
+	float lifetimeMax = 1.f;
+	float speedMin = 0.f;
+	float speedMax = 0.f;
+
+	/// <summary>
+	/// Direction particles are fired in, in radians, give or take half the spread.
+	/// </summary>
+	float direction = 0.f;
+	float spread = 6.28318530718f;
+
+	float gravityX = 0.f;
+	float gravityY = 0.f;
+
+	/// <summary>
+	/// Rate at which particles slow down, as a fraction of their speed lost per second.
+	/// </summary>
+	float drag = 0.f;
+
+	float spinMin = 0.f;
+	float spinMax = 0.f;
+	float scaleStart = 1.f;
+	float scaleEnd = 1.f;
+	SDL_Color colorStart = LunaColorWhite;
+	SDL_Color colorEnd = LunaColorWhite;
+};
+
+/// <summary>
+/// Source of many short-lived sprites that share a texture, depth & blend mode. Particles are kept as a
+/// structure of arrays and integrated in bulk, and are drawn straight from those arrays in a single batch
+/// per emitter & camera, culled by the bounds of the whole emitter.
+/// <para/>Particles have no order; when one dies, the last one alive takes its place.
+/// </summary>
+class ParticleEmitter {
+public:
+	LUNA_API ParticleEmitter(const ParticleEmitterSettings& settings, float x, float y);
+
+	LUNA_API bool IsValid() const;
+
+	LUNA_API const ParticleEmitterSettings& GetSettings() const;
+
+	/// <summary>
+	/// Replace the settings. Particles already alive keep moving as they were fired, but fade & scale
+	/// by the new settings; any beyond the new maximum are dropped.
+	/// </summary>
+	LUNA_API void SetSettings(const ParticleEmitterSettings& settings);
+
+	LUNA_API float GetPositionX() const;
+	LUNA_API float GetPositionY() const;
+	LUNA_API void SetPosition(float x, float y);
+
+	/// <summary>
+	/// Spawn particles now, on top of the emit rate.
+	/// </summary>
+	/// <returns>Number of particles spawned, fewer than asked if the emitter is full</returns>
+	LUNA_API std::uint32_t Burst(std::uint32_t count);
+	LUNA_API void Clear();
+
+	LUNA_API std::uint32_t GetParticleCount() const;
+
+	/// <summary>
+	/// Get a box holding the centers of every particle as of the last update.
+	/// </summary>
+	LUNA_API ShapeAABB GetBounds() const;
+
+	/// <summary>
+	/// Get a sprite drawn the way every particle is, at the emitter's position.
+	/// </summary>
+	LUNA_API const Sprite& GetSprite() const;
+
+	/// <summary>
+	/// True if particles need blending with what is behind them.
+	/// </summary>
+	LUNA_API bool GetTranslucent() const;
+
+protected:
+	friend class SpriteRenderer;
+
+	/// <summary>
+	/// Age, move & retire particles, then spawn new ones, splitting the particles across the pool.
+	/// </summary>
+	void Update(float dt, detail::ThreadPool& threadPool);
+
+private:
+	void Spawn(std::uint32_t count);
+	void Kill(std::uint32_t index);
+	void Resize(std::uint32_t capacity);
+
+	ParticleEmitterSettings m_settings;
+	Sprite m_sprite;
+	float m_positionX = 0.f;
+	float m_positionY = 0.f;
+	float m_emitAccumulator = 0.f;
+	Uint64 m_randomState = 0;
+	std::uint32_t m_count = 0;
+	ShapeAABB m_bounds;
+	std::vector<ShapeAABB> m_chunkBounds;
+
+	std::vector<float> m_x;
+	std::vector<float> m_y;
+	std::vector<float> m_velocityX;
+	std::vector<float> m_velocityY;
+	std::vector<float> m_rotation;
+	std::vector<float> m_spin;
+	std::vector<float> m_age;
+	std::vector<float> m_inverseLifetime;
+};
+
+namespace detail {
+
+/// <summary>
+/// Step a structure-of-arrays list of particles forward, with gravity applied before velocity damping.
+/// Fills in the box holding every updated position.
+/// </summary>
+/// <param name="damping">Fraction of velocity kept over the step</param>
+LUNA_API void IntegrateParticles(float* x, float* y, float* velocityX, float* velocityY, float* rotation, const float* spin, float* age, std::size_t count,
+	float dt, float gravityX, float gravityY, float damping, ShapeAABB& bounds);
+
+} // detail
+
+} // luna
\ No newline at end of file
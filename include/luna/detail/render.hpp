@@ -2,27 +2,227 @@
 
 #include <luna/detail/common.hpp>
 #include <luna/detail/sprite.hpp>
+#include <luna/detail/text.hpp>
+#include <luna/detail/particles.hpp>
 #include <luna/detail/shapes.hpp>
+#include <luna/detail/gpu_buffer.hpp>
+#include <luna/detail/capture.hpp>
 
 namespace luna {
 
 // Forward declarations
 class Game;
+class Room;
 class Camera;
 class SpriteBatchShaderPipeline;
 class PrimitiveBatchShaderPipeline;
+class ShapeBatchShaderPipeline;
+
+typedef std::uint32_t SpriteInstanceID;
+constexpr SpriteInstanceID SPRITE_INSTANCE_ID_NULL = 0;
+
+typedef std::uint32_t StaticSpriteID;
+constexpr StaticSpriteID STATIC_SPRITE_ID_NULL = 0;
+
+/// <summary>
+/// Called with a render target's pixels once they have been copied back from the GPU, packed row after row.
+/// </summary>
+using RenderTargetReadFunc = std::function<void(const std::uint8_t* pixels, std::uint32_t width, std::uint32_t height)>;
+
+/// <summary>
+/// Work handed to the GPU to draw the last frame.
+/// </summary>
+struct RenderCounts {
+	std::uint32_t renderables = 0;
+	std::uint32_t batches = 0;
+	std::uint32_t renderPasses = 0;
+	std::uint32_t drawCalls = 0;
+	std::uint32_t texturePageSwitches = 0;
+	std::uint32_t particles = 0;
+	std::uint64_t uploadBytes = 0;
+
+	/// <summary>
+	/// 1 if the frame was drawn but not shown, because the window had no swapchain image free.
+	/// </summary>
+	std::uint32_t framesSkipped = 0;
+};
+
+/// <summary>
+/// CPU time a renderer spent on each stage of drawing the last frame, in milliseconds.
+/// </summary>
+struct RenderTimings {
+	/// <summary>
+	/// Time spent gathering cameras, merging the threads' draw queues & writing any capture.
+	/// </summary>
+	float gatherMs = 0.f;
+
+	/// <summary>
+	/// Time spent culling the frame's renderables & querying static sprites.
+	/// </summary>
+	float cullMs = 0.f;
+
+	/// <summary>
+	/// Time spent submitting particle emitters, & staging & submitting sprite instances.
+	/// </summary>
+	float prepareMs = 0.f;
+	float sortMs = 0.f;
+	float batchMs = 0.f;
+	float packMs = 0.f;
+	float submitMs = 0.f;
+
+	/// <summary>
+	/// Time spent blocked on the GPU, waiting for a frame in flight to finish with its staging buffers.
+	/// </summary>
+	float fenceWaitMs = 0.f;
+
+	/// <summary>
+	/// Time the GPU spent drawing the frame, or a negative value if the device cannot measure it.
+	/// </summary>
+	float gpuMs = -1.f;
+};
 
 /// <summary>
 /// Abstract rendering base class.
 /// </summary>
 class Renderer {
 public:
+	/// <summary>
+	/// False for renderers that never touch the GPU, so the game can run without a GPU device.
+	/// </summary>
+	static constexpr bool REQUIRES_GPU_DEVICE = true;
+
 	LUNA_API virtual bool IsValid() const = 0;
 	LUNA_API virtual void DrawSprite(Sprite sprite) = 0;
 	LUNA_API virtual void DrawPrimitive(Primitive primitive) = 0;
 
+	/// <summary>
+	/// Open a TrueType font at a point size for drawing text. Loading the same file at the same size again
+	/// returns the same handle, and the font stays loaded until it has been unloaded as many times.
+	/// </summary>
+	/// <returns>Handle to the font, or FONT_ID_NULL on failure</returns>
+	LUNA_API virtual FontID LoadFont(const std::string& filename, float pointSize) = 0;
+	LUNA_API virtual void UnloadFont(FontID font) = 0;
+
+	/// <summary>
+	/// Draw a string this frame. May be called from any thread, like DrawSprite.
+	/// </summary>
+	LUNA_API virtual void DrawText(const Text& text) = 0;
+
+	/// <summary>
+	/// Hand a sprite over to the renderer, which keeps drawing it every frame until it is destroyed.
+	/// </summary>
+	/// <returns>Handle to the instance, or SPRITE_INSTANCE_ID_NULL if the sprite is invalid</returns>
+	LUNA_API virtual SpriteInstanceID CreateSpriteInstance(const Sprite& sprite) = 0;
+
+	/// <summary>
+	/// Stop drawing a sprite instance. Its handle may be given to a later instance.
+	/// </summary>
+	LUNA_API virtual void DestroySpriteInstance(SpriteInstanceID instanceID) = 0;
+
+	/// <summary>
+	/// Get a sprite instance for modifying, marking it to be uploaded again next frame.
+	/// The pointer is only valid until the next instance is created.
+	/// </summary>
+	/// <returns>Sprite pointer, or nullptr if the handle is invalid</returns>
+	LUNA_API virtual Sprite* EditSpriteInstance(SpriteInstanceID instanceID) = 0;
+
+	/// <summary>
+	/// Get a sprite instance without marking it as changed.
+	/// </summary>
+	/// <returns>Sprite pointer, or nullptr if the handle is invalid</returns>
+	LUNA_API virtual const Sprite* GetSpriteInstance(SpriteInstanceID instanceID) const = 0;
+
+	/// <summary>
+	/// Register a sprite that stays where it is, such as a tile. Static sprites are kept in a spatial
+	/// index, and each frame only those near the camera are looked at & drawn.
+	/// </summary>
+	/// <returns>Handle to the sprite, or STATIC_SPRITE_ID_NULL if the sprite is invalid</returns>
+	LUNA_API virtual StaticSpriteID CreateStaticSprite(const Sprite& sprite) = 0;
+
+	/// <summary>
+	/// Stop drawing a static sprite. Its handle may be given to a later static sprite.
+	/// </summary>
+	LUNA_API virtual void DestroyStaticSprite(StaticSpriteID staticSpriteID) = 0;
+
+	/// <summary>
+	/// Replace a static sprite, moving it in the spatial index.
+	/// </summary>
+	/// <returns>False if the handle or the sprite is invalid</returns>
+	LUNA_API virtual bool SetStaticSprite(StaticSpriteID staticSpriteID, const Sprite& sprite) = 0;
+
+	/// <summary>
+	/// Get a static sprite.
+	/// </summary>
+	/// <returns>Sprite pointer, or nullptr if the handle is invalid</returns>
+	LUNA_API virtual const Sprite* GetStaticSprite(StaticSpriteID staticSpriteID) const = 0;
+
+	/// <summary>
+	/// Create a particle emitter, which the renderer updates every tick & draws every frame until it is destroyed.
+	/// </summary>
+	/// <returns>Handle to the emitter, or PARTICLE_EMITTER_ID_NULL if its texture is invalid</returns>
+	LUNA_API virtual ParticleEmitterID CreateParticleEmitter(const ParticleEmitterSettings& settings, float x, float y) = 0;
+
+	/// <summary>
+	/// Destroy a particle emitter along with its particles. Its handle may be given to a later emitter.
+	/// </summary>
+	LUNA_API virtual void DestroyParticleEmitter(ParticleEmitterID emitterID) = 0;
+
+	/// <summary>
+	/// Get a particle emitter for moving, bursting or changing its settings.
+	/// </summary>
+	/// <returns>Emitter pointer, or nullptr if the handle is invalid</returns>
+	LUNA_API virtual ParticleEmitter* GetParticleEmitter(ParticleEmitterID emitterID) = 0;
+
+	/// <summary>
+	/// Create a texture that cameras can be drawn into, and that sprites made with Sprite::FromRenderTarget show.
+	/// </summary>
+	/// <returns>Handle to the render target, or RENDER_TARGET_ID_NULL on failure</returns>
+	LUNA_API virtual RenderTargetID CreateRenderTarget(std::uint32_t width, std::uint32_t height) = 0;
+
+	/// <summary>
+	/// Free a render target. Its handle may be given to a later render target.
+	/// </summary>
+	LUNA_API virtual void DestroyRenderTarget(RenderTargetID renderTarget) = 0;
+
+	/// <summary>
+	/// Copy a render target back to the CPU after the frame being built has been drawn, without waiting on
+	/// the GPU. The function is called during a later frame, from the thread that draws frames, with pixels
+	/// in the format given by detail::GetColorTargetFormat.
+	/// </summary>
+	/// <returns>False if the handle is invalid</returns>
+	LUNA_API virtual bool ReadRenderTarget(RenderTargetID renderTarget, RenderTargetReadFunc func) = 0;
+
+	/// <summary>
+	/// Get the render target that cameras without one of their own are drawn into when the game is headless.
+	/// </summary>
+	/// <returns>Handle to the frame target, or RENDER_TARGET_ID_NULL when drawing into a window</returns>
+	LUNA_API virtual RenderTargetID GetFrameTarget() const = 0;
+
+	/// <summary>
+	/// Get the work that went into the last frame.
+	/// </summary>
+	LUNA_API virtual const RenderCounts& GetFrameCounts() const = 0;
+
+	/// <summary>
+	/// Get the time spent on each stage of drawing the last frame.
+	/// </summary>
+	LUNA_API virtual const RenderTimings& GetFrameTimings() const = 0;
+
 protected:
 	friend class Game;
+
+	/// <summary>
+	/// Advance anything the renderer simulates, once per game tick.
+	/// </summary>
+	virtual void Tick(float dt) = 0;
+
+	/// <summary>
+	/// Wait until the renderer has room for another frame, sleeping rather than spinning. Nothing should be
+	/// drawn until it does, so no work goes into frames that would be thrown away.
+	/// </summary>
+	/// <param name="timeoutNS">Longest time to wait, so the caller can keep handling events</param>
+	/// <returns>False if there is still no room once the timeout has passed</returns>
+	virtual bool WaitForFrame(std::uint64_t timeoutNS) = 0;
 	virtual void PreDraw() = 0;
 	virtual void Draw() = 0;
 	virtual void PostDraw() = 0;
@@ -30,6 +230,35 @@ protected:
 
 /// <summary>
 /// 2D Sprite batching renderer.
+/// DrawSprite & DrawPrimitive may be called from any number of threads while a frame is being
+/// built; each thread fills its own queue, and the queues are merged when the frame is drawn.
+/// Every enabled camera in the room is drawn into its own viewport. The frame's objects are
+/// sorted & uploaded once, then culled against every camera in the same pass; each camera only
+/// uploads a list of indices into the shared data for what it sees. Cameras drawing into render
+/// targets get a render pass of their own before the window's, so sprites showing a target see
+/// this frame's contents; a target cannot show itself. Static sprites
+/// are filed in a uniform grid instead, so the cost of culling them follows what is on screen rather
+/// than the size of the world; like sprite instances, they may only be touched from the thread that
+/// draws the frame, and must be destroyed before their resource file is unloaded.
+/// Opaque sprites are drawn first, in front to back order within each batch: solid ones, which cover their
+/// whole quad, without blending or discarding texels so overdraw is rejected before it is shaded, then those
+/// with empty texels, which are alpha tested. Translucent sprites follow back to front without writing depth.
+/// Opaque sprite instances are kept sorted in a GPU buffer of their own, and only instances that
+/// were edited are uploaded again; translucent instances still have to be depth sorted against
+/// everything else each frame. Sprite instances are not camera culled, and must be destroyed
+/// before the resource file holding their texture is unloaded, and only touched from the thread
+/// that draws the frame.
+/// Text is laid out into one sprite per glyph, sampling a glyph atlas that each glyph is rasterised into once
+/// per font & size, so all the text at a depth on the same atlas page is a single sprite batch; the atlas
+/// holds a few pages, and evicts the least recently used glyphs once it is full.
+/// Particle emitters are stepped on the worker threads each tick, and written straight from their arrays into
+/// the frame's sprite data; each emitter is culled by its bounds & drawn in one call per camera that sees it.
+/// Like sprite instances, they may only be touched from the thread that draws the frame, and must be destroyed
+/// before the resource file holding their texture is unloaded.
+/// Unless analytic primitives are disabled, circles, AABBs & lines are drawn as one quad each and
+/// shaded by their signed distance, so filled & outlined primitives share a batch; anti-aliased
+/// edges of opaque primitives are depth tested like the rest of the shape. Thick polylines are
+/// drawn in the same batch, one quad per segment.
 /// </summary>
 class SpriteRenderer : public Renderer {
 public:
@@ -39,46 +268,154 @@ public:
 	LUNA_API bool IsValid() const override;
 	LUNA_API void DrawSprite(Sprite sprite) override;
 	LUNA_API void DrawPrimitive(Primitive primitive) override;
+	LUNA_API FontID LoadFont(const std::string& filename, float pointSize) override;
+	LUNA_API void UnloadFont(FontID font) override;
+	LUNA_API void DrawText(const Text& text) override;
+	LUNA_API SpriteInstanceID CreateSpriteInstance(const Sprite& sprite) override;
+	LUNA_API void DestroySpriteInstance(SpriteInstanceID instanceID) override;
+	LUNA_API Sprite* EditSpriteInstance(SpriteInstanceID instanceID) override;
+	LUNA_API const Sprite* GetSpriteInstance(SpriteInstanceID instanceID) const override;
+	LUNA_API StaticSpriteID CreateStaticSprite(const Sprite& sprite) override;
+	LUNA_API void DestroyStaticSprite(StaticSpriteID staticSpriteID) override;
+	LUNA_API bool SetStaticSprite(StaticSpriteID staticSpriteID, const Sprite& sprite) override;
+	LUNA_API const Sprite* GetStaticSprite(StaticSpriteID staticSpriteID) const override;
+	LUNA_API ParticleEmitterID CreateParticleEmitter(const ParticleEmitterSettings& settings, float x, float y) override;
+	LUNA_API void DestroyParticleEmitter(ParticleEmitterID emitterID) override;
+	LUNA_API ParticleEmitter* GetParticleEmitter(ParticleEmitterID emitterID) override;
+	LUNA_API RenderTargetID CreateRenderTarget(std::uint32_t width, std::uint32_t height) override;
+	LUNA_API void DestroyRenderTarget(RenderTargetID renderTarget) override;
+	LUNA_API bool ReadRenderTarget(RenderTargetID renderTarget, RenderTargetReadFunc func) override;
+	LUNA_API RenderTargetID GetFrameTarget() const override;
+
+	/// <summary>
+	/// Get the batches, render passes, draw calls, texture page switches, particles & bytes of instance, vertex & index data that went into the last frame.
+	/// </summary>
+	LUNA_API const RenderCounts& GetFrameCounts() const override;
+
+	/// <summary>
+	/// Get the CPU time spent culling, sorting, batching, packing & submitting the last frame. SDL_GPU has no
+	/// timestamp queries, so the GPU's own time is never known; the time spent waiting on its fences is.
+	/// </summary>
+	LUNA_API const RenderTimings& GetFrameTimings() const override;
+
+	/// <summary>
+	/// Write the next frames drawn to a file, along with the cameras, render targets & textures they refer to,
+	/// so the same workload can be replayed later with ReadRenderCapture. Replaces any capture already running.
+	/// </summary>
+	/// <param name="filename">File to write</param>
+	/// <param name="frameCount">Number of frames to capture, or 0 to keep capturing until StopCapture</param>
+	/// <returns>False if the file could not be opened</returns>
+	LUNA_API bool StartCapture(const std::string& filename, std::uint32_t frameCount = 1);
+	LUNA_API void StopCapture();
+	LUNA_API bool IsCapturing() const;
 
 protected:
 	friend class Game;
+
+	/// <param name="nullDevice">Prepare frames in host memory without ever touching the GPU</param>
+	LUNA_API explicit SpriteRenderer(bool nullDevice);
+
+	void Tick(float dt) override;
+	bool WaitForFrame(std::uint64_t timeoutNS) override;
 	void PreDraw() override;
 	void Draw() override;
 	void PostDraw() override;
 
 	struct SpriteBatchInfo {
 		float x, y, z, rotation;
-		float w, h, _paddingA, _paddingB;
+		float w, h, additive, _padding;
 		float scaleX, scaleY, originX, originY;
 		float texU, texV, texW, texH;
 		float r, g, b, a;
 	};
 
+	/// <summary>
+	/// SpriteBatchInfo in half the size, read by the PACKED_SPRITE_DATA variant of the sprite batch shader.
+	/// Rotation is stored as a fraction of a turn & flags in the upper 16 bits, size, scale & origin as halves,
+	/// color as RGBA8, and texture coordinates as 16 bit normalized integers.
+	/// </summary>
+	struct PackedSpriteBatchInfo {
+		float x, y, z;
+		std::uint32_t rotationFlags;
+		std::uint32_t size, scale, origin;
+		std::uint32_t color;
+		std::uint32_t texUV, texWH;
+	};
+	static constexpr std::uint32_t PACKED_SPRITE_FLAG_ADDITIVE = 0x1;
+
+	// Layouts must match the structs in SpriteBatch.vert.hlsl
+	static_assert(sizeof(SpriteBatchInfo) == 80);
+	static_assert(sizeof(PackedSpriteBatchInfo) == 40);
+
+	struct SpriteBatchUniforms {
+		glm::mat4 viewProjection;
+		std::uint32_t baseSprite, indexed, _padding[2];
+	};
+
+	/// <summary>
+	/// Primitive drawn by the shape batch shader. Geometry holds a circle's center & radius,
+	/// an AABB's left, top, right & bottom, or a line or polyline segment's end points. Thickness
+	/// is the width of outlines & lines in pixels, of segments in world units, and 0 for filled
+	/// shapes. Color is RGBA8.
+	/// <para/>Type: [7:0] shape type | [10:8] start end | [13:11] end end | [14] start wraps | [15] end wraps | [31:16] wrap distance
+	/// <para/>Segments of a polyline are written back to back, so miter & bevel joins read their
+	/// neighbors from the records on either side, or the record a wrap distance away for the
+	/// joins that close a polyline.
+	/// </summary>
+	struct ShapeBatchInfo {
+		float geometry[4];
+		float z, thickness;
+		std::uint32_t type, color;
+	};
+	static constexpr std::uint32_t SHAPE_BATCH_TYPE_CIRCLE = 0;
+	static constexpr std::uint32_t SHAPE_BATCH_TYPE_AABB = 1;
+	static constexpr std::uint32_t SHAPE_BATCH_TYPE_LINE = 2;
+	static constexpr std::uint32_t SHAPE_BATCH_TYPE_SEGMENT = 3;
+	static constexpr std::uint32_t SHAPE_SEGMENT_END_BUTT = 0;
+	static constexpr std::uint32_t SHAPE_SEGMENT_END_SQUARE = 1;
+	static constexpr std::uint32_t SHAPE_SEGMENT_END_ROUND = 2;
+	static constexpr std::uint32_t SHAPE_SEGMENT_END_MITER = 3;
+	static constexpr std::uint32_t SHAPE_SEGMENT_END_BEVEL = 4;
+
+	// Layout must match the struct in ShapeBatch.vert.hlsl
+	static_assert(sizeof(ShapeBatchInfo) == 32);
+
+	struct ShapeBatchUniforms {
+		glm::mat4 viewProjection;
+		std::uint32_t baseShape;
+		float pixelSize;
+		std::uint32_t _padding[2];
+	};
+
 private:
 	enum RenderableType {
 		Unknown,
 		SpriteType,
-		PrimitiveType
+		PrimitiveType,
+		ParticleType
 	};
 
 	/// <summary>
 	/// Generic wrapper for any object that can be drawn onto the screen.
-	/// Includes sprites, text, primitives, etc.
+	/// Includes sprites, text, primitives, particle emitters, etc.
 	/// </summary>
 	struct Renderable {
 		SpriteRenderer* m_renderer;
 		std::size_t m_renderableIndex;
 		RenderableType m_renderableType;
 		bool m_opaque;
+		std::uint64_t m_sortKey;
+		std::uint32_t m_cameraMask;
 
 		Renderable();
-		Renderable(SpriteRenderer* renderer, std::size_t renderableIndex, RenderableType renderableType, bool opaque);
+		Renderable(SpriteRenderer* renderer, std::size_t renderableIndex, RenderableType renderableType, bool opaque, std::uint64_t sortKey);
 		Renderable(const Renderable& renderable);
 		Renderable(Renderable&& renderable) noexcept;
 
 		bool IsValid() const;
 		Sprite* GetSprite() const;
 		Primitive* GetPrimitive() const;
+		ParticleEmitter* GetParticleEmitter() const;
 		
 		Renderable& operator=(const Renderable& other);
 		Renderable& operator=(Renderable&& other) noexcept;
@@ -90,6 +427,16 @@ private:
 	/// </summary>
 	using RenderableList = std::vector<Renderable>;
 
+	/// <summary>
+	/// Objects submitted by a single thread since the last frame was drawn.
+	/// </summary>
+	struct DrawQueue {
+		SpriteList m_sprites;
+		PrimitiveList m_primitives;
+		RenderableList m_renderables;
+		std::uint32_t m_idleFrames = 0;
+	};
+
 	/// <summary>
 	/// Container for a list of similar drawable objects, including metadata about them.
 	/// All objects in a batch can be drawn in the same render pass, without changing GPU state.
@@ -99,6 +446,15 @@ private:
 		RenderableList m_renderableList;
 		bool m_opaque;
 
+		// Where the batch's data was placed in the frame's buffers; sprite instances for sprite
+		// batches, shapes or indices & a base vertex for primitive batches
+		std::uint32_t m_firstElement;
+		std::uint32_t m_elementCount;
+		std::int32_t m_vertexOffset;
+
+		// Where each primitive's shapes or indices start, relative to the first element, followed by the element count
+		std::vector<std::uint32_t> m_elementOffsets;
+
 		RenderableBatch();
 		RenderableBatch(RenderableType type, const RenderableList& renderableList, bool opaque);
 		RenderableBatch(const RenderableBatch& other);
@@ -110,52 +466,241 @@ private:
 		bool operator==(const RenderableBatch& other) const;
 	};
 
-	struct CompRenderableDepth {
-		bool operator()(const Renderable& lhs, const Renderable& rhs);
+	/// <summary>
+	/// Bounds of the frame's sprites & primitives, laid out for testing many at once against the cameras.
+	/// Sprites & circles are culled by their bounding circle, everything else by its bounding box.
+	/// Visibility is stored one camera after another.
+	/// </summary>
+	struct CullingBounds {
+		// Every sprite, in frame order, then the circle primitives
+		std::vector<float> m_circleX, m_circleY, m_circleRadius;
+		std::vector<std::uint8_t> m_circleVisible;
+		std::vector<float> m_boxLeft, m_boxTop, m_boxRight, m_boxBottom;
+		std::vector<std::uint8_t> m_boxVisible;
+		std::vector<std::size_t> m_circlePrimitives, m_boxPrimitives;
+		std::vector<std::uint32_t> m_primitiveMasks;
+
+		// Every particle emitter with particles to draw
+		std::vector<std::size_t> m_emitters;
+		std::vector<float> m_emitterLeft, m_emitterTop, m_emitterRight, m_emitterBottom;
+		std::vector<std::uint8_t> m_emitterVisible;
+	};
+
+	/// <summary>
+	/// Part of a batch seen by one camera, as a run of that camera's draw indices.
+	/// </summary>
+	struct CameraBatch {
+		std::size_t m_batchIndex;
+		std::uint32_t m_firstElement;
+		std::uint32_t m_elementCount;
+	};
+
+	/// <summary>
+	/// Enabled camera drawn this frame.
+	/// </summary>
+	struct CameraView {
+		const Camera* m_camera = nullptr;
+		RenderTargetID m_renderTarget = RENDER_TARGET_ID_NULL;
+		SDL_GPUViewport m_viewport = {};
+		SDL_Rect m_scissor = {};
+		float m_pixelSize = 1.f;
+
+		/// <summary>
+		/// Drawn in a render pass of its own that keeps the target's color but clears depth to this camera's near
+		/// plane, since it overlaps an earlier view of the same target or has a different near plane.
+		/// </summary>
+		bool m_splitPass = false;
+		std::vector<CameraBatch> m_batches;
+	};
+
+	/// <summary>
+	/// Sprite kept by the renderer between frames.
+	/// </summary>
+	struct SpriteInstance {
+		Sprite m_sprite;
+		std::uint64_t m_sortKey = 0;
+		std::uint32_t m_bufferIndex = 0;
+		bool m_alive = false;
+		bool m_dirty = false;
 	};
 
-	struct CompRenderableType {
-		bool operator()(const Renderable& lhs, const Renderable& rhs);
+	/// <summary>
+	/// Sprite filed in the static sprite grid, along with the box it was filed under.
+	/// </summary>
+	struct StaticSprite {
+		Sprite m_sprite;
+		ShapeAABB m_bounds;
+		std::uint64_t m_sortKey = 0;
+		bool m_alive = false;
 	};
 
-	struct CompRenderableSpriteTexturePage {
-		bool operator()(const Renderable& lhs, const Renderable& rhs);
+	/// <summary>
+	/// Texture that cameras draw into, with a depth buffer of its own.
+	/// </summary>
+	struct RenderTarget {
+		SDL_GPUTexture* m_sdlTexture = nullptr;
+		SDL_GPUTexture* m_sdlDepthTexture = nullptr;
+		std::uint32_t m_width = 0;
+		std::uint32_t m_height = 0;
+		bool m_alive = false;
 	};
 
-	struct CompRenderablePrimitiveWireframe {
-		bool operator()(const Renderable& lhs, const Renderable& rhs);
+	/// <summary>
+	/// Copy of a render target on its way back from the GPU.
+	/// </summary>
+	struct RenderTargetRead {
+		RenderTargetID m_renderTarget = RENDER_TARGET_ID_NULL;
+		RenderTargetReadFunc m_func;
+		SDL_GPUTransferBuffer* m_sdlTransferBuffer = nullptr;
+		std::uint32_t m_width = 0;
+		std::uint32_t m_height = 0;
+		std::uint64_t m_frameIndex = 0;
 	};
-	
-	void RenderSpriteListBatch(SDL_GPUCommandBuffer* commandBuffer, glm::mat4* cameraMatrix, const RenderableList& sprites);
-	void SetTexturePage(SDL_GPUCommandBuffer* commandBuffer, const TexturePage* texturePage);
-	void RenderPrimitiveListBatch(SDL_GPUCommandBuffer* commandBuffer, glm::mat4* cameraMatrix, const RenderableList& primitives, bool wireframe);
 
-	RenderableList m_opaqueRenderables;
-	RenderableList m_translucentRenderables;
+	/// <summary>
+	/// Run of opaque sprite instances in the instance buffer that share a batch.
+	/// </summary>
+	struct SpriteInstanceBatch {
+		std::uint64_t m_sortKey;
+		std::size_t m_instanceIndex;
+		std::uint32_t m_firstElement;
+		std::uint32_t m_elementCount;
+	};
+
+	/// <summary>
+	/// Region of the upload ring to copy into the instance buffer.
+	/// </summary>
+	struct SpriteInstanceUpload {
+		std::uint32_t m_offset;
+		std::uint32_t m_bufferOffset;
+		std::uint32_t m_size;
+	};
+
+	// Solid sprites sort ahead of the other opaque sprites, so they fill the depth buffer first
+	static constexpr std::uint32_t SPRITE_PIPELINE_SOLID = 0;
+	static constexpr std::uint32_t SPRITE_PIPELINE_PREMULTIPLIED = 1;
+	static constexpr std::uint32_t SPRITE_PIPELINE_STRAIGHT = 2;
+	static constexpr std::uint32_t SPRITE_PIPELINE_RENDER_TARGET = 3;
+
+	// Glyph pages share the render target pipeline, keyed above any render target; render target handles
+	// are kept below this, so the two never share a batch
+	static constexpr TexturePageID SPRITE_SORT_GLYPH_PAGE = 0x8000;
+
+	static std::uint64_t SpriteSortKey(const Sprite& sprite);
+	void WriteSprite(std::uint8_t* dataPtr, const Sprite& sprite) const;
+	DrawQueue& GetThreadQueue();
+	void MergeThreadQueues();
+	void GatherCameraViews(const Room* room);
+	void CaptureFrame(const Room* room);
+	void CullRenderables();
+	bool UpdateSpriteInstances();
+	void SubmitSpriteInstances();
+	void SubmitStaticSprites();
+	void SubmitParticleEmitters();
+	void WriteSpriteBatch(std::uint8_t* dataPtr, const Renderable* const* sprites, std::size_t count);
+	void WriteParticles(std::uint8_t* dataPtr, const ParticleEmitter& emitter, std::size_t begin, std::size_t end) const;
+	static std::uint32_t GetShapeCount(const Primitive& primitive);
+	static void WriteShapes(ShapeBatchInfo* dataPtr, const Primitive& primitive);
+	SDL_GPUTexture* GetTexturePageTexture(SDL_GPUCopyPass* copyPass, TexturePageID texturePageID, const TexturePage* texturePage);
+	SDL_GPUTexture* GetSpriteTexture(SDL_GPUCopyPass* copyPass, const Sprite& sprite);
+	void UploadGlyphPages(SDL_GPUCopyPass* copyPass);
+	RenderTarget* GetRenderTarget(RenderTargetID renderTarget);
+	void DownloadRenderTargets(SDL_GPUCommandBuffer* commandBuffer);
+	void FinishRenderTargetReads();
+	bool AcquireFrameSlot(std::uint32_t frameSlot, bool wait);
+	void ReleaseUnusedTexturePages();
+	void UpdateSampler();
+
+	bool m_nullDevice = false;
+	RenderCounts m_frameCounts;
+	RenderTimings m_frameTimings;
+	detail::RenderCaptureWriter* m_captureWriter = nullptr;
+	std::uint32_t m_captureFramesLeft = 0;
+	CapturedFrame m_capturedFrame;
+	RenderableList m_renderables;
+	std::uint64_t m_rendererSerial = 0;
+	std::mutex m_queueMutex;
+	std::vector<std::shared_ptr<DrawQueue>> m_queues;
+	detail::ThreadPool m_threadPool;
+	CullingBounds m_cullingBounds;
+	std::vector<CameraView> m_cameraViews;
+	detail::GPURingBuffer* m_drawIndexRing = nullptr;
+
+	bool m_compactFormats = false;
+	std::uint32_t m_spriteDataStride = 0;
+	std::uint32_t m_primitiveVertexStride = 0;
 
-	TexturePageID m_currentTexturePageID = TEXTURE_PAGE_ID_NULL;
 	SpriteList m_sprites;
-	std::size_t m_lastSpriteBatchCount = 0;
+	SpriteBatchShaderPipeline* m_spriteBatchSolidPipeline = nullptr;
 	SpriteBatchShaderPipeline* m_spriteBatchPipeline = nullptr;
-	SDL_GPUTransferBuffer* m_sdlSpriteDataTransferBuffer = nullptr;
-	SDL_GPUBuffer* m_sdlSpriteDataBuffer = nullptr;
+	SpriteBatchShaderPipeline* m_spriteBatchStraightPipeline = nullptr;
+	SpriteBatchShaderPipeline* m_spriteBatchTranslucentPipeline = nullptr;
+	SpriteBatchShaderPipeline* m_spriteBatchTranslucentStraightPipeline = nullptr;
+	detail::GPURingBuffer* m_spriteDataRing = nullptr;
+
+	std::vector<SpriteInstance> m_spriteInstances;
+	std::vector<std::size_t> m_freeSpriteInstances;
+	std::vector<std::size_t> m_dirtySpriteInstances;
+	std::vector<std::size_t> m_translucentSpriteInstances;
+	std::vector<std::size_t> m_spriteInstanceOrder;
+	std::vector<SpriteInstanceBatch> m_spriteInstanceBatches;
+	std::vector<SpriteInstanceUpload> m_spriteInstanceUploads;
+	bool m_spriteInstanceLayoutDirty = false;
+	detail::GPURingBuffer* m_spriteInstanceRing = nullptr;
+	SDL_GPUBuffer* m_sdlSpriteInstanceBuffer = nullptr;
+	std::uint32_t m_spriteInstanceCapacity = 0;
+
+	std::vector<StaticSprite> m_staticSprites;
+	std::vector<std::size_t> m_freeStaticSprites;
+	std::vector<std::uint32_t> m_staticSpriteMasks;
+	std::vector<std::size_t> m_visibleStaticSprites;
+	detail::SpatialGrid m_staticSpriteGrid;
+
+	std::vector<std::unique_ptr<ParticleEmitter>> m_particleEmitters;
+	std::vector<std::size_t> m_freeParticleEmitters;
+
+	detail::GlyphAtlas* m_glyphAtlas = nullptr;
+	std::vector<SDL_GPUTexture*> m_sdlGlyphPages;
+
+	std::vector<RenderTarget> m_renderTargets;
+	std::vector<std::size_t> m_freeRenderTargets;
+	std::vector<RenderTargetRead> m_requestedReads;
+	std::vector<RenderTargetRead> m_pendingReads;
+	RenderTargetID m_frameTarget = RENDER_TARGET_ID_NULL;
 
 	PrimitiveList m_primitives;
-	std::size_t m_lastPrimitiveVertexCount = 0;
-	std::size_t m_lastPrimitiveIndexCount = 0;
 	PrimitiveBatchShaderPipeline* m_primitiveLineBatchPipeline = nullptr;
 	PrimitiveBatchShaderPipeline* m_primitiveBatchPipeline = nullptr;
-	SDL_GPUTransferBuffer* m_sdlPrimitiveDataTransferBuffer = nullptr;
-	SDL_GPUBuffer* m_sdlPrimitiveDataVertexBuffer = nullptr;
-	SDL_GPUBuffer* m_sdlPrimitiveDataIndexBuffer = nullptr;
+	detail::GPURingBuffer* m_primitiveVertexRing = nullptr;
+	detail::GPURingBuffer* m_primitiveIndexRing = nullptr;
+	PrimitiveArena m_primitiveArena;
+
+	bool m_analyticPrimitives = false;
+	ShapeBatchShaderPipeline* m_shapeBatchPipeline = nullptr;
+	detail::GPURingBuffer* m_shapeDataRing = nullptr;
+
+	std::uint64_t m_frameIndex = 0;
+	SDL_GPUFence* m_sdlFrameFences[RENDER_FRAMES_IN_FLIGHT] = {};
 
-	bool m_clearTarget = false;
 	SDL_GPUColorTargetInfo m_sdlRenderColorTargetInfo = {};
 	SDL_GPUDepthStencilTargetInfo m_sdlRenderDepthStencilTargetInfo = {};
 	SDL_GPUSampler* m_sdlGPUSampler = nullptr;
-	SDL_GPUTexture* m_sdlGPUAtlasTexture = nullptr;
+	bool m_samplerTrilinear = false;
+	std::unordered_map<std::uint64_t, SDL_GPUTexture*> m_sdlTexturePages;
 	SDL_GPUTexture* m_sdlGPUDepthTexture = nullptr;
-	SDL_GPUTransferBuffer* m_sdlTextureTransferBuffer = nullptr;
+};
+
+/// <summary>
+/// Renderer that culls, sorts, batches & packs frames exactly like SpriteRenderer, into host memory
+/// instead of GPU buffers, and records no GPU commands. What it would have drawn is counted in
+/// GetFrameCounts, so the CPU cost of rendering can be profiled where there is no GPU.
+/// Render targets have no pixels, so they cannot be read back.
+/// </summary>
+class NullRenderer : public SpriteRenderer {
+public:
+	static constexpr bool REQUIRES_GPU_DEVICE = false;
+
+	LUNA_API NullRenderer();
 };
 
 namespace detail {
@@ -166,11 +711,43 @@ namespace detail {
 class AbstractRendererFactory {
 public:
 	LUNA_API virtual Renderer* generate() = 0;
+	LUNA_API virtual bool requires_gpu_device() const = 0;
 };
 
 // TODO find a class to tuck this into?
 LUNA_API SDL_GPUTextureFormat GetDepthStencilFormat(SDL_GPUDevice* device);
 
+/// <summary>
+/// Format of everything the renderer draws into; the window's swapchain format, or BGRA8 when headless.
+/// </summary>
+LUNA_API SDL_GPUTextureFormat GetColorTargetFormat(SDL_GPUDevice* device);
+
+/// <summary>
+/// Pack the draw state of a renderable into a key, so that a single ascending sort orders
+/// a frame for drawing and groups it into as few batches as possible.
+/// <para/>Opaque: [63] 0 | [62:61] type | [60:59] pipeline | [58:43] texture page | [42:11] depth, front to back
+/// <para/>Translucent: [63] 1 | [62:31] depth, back to front | [30:29] type | [28:27] pipeline | [26:11] texture page
+/// </summary>
+/// <param name="opaque">False if the renderable needs blending with what is behind it</param>
+/// <param name="type">Renderable type, up to 2 bits</param>
+/// <param name="pipeline">Shader pipeline variant for that type, up to 2 bits</param>
+/// <param name="texturePage">Texture page index, truncated to 16 bits</param>
+/// <param name="depth">Draw depth, where larger values are nearer the camera</param>
+/// <returns>Sort key</returns>
+constexpr std::uint64_t MakeRenderSortKey(bool opaque, std::uint32_t type, std::uint32_t pipeline, TexturePageID texturePage, std::int32_t depth) {
+	std::uint64_t state = (std::uint64_t(type & 0x3) << 18) | (std::uint64_t(pipeline & 0x3) << 16) | (std::uint64_t(texturePage) & 0xFFFF);
+	std::uint64_t biasedDepth = std::uint64_t(std::uint32_t(depth) ^ 0x80000000u);
+	if (opaque) { return (state << 43) | ((~biasedDepth & 0xFFFFFFFF) << 11); }
+	else { return (std::uint64_t(1) << 63) | (biasedDepth << 31) | (state << 11); }
+}
+
+/// <summary>
+/// Strip the depth out of a sort key, leaving only the state that must match for two renderables to share a batch.
+/// </summary>
+inline std::uint64_t RenderSortKeyState(std::uint64_t key) {
+	return (key >> 63) ? (key & ~(std::uint64_t(0xFFFFFFFF) << 31)) : (key & ~(std::uint64_t(0xFFFFFFFF) << 11));
+}
+
 } // detail
 
 /// <summary>
@@ -184,8 +761,12 @@ public:
 		static_assert(std::is_base_of_v<Renderer, T>);
 		return new T();
 	}
+	LUNA_API bool requires_gpu_device() const override {
+		return T::REQUIRES_GPU_DEVICE;
+	}
 };
 
 using SpriteRendererFactory = RendererFactory<SpriteRenderer>;
+using NullRendererFactory = RendererFactory<NullRenderer>;
 
 } // luna
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <luna/detail/common.hpp>
+#include <luna/detail/shapes.hpp>
 
 namespace luna {
 
@@ -50,11 +51,22 @@ public:
 	LUNA_API std::int32_t GetOriginX() const;
 	LUNA_API std::int32_t GetOriginY() const;
 	LUNA_API std::uint8_t GetProperties() const;
+	LUNA_API const CollisionMask* GetCollisionMask(std::int32_t animationFrame = 0) const;
+
+	/// <summary>
+	/// True if every texel of every animation frame is fully opaque, so the texture covers its whole frame.
+	/// </summary>
+	LUNA_API bool IsSolid() const;
 
 protected:
 	friend class ResourceFile;
 	void Load(ResourceFile* file, const Buffer& block) override;
 
+	/// <summary>
+	/// Build a collision mask for each animation frame from the texture page alpha channel, noting whether any texel is not fully opaque.
+	/// </summary>
+	void GenerateCollisionMasks();
+
 private:
 	const TexturePage* m_texturePage = nullptr;
 	TexturePageID m_texturePageID = 0;
@@ -74,10 +86,15 @@ private:
 	std::int32_t m_originX = 0;
 	std::int32_t m_originY = 0;
 	std::uint8_t m_properties = 0;
+	bool m_solid = false;
+	std::vector<CollisionMask> m_collisionMasks;
 };
 
 /// <summary>
 /// Resource class representing a sound file.
+/// PCM data is stored as a table of independently LZ4 compressed chunks, so streamed sounds
+/// (music, ambience) can be decoded a chunk at a time while playing. Other sounds are decoded
+/// in full when the resource file loads.
 /// </summary>
 class ResourceSound : public ResourceBase {
 public:
@@ -85,9 +102,38 @@ public:
 
 	LUNA_API bool IsValid() const override;
 
+	LUNA_API const SDL_AudioSpec& GetSpec() const;
+	LUNA_API bool IsStreamed() const;
+	LUNA_API std::uint64_t GetSize() const;
+	LUNA_API const std::uint8_t* GetData() const;
+	LUNA_API std::size_t GetChunkCount() const;
+	LUNA_API std::uint32_t GetChunkSize(std::size_t chunk) const;
+
+	/// <summary>
+	/// Decode one chunk of PCM data. Safe to call from any thread.
+	/// </summary>
+	/// <param name="chunk">Chunk index</param>
+	/// <param name="dst">Destination, at least GetChunkSize(chunk) bytes long</param>
+	/// <returns>True if successful</returns>
+	LUNA_API bool DecodeChunk(std::size_t chunk, std::uint8_t* dst) const;
+
 protected:
 	friend class ResourceFile;
 	void Load(ResourceFile* file, const Buffer& block) override;
+
+private:
+	struct Chunk {
+		std::uint64_t offset;
+		std::uint32_t compressedSize;
+		std::uint32_t uncompressedSize;
+	};
+
+	SDL_AudioSpec m_spec = {};
+	bool m_streamed = false;
+	std::uint64_t m_size = 0;
+	std::vector<Chunk> m_chunks;
+	Buffer m_encoded;
+	Buffer m_data;
 };
 
 /// <summary>
@@ -138,6 +184,8 @@ protected:
 
 /// <summary>
 /// Resource class representing a complete texture page.
+/// 32-bit pages with an alpha channel are converted to premultiplied alpha when loaded.
+/// Mip levels 1..N are generated after the owning file has loaded its textures.
 /// </summary>
 class TexturePage {
 public:
@@ -147,16 +195,35 @@ public:
 	LUNA_API std::string ErrorMessage() const;
 
 	LUNA_API std::string GetName() const;
+	LUNA_API ResourceID GetFileID() const;
+
+	/// <summary>
+	/// Get the base level's pixels, which are premultiplied if IsPremultiplied is true.
+	/// </summary>
 	LUNA_API std::uint8_t* GetData() const;
 	LUNA_API SDL_PixelFormat GetFormat() const;
+
+	/// <summary>
+	/// Get a pixel of the base level, with its color premultiplied by alpha if IsPremultiplied is true.
+	/// </summary>
 	LUNA_API SDL_Color GetPixel(unsigned int x, unsigned int y) const;
 	LUNA_API std::uint32_t GetWidth() const;
 	LUNA_API std::uint32_t GetHeight() const;
+	LUNA_API bool IsPremultiplied() const;
+	LUNA_API std::uint32_t GetMipLevelCount() const;
+	LUNA_API std::uint8_t* GetMipData(std::uint32_t level) const;
+	LUNA_API std::uint32_t GetMipWidth(std::uint32_t level) const;
+	LUNA_API std::uint32_t GetMipHeight(std::uint32_t level) const;
+
+	/// <summary>
+	/// Write the base level out as an image, premultiplied if IsPremultiplied is true.
+	/// </summary>
 	LUNA_API bool WriteToFile(std::filesystem::path outputFile = "") const;
 
 protected:
 	friend class ResourceFile;
 	void Load(ResourceFile* file, const Buffer& block);
+	void GenerateMipmaps(std::uint32_t padding);
 
 private:
 	ResourceID m_resourceFileID = RESOURCE_ID_NULL;
@@ -166,7 +233,24 @@ private:
 	std::uint32_t m_height = 0;
 	SDL_PixelFormat m_format = SDL_PixelFormat::SDL_PIXELFORMAT_UNKNOWN;
 	SDL_Palette m_palette = { 0 };
+	bool m_premultiplied = false;
 	Buffer m_buffer;
+	std::vector<Buffer> m_mipLevels;
+};
+
+/// <summary>
+/// Time spent in each stage of loading an ARC file, in nanoseconds.
+/// </summary>
+struct ResourceFileLoadStats {
+	std::uint64_t fileBytes = 0;
+	std::uint64_t compressedBytes = 0;
+	std::uint64_t uncompressedBytes = 0;
+	std::uint64_t readNS = 0;
+	std::uint64_t decryptNS = 0;
+	std::uint64_t crcNS = 0;
+	std::uint64_t decompressNS = 0;
+	std::uint64_t processNS = 0;
+	std::uint64_t indexNS = 0;
 };
 
 /// <summary>
@@ -176,10 +260,16 @@ class ResourceFile {
 public:
 	LUNA_API ResourceFile(ResourceID resourceFileID, const std::string& filename, const std::string& password);
 
+	/// <summary>
+	/// Load an ARC file that is already in memory.
+	/// </summary>
+	LUNA_API ResourceFile(ResourceID resourceFileID, const Buffer& fileBuffer, const std::string& password);
+
 	LUNA_API bool IsValid() const;
 	LUNA_API std::string ErrorMessage() const;
 	LUNA_API std::string GetFilename() const;
 	LUNA_API ResourceID GetID() const;
+	LUNA_API const ResourceFileLoadStats& GetLoadStats() const;
 
 	LUNA_API TexturePageID GetTexturePageID(const std::string& name) const;
 	LUNA_API const TexturePage* GetTexturePage(TexturePageID texturePageID) const;
@@ -189,7 +279,27 @@ public:
 	LUNA_API const ResourceTexture* GetTexture(ResourceID resourceTextureID) const;
 	LUNA_API std::size_t GetTextureCount() const;
 
+	/// <summary>
+	/// Look up the name a texture was stored under. Searches every texture in the file.
+	/// </summary>
+	/// <returns>Texture name, or an empty string if the texture is not in this file</returns>
+	LUNA_API std::string GetTextureName(ResourceID resourceTextureID) const;
+
+	LUNA_API ResourceID GetSoundID(const std::string& name) const;
+	LUNA_API const ResourceSound* GetSound(ResourceID resourceSoundID) const;
+	LUNA_API std::size_t GetSoundCount() const;
+
+protected:
+	friend class TexturePage;
+	friend class ResourceTexture;
+	friend class ResourceSound;
+	friend class ResourceText;
+	ResourceFileLoadStats m_loadStats;
+
 private:
+	void Parse(Buffer& fileBuffer, const std::string& password);
+	std::uint32_t CalculateTexturePagePadding(std::vector<std::size_t>& pageTextures) const;
+
 	ResourceID m_resourceFileID;
 	std::string m_errorMessage;
 	std::string m_filename;
@@ -197,6 +307,9 @@ private:
 	std::unordered_map<ResourceID, std::size_t> m_resourceIDMap;
 	std::vector<TexturePage> m_texturePages;
 	std::vector<ResourceTexture> m_textures;
+	std::unordered_map<std::string, std::size_t> m_soundNameMap;
+	std::unordered_map<ResourceID, std::size_t> m_soundIDMap;
+	std::vector<ResourceSound> m_sounds;
 };
 
 /// <summary>
@@ -220,6 +333,9 @@ public:
 	LUNA_API static ResourceID GetTextureID(const std::string& name, ResourceID resourceFileID = RESOURCE_ID_NULL);
 	LUNA_API static const ResourceTexture* GetTexture(ResourceID resourceTextureID, ResourceID resourceFileID = RESOURCE_ID_NULL);
 
+	LUNA_API static ResourceID GetSoundID(const std::string& name, ResourceID resourceFileID = RESOURCE_ID_NULL);
+	LUNA_API static const ResourceSound* GetSound(ResourceID resourceSoundID, ResourceID resourceFileID = RESOURCE_ID_NULL);
+
 protected:
 	friend class ResourceFile;
 	static ResourceID GenerateID();
@@ -16,9 +16,32 @@ protected:
 	SDL_GPUGraphicsPipeline* m_pipeline = nullptr;
 };
 
+/// <summary>
+/// How a sprite pipeline treats transparency & depth.
+/// </summary>
+enum class SpriteBatchPass {
+	/// <summary>
+	/// Sprites covering their whole quad, drawn front to back without blending or discarding texels, so the depth test runs before shading.
+	/// </summary>
+	Solid,
+
+	/// <summary>
+	/// Opaque sprites with empty texels, which are discarded so they neither draw nor write depth.
+	/// </summary>
+	AlphaTested,
+
+	/// <summary>
+	/// Translucent sprites, blended back to front and tested against depth without writing it.
+	/// </summary>
+	Translucent
+};
+
 class SpriteBatchShaderPipeline : public ShaderPipeline {
 public:
-	LUNA_API SpriteBatchShaderPipeline();
+	/// <param name="premultipliedAlpha">Sample textures with premultiplied alpha, rather than premultiplying texels in the shader</param>
+	/// <param name="packedData">Read sprite data in the packed 40 byte layout</param>
+	/// <param name="pass">Which sprites the pipeline draws</param>
+	LUNA_API SpriteBatchShaderPipeline(bool premultipliedAlpha = true, bool packedData = false, SpriteBatchPass pass = SpriteBatchPass::AlphaTested);
 	LUNA_API ~SpriteBatchShaderPipeline();
 
 	LUNA_API SDL_GPUGraphicsPipeline* GetPipeline() const override;
@@ -33,7 +56,9 @@ private:
 
 class PrimitiveBatchShaderPipeline : public ShaderPipeline {
 public:
-	LUNA_API PrimitiveBatchShaderPipeline(bool wireframe = false);
+	/// <param name="wireframe">Draw lines instead of triangles</param>
+	/// <param name="packedColor">Read vertices as VertexPosPackedColor instead of VertexPosColor</param>
+	LUNA_API PrimitiveBatchShaderPipeline(bool wireframe = false, bool packedColor = false);
 	LUNA_API ~PrimitiveBatchShaderPipeline();
 
 	LUNA_API SDL_GPUGraphicsPipeline* GetPipeline() const override;
@@ -46,4 +71,23 @@ private:
 	SDL_GPUShader* m_vertShader = nullptr;
 };
 
+/// <summary>
+/// Draws circles, AABBs & lines as one quad each, shaded by their signed distance field.
+/// Shapes are read from a storage buffer of ShapeBatchInfo; filled & outlined shapes share the pipeline.
+/// </summary>
+class ShapeBatchShaderPipeline : public ShaderPipeline {
+public:
+	LUNA_API ShapeBatchShaderPipeline();
+	LUNA_API ~ShapeBatchShaderPipeline();
+
+	LUNA_API SDL_GPUGraphicsPipeline* GetPipeline() const override;
+
+	LUNA_API void Clear();
+	LUNA_API bool IsValid() const override;
+
+private:
+	SDL_GPUShader* m_fragShader = nullptr;
+	SDL_GPUShader* m_vertShader = nullptr;
+};
+
 } // luna
\ No newline at end of file
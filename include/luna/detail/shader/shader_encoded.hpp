@@ -1,5 +1,5 @@
 // The following file has been auto-generated by headerencoder, modifying it may have unintended consequences.
-// Generation date: Wed Jul  2 11:05:58 2025
+// Generation date: Mon Oct 19 02:30:15 2026
 #pragma once
 #include <string>
 struct ShaderInfo {
@@ -12,5 +12,7 @@ struct ShaderInfo {
 };
 extern const ShaderInfo SpriteBatch_frag_hlsl;
 extern const ShaderInfo PrimitiveBatch_frag_hlsl;
+extern const ShaderInfo ShapeBatch_frag_hlsl;
 extern const ShaderInfo SpriteBatch_vert_hlsl;
 extern const ShaderInfo PrimitiveBatch_vert_hlsl;
+extern const ShaderInfo ShapeBatch_vert_hlsl;
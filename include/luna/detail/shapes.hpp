@@ -18,7 +18,26 @@ enum class ShapeType {
 	Unknown,
 	LineType,
 	AABBType,
-	CircleType
+	CircleType,
+	PolylineType
+};
+
+/// <summary>
+/// How the segments of a thick polyline meet.
+/// </summary>
+enum class LineJoin {
+	Miter,
+	Bevel,
+	Round
+};
+
+/// <summary>
+/// How the ends of an open thick polyline are finished.
+/// </summary>
+enum class LineCap {
+	Butt,
+	Square,
+	Round
 };
 
 class ShapeLine : public detail::Shape {
@@ -65,6 +84,89 @@ public:
 	float radius;
 };
 
+/// <summary>
+/// Connected run of line segments, optionally closed back onto its first point.
+/// </summary>
+class ShapePolyline : public detail::Shape {
+public:
+	LUNA_API ShapePolyline(std::vector<VertexPos> _points = {}, bool _closed = false);
+
+	/// <summary>
+	/// Area enclosed by a closed polyline, or 0 if it is open.
+	/// </summary>
+	float Area() const override;
+	LUNA_API ShapeAABB GetShapeAABB() const;
+
+	/// <summary>
+	/// Number of segments, counting the one back to the first point if closed.
+	/// </summary>
+	LUNA_API std::uint32_t GetSegmentCount() const;
+
+	bool operator==(const ShapePolyline& other) const;
+
+	std::vector<VertexPos> points;
+	bool closed;
+};
+
+/// <summary>
+/// One-bit-per-pixel opacity mask, stored as rows of 64-bit words.
+/// Column x of a row lives in bit (x % 64) of word (x / 64).
+/// </summary>
+class CollisionMask {
+public:
+	LUNA_API CollisionMask();
+	LUNA_API CollisionMask(std::uint32_t width, std::uint32_t height);
+
+	LUNA_API bool IsValid() const;
+	LUNA_API std::uint32_t GetWidth() const;
+	LUNA_API std::uint32_t GetHeight() const;
+	LUNA_API std::uint32_t GetStride() const;
+	LUNA_API std::uint32_t GetCount() const;
+	LUNA_API const std::uint64_t* GetRow(std::uint32_t y) const;
+	LUNA_API bool GetBit(std::int64_t x, std::int64_t y) const;
+	LUNA_API void SetBit(std::uint32_t x, std::uint32_t y, bool value);
+
+	/// <summary>
+	/// Read 64 consecutive bits from a row, starting at the given column.
+	/// Columns outside of the mask read as 0.
+	/// </summary>
+	/// <param name="x">First column (may be negative)</param>
+	/// <param name="y">Row</param>
+	/// <returns>Bit i holds column (x + i)</returns>
+	LUNA_API std::uint64_t ReadBits(std::int64_t x, std::uint32_t y) const;
+
+	/// <summary>
+	/// Check if any bit in the columns [x0, x1) of a row is set.
+	/// </summary>
+	LUNA_API bool AnyBits(std::int64_t x0, std::int64_t x1, std::uint32_t y) const;
+
+private:
+	std::uint32_t m_width;
+	std::uint32_t m_height;
+	std::uint32_t m_stride;
+	std::vector<std::uint64_t> m_words;
+};
+
+/// <summary>
+/// Collision mask placed in the world. Texel (c, r) covers the region starting at
+/// (x + c * scaleX, y + r * scaleY); negative scales mirror the mask around (x, y).
+/// </summary>
+class ShapeMask : public detail::Shape {
+public:
+	LUNA_API ShapeMask(const CollisionMask* _mask = nullptr, float _x = 0.f, float _y = 0.f, float _scaleX = 1.f, float _scaleY = 1.f);
+
+	float Area() const override;
+	LUNA_API ShapeAABB GetShapeAABB() const;
+
+	bool operator==(const ShapeMask& other) const;
+
+	const CollisionMask* mask;
+	float x;
+	float y;
+	float scaleX;
+	float scaleY;
+};
+
 LUNA_API float PointDistance(float x1, float y1, float x2, float y2);
 
 LUNA_API float PointDistance(const VertexPos& p1, const VertexPos& p2);
@@ -97,6 +199,9 @@ LUNA_API bool PointInShape(float x, float y, const ShapeAABB& shape);
 template<>
 LUNA_API bool PointInShape(float x, float y, const ShapeCircle& shape);
 
+template<>
+LUNA_API bool PointInShape(float x, float y, const ShapeMask& shape);
+
 template<typename S1, typename S2>
 LUNA_API bool ShapeIntersects(const S1& shape1, const S2& shape2) { return false; }
 
@@ -127,7 +232,59 @@ LUNA_API bool ShapeIntersects(const ShapeCircle& shape1, const ShapeAABB& shape2
 template<>
 LUNA_API bool ShapeIntersects(const ShapeCircle& shape1, const ShapeCircle& shape2);
 
-using AnyShape = std::variant<std::monostate, ShapeLine, ShapeAABB, ShapeCircle>;
+template<>
+LUNA_API bool ShapeIntersects(const ShapeMask& shape1, const ShapeMask& shape2);
+
+template<>
+LUNA_API bool ShapeIntersects(const ShapeMask& shape1, const ShapeAABB& shape2);
+
+template<>
+LUNA_API bool ShapeIntersects(const ShapeAABB& shape1, const ShapeMask& shape2);
+
+using AnyShape = std::variant<std::monostate, ShapeLine, ShapeAABB, ShapeCircle, ShapePolyline>;
+
+/// <summary>
+/// Test a structure-of-arrays list of circles against an AABB, with the same result as ShapeIntersects.
+/// </summary>
+/// <param name="x">Circle centers along x</param>
+/// <param name="y">Circle centers along y</param>
+/// <param name="radius">Circle radii</param>
+/// <param name="count">Number of circles</param>
+/// <param name="bounds">Box to test against</param>
+/// <param name="visible">Set to 1 for each circle touching the box, and 0 for the rest</param>
+LUNA_API void CullCircles(const float* x, const float* y, const float* radius, std::size_t count, const ShapeAABB& bounds, std::uint8_t* visible);
+
+/// <summary>
+/// Test a structure-of-arrays list of AABBs against an AABB, with the same result as ShapeIntersects.
+/// </summary>
+/// <param name="left">Box left edges</param>
+/// <param name="top">Box top edges</param>
+/// <param name="right">Box right edges</param>
+/// <param name="bottom">Box bottom edges</param>
+/// <param name="count">Number of boxes</param>
+/// <param name="bounds">Box to test against</param>
+/// <param name="visible">Set to 1 for each box touching the bounds, and 0 for the rest</param>
+LUNA_API void CullAABBs(const float* left, const float* top, const float* right, const float* bottom, std::size_t count, const ShapeAABB& bounds, std::uint8_t* visible);
+
+/// <summary>
+/// Vertices & 32 bit indices that primitives write their geometry into.
+/// Clearing keeps the storage, so an arena reused every frame stops allocating once it has held the largest frame.
+/// </summary>
+class PrimitiveArena {
+public:
+	LUNA_API void Clear();
+
+	LUNA_API std::uint32_t GetVertexCount() const;
+	LUNA_API std::uint32_t GetIndexCount() const;
+	LUNA_API const VertexPosColor* GetVertices() const;
+	LUNA_API const std::uint32_t* GetIndices() const;
+
+private:
+	friend class Primitive;
+	std::vector<VertexPosColor> m_vertices;
+	std::vector<std::uint32_t> m_indices;
+	std::vector<std::pair<std::uint32_t, std::uint32_t>> m_edges;
+};
 
 class Primitive {
 public:
@@ -135,25 +292,41 @@ public:
 	LUNA_API Primitive(ShapeLine shape, bool outline = false, std::int32_t depth = 0, SDL_Color blend = LunaColorWhite);
 	LUNA_API Primitive(ShapeAABB shape, bool outline = false, std::int32_t depth = 0, SDL_Color blend = LunaColorWhite);
 	LUNA_API Primitive(ShapeCircle shape, bool outline = false, std::int32_t depth = 0, SDL_Color blend = LunaColorWhite);
+	/// <param name="width">Width of the line in world units</param>
+	LUNA_API Primitive(ShapePolyline shape, float width = 1.f, LineJoin join = LineJoin::Miter, LineCap cap = LineCap::Butt, std::int32_t depth = 0, SDL_Color blend = LunaColorWhite);
 	LUNA_API Primitive(const Primitive& primitive);
 	LUNA_API Primitive(Primitive&& primitive) noexcept;
 
 	LUNA_API bool IsWireframe() const;
 
-	LUNA_API AnyShape GetShape() const;
+	LUNA_API const AnyShape& GetShape() const;
 	LUNA_API ShapeType GetShapeType() const;
 	LUNA_API bool GetOutline() const;
+	LUNA_API float GetWidth() const;
+	LUNA_API LineJoin GetLineJoin() const;
+	LUNA_API LineCap GetLineCap() const;
 	LUNA_API std::int32_t GetDepth() const;
 	LUNA_API SDL_Color GetBlend() const;
 	LUNA_API float GetAlpha() const;
 
-	LUNA_API std::vector<VertexPosColor> GetVertices();
-	LUNA_API std::vector<std::uint16_t> GetIndices();
+	LUNA_API std::vector<VertexPosColor> GetVertices() const;
+	LUNA_API std::vector<std::uint16_t> GetIndices() const;
+
+	/// <summary>
+	/// Append this primitive's vertices & indices to an arena.
+	/// </summary>
+	/// <param name="arena">Arena to write into</param>
+	/// <param name="baseVertex">Arena vertex that indices are counted from</param>
+	LUNA_API void WriteGeometry(PrimitiveArena& arena, std::uint32_t baseVertex = 0) const;
 
 	LUNA_API void SetShape(ShapeLine shape);
 	LUNA_API void SetShape(ShapeAABB shape);
 	LUNA_API void SetShape(ShapeCircle shape);
+	LUNA_API void SetShape(ShapePolyline shape);
 	LUNA_API void SetOutline(bool outline);
+	LUNA_API void SetWidth(float width);
+	LUNA_API void SetLineJoin(LineJoin join);
+	LUNA_API void SetLineCap(LineCap cap);
 	LUNA_API void SetDepth(std::int32_t depth);
 	LUNA_API void SetBlend(SDL_Color blend);
 	LUNA_API void SetAlpha(float alpha);
@@ -163,16 +336,14 @@ public:
 	LUNA_API bool operator==(const Primitive& other) const;
 
 private:
-	void CalculateVertices();
-
 	AnyShape m_shape;
 	ShapeType m_shapeType;
 	bool m_outline;
+	float m_width;
+	LineJoin m_join;
+	LineCap m_cap;
 	std::int32_t m_depth;
 	SDL_Color m_blend;
-	std::vector<VertexPosColor> m_vertices;
-	std::vector<std::uint16_t> m_indices;
-	bool m_dirty;
 };
 
 using PrimitiveList = std::vector<Primitive>;
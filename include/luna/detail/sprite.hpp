@@ -8,9 +8,23 @@ namespace luna {
 
 typedef std::uint32_t SpriteID;
 constexpr SpriteID SPRITE_ID_NULL = 0;
+typedef std::uint32_t RenderTargetID;
+constexpr RenderTargetID RENDER_TARGET_ID_NULL = 0;
+typedef std::uint32_t GlyphPageID;
+constexpr GlyphPageID GLYPH_PAGE_ID_NULL = 0;
 
 // Forward declarations
 class RoomManager;
+class SpriteRenderer;
+namespace detail { class GlyphAtlas; }
+
+/// <summary>
+/// Method used to composite a sprite onto the render target.
+/// </summary>
+enum class SpriteBlendMode {
+	Normal,
+	Additive
+};
 
 struct SpriteTextureCoords {
 	float textureU;
@@ -29,6 +43,16 @@ public:
 	LUNA_API Sprite(Sprite&& sprite) noexcept;
 	LUNA_API Sprite(const ResourceID textureID, float x, float y, int32_t image = 0, float imageSpeed = 0.f, int32_t depth = 0, float scaleX = 1.f, float scaleY = 1.f, float rotation = 0.f, SDL_Color blend = LunaColorWhite);
 
+	/// <summary>
+	/// Make a sprite that shows the whole of a render target. Render targets are treated as premultiplied
+	/// & translucent, and show whatever was last drawn into them; cameras drawing into a target are drawn
+	/// before the sprites that show it.
+	/// </summary>
+	/// <param name="renderTarget">Render target to sample</param>
+	/// <param name="width">Width of the sprite in world units</param>
+	/// <param name="height">Height of the sprite in world units</param>
+	LUNA_API static Sprite FromRenderTarget(RenderTargetID renderTarget, std::uint32_t width, std::uint32_t height, float x, float y, int32_t depth = 0, float scaleX = 1.f, float scaleY = 1.f, float rotation = 0.f, SDL_Color blend = LunaColorWhite);
+
 	LUNA_API bool IsValid() const;
 
 	LUNA_API float GetPositionX() const;
@@ -42,15 +66,28 @@ public:
 	LUNA_API std::int32_t GetNumImages() const;
 	LUNA_API std::int32_t GetDepth() const;
 	LUNA_API ResourceID GetTextureID() const;
+	LUNA_API RenderTargetID GetRenderTargetID() const;
+
+	/// <summary>
+	/// Get the glyph atlas page shown by a sprite laid out from text, or GLYPH_PAGE_ID_NULL for any other sprite.
+	/// </summary>
+	LUNA_API GlyphPageID GetGlyphPageID() const;
 	LUNA_API SpriteTextureCoords GetTextureCoords() const;
 	LUNA_API TexturePageID GetTexturePageID() const;
 	LUNA_API const TexturePage* GetTexturePage() const;
 	LUNA_API SDL_Color GetBlend() const;
 	LUNA_API float GetAlpha() const;
+	LUNA_API SpriteBlendMode GetBlendMode() const;
 	LUNA_API float GetOriginX() const;
 	LUNA_API float GetOriginY() const;
 	LUNA_API bool GetTranslucent() const;
 
+	/// <summary>
+	/// True if the sprite fully covers its quad: a texture without transparent texels, shown with an opaque tint.
+	/// Solid sprites are drawn without alpha testing, so the GPU can reject them by depth before shading.
+	/// </summary>
+	LUNA_API bool GetSolid() const;
+
 	LUNA_API void SetPositionX(float x);
 	LUNA_API void SetPositionY(float y);
 	LUNA_API void SetScaleX(float scaleX);
@@ -60,11 +97,13 @@ public:
 	LUNA_API void SetDepth(std::int32_t depth);
 	LUNA_API void SetBlend(const SDL_Color& blend);
 	LUNA_API void SetAlpha(float alpha);
+	LUNA_API void SetBlendMode(SpriteBlendMode blendMode);
 	LUNA_API void SetOriginX(std::int32_t originX);
 	LUNA_API void SetOriginY(std::int32_t originY);
 
 	LUNA_API ShapeAABB GetShapeAABB() const;
 	LUNA_API ShapeCircle GetShapeCircle() const;
+	LUNA_API ShapeMask GetShapeMask() const;
 
 	LUNA_API Sprite& operator=(const Sprite& other);
 	LUNA_API Sprite& operator=(Sprite&& other) noexcept;
@@ -74,11 +113,23 @@ protected:
 	bool Tick(float dt);
 
 private:
+	friend class SpriteRenderer;
+	friend class detail::GlyphAtlas;
+
+	/// <summary>
+	/// Make a sprite that shows one glyph in the renderer's glyph atlas. Glyphs are premultiplied & translucent,
+	/// and only stay in the atlas for the frame they were laid out in, so only the renderer makes these.
+	/// </summary>
+	static Sprite FromGlyph(GlyphPageID glyphPage, const SpriteTextureCoords& coords, float width, float height, float x, float y, int32_t depth, float scale, SDL_Color blend);
+
 	void CalculateUVs();
 
 	const ResourceTexture* m_texture = nullptr;
 	ResourceID m_textureID = RESOURCE_ID_NULL;
+	RenderTargetID m_renderTargetID = RENDER_TARGET_ID_NULL;
+	GlyphPageID m_glyphPageID = GLYPH_PAGE_ID_NULL;
 	SDL_Color m_blend = LunaColorWhite;
+	SpriteBlendMode m_blendMode = SpriteBlendMode::Normal;
 	float m_positionX = 0.f;
 	float m_positionY = 0.f;
 	float m_width = 0.f;
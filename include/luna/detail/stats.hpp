@@ -0,0 +1,117 @@
+#pragma once
+
+#include <luna/detail/common.hpp>
+#include <luna/detail/render.hpp>
+
+namespace luna {
+
+class Room;
+
+/// <summary>
+/// Where the last frame's time went, in milliseconds, along with the renderer's own stages & counts.
+/// </summary>
+struct FrameStats {
+	/// <summary>
+	/// Time from the start of the last frame to the start of the one after it.
+	/// </summary>
+	float frameMs = 0.f;
+
+	/// <summary>
+	/// Time spent ticking the room, including the tick callbacks.
+	/// </summary>
+	float tickMs = 0.f;
+
+	/// <summary>
+	/// Time spent handing the frame's sprites & primitives to the renderer, including the draw callbacks.
+	/// </summary>
+	float drawSubmitMs = 0.f;
+
+	/// <summary>
+	/// Time spent in the renderer drawing the frame; broken down further in render.
+	/// </summary>
+	float drawMs = 0.f;
+
+	RenderTimings render;
+	RenderCounts counts;
+};
+
+/// <summary>
+/// Frame times over a rolling window of the most recent frames, filed into fixed width buckets.
+/// </summary>
+class FrameTimeHistogram {
+public:
+	/// <param name="windowSize">Number of recent frames kept</param>
+	/// <param name="bucketWidthMs">Width of each bucket</param>
+	/// <param name="bucketCount">Number of buckets; frames slower than the last bucket are filed into it</param>
+	LUNA_API FrameTimeHistogram(std::size_t windowSize = 1000, float bucketWidthMs = 1.f, std::size_t bucketCount = 100);
+
+	/// <summary>
+	/// Add a frame, dropping the oldest one if the window is full.
+	/// </summary>
+	LUNA_API void Record(float frameMs);
+	LUNA_API void Clear();
+
+	LUNA_API std::size_t GetSampleCount() const;
+	LUNA_API std::size_t GetWindowSize() const;
+
+	/// <summary>
+	/// Get a recorded frame time.
+	/// </summary>
+	/// <param name="age">Number of frames recorded since, so 0 is the newest frame</param>
+	/// <returns>Frame time, or 0 if fewer frames have been recorded</returns>
+	LUNA_API float GetRecent(std::size_t age) const;
+	LUNA_API float GetMean() const;
+	LUNA_API float GetMax() const;
+
+	/// <summary>
+	/// Get the frame time that the given percentage of frames in the window are faster than or equal to.
+	/// </summary>
+	LUNA_API float GetPercentile(float percent) const;
+
+	/// <summary>
+	/// Get the mean time of the slowest frames in the window, e.g. the 1% low for percent = 1.
+	/// </summary>
+	LUNA_API float GetLow(float percent = 1.f) const;
+
+	LUNA_API std::size_t GetBucketCount() const;
+	LUNA_API float GetBucketWidth() const;
+
+	/// <summary>
+	/// Get the number of frames in the window that took [index * width, (index + 1) * width) milliseconds.
+	/// </summary>
+	LUNA_API std::size_t GetBucket(std::size_t index) const;
+
+private:
+	std::size_t GetBucketIndex(float frameMs) const;
+
+	std::vector<float> m_samples;
+	std::vector<std::size_t> m_buckets;
+	std::size_t m_windowSize = 0;
+	std::size_t m_next = 0;
+	float m_bucketWidthMs = 1.f;
+	double m_sum = 0.0;
+};
+
+namespace detail {
+
+using StatsClock = std::chrono::steady_clock;
+
+/// <summary>
+/// Milliseconds since the given time point.
+/// </summary>
+inline float ElapsedMs(StatsClock::time_point start) {
+	return std::chrono::duration<float, std::milli>(StatsClock::now() - start).count();
+}
+
+/// <summary>
+/// Draw a frame time graph & a breakdown of the last frame's stages over the top left corner of the room's active camera,
+/// or of the first camera drawing into the frame if the active one draws into a render target.
+/// <para/>Graph: one bar per recent frame, green under 16.7ms, yellow under 33.3ms & red above, with lines
+/// at 16.7ms & 33.3ms and a white line at the 1% low.
+/// <para/>Breakdown: tick, submit, gather, cull, prepare, sort, batch, pack, GPU submit & fence wait, stacked left to right.
+/// </summary>
+void DrawStatsOverlay(Renderer* renderer, const Room* room, const FrameStats& stats, const FrameTimeHistogram& histogram);
+
+} // detail
+
+} // luna
\ No newline at end of file
@@ -100,7 +100,7 @@ public:
 		push_string(value.data(), value.size(), maxLen);
 	}
 	void push_string(const char* value, std::size_t len, std::size_t maxLen) {
-		while (m_size + len >= m_capacity) { resize(); }
+		while (m_size + maxLen >= m_capacity) { resize(); }
 		for (std::size_t i = 0; i < maxLen; ++i) {
 			if (i < len) { m_data[m_size++] = std::uint8_t(value[i]); }
 			else { m_data[m_size++] = 0; }
@@ -160,7 +160,7 @@ public:
 		return get_internal<std::uint64_t>(pos);
 	}
 	std::string get_string(std::size_t pos, std::size_t len) const {
-		if (pos + len > m_size) { throw std::out_of_range("Buffer out of range"); }
+		if (pos > m_size || len > m_size - pos) { throw std::out_of_range("Buffer out of range"); }
 		std::string res((char*)&m_data[pos], len);
 		std::size_t end = res.find_last_not_of((char)0);
 		if (end != std::string::npos) {
@@ -193,7 +193,7 @@ public:
 	}
 
 	AlignedBuffer<A> get_chunk(std::size_t pos, std::size_t len) const {
-		if (pos + len > m_size) { throw std::out_of_range("Buffer out of range"); }
+		if (pos > m_size || len > m_size - pos) { throw std::out_of_range("Buffer out of range"); }
 		return AlignedBuffer<A>(&m_data[pos], len);
 	}
 	void pad(std::size_t alignTo) {
@@ -211,8 +211,9 @@ private:
 	void resize(std::size_t newCapacity = 0) {
 		if (newCapacity == 0) { newCapacity = NextPow2(m_capacity + 1); }
 		std::uint8_t* newData = new std::uint8_t[newCapacity];
-		memcpy_s(newData, newCapacity, m_data, m_capacity);
+		memcpy_s(newData, newCapacity, m_data, m_size);
 		delete[] m_data;
+		m_data = newData;
 		m_capacity = newCapacity;
 	}
 
@@ -230,7 +231,7 @@ private:
 
 	template<typename T>
 	T get_internal(std::size_t pos) const {
-		if (pos + sizeof(T) > m_size) { throw std::out_of_range(""); }
+		if (pos > m_size || sizeof(T) > m_size - pos) { throw std::out_of_range(""); }
 		T value = T();
 		memcpy_s(&value, sizeof(T), &m_data[pos], sizeof(T));
 		return value;
@@ -238,7 +239,7 @@ private:
 
 	template<typename T>
 	void set_internal(T value, std::size_t pos) {
-		if (pos + sizeof(T) > m_size) { throw std::out_of_range(""); }
+		if (pos > m_size || sizeof(T) > m_size - pos) { throw std::out_of_range(""); }
 		memcpy_s(&m_data[pos], sizeof(T), &value, sizeof(T));
 	}
 
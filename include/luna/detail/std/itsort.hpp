@@ -1,7 +1,9 @@
 #pragma once
 
+#include <cstdint>
 #include <iterator>
 #include <algorithm>
+#include <vector>
 
 namespace luna {
 namespace detail {
@@ -389,6 +391,64 @@ private:
 	IntroSort() {}
 	~IntroSort() {}
 };
+
+/// <summary>
+/// <para/>Radix Sort
+/// <para/>Time: O(n * k)
+/// <para/>Space: O(n)
+/// <para/>Stable
+/// <para/>Sort by an unsigned 64-bit key one byte at a time, starting with the least
+/// significant byte. All 8 histograms are built in a single pass, and bytes that are
+/// the same for every key are skipped entirely. Beats comparison sorts for large
+/// sets whose ordering can be packed into a single integer.
+/// </summary>
+class RadixSort {
+public:
+	template<class RandomAccessIterator, class KeyFunc>
+	static void sort(RandomAccessIterator begin, RandomAccessIterator end, KeyFunc key) {
+		typedef typename std::iterator_traits<RandomAccessIterator>::value_type ValueType;
+		std::size_t size = std::size_t(std::distance(begin, end));
+		if (size < 2) { return; }
+		//Count the occurrences of every byte value, for every byte of the key
+		std::vector<std::size_t> counts(8 * 256, 0);
+		for (auto it = begin; it != end; ++it) {
+			std::uint64_t k = std::uint64_t(key(*it));
+			for (std::size_t d = 0; d < 8; ++d) {
+				++counts[(d * 256) + ((k >> (d * 8)) & 0xFF)];
+			}
+		}
+		//Scatter back and forth between the range and a scratch buffer
+		std::vector<ValueType> scratch(size);
+		bool inScratch = false;
+		std::uint64_t firstKey = std::uint64_t(key(*begin));
+		for (std::size_t d = 0; d < 8; ++d) {
+			std::size_t* count = &counts[d * 256];
+			if (count[(firstKey >> (d * 8)) & 0xFF] == size) { continue; }
+			std::size_t offset = 0;
+			for (std::size_t i = 0; i < 256; ++i) {
+				std::size_t c = count[i];
+				count[i] = offset;
+				offset += c;
+			}
+			if (!inScratch) { radix_scatter(begin, end, scratch.begin(), count, d, key); }
+			else { radix_scatter(scratch.begin(), scratch.end(), begin, count, d, key); }
+			inScratch = !inScratch;
+			firstKey = std::uint64_t(key((inScratch) ? scratch[0] : *begin));
+		}
+		if (inScratch) { std::move(scratch.begin(), scratch.end(), begin); }
+	}
+
+	template<class SrcIterator, class DstIterator, class KeyFunc>
+	static void radix_scatter(SrcIterator begin, SrcIterator end, DstIterator dst, std::size_t* offsets, std::size_t digit, KeyFunc key) {
+		for (auto it = begin; it != end; ++it) {
+			std::size_t bucket = std::size_t((std::uint64_t(key(*it)) >> (digit * 8)) & 0xFF);
+			*std::next(dst, offsets[bucket]++) = std::move(*it);
+		}
+	}
+private:
+	RadixSort() {}
+	~RadixSort() {}
+};
 } // detail
 
 template<class RandomAccessIterator>
@@ -440,4 +500,14 @@ template<class RandomAccessIterator, class Compare>
 void intro_sort(RandomAccessIterator const begin, RandomAccessIterator const end, Compare comp) {
 	detail::IntroSort::sort(begin, end, comp);
 }
+
+template<class RandomAccessIterator>
+void radix_sort(RandomAccessIterator const begin, RandomAccessIterator const end) {
+	typedef typename std::iterator_traits<RandomAccessIterator>::value_type ValueType;
+	detail::RadixSort::sort(begin, end, [](const ValueType& value) { return std::uint64_t(value); });
+}
+template<class RandomAccessIterator, class KeyFunc>
+void radix_sort(RandomAccessIterator const begin, RandomAccessIterator const end, KeyFunc key) {
+	detail::RadixSort::sort(begin, end, key);
+}
 } // luna
\ No newline at end of file
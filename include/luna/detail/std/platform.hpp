@@ -48,8 +48,9 @@
 #endif
 
 // SIMD Definitions
+// AVX2 paths are only built when the compiler targets AVX2 (see LUNA_ENABLE_AVX2)
 //#define LUNA_DISABLE_SIMD
-#if (defined(LUNA_ARCH_X86) || defined(LUNA_ARCH_X64)) && !defined(LUNA_DISABLE_SIMD) && !defined(LUNA_CMP_UNKNOWN)
+#if (defined(LUNA_ARCH_X86) || defined(LUNA_ARCH_X64)) && defined(__AVX2__) && !defined(LUNA_DISABLE_SIMD) && !defined(LUNA_CMP_UNKNOWN)
 # define LUNA_SIMD_AVX
 
 #elif (defined(LUNA_ARCH_ARM) || defined(LUNA_ARCH_ARM64)) && !defined(LUNA_DISABLE_SIMD) && !defined(LUNA_CMP_UNKNOWN)
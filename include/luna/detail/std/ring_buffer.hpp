@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace luna {
+namespace detail {
+
+/// <summary>
+/// Lock-free byte queue for exactly one producer thread and one consumer thread.
+/// </summary>
+class RingBuffer {
+public:
+	RingBuffer() = default;
+	RingBuffer(std::size_t capacity) {
+		reset(capacity);
+	}
+	RingBuffer(const RingBuffer&) = delete;
+	RingBuffer& operator=(const RingBuffer&) = delete;
+
+	/// <summary>
+	/// Reallocate the queue, rounding the capacity up to a power of 2.
+	/// Neither side may be using the queue while this runs.
+	/// </summary>
+	void reset(std::size_t capacity) {
+		std::size_t pow2 = 1;
+		while (pow2 < capacity) { pow2 <<= 1; }
+		m_data.reset(new std::uint8_t[pow2]);
+		m_capacity = pow2;
+		clear();
+	}
+
+	/// <summary>
+	/// Empty the queue. Neither side may be using the queue while this runs.
+	/// </summary>
+	void clear() {
+		m_head.store(0, std::memory_order_relaxed);
+		m_tail.store(0, std::memory_order_relaxed);
+	}
+
+	std::size_t capacity() const {
+		return m_capacity;
+	}
+	std::size_t size() const {
+		return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+	}
+	std::size_t space() const {
+		return m_capacity - size();
+	}
+
+	/// <summary>
+	/// Append bytes to the queue. Producer thread only.
+	/// </summary>
+	/// <returns>Number of bytes written</returns>
+	std::size_t write(const std::uint8_t* data, std::size_t len) {
+		std::size_t head = m_head.load(std::memory_order_relaxed);
+		std::size_t tail = m_tail.load(std::memory_order_acquire);
+		len = std::min(len, m_capacity - (head - tail));
+		std::size_t start = head & (m_capacity - 1);
+		std::size_t first = std::min(len, m_capacity - start);
+		memcpy(&m_data[start], data, first);
+		memcpy(&m_data[0], data + first, len - first);
+		m_head.store(head + len, std::memory_order_release);
+		return len;
+	}
+
+	/// <summary>
+	/// Remove bytes from the queue. Consumer thread only.
+	/// </summary>
+	/// <returns>Number of bytes read</returns>
+	std::size_t read(std::uint8_t* data, std::size_t len) {
+		std::size_t tail = m_tail.load(std::memory_order_relaxed);
+		std::size_t head = m_head.load(std::memory_order_acquire);
+		len = std::min(len, head - tail);
+		std::size_t start = tail & (m_capacity - 1);
+		std::size_t first = std::min(len, m_capacity - start);
+		memcpy(data, &m_data[start], first);
+		memcpy(data + first, &m_data[0], len - first);
+		m_tail.store(tail + len, std::memory_order_release);
+		return len;
+	}
+
+private:
+	std::unique_ptr<std::uint8_t[]> m_data;
+	std::size_t m_capacity = 0;
+	std::atomic<std::size_t> m_head = 0;
+	std::atomic<std::size_t> m_tail = 0;
+};
+
+} // namespace detail
+} // luna
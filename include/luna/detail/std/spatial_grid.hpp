@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+namespace luna {
+namespace detail {
+
+/// <summary>
+/// Uniform grid of square cells over an unbounded plane, for finding which items' boxes touch a region.
+/// Each item is filed under every cell its box touches, and cells are only allocated once something
+/// is in them, so memory follows the items rather than the size of the world. Items spanning too many
+/// cells are kept in a list of their own, and reported by every query.
+/// </summary>
+class SpatialGrid {
+public:
+	/// <param name="cellSize">Width & height of a cell</param>
+	/// <param name="maxCellsPerItem">Most cells an item may be filed under before it is treated as large</param>
+	SpatialGrid(float cellSize = 256.f, std::size_t maxCellsPerItem = 64) :
+		m_cellSize(cellSize),
+		m_maxCellsPerItem(maxCellsPerItem) {}
+
+	/// <summary>
+	/// File an item under the cells its box touches. Items are identified by small integers, such as slot indices.
+	/// </summary>
+	void insert(std::uint32_t id, float left, float top, float right, float bottom) {
+		if (id >= m_stamps.size()) { m_stamps.resize(std::size_t(id) + 1, 0); }
+		CellRange range = cell_range(left, top, right, bottom);
+		if (range.count() > m_maxCellsPerItem) {
+			m_large.push_back(id);
+			return;
+		}
+		for (std::int32_t y = range.top; y <= range.bottom; ++y) {
+			for (std::int32_t x = range.left; x <= range.right; ++x) { m_cells[cell_key(x, y)].push_back(id); }
+		}
+	}
+
+	/// <summary>
+	/// Take an item out of the grid. The box must be the one it was inserted with.
+	/// </summary>
+	void erase(std::uint32_t id, float left, float top, float right, float bottom) {
+		CellRange range = cell_range(left, top, right, bottom);
+		if (range.count() > m_maxCellsPerItem) {
+			erase_from(m_large, id);
+			return;
+		}
+		for (std::int32_t y = range.top; y <= range.bottom; ++y) {
+			for (std::int32_t x = range.left; x <= range.right; ++x) {
+				auto it = m_cells.find(cell_key(x, y));
+				if (it == m_cells.end()) { continue; }
+				erase_from(it->second, id);
+				if (it->second.empty()) { m_cells.erase(it); }
+			}
+		}
+	}
+
+	/// <summary>
+	/// Remove every item.
+	/// </summary>
+	void clear() {
+		m_cells.clear();
+		m_large.clear();
+		m_stamps.clear();
+		m_stamp = 0;
+	}
+
+	/// <summary>
+	/// Call func(id) once for every item filed under a cell the box touches.
+	/// Items are reported at most once, but may not actually touch the box.
+	/// </summary>
+	template<class Func>
+	void query(float left, float top, float right, float bottom, Func func) {
+		// Stamp items as they are reported, so those spanning several cells are only reported once
+		if (++m_stamp == 0) {
+			std::fill(m_stamps.begin(), m_stamps.end(), 0);
+			m_stamp = 1;
+		}
+		for (auto id : m_large) { func(id); }
+		CellRange range = cell_range(left, top, right, bottom);
+		for (std::int32_t y = range.top; y <= range.bottom; ++y) {
+			for (std::int32_t x = range.left; x <= range.right; ++x) {
+				auto it = m_cells.find(cell_key(x, y));
+				if (it == m_cells.end()) { continue; }
+				for (auto id : it->second) {
+					if (m_stamps[id] == m_stamp) { continue; }
+					m_stamps[id] = m_stamp;
+					func(id);
+				}
+			}
+		}
+	}
+
+private:
+	struct CellRange {
+		std::int32_t left, top, right, bottom;
+		std::size_t count() const { return std::size_t(right - left + 1) * std::size_t(bottom - top + 1); }
+	};
+
+	std::int32_t cell_coord(float value) const {
+		float cell = std::floor(value / m_cellSize);
+		return std::int32_t(std::max(std::min(cell, 1e9f), -1e9f));
+	}
+
+	CellRange cell_range(float left, float top, float right, float bottom) const {
+		return { cell_coord(std::min(left, right)), cell_coord(std::min(top, bottom)), cell_coord(std::max(left, right)), cell_coord(std::max(top, bottom)) };
+	}
+
+	static std::uint64_t cell_key(std::int32_t x, std::int32_t y) {
+		return (std::uint64_t(std::uint32_t(x)) << 32) | std::uint32_t(y);
+	}
+
+	static void erase_from(std::vector<std::uint32_t>& items, std::uint32_t id) {
+		auto it = std::find(items.begin(), items.end(), id);
+		if (it == items.end()) { return; }
+		*it = items.back();
+		items.pop_back();
+	}
+
+	float m_cellSize;
+	std::size_t m_maxCellsPerItem;
+	std::unordered_map<std::uint64_t, std::vector<std::uint32_t>> m_cells;
+	std::vector<std::uint32_t> m_large;
+	std::vector<std::uint32_t> m_stamps;
+	std::uint32_t m_stamp = 0;
+};
+
+} // namespace detail
+} // luna
\ No newline at end of file
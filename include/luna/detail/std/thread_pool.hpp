@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace luna {
+namespace detail {
+
+/// <summary>
+/// Fixed set of worker threads for splitting loops across cores.
+/// Only one thread may hand out work at a time; it takes part in the work itself and
+/// returns once every chunk has been processed.
+/// </summary>
+class ThreadPool {
+public:
+	/// <param name="threadCount">Number of workers, or 0 to leave one core for the calling thread</param>
+	ThreadPool(std::size_t threadCount = 0) {
+		if (threadCount == 0) {
+			std::size_t cores = std::size_t(std::thread::hardware_concurrency());
+			threadCount = (cores > 1) ? cores - 1 : 0;
+		}
+		for (std::size_t i = 0; i < threadCount; ++i) {
+			m_threads.emplace_back(&ThreadPool::worker_loop, this);
+		}
+	}
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+	~ThreadPool() {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_quit = true;
+		}
+		m_wake.notify_all();
+		for (auto& thread : m_threads) { thread.join(); }
+	}
+
+	/// <summary>
+	/// Number of worker threads, not counting the caller.
+	/// </summary>
+	std::size_t size() const {
+		return m_threads.size();
+	}
+
+	/// <summary>
+	/// Call func(begin, end) over [0, count) in chunks of at most grain elements, spread across
+	/// the workers and the calling thread. Small ranges run inline.
+	/// </summary>
+	template<class Func>
+	void parallel_for(std::size_t count, std::size_t grain, Func func) {
+		grain = std::max<std::size_t>(grain, 1);
+		if (count == 0) { return; }
+		if (m_threads.empty() || count <= grain) {
+			func(std::size_t(0), count);
+			return;
+		}
+
+		// Publish the job & wake the workers
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_job = [&func](std::size_t begin, std::size_t end) { func(begin, end); };
+			m_count = count;
+			m_grain = grain;
+			m_next.store(0, std::memory_order_relaxed);
+			m_pending = m_threads.size();
+			++m_generation;
+		}
+		m_wake.notify_all();
+
+		// Help out, then wait for the stragglers
+		run_chunks();
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_done.wait(lock, [this]() { return m_pending == 0; });
+		m_job = nullptr;
+	}
+
+private:
+	void run_chunks() {
+		while (true) {
+			std::size_t begin = m_next.fetch_add(m_grain, std::memory_order_relaxed);
+			if (begin >= m_count) { break; }
+			m_job(begin, std::min(begin + m_grain, m_count));
+		}
+	}
+
+	void worker_loop() {
+		std::uint64_t seenGeneration = 0;
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_wake.wait(lock, [&]() { return m_quit || m_generation != seenGeneration; });
+				if (m_quit) { return; }
+				seenGeneration = m_generation;
+			}
+			run_chunks();
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				--m_pending;
+			}
+			m_done.notify_one();
+		}
+	}
+
+	std::vector<std::thread> m_threads;
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_done;
+	std::function<void(std::size_t, std::size_t)> m_job;
+	std::size_t m_count = 0;
+	std::size_t m_grain = 1;
+	std::atomic<std::size_t> m_next = 0;
+	std::size_t m_pending = 0;
+	std::uint64_t m_generation = 0;
+	bool m_quit = false;
+};
+
+} // namespace detail
+} // luna
\ No newline at end of file
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <luna/detail/common.hpp>
+#include <luna/detail/sprite.hpp>
+
+namespace luna {
+
+typedef std::uint32_t FontID;
+constexpr FontID FONT_ID_NULL = 0;
+
+/// <summary>
+/// Which end of each line a string is anchored at.
+/// </summary>
+enum class TextAlign {
+	Left,
+	Center,
+	Right
+};
+
+/// <summary>
+/// String drawn in a font loaded by the renderer. Lines are broken at '\n', and each line is aligned
+/// on its own; the position is the top of the first line, at the aligned end.
+/// </summary>
+class Text {
+public:
+	LUNA_API Text();
+	LUNA_API Text(FontID font, const std::string& string, float x, float y, std::int32_t depth = 0, SDL_Color color = LunaColorWhite, TextAlign align = TextAlign::Left, float scale = 1.f);
+
+	LUNA_API bool IsValid() const;
+
+	LUNA_API FontID GetFont() const;
+	LUNA_API const std::string& GetString() const;
+	LUNA_API float GetPositionX() const;
+	LUNA_API float GetPositionY() const;
+	LUNA_API std::int32_t GetDepth() const;
+	LUNA_API SDL_Color GetColor() const;
+	LUNA_API TextAlign GetAlign() const;
+	LUNA_API float GetScale() const;
+
+	LUNA_API void SetFont(FontID font);
+	LUNA_API void SetString(const std::string& string);
+	LUNA_API void SetPositionX(float x);
+	LUNA_API void SetPositionY(float y);
+	LUNA_API void SetDepth(std::int32_t depth);
+	LUNA_API void SetColor(const SDL_Color& color);
+	LUNA_API void SetAlign(TextAlign align);
+	LUNA_API void SetScale(float scale);
+
+private:
+	FontID m_font = FONT_ID_NULL;
+	std::string m_string;
+	float m_positionX = 0.f;
+	float m_positionY = 0.f;
+	std::int32_t m_depth = 0;
+	SDL_Color m_color = LunaColorWhite;
+	TextAlign m_align = TextAlign::Left;
+	float m_scale = 1.f;
+};
+
+namespace detail {
+
+/// <summary>
+/// Cache of rasterised glyphs, shelf packed into a few square pages so text can be drawn as sprites.
+/// Each glyph is rasterised once per font & size, the first time it is laid out, and stays in the atlas
+/// until its shelf is the least recently used one and space is needed. Glyphs laid out in the frame being
+/// built are never evicted. Pages are kept in host memory, premultiplied BGRA8, along with the region
+/// written since the renderer last uploaded them.
+/// <para/>Fonts & layout are guarded by a mutex, so text may be laid out from any thread.
+/// </summary>
+class GlyphAtlas {
+public:
+	/// <param name="pageSize">Width & height of each page in pixels</param>
+	/// <param name="maxPages">Number of pages allocated before glyphs start being evicted</param>
+	GlyphAtlas(std::uint32_t pageSize = 1024, std::uint32_t maxPages = 4);
+	~GlyphAtlas();
+
+	/// <summary>
+	/// Open a font file at a point size. Opening the same file at the same size again returns the same
+	/// handle, and it stays open until it has been closed as many times.
+	/// </summary>
+	/// <returns>Handle to the font, or FONT_ID_NULL on failure</returns>
+	FontID OpenFont(const std::string& filename, float pointSize);
+	void CloseFont(FontID font);
+
+	/// <summary>
+	/// Lay a string out into one sprite per visible glyph, rasterising glyphs that are not in the atlas.
+	/// Glyphs that do not fit in the atlas are skipped.
+	/// </summary>
+	/// <returns>Number of sprites added</returns>
+	std::size_t LayoutText(const Text& text, SpriteList& sprites);
+
+	/// <summary>
+	/// Start a new frame; glyphs laid out before now may be evicted again.
+	/// </summary>
+	void BeginFrame();
+
+	std::uint32_t GetPageSize() const;
+	std::uint32_t GetPageCount() const;
+	const std::uint8_t* GetPagePixels(GlyphPageID page) const;
+
+	/// <summary>
+	/// Get the region of a page written since the last call, and mark it as uploaded.
+	/// </summary>
+	/// <returns>False if nothing was written</returns>
+	bool TakeDirtyRect(GlyphPageID page, SDL_Rect& rect);
+
+private:
+	struct Font {
+		TTF_Font* m_ttfFont = nullptr;
+		std::string m_filename;
+		float m_pointSize = 0.f;
+		std::uint32_t m_references = 0;
+		std::int32_t m_lineSkip = 0;
+	};
+
+	/// <summary>
+	/// Placed glyph, or a glyph with nothing to draw such as a space if it has no page.
+	/// </summary>
+	struct Glyph {
+		GlyphPageID m_page = GLYPH_PAGE_ID_NULL;
+		std::size_t m_shelf = 0;
+		std::uint32_t m_x = 0, m_y = 0, m_width = 0, m_height = 0;
+		float m_offsetX = 0.f, m_offsetY = 0.f;
+		float m_advance = 0.f;
+	};
+
+	/// <summary>
+	/// Row of glyphs no taller than the shelf, filled left to right & evicted all at once.
+	/// </summary>
+	struct Shelf {
+		GlyphPageID m_page = GLYPH_PAGE_ID_NULL;
+		std::uint32_t m_y = 0;
+		std::uint32_t m_height = 0;
+		std::uint32_t m_nextX = 0;
+		std::uint64_t m_lastUsed = 0;
+		std::vector<std::uint64_t> m_glyphs;
+	};
+
+	struct Page {
+		std::vector<std::uint8_t> m_pixels;
+		std::uint32_t m_nextShelfY = 0;
+		SDL_Rect m_dirtyRect = {};
+	};
+
+	static std::uint64_t GlyphKey(FontID font, Uint32 codepoint);
+	const Glyph* GetGlyph(FontID font, Font& fontInfo, Uint32 codepoint);
+	bool Allocate(std::uint32_t width, std::uint32_t height, std::size_t& shelfIndex, std::uint32_t& x);
+	void EvictShelf(std::size_t shelfIndex);
+	void MarkDirty(GlyphPageID page, const SDL_Rect& rect);
+
+	std::mutex m_mutex;
+	std::uint32_t m_pageSize = 0;
+	std::uint32_t m_maxPages = 0;
+	std::uint64_t m_frameIndex = 1;
+	FontID m_nextFontID = 1;
+	std::unordered_map<FontID, Font> m_fonts;
+	std::unordered_map<std::uint64_t, Glyph> m_glyphs;
+	std::vector<Shelf> m_shelves;
+	std::vector<Page> m_pages;
+};
+
+} // detail
+
+} // luna
\ No newline at end of file
@@ -37,4 +37,79 @@ private:
 	float m_data[7];
 };
 
+/// <summary>
+/// Vertex with its color packed into RGBA8, for uploading to the GPU at a little over half the size of VertexPosColor.
+/// </summary>
+class VertexPosPackedColor {
+public:
+	LUNA_API VertexPosPackedColor(float x, float y, float z, std::uint32_t color);
+	LUNA_API VertexPosPackedColor(const VertexPosColor& vertex);
+
+	VertexPos xyz() const;
+	std::uint32_t GetColor() const;
+
+	LUNA_API bool operator==(const VertexPosPackedColor& other) const;
+	LUNA_API bool operator!=(const VertexPosPackedColor& other) const;
+	friend std::ostream& operator<< (std::ostream& stream, const VertexPosPackedColor& vertex);
+
+private:
+	float m_position[3];
+	std::uint32_t m_color;
+};
+
+namespace detail {
+
+/// <summary>
+/// Convert a float to IEEE half precision, rounding to nearest even.
+/// </summary>
+inline std::uint16_t PackHalf(float value) {
+	std::uint32_t bits = 0;
+	SDL_memcpy(&bits, &value, sizeof(bits));
+	std::uint32_t sign = (bits >> 16) & 0x8000;
+	std::uint32_t biasedExponent = (bits >> 23) & 0xFF;
+	std::uint32_t mantissa = bits & 0x7FFFFF;
+	if (biasedExponent == 0xFF) { return std::uint16_t(sign | 0x7C00 | ((mantissa) ? 0x200 : 0)); }
+	std::int32_t exponent = std::int32_t(biasedExponent) - 127 + 15;
+	if (exponent >= 31) { return std::uint16_t(sign | 0x7C00); }
+
+	// Values too small for a normal half become denormals, or zero
+	std::uint32_t shift = 13;
+	if (exponent <= 0) {
+		if (exponent < -10) { return std::uint16_t(sign); }
+		mantissa |= 0x800000;
+		shift = std::uint32_t(14 - exponent);
+		exponent = 0;
+	}
+	std::uint32_t half = (std::uint32_t(exponent) << 10) | (mantissa >> shift);
+	std::uint32_t remainder = mantissa & ((1u << shift) - 1);
+	std::uint32_t halfway = 1u << (shift - 1);
+	if (remainder > halfway || (remainder == halfway && (half & 1))) { ++half; }
+	return std::uint16_t(sign | half);
+}
+
+/// <summary>
+/// Pack two floats as halves, x in the low 16 bits.
+/// </summary>
+inline std::uint32_t PackHalf2(float x, float y) {
+	return std::uint32_t(PackHalf(x)) | (std::uint32_t(PackHalf(y)) << 16);
+}
+
+/// <summary>
+/// Pack two floats in [0, 1] as 16 bit normalized integers, x in the low 16 bits.
+/// </summary>
+inline std::uint32_t PackUnorm2x16(float x, float y) {
+	auto pack = [](float value) { return std::uint32_t(std::clamp(value, 0.f, 1.f) * 65535.f + 0.5f); };
+	return pack(x) | (pack(y) << 16);
+}
+
+/// <summary>
+/// Pack four floats in [0, 1] as 8 bit normalized integers, r in the low 8 bits.
+/// </summary>
+inline std::uint32_t PackUnorm4x8(float r, float g, float b, float a) {
+	auto pack = [](float value) { return std::uint32_t(std::clamp(value, 0.f, 1.f) * 255.f + 0.5f); };
+	return pack(r) | (pack(g) << 8) | (pack(b) << 16) | (pack(a) << 24);
+}
+
+} // detail
+
 } // luna
\ No newline at end of file
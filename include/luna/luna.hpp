@@ -3,5 +3,8 @@
 #include <luna/detail/game.hpp>
 #include <luna/detail/camera.hpp>
 #include <luna/detail/resources.hpp>
+#include <luna/detail/audio.hpp>
 #include <luna/detail/sprite.hpp>
+#include <luna/detail/text.hpp>
+#include <luna/detail/particles.hpp>
 #include <luna/detail/room.hpp>
\ No newline at end of file
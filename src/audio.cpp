@@ -0,0 +1,203 @@
+#include <luna/detail/audio.hpp>
+
+namespace luna {
+
+Sound::Sound(ResourceID soundID, bool loop) {
+	Open(soundID, loop);
+}
+
+Sound::~Sound() {
+	Close();
+}
+
+bool Sound::IsValid() const {
+	return m_sdlAudioStream != nullptr;
+}
+
+bool Sound::Open(ResourceID soundID, bool loop) {
+	Close();
+
+	// Find sound
+	m_sound = ResourceManager::GetSound(soundID);
+	if (!m_sound) {
+		SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "Failed to open sound! %s", ResourceManager::ErrorMessage().c_str());
+		return false;
+	}
+
+	// Create a stream on its own logical device, so it can be paused independently
+	const SDL_AudioSpec& spec = m_sound->GetSpec();
+	m_sdlAudioStream = SDL_OpenAudioDeviceStream(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, &spec, AudioStreamCallback, this);
+	if (!m_sdlAudioStream) {
+		SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "SDL_OpenAudioDeviceStream failed! %s", SDL_GetError());
+		m_sound = nullptr;
+		return false;
+	}
+	SDL_SetAudioStreamGain(m_sdlAudioStream, m_gain);
+
+	// Buffer about a second of audio, and at least two chunks
+	if (m_sound->IsStreamed()) {
+		std::size_t largestChunk = 0;
+		for (std::size_t i = 0; i < m_sound->GetChunkCount(); ++i) {
+			largestChunk = std::max<std::size_t>(largestChunk, m_sound->GetChunkSize(i));
+		}
+		std::size_t bytesPerSecond = std::size_t(SDL_AUDIO_FRAMESIZE(spec)) * std::size_t(spec.freq);
+		m_ring.reset(std::max(bytesPerSecond, largestChunk * 2));
+	}
+	m_loop = loop;
+	m_cursor = 0;
+	m_nextChunk = 0;
+	m_finished = false;
+	return true;
+}
+
+void Sound::Close() {
+	if (!m_sdlAudioStream) { return; }
+	Stop();
+	SDL_DestroyAudioStream(m_sdlAudioStream);
+	m_sdlAudioStream = nullptr;
+	m_sound = nullptr;
+}
+
+void Sound::Play() {
+	if (!IsValid()) { return; }
+	if (m_finished) { Stop(); }
+	if (m_sound->IsStreamed() && !m_decodeThread.joinable()) { StartDecoder(); }
+	m_finished = false;
+	SDL_ResumeAudioStreamDevice(m_sdlAudioStream);
+	m_playing = true;
+}
+
+void Sound::Pause() {
+	if (!IsValid()) { return; }
+	SDL_PauseAudioStreamDevice(m_sdlAudioStream);
+	m_playing = false;
+}
+
+void Sound::Stop() {
+	if (!IsValid()) { return; }
+	Pause();
+	StopDecoder();
+
+	// Rewind, keeping the audio thread out while its state is reset
+	SDL_LockAudioStream(m_sdlAudioStream);
+	SDL_ClearAudioStream(m_sdlAudioStream);
+	m_ring.clear();
+	m_cursor = 0;
+	m_nextChunk = 0;
+	m_finished = false;
+	SDL_UnlockAudioStream(m_sdlAudioStream);
+}
+
+bool Sound::IsPlaying() const {
+	if (!IsValid() || !m_playing) { return false; }
+	return !(m_finished && SDL_GetAudioStreamQueued(m_sdlAudioStream) == 0);
+}
+
+bool Sound::GetLoop() const {
+	return m_loop;
+}
+
+float Sound::GetGain() const {
+	return m_gain;
+}
+
+void Sound::SetLoop(bool loop) {
+	m_loop = loop;
+}
+
+void Sound::SetGain(float gain) {
+	m_gain = gain;
+	if (m_sdlAudioStream) { SDL_SetAudioStreamGain(m_sdlAudioStream, m_gain); }
+}
+
+SDL_AudioDeviceID Sound::GetDeviceID() const {
+	return (m_sdlAudioStream) ? SDL_GetAudioStreamDevice(m_sdlAudioStream) : 0;
+}
+
+void SDLCALL Sound::AudioStreamCallback(void* userdata, SDL_AudioStream* stream, int additionalAmount, int /*totalAmount*/) {
+	Sound* sound = (Sound*)userdata;
+	sound->Feed(stream, additionalAmount);
+}
+
+void Sound::Feed(SDL_AudioStream* stream, int amount) {
+	if (amount <= 0 || !m_sound) { return; }
+	if (!m_sound->IsStreamed()) {
+		// Copy straight out of the decoded sound
+		const std::uint8_t* data = m_sound->GetData();
+		std::uint64_t size = m_sound->GetSize();
+		while (amount > 0 && size > 0) {
+			if (m_cursor >= size) {
+				if (!m_loop) {
+					m_finished = true;
+					return;
+				}
+				m_cursor = 0;
+			}
+			int len = int(std::min<std::uint64_t>(std::uint64_t(amount), size - m_cursor));
+			SDL_PutAudioStreamData(stream, data + m_cursor, len);
+			m_cursor += std::uint64_t(len);
+			amount -= len;
+		}
+	}
+	else {
+		// Drain the ring buffer; if the decoder falls behind the device plays silence until it catches up
+		std::uint8_t scratch[4096];
+		while (amount > 0) {
+			std::size_t len = m_ring.read(scratch, std::min(std::size_t(amount), sizeof(scratch)));
+			if (len == 0) {
+				if (m_decodeFinished) { m_finished = true; }
+				break;
+			}
+			SDL_PutAudioStreamData(stream, scratch, int(len));
+			amount -= int(len);
+		}
+		m_decodeCondition.notify_one();
+	}
+}
+
+void Sound::StartDecoder() {
+	m_decodeQuit = false;
+	m_decodeFinished = false;
+	m_decodeThread = std::thread(&Sound::DecodeThread, this);
+}
+
+void Sound::StopDecoder() {
+	if (!m_decodeThread.joinable()) { return; }
+	m_decodeQuit = true;
+	m_decodeCondition.notify_one();
+	m_decodeThread.join();
+}
+
+void Sound::DecodeThread() {
+	std::vector<std::uint8_t> chunk;
+	while (!m_decodeQuit) {
+		// Pick the next chunk
+		if (m_nextChunk >= m_sound->GetChunkCount()) {
+			if (!m_loop) { break; }
+			m_nextChunk = 0;
+		}
+		std::uint32_t size = m_sound->GetChunkSize(m_nextChunk);
+
+		// Wait for the audio thread to make room for it
+		{
+			std::unique_lock<std::mutex> lock(m_decodeMutex);
+			m_decodeCondition.wait_for(lock, std::chrono::milliseconds(10), [&]() {
+				return m_decodeQuit || m_ring.space() >= size;
+			});
+		}
+		if (m_decodeQuit) { break; }
+		if (m_ring.space() < size) { continue; }
+
+		// Decode it
+		chunk.resize(size);
+		if (!m_sound->DecodeChunk(m_nextChunk, chunk.data())) {
+			SDL_LogError(SDL_LOG_CATEGORY_AUDIO, "Failed to decode audio chunk %zu", m_nextChunk);
+			break;
+		}
+		m_ring.write(chunk.data(), size);
+		++m_nextChunk;
+	}
+	m_decodeFinished = true;
+}
+
+} // luna
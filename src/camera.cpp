@@ -52,6 +52,34 @@ std::int32_t Camera::GetBottomEdge() const {
 	return m_cameraY + std::int32_t(m_cameraH);
 }
 
+const ShapeAABB& Camera::GetBoundingBox() const {
+	return m_bbox;
+}
+
+bool Camera::IsEnabled() const {
+	return m_enabled;
+}
+
+std::uint32_t Camera::GetViewportX() const {
+	return m_viewportX;
+}
+
+std::uint32_t Camera::GetViewportY() const {
+	return m_viewportY;
+}
+
+std::uint32_t Camera::GetViewportWidth() const {
+	return m_viewportW;
+}
+
+std::uint32_t Camera::GetViewportHeight() const {
+	return m_viewportH;
+}
+
+RenderTargetID Camera::GetRenderTarget() const {
+	return m_renderTarget;
+}
+
 bool Camera::PointOnCamera(float x, float y) const {
 	return PointInShape(x, y, m_bbox);
 }
@@ -73,6 +101,7 @@ bool Camera::RegionOnCamera(const AnyShape& shape, ShapeType type) const {
 	case ShapeType::LineType: return ShapeIntersects(std::get<ShapeLine>(shape), m_bbox); break;
 	case ShapeType::AABBType: return ShapeIntersects(std::get<ShapeAABB>(shape), m_bbox); break;
 	case ShapeType::CircleType: return ShapeIntersects(std::get<ShapeCircle>(shape), m_bbox); break;
+	case ShapeType::PolylineType: return ShapeIntersects(std::get<ShapePolyline>(shape).GetShapeAABB(), m_bbox); break;
 	}
 	return false;
 }
@@ -105,6 +134,21 @@ void Camera::SetFarPlane(std::int32_t zFar) {
 	m_zFar = zFar;
 }
 
+void Camera::SetEnabled(bool enabled) {
+	m_enabled = enabled;
+}
+
+void Camera::SetViewport(std::uint32_t x, std::uint32_t y, std::uint32_t width, std::uint32_t height) {
+	m_viewportX = x;
+	m_viewportY = y;
+	m_viewportW = width;
+	m_viewportH = height;
+}
+
+void Camera::SetRenderTarget(RenderTargetID renderTarget) {
+	m_renderTarget = renderTarget;
+}
+
 glm::mat4 Camera::ProjectionOrtho() const {
 	//float left = (float)m_cameraX;
 	//float right = (float)(m_cameraX + std::int32_t(m_cameraW));
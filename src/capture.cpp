@@ -0,0 +1,396 @@
+#include <luna/detail/capture.hpp>
+
+namespace luna {
+
+static const char* RENDER_CAPTURE_MAGIC = "LRCP";
+static constexpr std::uint32_t RENDER_CAPTURE_VERSION = 1;
+
+static void PushFloat(Buffer& buffer, float value) {
+	std::uint32_t bits = 0;
+	SDL_memcpy(&bits, &value, sizeof(float));
+	buffer.push_uint32(bits);
+}
+
+static void PushColor(Buffer& buffer, SDL_Color color) {
+	buffer.push_uint8(color.r);
+	buffer.push_uint8(color.g);
+	buffer.push_uint8(color.b);
+	buffer.push_uint8(color.a);
+}
+
+static void PushString(Buffer& buffer, const std::string& value) {
+	std::size_t length = std::min<std::size_t>(value.size(), 0xFFFF);
+	buffer.push_uint16(std::uint16_t(length));
+	if (length > 0) { buffer.push_string(value.data(), length, length); }
+}
+
+/// <summary>
+/// Reads values front to back out of a frame, throwing std::out_of_range past its end.
+/// </summary>
+struct CaptureReader {
+	const Buffer& buffer;
+	std::size_t pos = 0;
+
+	std::uint8_t u8() { std::uint8_t value = buffer.get_uint8(pos); pos += 1; return value; }
+	std::uint16_t u16() { std::uint16_t value = buffer.get_uint16(pos); pos += 2; return value; }
+	std::uint32_t u32() { std::uint32_t value = buffer.get_uint32(pos); pos += 4; return value; }
+	std::int32_t i32() { std::int32_t value = buffer.get_int32(pos); pos += 4; return value; }
+	float f32() {
+		std::uint32_t bits = u32();
+		float value = 0.f;
+		SDL_memcpy(&value, &bits, sizeof(float));
+		return value;
+	}
+	SDL_Color color() {
+		SDL_Color value = {};
+		value.r = u8();
+		value.g = u8();
+		value.b = u8();
+		value.a = u8();
+		return value;
+	}
+	std::string string() {
+		std::size_t length = u16();
+		if (pos > buffer.size() || length > buffer.size() - pos) { throw std::out_of_range("Buffer out of range"); }
+		std::string value((const char*)buffer.data(pos), length);
+		pos += length;
+		return value;
+	}
+	std::uint32_t count(std::size_t minElementSize) {
+		// Reject counts the rest of the frame could not possibly hold, before anything is allocated for them
+		std::uint32_t value = u32();
+		if (std::uint64_t(value) * minElementSize > buffer.size() - pos) { throw std::out_of_range("Count out of range"); }
+		return value;
+	}
+};
+
+static void WriteFrameData(Buffer& buffer, const CapturedFrame& frame) {
+	buffer.push_uint32(frame.windowWidth);
+	buffer.push_uint32(frame.windowHeight);
+	PushColor(buffer, frame.clearColor);
+
+	buffer.push_uint32(std::uint32_t(frame.cameras.size()));
+	for (auto& camera : frame.cameras) {
+		buffer.push_int32(camera.GetPositionX());
+		buffer.push_int32(camera.GetPositionY());
+		buffer.push_uint32(camera.GetWidth());
+		buffer.push_uint32(camera.GetHeight());
+		buffer.push_int32(camera.GetNearPlane());
+		buffer.push_int32(camera.GetFarPlane());
+		buffer.push_uint8((camera.IsEnabled()) ? 1 : 0);
+		buffer.push_uint32(camera.GetViewportX());
+		buffer.push_uint32(camera.GetViewportY());
+		buffer.push_uint32(camera.GetViewportWidth());
+		buffer.push_uint32(camera.GetViewportHeight());
+		buffer.push_uint32(camera.GetRenderTarget());
+	}
+
+	buffer.push_uint32(std::uint32_t(frame.renderTargets.size()));
+	for (auto& renderTarget : frame.renderTargets) {
+		buffer.push_uint32(renderTarget.renderTarget);
+		buffer.push_uint32(renderTarget.width);
+		buffer.push_uint32(renderTarget.height);
+	}
+
+	buffer.push_uint32(std::uint32_t(frame.textures.size()));
+	for (auto& texture : frame.textures) {
+		buffer.push_uint32(texture.textureID);
+		PushString(buffer, texture.file);
+		PushString(buffer, texture.name);
+	}
+
+	buffer.push_uint32(std::uint32_t(frame.sprites.size()));
+	for (auto& sprite : frame.sprites) {
+		buffer.push_uint8(std::uint8_t(sprite.kind));
+		buffer.push_uint8(std::uint8_t(sprite.blendMode));
+		buffer.push_uint32(sprite.texture);
+		buffer.push_uint32(sprite.renderTarget);
+		buffer.push_int32(sprite.image);
+		buffer.push_int32(sprite.depth);
+		PushFloat(buffer, sprite.x);
+		PushFloat(buffer, sprite.y);
+		PushFloat(buffer, sprite.width);
+		PushFloat(buffer, sprite.height);
+		PushFloat(buffer, sprite.scaleX);
+		PushFloat(buffer, sprite.scaleY);
+		PushFloat(buffer, sprite.rotation);
+		PushFloat(buffer, sprite.originX);
+		PushFloat(buffer, sprite.originY);
+		PushColor(buffer, sprite.blend);
+	}
+
+	buffer.push_uint32(std::uint32_t(frame.primitives.size()));
+	for (auto& primitive : frame.primitives) {
+		buffer.push_uint8(std::uint8_t(primitive.GetShapeType()));
+		buffer.push_uint8((primitive.GetOutline()) ? 1 : 0);
+		buffer.push_uint8(std::uint8_t(primitive.GetLineJoin()));
+		buffer.push_uint8(std::uint8_t(primitive.GetLineCap()));
+		PushFloat(buffer, primitive.GetWidth());
+		buffer.push_int32(primitive.GetDepth());
+		PushColor(buffer, primitive.GetBlend());
+		switch (primitive.GetShapeType()) {
+		case ShapeType::LineType: {
+			const ShapeLine& line = std::get<ShapeLine>(primitive.GetShape());
+			PushFloat(buffer, line.x1);
+			PushFloat(buffer, line.y1);
+			PushFloat(buffer, line.x2);
+			PushFloat(buffer, line.y2);
+		} break;
+		case ShapeType::AABBType: {
+			const ShapeAABB& aabb = std::get<ShapeAABB>(primitive.GetShape());
+			PushFloat(buffer, aabb.left);
+			PushFloat(buffer, aabb.top);
+			PushFloat(buffer, aabb.right);
+			PushFloat(buffer, aabb.bottom);
+		} break;
+		case ShapeType::CircleType: {
+			const ShapeCircle& circle = std::get<ShapeCircle>(primitive.GetShape());
+			PushFloat(buffer, circle.x);
+			PushFloat(buffer, circle.y);
+			PushFloat(buffer, circle.radius);
+		} break;
+		case ShapeType::PolylineType: {
+			const ShapePolyline& polyline = std::get<ShapePolyline>(primitive.GetShape());
+			buffer.push_uint8((polyline.closed) ? 1 : 0);
+			buffer.push_uint32(std::uint32_t(polyline.points.size()));
+			for (auto& point : polyline.points) {
+				PushFloat(buffer, point[0]);
+				PushFloat(buffer, point[1]);
+			}
+		} break;
+		default: break;
+		}
+	}
+}
+
+static void ReadFrameData(CaptureReader& reader, CapturedFrame& frame) {
+	frame.windowWidth = reader.u32();
+	frame.windowHeight = reader.u32();
+	frame.clearColor = reader.color();
+
+	std::uint32_t cameraCount = reader.count(45);
+	for (std::uint32_t i = 0; i < cameraCount; ++i) {
+		std::int32_t x = reader.i32();
+		std::int32_t y = reader.i32();
+		std::uint32_t width = reader.u32();
+		std::uint32_t height = reader.u32();
+		std::int32_t zNear = reader.i32();
+		std::int32_t zFar = reader.i32();
+		Camera camera(x, y, width, height, zNear, zFar);
+		camera.SetEnabled(reader.u8() != 0);
+		std::uint32_t viewportX = reader.u32();
+		std::uint32_t viewportY = reader.u32();
+		std::uint32_t viewportWidth = reader.u32();
+		std::uint32_t viewportHeight = reader.u32();
+		camera.SetViewport(viewportX, viewportY, viewportWidth, viewportHeight);
+		camera.SetRenderTarget(reader.u32());
+		frame.cameras.push_back(camera);
+	}
+
+	std::uint32_t renderTargetCount = reader.count(12);
+	for (std::uint32_t i = 0; i < renderTargetCount; ++i) {
+		CapturedRenderTarget renderTarget;
+		renderTarget.renderTarget = reader.u32();
+		renderTarget.width = reader.u32();
+		renderTarget.height = reader.u32();
+		frame.renderTargets.push_back(renderTarget);
+	}
+
+	std::uint32_t textureCount = reader.count(8);
+	for (std::uint32_t i = 0; i < textureCount; ++i) {
+		CapturedTexture texture;
+		texture.textureID = reader.u32();
+		texture.file = reader.string();
+		texture.name = reader.string();
+		frame.textures.push_back(std::move(texture));
+	}
+
+	std::uint32_t spriteCount = reader.count(58);
+	frame.sprites.reserve(spriteCount);
+	for (std::uint32_t i = 0; i < spriteCount; ++i) {
+		CapturedSprite sprite;
+		sprite.kind = CapturedSpriteKind(reader.u8());
+		sprite.blendMode = SpriteBlendMode(reader.u8());
+		sprite.texture = reader.u32();
+		sprite.renderTarget = reader.u32();
+		sprite.image = reader.i32();
+		sprite.depth = reader.i32();
+		sprite.x = reader.f32();
+		sprite.y = reader.f32();
+		sprite.width = reader.f32();
+		sprite.height = reader.f32();
+		sprite.scaleX = reader.f32();
+		sprite.scaleY = reader.f32();
+		sprite.rotation = reader.f32();
+		sprite.originX = reader.f32();
+		sprite.originY = reader.f32();
+		sprite.blend = reader.color();
+		if (sprite.texture != CAPTURED_TEXTURE_NONE && sprite.texture >= frame.textures.size()) { throw std::out_of_range("Texture index out of range"); }
+		frame.sprites.push_back(sprite);
+	}
+
+	std::uint32_t primitiveCount = reader.count(16);
+	frame.primitives.reserve(primitiveCount);
+	for (std::uint32_t i = 0; i < primitiveCount; ++i) {
+		Primitive primitive;
+		ShapeType shapeType = ShapeType(reader.u8());
+		primitive.SetOutline(reader.u8() != 0);
+		primitive.SetLineJoin(LineJoin(reader.u8()));
+		primitive.SetLineCap(LineCap(reader.u8()));
+		primitive.SetWidth(reader.f32());
+		primitive.SetDepth(reader.i32());
+		primitive.SetBlend(reader.color());
+		switch (shapeType) {
+		case ShapeType::LineType: {
+			float x1 = reader.f32();
+			float y1 = reader.f32();
+			float x2 = reader.f32();
+			float y2 = reader.f32();
+			primitive.SetShape(ShapeLine(x1, y1, x2, y2));
+		} break;
+		case ShapeType::AABBType: {
+			float left = reader.f32();
+			float top = reader.f32();
+			float right = reader.f32();
+			float bottom = reader.f32();
+			primitive.SetShape(ShapeAABB(left, top, right, bottom));
+		} break;
+		case ShapeType::CircleType: {
+			float x = reader.f32();
+			float y = reader.f32();
+			float radius = reader.f32();
+			primitive.SetShape(ShapeCircle(x, y, radius));
+		} break;
+		case ShapeType::PolylineType: {
+			bool closed = (reader.u8() != 0);
+			std::uint32_t pointCount = reader.count(8);
+			std::vector<VertexPos> points;
+			points.reserve(pointCount);
+			for (std::uint32_t p = 0; p < pointCount; ++p) {
+				float x = reader.f32();
+				float y = reader.f32();
+				points.emplace_back(x, y);
+			}
+			primitive.SetShape(ShapePolyline(std::move(points), closed));
+		} break;
+		default: throw std::out_of_range("Unknown primitive shape");
+		}
+		frame.primitives.push_back(std::move(primitive));
+	}
+}
+
+bool CapturedSprite::operator==(const CapturedSprite& other) const {
+	return (
+		kind == other.kind &&
+		blendMode == other.blendMode &&
+		texture == other.texture &&
+		renderTarget == other.renderTarget &&
+		image == other.image &&
+		depth == other.depth &&
+		x == other.x &&
+		y == other.y &&
+		width == other.width &&
+		height == other.height &&
+		scaleX == other.scaleX &&
+		scaleY == other.scaleY &&
+		rotation == other.rotation &&
+		originX == other.originX &&
+		originY == other.originY &&
+		blend.r == other.blend.r &&
+		blend.g == other.blend.g &&
+		blend.b == other.blend.b &&
+		blend.a == other.blend.a
+		);
+}
+
+void CapturedFrame::Clear() {
+	windowWidth = 0;
+	windowHeight = 0;
+	clearColor = LunaColorWhite;
+	cameras.clear();
+	renderTargets.clear();
+	textures.clear();
+	sprites.clear();
+	primitives.clear();
+}
+
+bool ReadRenderCapture(const std::string& filename, std::vector<CapturedFrame>& frames) {
+	frames.clear();
+	std::ifstream file(filename, std::ios::in | std::ios::ate | std::ios::binary);
+	if (!file.is_open()) {
+		SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to open render capture (%s)", filename.c_str());
+		return false;
+	}
+	std::size_t fileSize = file.tellg();
+	Buffer fileBuffer(fileSize, 0);
+	file.seekg(0, std::ios::beg);
+	file.read((char*)fileBuffer.data(), fileSize);
+	file.close();
+
+	try {
+		CaptureReader fileReader = { fileBuffer };
+		if (fileBuffer.get_string(0, 4) != RENDER_CAPTURE_MAGIC) { throw std::runtime_error("Not a render capture"); }
+		fileReader.pos = 4;
+		if (fileReader.u32() != RENDER_CAPTURE_VERSION) { throw std::runtime_error("Unsupported render capture version"); }
+		while (fileReader.pos < fileBuffer.size()) {
+			std::uint32_t frameSize = fileReader.u32();
+			std::uint32_t compressedSize = fileReader.u32();
+			if (compressedSize > fileBuffer.size() - fileReader.pos || frameSize > std::uint32_t(LZ4_MAX_INPUT_SIZE)) { throw std::out_of_range("Frame out of range"); }
+			Buffer frameBuffer(frameSize, 0);
+			if (LZ4_decompress_safe((const char*)fileBuffer.data(fileReader.pos), (char*)frameBuffer.data(), int(compressedSize), int(frameSize)) != int(frameSize)) {
+				throw std::runtime_error("Failed to decompress frame");
+			}
+			fileReader.pos += compressedSize;
+			CaptureReader frameReader = { frameBuffer };
+			frames.emplace_back();
+			ReadFrameData(frameReader, frames.back());
+		}
+	}
+	catch (std::exception& e) {
+		SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to read render capture (%s); %s", filename.c_str(), e.what());
+		frames.clear();
+		return false;
+	}
+	return true;
+}
+
+namespace detail {
+
+RenderCaptureWriter::RenderCaptureWriter(const std::string& filename) :
+	m_file(filename, std::ios::out | std::ios::binary | std::ios::trunc) {
+	if (!m_file.is_open()) {
+		SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to open render capture (%s)", filename.c_str());
+		return;
+	}
+	std::uint32_t version = RENDER_CAPTURE_VERSION;
+	m_file.write(RENDER_CAPTURE_MAGIC, 4);
+	m_file.write((const char*)&version, sizeof(std::uint32_t));
+}
+
+bool RenderCaptureWriter::IsOpen() const {
+	return m_file.is_open() && m_file.good();
+}
+
+bool RenderCaptureWriter::WriteFrame(const CapturedFrame& frame) {
+	if (!IsOpen()) { return false; }
+
+	// Frames are compressed one at a time, so a capture cut short still holds every frame written before
+	m_frameBuffer.clear();
+	WriteFrameData(m_frameBuffer, frame);
+	int frameSize = int(m_frameBuffer.size());
+	m_compressedBuffer.resize(std::size_t(LZ4_compressBound(frameSize)));
+	int compressedSize = LZ4_compress_default((const char*)m_frameBuffer.data(), m_compressedBuffer.data(), frameSize, int(m_compressedBuffer.size()));
+	if (compressedSize <= 0) {
+		SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to compress captured frame");
+		return false;
+	}
+	std::uint32_t sizes[2] = { std::uint32_t(frameSize), std::uint32_t(compressedSize) };
+	m_file.write((const char*)sizes, sizeof(sizes));
+	m_file.write(m_compressedBuffer.data(), compressedSize);
+	m_file.flush();
+	return m_file.good();
+}
+
+} // detail
+
+} // luna
\ No newline at end of file
@@ -110,4 +110,115 @@ SDL_FColor ConvertToFColor(SDL_Color color) {
 	};
 }
 
+void PremultiplyAlpha(std::uint8_t* pixels, std::size_t pixelCount, std::uint32_t alphaIndex) {
+	if (!pixels || alphaIndex > 3) { return; }
+	std::size_t i = 0;
+
+#if defined(LUNA_SIMD_AVX)
+	// Process 8 pixels at a time, widening each channel to 16 bits
+	alignas(32) std::uint8_t alphaShuffle[32];
+	alignas(32) std::uint16_t alphaMask[16];
+	for (std::uint32_t b = 0; b < 32; b += 2) {
+		std::uint32_t pixel = (b % 16) / 8;
+		alphaShuffle[b + 0] = std::uint8_t((pixel * 8) + (alphaIndex * 2));
+		alphaShuffle[b + 1] = std::uint8_t((pixel * 8) + (alphaIndex * 2) + 1);
+		alphaMask[b / 2] = ((b / 2) % 4 == alphaIndex) ? 0xFFFF : 0x0000;
+	}
+	const __m256i shuffle = _mm256_load_si256((const __m256i*)alphaShuffle);
+	const __m256i keep = _mm256_load_si256((const __m256i*)alphaMask);
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i bias = _mm256_set1_epi16(128);
+	for (; i + 8 <= pixelCount; i += 8) {
+		__m256i src = _mm256_loadu_si256((const __m256i*)(pixels + (i * 4)));
+		__m256i lo = _mm256_unpacklo_epi8(src, zero);
+		__m256i hi = _mm256_unpackhi_epi8(src, zero);
+		__m256i loAlpha = _mm256_shuffle_epi8(lo, shuffle);
+		__m256i hiAlpha = _mm256_shuffle_epi8(hi, shuffle);
+
+		// (c * a) / 255, rounded
+		__m256i loMul = _mm256_add_epi16(_mm256_mullo_epi16(lo, loAlpha), bias);
+		__m256i hiMul = _mm256_add_epi16(_mm256_mullo_epi16(hi, hiAlpha), bias);
+		loMul = _mm256_srli_epi16(_mm256_add_epi16(loMul, _mm256_srli_epi16(loMul, 8)), 8);
+		hiMul = _mm256_srli_epi16(_mm256_add_epi16(hiMul, _mm256_srli_epi16(hiMul, 8)), 8);
+
+		// Leave the alpha channel untouched
+		lo = _mm256_blendv_epi8(loMul, lo, keep);
+		hi = _mm256_blendv_epi8(hiMul, hi, keep);
+		_mm256_storeu_si256((__m256i*)(pixels + (i * 4)), _mm256_packus_epi16(lo, hi));
+	}
+#elif defined(LUNA_SIMD_NEON)
+	// Process 16 pixels at a time, deinterleaved into channel planes
+	for (; i + 16 <= pixelCount; i += 16) {
+		uint8x16x4_t src = vld4q_u8(pixels + (i * 4));
+		uint8x16_t alpha = src.val[alphaIndex];
+		for (std::uint32_t c = 0; c < 4; ++c) {
+			if (c == alphaIndex) { continue; }
+			uint16x8_t lo = vmull_u8(vget_low_u8(src.val[c]), vget_low_u8(alpha));
+			uint16x8_t hi = vmull_u8(vget_high_u8(src.val[c]), vget_high_u8(alpha));
+			src.val[c] = vcombine_u8(
+				vraddhn_u16(lo, vrshrq_n_u16(lo, 8)),
+				vraddhn_u16(hi, vrshrq_n_u16(hi, 8))
+			);
+		}
+		vst4q_u8(pixels + (i * 4), src);
+	}
+#endif
+
+	// Handle remaining pixels
+	for (; i < pixelCount; ++i) {
+		std::uint8_t* pixel = pixels + (i * 4);
+		std::uint32_t alpha = pixel[alphaIndex];
+		for (std::uint32_t c = 0; c < 4; ++c) {
+			if (c == alphaIndex) { continue; }
+			std::uint32_t value = (pixel[c] * alpha) + 128;
+			pixel[c] = std::uint8_t((value + (value >> 8)) >> 8);
+		}
+	}
+}
+
+void DownsampleBox(const std::uint8_t* src, std::uint32_t srcWidth, std::uint32_t srcHeight, std::uint8_t* dst) {
+	if (!src || !dst || srcWidth == 0 || srcHeight == 0) { return; }
+	std::uint32_t dstWidth = std::max(1u, srcWidth / 2);
+	std::uint32_t dstHeight = std::max(1u, srcHeight / 2);
+	for (std::uint32_t y = 0; y < dstHeight; ++y) {
+		const std::uint8_t* row0 = src + (std::size_t(std::min(y * 2, srcHeight - 1)) * srcWidth * 4);
+		const std::uint8_t* row1 = src + (std::size_t(std::min((y * 2) + 1, srcHeight - 1)) * srcWidth * 4);
+		std::uint8_t* out = dst + (std::size_t(y) * dstWidth * 4);
+		std::uint32_t x = 0;
+
+#if defined(LUNA_SIMD_AVX)
+		// Average rows, then average even & odd columns, 4 output pixels at a time
+		for (; (x * 2) + 8 <= srcWidth && x + 4 <= dstWidth; x += 4) {
+			__m256i a = _mm256_loadu_si256((const __m256i*)(row0 + (x * 8)));
+			__m256i b = _mm256_loadu_si256((const __m256i*)(row1 + (x * 8)));
+			__m256i v = _mm256_avg_epu8(a, b);
+			__m256i even = _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 0, 2, 0));
+			__m256i odd = _mm256_shuffle_epi32(v, _MM_SHUFFLE(3, 1, 3, 1));
+			__m256i r = _mm256_permute4x64_epi64(_mm256_avg_epu8(even, odd), _MM_SHUFFLE(3, 1, 2, 0));
+			_mm_storeu_si128((__m128i*)(out + (x * 4)), _mm256_castsi256_si128(r));
+		}
+#elif defined(LUNA_SIMD_NEON)
+		// Deinterleave even & odd pixels, 4 output pixels at a time
+		for (; (x * 2) + 8 <= srcWidth && x + 4 <= dstWidth; x += 4) {
+			uint32x4x2_t a = vld2q_u32((const std::uint32_t*)(row0 + (x * 8)));
+			uint32x4x2_t b = vld2q_u32((const std::uint32_t*)(row1 + (x * 8)));
+			uint8x16_t even = vrhaddq_u8(vreinterpretq_u8_u32(a.val[0]), vreinterpretq_u8_u32(b.val[0]));
+			uint8x16_t odd = vrhaddq_u8(vreinterpretq_u8_u32(a.val[1]), vreinterpretq_u8_u32(b.val[1]));
+			vst1q_u8(out + (x * 4), vrhaddq_u8(even, odd));
+		}
+#endif
+
+		// Handle remaining pixels
+		for (; x < dstWidth; ++x) {
+			std::uint32_t x0 = std::min(x * 2, srcWidth - 1);
+			std::uint32_t x1 = std::min((x * 2) + 1, srcWidth - 1);
+			for (std::uint32_t c = 0; c < 4; ++c) {
+				std::uint32_t even = (row0[(x0 * 4) + c] + row1[(x0 * 4) + c] + 1) >> 1;
+				std::uint32_t odd = (row0[(x1 * 4) + c] + row1[(x1 * 4) + c] + 1) >> 1;
+				out[(x * 4) + c] = std::uint8_t((even + odd + 1) >> 1);
+			}
+		}
+	}
+}
+
 } // luna
\ No newline at end of file
@@ -4,6 +4,9 @@
 
 namespace luna {
 
+// Longest the game waits on the renderer for room for a frame before handling events again
+static constexpr std::uint64_t GAME_FRAME_WAIT_TIMEOUT_NS = 4000000;
+
 std::function<void()> Game::m_startFunc = {};
 std::function<void()> Game::m_endFunc = {};
 std::function<void(float)> Game::m_preTickFunc = {};
@@ -14,16 +17,24 @@ std::function<void(Renderer*)> Game::m_postDrawFunc = {};
 bool Game::m_enableGraphicsDebugging = false;
 bool Game::m_enableVsync = false;
 bool Game::m_enableHDR = false;
+bool Game::m_enableTrilinearFiltering = false;
+bool Game::m_enableCompactVertexFormats = true;
+bool Game::m_enableAnalyticPrimitives = true;
+bool Game::m_headless = false;
+bool Game::m_enableStatsOverlay = false;
 bool Game::m_updateSwapchainParametersFlag = false;
 bool Game::m_quitFlag = false;
 unsigned int Game::m_windowW = 0;
 unsigned int Game::m_windowH = 0;
 unsigned int Game::m_ticksPerSecond = 0;
+unsigned int Game::m_maxFrameLatency = 2;
 SDL_Window* Game::m_sdlWindow = nullptr;
 SDL_GPUDevice* Game::m_sdlGPUDevice = nullptr;
 SDL_GPUPresentMode Game::m_sdlGPUPresentMode = SDL_GPU_PRESENTMODE_VSYNC;
 SDL_GPUSwapchainComposition Game::m_sdlGPUSwapchainComposition = SDL_GPU_SWAPCHAINCOMPOSITION_SDR;
 Renderer* Game::m_renderer = nullptr;
+FrameStats Game::m_frameStats = {};
+FrameTimeHistogram Game::m_frameTimeHistogram = {};
 
 bool Game::Init(GameInit* init) {
 	// Save init values
@@ -33,6 +44,11 @@ bool Game::Init(GameInit* init) {
 	m_enableGraphicsDebugging = init->enableGraphicsDebugging;
 	m_enableVsync = init->enableVsync;
 	m_enableHDR = init->enableHDR;
+	m_enableTrilinearFiltering = init->enableTrilinearFiltering;
+	m_enableCompactVertexFormats = init->enableCompactVertexFormats;
+	m_enableAnalyticPrimitives = init->enableAnalyticPrimitives;
+	m_headless = init->headless;
+	m_enableStatsOverlay = init->enableStatsOverlay;
 	m_startFunc = init->startFunc;
 	m_endFunc = init->endFunc;
 	m_preTickFunc = init->preTickFunc;
@@ -40,6 +56,7 @@ bool Game::Init(GameInit* init) {
 	m_preDrawFunc = init->preDrawFunc;
 	m_postDrawFunc = init->postDrawFunc;
 	m_ticksPerSecond = init->ticksPerSecond;
+	m_maxFrameLatency = std::clamp(init->maxFrameLatency, 1u, RENDER_FRAMES_IN_FLIGHT);
 
 	// Initialize SDL
 	if (!SDL_SetAppMetadata(init->appName.c_str(), init->appVersion.c_str(), init->appIdentifier.c_str())) {
@@ -47,40 +64,61 @@ bool Game::Init(GameInit* init) {
 		Cleanup();
 		return false;
 	}
-	if (!SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_GAMEPAD)) {
+	if (!init->audioDriver.empty()) {
+		// e.g. "dummy" to run without an audio device
+		SDL_SetHint(SDL_HINT_AUDIO_DRIVER, init->audioDriver.c_str());
+	}
+	// Headless games never open a window, so they can run where there is no display
+	SDL_InitFlags initFlags = SDL_INIT_AUDIO | SDL_INIT_GAMEPAD | SDL_INIT_EVENTS;
+	if (!m_headless) { initFlags |= SDL_INIT_VIDEO; }
+	if (!SDL_Init(initFlags)) {
 		SDL_LogError(SDL_LOG_CATEGORY_ERROR, "SDL_Init failed! %s", SDL_GetError());
 		Cleanup();
 		return false;
 	}
 	SDL_srand(0);
-
-	// Create window
-	m_sdlWindow = SDL_CreateWindow(init->windowTitle.c_str(), int(init->windowW), int(init->windowH), 0);
-	if (!m_sdlWindow) {
-		SDL_LogError(SDL_LOG_CATEGORY_ERROR, "SDL_CreateWindow failed! %s", SDL_GetError());
+	if (!TTF_Init()) {
+		SDL_LogError(SDL_LOG_CATEGORY_ERROR, "TTF_Init failed! %s", SDL_GetError());
 		Cleanup();
 		return false;
 	}
 
-	// Create GPU device
-	m_sdlGPUDevice = SDL_CreateGPUDevice(
-		SDL_GPU_SHADERFORMAT_SPIRV | SDL_GPU_SHADERFORMAT_DXIL | SDL_GPU_SHADERFORMAT_MSL,
-		m_enableGraphicsDebugging,
-		nullptr
-	);
-	if (!m_sdlGPUDevice) {
-		SDL_LogError(SDL_LOG_CATEGORY_ERROR, "SDL_CreateGPUDevice failed!");
-		Cleanup();
-		return false;
+	// Create window
+	if (!m_headless) {
+		m_sdlWindow = SDL_CreateWindow(init->windowTitle.c_str(), int(init->windowW), int(init->windowH), 0);
+		if (!m_sdlWindow) {
+			SDL_LogError(SDL_LOG_CATEGORY_ERROR, "SDL_CreateWindow failed! %s", SDL_GetError());
+			Cleanup();
+			return false;
+		}
 	}
-	if (!SDL_ClaimWindowForGPUDevice(m_sdlGPUDevice, m_sdlWindow)) {
-		SDL_LogError(SDL_LOG_CATEGORY_ERROR, "SDL_ClaimWindowForGPUDevice failed!");
-		Cleanup();
-		return false;
+
+	// Create GPU device, unless the renderer never uses one
+	if (init->rendererFactory->requires_gpu_device()) {
+		m_sdlGPUDevice = SDL_CreateGPUDevice(
+			SDL_GPU_SHADERFORMAT_SPIRV | SDL_GPU_SHADERFORMAT_DXIL | SDL_GPU_SHADERFORMAT_MSL,
+			m_enableGraphicsDebugging,
+			nullptr
+		);
+		if (!m_sdlGPUDevice) {
+			SDL_LogError(SDL_LOG_CATEGORY_ERROR, "SDL_CreateGPUDevice failed!");
+			Cleanup();
+			return false;
+		}
+		if (!SDL_SetGPUAllowedFramesInFlight(m_sdlGPUDevice, m_maxFrameLatency)) {
+			SDL_LogError(SDL_LOG_CATEGORY_ERROR, "SDL_SetGPUAllowedFramesInFlight failed! %s", SDL_GetError());
+		}
 	}
+	if (m_sdlWindow && m_sdlGPUDevice) {
+		if (!SDL_ClaimWindowForGPUDevice(m_sdlGPUDevice, m_sdlWindow)) {
+			SDL_LogError(SDL_LOG_CATEGORY_ERROR, "SDL_ClaimWindowForGPUDevice failed!");
+			Cleanup();
+			return false;
+		}
 
-	// Set render parameters
-	SetSwapchainParameters();
+		// Set render parameters
+		SetSwapchainParameters();
+	}
 
 	// Create shader pipelines
 	SDL_ShaderCross_Init();
@@ -109,16 +147,24 @@ int Game::Run() {
 		}
 		if (m_quitFlag) { break; }
 
+		// Do no work on a frame until the renderer has room for it. The time carries over, so it is
+		// ticked & counted with the next frame that is drawn
+		if (!m_renderer->WaitForFrame(GAME_FRAME_WAIT_TIMEOUT_NS)) { continue; }
+
 		// Update game state
 		auto timePointCurrent = std::chrono::high_resolution_clock::now();
 		auto timeSpan = std::chrono::duration_cast<std::chrono::duration<double>>(timePointCurrent - timePointLast);
 		timePointLast = timePointCurrent;
 		double frameTime = timeSpan.count();
+		m_frameStats.frameMs = float(frameTime * 1000.0);
+		m_frameTimeHistogram.Record(m_frameStats.frameMs);
+		auto stageStart = detail::StatsClock::now();
 		if (m_ticksPerSecond > 0) {
 			timeAccum += frameTime;
 			while (timeAccum >= tickRate) {
 				m_preTickFunc(float(tickRate));
 				RoomManager::Tick(float(tickRate));
+				m_renderer->Tick(float(tickRate));
 				m_postTickFunc(float(tickRate));
 				timeAccum -= tickRate;
 			}
@@ -126,8 +172,10 @@ int Game::Run() {
 		else {
 			m_preTickFunc(float(frameTime));
 			RoomManager::Tick(float(frameTime));
+			m_renderer->Tick(float(frameTime));
 			m_postTickFunc(float(frameTime));
 		}
+		m_frameStats.tickMs = detail::ElapsedMs(stageStart);
 
 		// Manage current room state
 		Room* currentRoom = RoomManager::GetCurrentRoom();
@@ -137,12 +185,19 @@ int Game::Run() {
 
 		// Draw
 		if (m_updateSwapchainParametersFlag) { SetSwapchainParameters(); }
+		stageStart = detail::StatsClock::now();
 		m_renderer->PreDraw();
 		m_preDrawFunc(m_renderer);
 		RoomManager::Draw(float(frameTime));
 		m_postDrawFunc(m_renderer);
+		if (m_enableStatsOverlay) { detail::DrawStatsOverlay(m_renderer, currentRoom, m_frameStats, m_frameTimeHistogram); }
+		m_frameStats.drawSubmitMs = detail::ElapsedMs(stageStart);
+		stageStart = detail::StatsClock::now();
 		m_renderer->Draw();
 		m_renderer->PostDraw();
+		m_frameStats.drawMs = detail::ElapsedMs(stageStart);
+		m_frameStats.render = m_renderer->GetFrameTimings();
+		m_frameStats.counts = m_renderer->GetFrameCounts();
 	}
 	m_endFunc();
 	Cleanup();
@@ -195,7 +250,56 @@ void Game::SetHDREnabled(bool enableHDR) {
 	m_enableHDR = enableHDR;
 }
 
+bool Game::GetTrilinearFilteringEnabled() {
+	return m_enableTrilinearFiltering;
+}
+
+void Game::SetTrilinearFilteringEnabled(bool enableTrilinearFiltering) {
+	m_enableTrilinearFiltering = enableTrilinearFiltering;
+}
+
+bool Game::GetCompactVertexFormatsEnabled() {
+	return m_enableCompactVertexFormats;
+}
+
+bool Game::GetAnalyticPrimitivesEnabled() {
+	return m_enableAnalyticPrimitives;
+}
+
+bool Game::GetHeadless() {
+	return m_headless;
+}
+
+const FrameStats& Game::GetFrameStats() {
+	return m_frameStats;
+}
+
+const FrameTimeHistogram& Game::GetFrameTimeHistogram() {
+	return m_frameTimeHistogram;
+}
+
+bool Game::GetStatsOverlayEnabled() {
+	return m_enableStatsOverlay;
+}
+
+void Game::SetStatsOverlayEnabled(bool enableStatsOverlay) {
+	m_enableStatsOverlay = enableStatsOverlay;
+}
+
+unsigned int Game::GetMaxFrameLatency() {
+	return m_maxFrameLatency;
+}
+
+void Game::SetMaxFrameLatency(unsigned int maxFrameLatency) {
+	m_maxFrameLatency = std::clamp(maxFrameLatency, 1u, RENDER_FRAMES_IN_FLIGHT);
+	if (m_sdlGPUDevice && !SDL_SetGPUAllowedFramesInFlight(m_sdlGPUDevice, m_maxFrameLatency)) {
+		SDL_LogError(SDL_LOG_CATEGORY_ERROR, "SDL_SetGPUAllowedFramesInFlight failed! %s", SDL_GetError());
+	}
+}
+
 void Game::SetSwapchainParameters() {
+	if (!m_sdlWindow || !m_sdlGPUDevice) { return; }
+
 	// Choose present mode
 	SDL_GPUPresentMode presentMode = SDL_GPU_PRESENTMODE_VSYNC;
 	if (!m_enableVsync && SDL_WindowSupportsGPUPresentMode(
@@ -241,6 +345,7 @@ void Game::Cleanup() {
 	if (m_sdlGPUDevice && m_sdlWindow) { SDL_ReleaseWindowFromGPUDevice(m_sdlGPUDevice, m_sdlWindow); }
 	if (m_sdlWindow) { SDL_DestroyWindow(m_sdlWindow); }
 	if (m_sdlGPUDevice) { SDL_DestroyGPUDevice(m_sdlGPUDevice); }
+	if (TTF_WasInit()) { TTF_Quit(); }
 	m_renderer = nullptr;
 	m_sdlGPUDevice = nullptr;
 	m_sdlWindow = nullptr;
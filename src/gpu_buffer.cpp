@@ -0,0 +1,131 @@
+#include <luna/detail/gpu_buffer.hpp>
+#include <luna/detail/game.hpp>
+
+namespace luna {
+
+namespace detail {
+
+static constexpr std::uint32_t GPU_RING_BUFFER_MIN_CAPACITY = 64 * 1024;
+
+GPURingBuffer::GPURingBuffer(SDL_GPUBufferUsageFlags usage, std::uint32_t framesInFlight, bool hostMemory) :
+	m_frames(std::max<std::uint32_t>(framesInFlight, 1)),
+	m_usage(usage),
+	m_hostMemory(hostMemory) {}
+
+GPURingBuffer::~GPURingBuffer() {
+	if (m_hostMemory) { return; }
+	SDL_GPUDevice* device = Game::GetGPUDevice();
+	if (m_mapped) { Unmap(); }
+	for (auto& frame : m_frames) {
+		SDL_ReleaseGPUTransferBuffer(device, frame.m_sdlTransferBuffer);
+		SDL_ReleaseGPUBuffer(device, frame.m_sdlBuffer);
+	}
+}
+
+void GPURingBuffer::BeginFrame(std::uint64_t frameIndex) {
+	// Remember the largest frame so far, and size this frame's buffers for it up front
+	m_peakUsage = std::max(m_peakUsage, m_frameUsage);
+	m_currentFrame = std::uint32_t(frameIndex % m_frames.size());
+	m_offset = 0;
+	m_frameUsage = 0;
+	Frame& frame = m_frames[m_currentFrame];
+	if (m_peakUsage > frame.m_capacity) { Grow(frame, m_peakUsage); }
+}
+
+std::uint8_t* GPURingBuffer::Map(std::uint32_t size, std::uint32_t alignment, std::uint32_t& offset) {
+	SDL_assert(!m_mapped);
+	Frame& frame = m_frames[m_currentFrame];
+
+	// Place the region, growing if it does not fit
+	std::uint32_t aligned = (alignment > 1) ? ((m_offset + alignment - 1) / alignment) * alignment : m_offset;
+	if (frame.m_capacity == 0 || std::uint64_t(aligned) + size > frame.m_capacity) {
+		std::uint64_t needed = std::uint64_t(m_frameUsage) + size + alignment;
+		std::uint64_t capacity = std::max<std::uint64_t>(std::uint64_t(frame.m_capacity) * 2, needed);
+		if (capacity > SDL_MAX_UINT32 || !Grow(frame, std::uint32_t(capacity))) { return nullptr; }
+		aligned = 0;
+	}
+	std::uint8_t* dataPtr = (m_hostMemory) ? frame.m_hostMemory.data() : (std::uint8_t*)SDL_MapGPUTransferBuffer(Game::GetGPUDevice(), frame.m_sdlTransferBuffer, false);
+	if (!dataPtr) {
+		SDL_LogError(SDL_LOG_CATEGORY_ERROR, "SDL_MapGPUTransferBuffer failed! %s", SDL_GetError());
+		return nullptr;
+	}
+	m_mapped = true;
+	m_frameUsage += (aligned - m_offset) + size;
+	m_offset = aligned + size;
+	offset = aligned;
+	return dataPtr + aligned;
+}
+
+void GPURingBuffer::Unmap() {
+	if (!m_mapped) { return; }
+	m_mapped = false;
+	if (m_hostMemory) { return; }
+	SDL_UnmapGPUTransferBuffer(Game::GetGPUDevice(), m_frames[m_currentFrame].m_sdlTransferBuffer);
+}
+
+void GPURingBuffer::Upload(SDL_GPUCopyPass* copyPass, std::uint32_t offset, std::uint32_t size) {
+	UploadTo(copyPass, offset, size, m_frames[m_currentFrame].m_sdlBuffer, offset);
+}
+
+void GPURingBuffer::UploadTo(SDL_GPUCopyPass* copyPass, std::uint32_t offset, std::uint32_t size, SDL_GPUBuffer* buffer, std::uint32_t bufferOffset) {
+	if (size == 0 || !buffer || m_hostMemory) { return; }
+	SDL_GPUTransferBufferLocation transferBufferLocation = {};
+	transferBufferLocation.transfer_buffer = m_frames[m_currentFrame].m_sdlTransferBuffer;
+	transferBufferLocation.offset = offset;
+	SDL_GPUBufferRegion bufferRegion = {};
+	bufferRegion.buffer = buffer;
+	bufferRegion.offset = bufferOffset;
+	bufferRegion.size = size;
+	SDL_UploadToGPUBuffer(copyPass, &transferBufferLocation, &bufferRegion, false);
+}
+
+SDL_GPUBuffer* GPURingBuffer::GetBuffer() const {
+	return m_frames[m_currentFrame].m_sdlBuffer;
+}
+
+std::uint32_t GPURingBuffer::GetCapacity() const {
+	return m_frames[m_currentFrame].m_capacity;
+}
+
+bool GPURingBuffer::Grow(Frame& frame, std::uint32_t capacity) {
+	capacity = std::max(capacity, GPU_RING_BUFFER_MIN_CAPACITY);
+	if (m_hostMemory) {
+		frame.m_hostMemory.resize(capacity);
+		frame.m_capacity = capacity;
+		return true;
+	}
+
+	// Released buffers are kept alive by SDL until commands already recorded with them have run
+	SDL_GPUDevice* device = Game::GetGPUDevice();
+	SDL_ReleaseGPUTransferBuffer(device, frame.m_sdlTransferBuffer);
+	SDL_ReleaseGPUBuffer(device, frame.m_sdlBuffer);
+	frame = Frame();
+
+	SDL_GPUTransferBufferCreateInfo transferBufferCreateInfo = {};
+	transferBufferCreateInfo.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
+	transferBufferCreateInfo.size = capacity;
+	frame.m_sdlTransferBuffer = SDL_CreateGPUTransferBuffer(device, &transferBufferCreateInfo);
+	if (!frame.m_sdlTransferBuffer) {
+		SDL_LogError(SDL_LOG_CATEGORY_ERROR, "SDL_CreateGPUTransferBuffer failed! %s", SDL_GetError());
+		return false;
+	}
+
+	frame.m_capacity = capacity;
+	if (m_usage == 0) { return true; }
+
+	SDL_GPUBufferCreateInfo bufferCreateInfo = {};
+	bufferCreateInfo.usage = m_usage;
+	bufferCreateInfo.size = capacity;
+	frame.m_sdlBuffer = SDL_CreateGPUBuffer(device, &bufferCreateInfo);
+	if (!frame.m_sdlBuffer) {
+		SDL_LogError(SDL_LOG_CATEGORY_ERROR, "SDL_CreateGPUBuffer failed! %s", SDL_GetError());
+		SDL_ReleaseGPUTransferBuffer(device, frame.m_sdlTransferBuffer);
+		frame = Frame();
+		return false;
+	}
+	return true;
+}
+
+} // detail
+
+} // luna
\ No newline at end of file
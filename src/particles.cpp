@@ -0,0 +1,259 @@
+#include <luna/detail/particles.hpp>
+
+namespace luna {
+
+// Particles aged & moved per worker thread
+static constexpr std::size_t PARTICLE_UPDATE_GRAIN = 16384;
+
+ParticleEmitter::ParticleEmitter(const ParticleEmitterSettings& settings, float x, float y) :
+	m_positionX(x),
+	m_positionY(y),
+	m_bounds(x, y, x, y) {
+	// Every emitter gets its own sequence, so emitters made on the same tick do not spray in lockstep
+	static Uint64 seedCounter = 0;
+	m_randomState = ++seedCounter * 0x9E3779B97F4A7C15ull;
+	SetSettings(settings);
+}
+
+bool ParticleEmitter::IsValid() const {
+	return m_sprite.IsValid();
+}
+
+const ParticleEmitterSettings& ParticleEmitter::GetSettings() const {
+	return m_settings;
+}
+
+void ParticleEmitter::SetSettings(const ParticleEmitterSettings& settings) {
+	m_settings = settings;
+	m_sprite = Sprite(settings.textureID, m_positionX, m_positionY, settings.image, 0.f, settings.depth);
+	m_sprite.SetBlendMode(settings.blendMode);
+	Resize(settings.maxParticles);
+}
+
+float ParticleEmitter::GetPositionX() const {
+	return m_positionX;
+}
+
+float ParticleEmitter::GetPositionY() const {
+	return m_positionY;
+}
+
+void ParticleEmitter::SetPosition(float x, float y) {
+	m_positionX = x;
+	m_positionY = y;
+	m_sprite.SetPositionX(x);
+	m_sprite.SetPositionY(y);
+}
+
+std::uint32_t ParticleEmitter::Burst(std::uint32_t count) {
+	std::uint32_t spawned = std::min(count, std::uint32_t(m_x.size()) - m_count);
+	Spawn(spawned);
+	return spawned;
+}
+
+void ParticleEmitter::Clear() {
+	m_count = 0;
+	m_emitAccumulator = 0.f;
+	m_bounds = ShapeAABB(m_positionX, m_positionY, m_positionX, m_positionY);
+}
+
+std::uint32_t ParticleEmitter::GetParticleCount() const {
+	return m_count;
+}
+
+ShapeAABB ParticleEmitter::GetBounds() const {
+	return m_bounds;
+}
+
+const Sprite& ParticleEmitter::GetSprite() const {
+	return m_sprite;
+}
+
+bool ParticleEmitter::GetTranslucent() const {
+	return m_sprite.GetTranslucent() || m_settings.colorStart.a < 255 || m_settings.colorEnd.a < 255;
+}
+
+void ParticleEmitter::Update(float dt, detail::ThreadPool& threadPool) {
+	// Age & move every particle, each chunk keeping the bounds of its own particles
+	float damping = std::pow(1.f - std::clamp(m_settings.drag, 0.f, 1.f), dt);
+	m_chunkBounds.resize((m_count + PARTICLE_UPDATE_GRAIN - 1) / PARTICLE_UPDATE_GRAIN);
+	threadPool.parallel_for(m_count, PARTICLE_UPDATE_GRAIN, [&](std::size_t begin, std::size_t end) {
+		detail::IntegrateParticles(
+			m_x.data() + begin, m_y.data() + begin, m_velocityX.data() + begin, m_velocityY.data() + begin,
+			m_rotation.data() + begin, m_spin.data() + begin, m_age.data() + begin, end - begin,
+			dt, m_settings.gravityX, m_settings.gravityY, damping, m_chunkBounds[begin / PARTICLE_UPDATE_GRAIN]
+		);
+	});
+	m_bounds = ShapeAABB(m_positionX, m_positionY, m_positionX, m_positionY);
+	for (auto& chunk : m_chunkBounds) {
+		m_bounds.left = std::min(m_bounds.left, chunk.left);
+		m_bounds.top = std::min(m_bounds.top, chunk.top);
+		m_bounds.right = std::max(m_bounds.right, chunk.right);
+		m_bounds.bottom = std::max(m_bounds.bottom, chunk.bottom);
+	}
+
+	// Retire particles that have outlived their lifetime
+	for (std::uint32_t i = 0; i < m_count;) {
+		if (m_age[i] * m_inverseLifetime[i] >= 1.f) { Kill(i); }
+		else { ++i; }
+	}
+
+	// Spawn whole particles at the emit rate, carrying the remainder over to the next update
+	m_emitAccumulator += std::max(m_settings.emitRate, 0.f) * dt;
+	std::uint32_t spawnCount = std::uint32_t(m_emitAccumulator);
+	m_emitAccumulator -= float(spawnCount);
+	Burst(spawnCount);
+}
+
+void ParticleEmitter::Spawn(std::uint32_t count) {
+	if (count == 0) { return; }
+	const ParticleEmitterSettings& settings = m_settings;
+	auto random = [this](float lower, float upper) { return lower + (upper - lower) * SDL_randf_r(&m_randomState); };
+	for (std::uint32_t n = 0; n < count; ++n) {
+		std::uint32_t i = m_count++;
+		float distance = settings.spawnRadius * std::sqrt(SDL_randf_r(&m_randomState));
+		float offsetAngle = random(0.f, 6.28318530718f);
+		float angle = settings.direction + random(-0.5f, 0.5f) * settings.spread;
+		float speed = random(settings.speedMin, settings.speedMax);
+		m_x[i] = m_positionX + std::cos(offsetAngle) * distance;
+		m_y[i] = m_positionY + std::sin(offsetAngle) * distance;
+		m_velocityX[i] = std::cos(angle) * speed;
+		m_velocityY[i] = std::sin(angle) * speed;
+		m_rotation[i] = 0.f;
+		m_spin[i] = random(settings.spinMin, settings.spinMax);
+		m_age[i] = 0.f;
+		m_inverseLifetime[i] = 1.f / std::max(random(settings.lifetimeMin, settings.lifetimeMax), 0.0001f);
+	}
+
+	// New particles lie within the spawn disc until they next move
+	float radius = std::max(settings.spawnRadius, 0.f);
+	m_bounds.left = std::min(m_bounds.left, m_positionX - radius);
+	m_bounds.top = std::min(m_bounds.top, m_positionY - radius);
+	m_bounds.right = std::max(m_bounds.right, m_positionX + radius);
+	m_bounds.bottom = std::max(m_bounds.bottom, m_positionY + radius);
+}
+
+void ParticleEmitter::Kill(std::uint32_t index) {
+	std::uint32_t last = --m_count;
+	m_x[index] = m_x[last];
+	m_y[index] = m_y[last];
+	m_velocityX[index] = m_velocityX[last];
+	m_velocityY[index] = m_velocityY[last];
+	m_rotation[index] = m_rotation[last];
+	m_spin[index] = m_spin[last];
+	m_age[index] = m_age[last];
+	m_inverseLifetime[index] = m_inverseLifetime[last];
+}
+
+void ParticleEmitter::Resize(std::uint32_t capacity) {
+	m_x.resize(capacity);
+	m_y.resize(capacity);
+	m_velocityX.resize(capacity);
+	m_velocityY.resize(capacity);
+	m_rotation.resize(capacity);
+	m_spin.resize(capacity);
+	m_age.resize(capacity);
+	m_inverseLifetime.resize(capacity);
+	m_count = std::min(m_count, capacity);
+}
+
+namespace detail {
+
+void IntegrateParticles(float* x, float* y, float* velocityX, float* velocityY, float* rotation, const float* spin, float* age, std::size_t count,
+	float dt, float gravityX, float gravityY, float damping, ShapeAABB& bounds) {
+	float minX = std::numeric_limits<float>::max(), minY = std::numeric_limits<float>::max();
+	float maxX = std::numeric_limits<float>::lowest(), maxY = std::numeric_limits<float>::lowest();
+	std::size_t i = 0;
+
+#if defined(LUNA_SIMD_AVX)
+	// Step 8 particles at a time, keeping a running box per lane
+	const __m256 step = _mm256_set1_ps(dt);
+	const __m256 pullX = _mm256_set1_ps(gravityX * dt);
+	const __m256 pullY = _mm256_set1_ps(gravityY * dt);
+	const __m256 keep = _mm256_set1_ps(damping);
+	__m256 laneMinX = _mm256_set1_ps(minX), laneMinY = _mm256_set1_ps(minY);
+	__m256 laneMaxX = _mm256_set1_ps(maxX), laneMaxY = _mm256_set1_ps(maxY);
+	for (; i + 8 <= count; i += 8) {
+		__m256 vx = _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(velocityX + i), pullX), keep);
+		__m256 vy = _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(velocityY + i), pullY), keep);
+		__m256 px = _mm256_fmadd_ps(vx, step, _mm256_loadu_ps(x + i));
+		__m256 py = _mm256_fmadd_ps(vy, step, _mm256_loadu_ps(y + i));
+		_mm256_storeu_ps(velocityX + i, vx);
+		_mm256_storeu_ps(velocityY + i, vy);
+		_mm256_storeu_ps(x + i, px);
+		_mm256_storeu_ps(y + i, py);
+		_mm256_storeu_ps(rotation + i, _mm256_fmadd_ps(_mm256_loadu_ps(spin + i), step, _mm256_loadu_ps(rotation + i)));
+		_mm256_storeu_ps(age + i, _mm256_add_ps(_mm256_loadu_ps(age + i), step));
+		laneMinX = _mm256_min_ps(laneMinX, px);
+		laneMinY = _mm256_min_ps(laneMinY, py);
+		laneMaxX = _mm256_max_ps(laneMaxX, px);
+		laneMaxY = _mm256_max_ps(laneMaxY, py);
+	}
+	alignas(32) float lanes[4][8];
+	_mm256_store_ps(lanes[0], laneMinX);
+	_mm256_store_ps(lanes[1], laneMinY);
+	_mm256_store_ps(lanes[2], laneMaxX);
+	_mm256_store_ps(lanes[3], laneMaxY);
+	for (int lane = 0; lane < 8; ++lane) {
+		minX = std::min(minX, lanes[0][lane]);
+		minY = std::min(minY, lanes[1][lane]);
+		maxX = std::max(maxX, lanes[2][lane]);
+		maxY = std::max(maxY, lanes[3][lane]);
+	}
+#elif defined(LUNA_SIMD_NEON)
+	// Step 4 particles at a time, keeping a running box per lane
+	const float32x4_t step = vdupq_n_f32(dt);
+	const float32x4_t pullX = vdupq_n_f32(gravityX * dt);
+	const float32x4_t pullY = vdupq_n_f32(gravityY * dt);
+	const float32x4_t keep = vdupq_n_f32(damping);
+	float32x4_t laneMinX = vdupq_n_f32(minX), laneMinY = vdupq_n_f32(minY);
+	float32x4_t laneMaxX = vdupq_n_f32(maxX), laneMaxY = vdupq_n_f32(maxY);
+	for (; i + 4 <= count; i += 4) {
+		float32x4_t vx = vmulq_f32(vaddq_f32(vld1q_f32(velocityX + i), pullX), keep);
+		float32x4_t vy = vmulq_f32(vaddq_f32(vld1q_f32(velocityY + i), pullY), keep);
+		float32x4_t px = vmlaq_f32(vld1q_f32(x + i), vx, step);
+		float32x4_t py = vmlaq_f32(vld1q_f32(y + i), vy, step);
+		vst1q_f32(velocityX + i, vx);
+		vst1q_f32(velocityY + i, vy);
+		vst1q_f32(x + i, px);
+		vst1q_f32(y + i, py);
+		vst1q_f32(rotation + i, vmlaq_f32(vld1q_f32(rotation + i), vld1q_f32(spin + i), step));
+		vst1q_f32(age + i, vaddq_f32(vld1q_f32(age + i), step));
+		laneMinX = vminq_f32(laneMinX, px);
+		laneMinY = vminq_f32(laneMinY, py);
+		laneMaxX = vmaxq_f32(laneMaxX, px);
+		laneMaxY = vmaxq_f32(laneMaxY, py);
+	}
+	// Fold the lanes pairwise, since the across-vector vminvq/vmaxvq only exist on AArch64
+	float32x2_t pairMinX = vpmin_f32(vget_low_f32(laneMinX), vget_high_f32(laneMinX));
+	float32x2_t pairMinY = vpmin_f32(vget_low_f32(laneMinY), vget_high_f32(laneMinY));
+	float32x2_t pairMaxX = vpmax_f32(vget_low_f32(laneMaxX), vget_high_f32(laneMaxX));
+	float32x2_t pairMaxY = vpmax_f32(vget_low_f32(laneMaxY), vget_high_f32(laneMaxY));
+	minX = vget_lane_f32(vpmin_f32(pairMinX, pairMinX), 0);
+	minY = vget_lane_f32(vpmin_f32(pairMinY, pairMinY), 0);
+	maxX = vget_lane_f32(vpmax_f32(pairMaxX, pairMaxX), 0);
+	maxY = vget_lane_f32(vpmax_f32(pairMaxY, pairMaxY), 0);
+#endif
+
+	// Handle remaining particles
+	for (; i < count; ++i) {
+		velocityX[i] = (velocityX[i] + gravityX * dt) * damping;
+		velocityY[i] = (velocityY[i] + gravityY * dt) * damping;
+		x[i] += velocityX[i] * dt;
+		y[i] += velocityY[i] * dt;
+		rotation[i] += spin[i] * dt;
+		age[i] += dt;
+		minX = std::min(minX, x[i]);
+		minY = std::min(minY, y[i]);
+		maxX = std::max(maxX, x[i]);
+		maxY = std::max(maxY, y[i]);
+	}
+	bounds.left = minX;
+	bounds.top = minY;
+	bounds.right = maxX;
+	bounds.bottom = maxY;
+}
+
+} // detail
+
+} // luna
\ No newline at end of file
@@ -1,39 +1,125 @@
 #include <luna/detail/render.hpp>
 #include <luna/detail/game.hpp>
 #include <luna/detail/room.hpp>
+#include <luna/detail/stats.hpp>
 #include <luna/detail/shader.hpp>
 #include <luna/detail/sprite.hpp>
 #include <luna/detail/camera.hpp>
 
 namespace luna {
 
-SpriteRenderer::SpriteRenderer() {
-	// Build shader pipelines
-	m_spriteBatchPipeline = new SpriteBatchShaderPipeline();
-	m_primitiveBatchPipeline = new PrimitiveBatchShaderPipeline(false);
-	m_primitiveLineBatchPipeline = new PrimitiveBatchShaderPipeline(true);
+// Sprites packed per worker thread when filling the instance buffer
+static constexpr std::size_t SPRITE_BATCH_PACK_GRAIN = 4096;
+
+// Sprites bounded & culled per worker thread
+static constexpr std::size_t SPRITE_CULL_GRAIN = 8192;
+
+// Cameras drawn per frame, one per bit of a renderable's camera mask
+static constexpr std::size_t RENDER_MAX_CAMERAS = 32;
+
+// Frames a thread's draw queue may go without anything drawn into it before it is dropped
+static constexpr std::uint32_t RENDER_QUEUE_IDLE_FRAMES = 120;
+
+// SDL_GPU fences can't be waited on with a timeout, so a frame slot is checked again after sleeping this long
+static constexpr std::uint64_t RENDER_FRAME_WAIT_STEP_NS = 250000;
+
+// Larger depths are drawn in front, so opaque renderables must sort nearest first for early depth rejection,
+// and translucent ones farthest first so they blend over what is behind them
+static constexpr std::uint64_t SortKeyAtDepth(bool opaque, std::int32_t depth) {
+	return detail::MakeRenderSortKey(opaque, 1, 0, 0, depth);
+}
+static_assert(SortKeyAtDepth(true, 2) < SortKeyAtDepth(true, 1) && SortKeyAtDepth(true, 1) < SortKeyAtDepth(true, 0), "Opaque renderables must sort front to back");
+static_assert(SortKeyAtDepth(false, 0) < SortKeyAtDepth(false, 1) && SortKeyAtDepth(false, 1) < SortKeyAtDepth(false, 2), "Translucent renderables must sort back to front");
+static_assert(SortKeyAtDepth(true, -1000) < SortKeyAtDepth(false, 1000), "Opaque renderables must sort ahead of translucent ones");
+
+SpriteRenderer::SpriteRenderer() :
+	SpriteRenderer(false) {}
+
+SpriteRenderer::SpriteRenderer(bool nullDevice) :
+	m_nullDevice(nullDevice) {
+	// Tell this renderer's thread queues apart from those of any renderer that used to live at the same address
+	static std::atomic<std::uint64_t> rendererSerialCounter = 0;
+	m_rendererSerial = ++rendererSerialCounter;
+
+	// Build shader pipelines, reading either the full or the packed instance & vertex layouts
+	m_compactFormats = Game::GetCompactVertexFormatsEnabled();
+	m_spriteDataStride = std::uint32_t((m_compactFormats) ? sizeof(PackedSpriteBatchInfo) : sizeof(SpriteBatchInfo));
+	m_primitiveVertexStride = std::uint32_t((m_compactFormats) ? sizeof(VertexPosPackedColor) : sizeof(VertexPosColor));
+	m_analyticPrimitives = Game::GetAnalyticPrimitivesEnabled();
+	if (!m_nullDevice) {
+		m_spriteBatchSolidPipeline = new SpriteBatchShaderPipeline(true, m_compactFormats, SpriteBatchPass::Solid);
+		m_spriteBatchPipeline = new SpriteBatchShaderPipeline(true, m_compactFormats, SpriteBatchPass::AlphaTested);
+		m_spriteBatchStraightPipeline = new SpriteBatchShaderPipeline(false, m_compactFormats, SpriteBatchPass::AlphaTested);
+		m_spriteBatchTranslucentPipeline = new SpriteBatchShaderPipeline(true, m_compactFormats, SpriteBatchPass::Translucent);
+		m_spriteBatchTranslucentStraightPipeline = new SpriteBatchShaderPipeline(false, m_compactFormats, SpriteBatchPass::Translucent);
+		m_primitiveBatchPipeline = new PrimitiveBatchShaderPipeline(false, m_compactFormats);
+		m_primitiveLineBatchPipeline = new PrimitiveBatchShaderPipeline(true, m_compactFormats);
+		if (m_analyticPrimitives) { m_shapeBatchPipeline = new ShapeBatchShaderPipeline(); }
+	}
+
+	// Staging buffers are allocated on first use, and grow to fit the largest frame
+	m_spriteDataRing = new detail::GPURingBuffer(SDL_GPU_BUFFERUSAGE_GRAPHICS_STORAGE_READ, RENDER_FRAMES_IN_FLIGHT, m_nullDevice);
+	m_primitiveVertexRing = new detail::GPURingBuffer(SDL_GPU_BUFFERUSAGE_VERTEX, RENDER_FRAMES_IN_FLIGHT, m_nullDevice);
+	m_primitiveIndexRing = new detail::GPURingBuffer(SDL_GPU_BUFFERUSAGE_INDEX, RENDER_FRAMES_IN_FLIGHT, m_nullDevice);
+	m_spriteInstanceRing = new detail::GPURingBuffer(0, RENDER_FRAMES_IN_FLIGHT, m_nullDevice);
+	m_shapeDataRing = new detail::GPURingBuffer(SDL_GPU_BUFFERUSAGE_GRAPHICS_STORAGE_READ, RENDER_FRAMES_IN_FLIGHT, m_nullDevice);
+	m_drawIndexRing = new detail::GPURingBuffer(SDL_GPU_BUFFERUSAGE_GRAPHICS_STORAGE_READ, RENDER_FRAMES_IN_FLIGHT, m_nullDevice);
+	m_glyphAtlas = new detail::GlyphAtlas();
+
+	// Without a window, frames are drawn into a target the size the window would have been
+	if (Game::GetHeadless()) { m_frameTarget = CreateRenderTarget(Game::GetWindowWidth(), Game::GetWindowHeight()); }
 }
 
 SpriteRenderer::~SpriteRenderer() {
 	SDL_GPUDevice* device = Game::GetGPUDevice();
+	for (auto& fence : m_sdlFrameFences) {
+		if (!fence) { continue; }
+		SDL_WaitForGPUFences(device, true, &fence, 1);
+		SDL_ReleaseGPUFence(device, fence);
+	}
+	for (auto& read : m_pendingReads) { SDL_ReleaseGPUTransferBuffer(device, read.m_sdlTransferBuffer); }
+	for (auto& renderTarget : m_renderTargets) {
+		SDL_ReleaseGPUTexture(device, renderTarget.m_sdlTexture);
+		SDL_ReleaseGPUTexture(device, renderTarget.m_sdlDepthTexture);
+	}
+	delete m_spriteBatchSolidPipeline;
 	delete m_spriteBatchPipeline;
+	delete m_spriteBatchStraightPipeline;
+	delete m_spriteBatchTranslucentPipeline;
+	delete m_spriteBatchTranslucentStraightPipeline;
 	delete m_primitiveBatchPipeline;
 	delete m_primitiveLineBatchPipeline;
+	delete m_shapeBatchPipeline;
 	SDL_ReleaseGPUSampler(device, m_sdlGPUSampler);
-	SDL_ReleaseGPUTexture(device, m_sdlGPUAtlasTexture);
+	for (auto& texturePage : m_sdlTexturePages) {
+		SDL_ReleaseGPUTexture(device, texturePage.second);
+	}
+	for (auto& glyphPage : m_sdlGlyphPages) {
+		SDL_ReleaseGPUTexture(device, glyphPage);
+	}
 	SDL_ReleaseGPUTexture(device, m_sdlGPUDepthTexture);
-	SDL_ReleaseGPUBuffer(device, m_sdlSpriteDataBuffer);
-	SDL_ReleaseGPUTransferBuffer(device, m_sdlSpriteDataTransferBuffer);
-	SDL_ReleaseGPUBuffer(device, m_sdlPrimitiveDataVertexBuffer);
-	SDL_ReleaseGPUBuffer(device, m_sdlPrimitiveDataIndexBuffer);
-	SDL_ReleaseGPUTransferBuffer(device, m_sdlPrimitiveDataTransferBuffer);
-	SDL_ReleaseGPUTransferBuffer(device, m_sdlTextureTransferBuffer);
+	delete m_glyphAtlas;
+	delete m_spriteDataRing;
+	delete m_primitiveVertexRing;
+	delete m_primitiveIndexRing;
+	delete m_spriteInstanceRing;
+	delete m_shapeDataRing;
+	delete m_drawIndexRing;
+	delete m_captureWriter;
+	SDL_ReleaseGPUBuffer(device, m_sdlSpriteInstanceBuffer);
 }
 
 bool SpriteRenderer::IsValid() const {
+	if (m_nullDevice) { return (!Game::GetHeadless() || m_frameTarget != RENDER_TARGET_ID_NULL); }
 	return (
-		m_spriteBatchPipeline && m_primitiveBatchPipeline && m_primitiveLineBatchPipeline &&
-		m_spriteBatchPipeline->IsValid() && m_primitiveBatchPipeline->IsValid() && m_primitiveLineBatchPipeline->IsValid()
+		m_spriteBatchSolidPipeline && m_spriteBatchPipeline && m_spriteBatchStraightPipeline &&
+		m_spriteBatchTranslucentPipeline && m_spriteBatchTranslucentStraightPipeline &&
+		m_primitiveBatchPipeline && m_primitiveLineBatchPipeline &&
+		m_spriteBatchSolidPipeline->IsValid() && m_spriteBatchPipeline->IsValid() && m_spriteBatchStraightPipeline->IsValid() &&
+		m_spriteBatchTranslucentPipeline->IsValid() && m_spriteBatchTranslucentStraightPipeline->IsValid() &&
+		m_primitiveBatchPipeline->IsValid() && m_primitiveLineBatchPipeline->IsValid() &&
+		(!m_analyticPrimitives || (m_shapeBatchPipeline && m_shapeBatchPipeline->IsValid())) &&
+		(!Game::GetHeadless() || m_frameTarget != RENDER_TARGET_ID_NULL)
 		);
 }
 
@@ -41,38 +127,303 @@ void SpriteRenderer::DrawSprite(Sprite sprite) {
 	// Only draw valid sprites
 	if (!sprite.IsValid()) { return; }
 
-	// Cull sprites outside the camera view
-	Camera* camera = RoomManager::GetCurrentRoom()->GetActiveCamera();
-	if (camera) {
-		if (!camera->RegionOnCamera(sprite.GetShapeCircle())) { return; }
+	// Add to draw queue; culling waits until the frame is drawn
+	DrawQueue& queue = GetThreadQueue();
+	queue.m_renderables.emplace_back(this, queue.m_sprites.size(), RenderableType::SpriteType, !sprite.GetTranslucent(), SpriteSortKey(sprite));
+	queue.m_sprites.push_back(sprite);
+}
+
+void SpriteRenderer::DrawPrimitive(Primitive primitive) {
+	// Analytic primitives all share the shape pipeline, whether filled or outlined
+	bool opaque = (primitive.GetAlpha() >= 1.f);
+	std::uint32_t pipeline = (m_analyticPrimitives) ? 2 : ((primitive.IsWireframe()) ? 1 : 0);
+	std::uint64_t sortKey = detail::MakeRenderSortKey(opaque, RenderableType::PrimitiveType, pipeline, 0, primitive.GetDepth());
+
+	// Add to draw queue; culling waits until the frame is drawn
+	DrawQueue& queue = GetThreadQueue();
+	queue.m_renderables.emplace_back(this, queue.m_primitives.size(), RenderableType::PrimitiveType, opaque, sortKey);
+	queue.m_primitives.push_back(std::move(primitive));
+}
+
+FontID SpriteRenderer::LoadFont(const std::string& filename, float pointSize) {
+	return m_glyphAtlas->OpenFont(filename, pointSize);
+}
+
+void SpriteRenderer::UnloadFont(FontID font) {
+	m_glyphAtlas->CloseFont(font);
+}
+
+void SpriteRenderer::DrawText(const Text& text) {
+	if (!text.IsValid()) { return; }
+
+	// Glyphs go straight into this thread's queue, to be sorted & batched like any other sprite
+	DrawQueue& queue = GetThreadQueue();
+	std::size_t firstGlyph = queue.m_sprites.size();
+	m_glyphAtlas->LayoutText(text, queue.m_sprites);
+	for (std::size_t i = firstGlyph; i < queue.m_sprites.size(); ++i) {
+		queue.m_renderables.emplace_back(this, i, RenderableType::SpriteType, false, SpriteSortKey(queue.m_sprites[i]));
 	}
+}
+
+SpriteInstanceID SpriteRenderer::CreateSpriteInstance(const Sprite& sprite) {
+	if (!sprite.IsValid()) { return SPRITE_INSTANCE_ID_NULL; }
 
-	// Add to draw queue
-	if (sprite.GetTranslucent()) { m_translucentRenderables.emplace_back(this, m_sprites.size(), RenderableType::SpriteType, false); }
-	else { m_opaqueRenderables.emplace_back(this, m_sprites.size(), RenderableType::SpriteType, true); }
-	m_sprites.push_back(sprite);
+	// Reuse the slot of a destroyed instance if there is one
+	std::size_t index = m_spriteInstances.size();
+	if (!m_freeSpriteInstances.empty()) {
+		index = m_freeSpriteInstances.back();
+		m_freeSpriteInstances.pop_back();
+	}
+	else { m_spriteInstances.emplace_back(); }
+	SpriteInstance& instance = m_spriteInstances[index];
+	instance.m_sprite = sprite;
+	instance.m_sortKey = SpriteSortKey(sprite);
+	instance.m_alive = true;
+	m_spriteInstanceLayoutDirty = true;
+	return SpriteInstanceID(index + 1);
 }
 
-void SpriteRenderer::DrawPrimitive(Primitive primitive) {
-	// Cull primitives outside the camera view
-	Camera* camera = RoomManager::GetCurrentRoom()->GetActiveCamera();
-	if (camera) {
-		if (!camera->RegionOnCamera(primitive.GetShape(), primitive.GetShapeType())) {
-			return;
+void SpriteRenderer::DestroySpriteInstance(SpriteInstanceID instanceID) {
+	if (instanceID == SPRITE_INSTANCE_ID_NULL || instanceID > m_spriteInstances.size()) { return; }
+	std::size_t index = std::size_t(instanceID - 1);
+	if (!m_spriteInstances[index].m_alive) { return; }
+	m_spriteInstances[index] = SpriteInstance();
+	m_freeSpriteInstances.push_back(index);
+	m_spriteInstanceLayoutDirty = true;
+}
+
+Sprite* SpriteRenderer::EditSpriteInstance(SpriteInstanceID instanceID) {
+	if (instanceID == SPRITE_INSTANCE_ID_NULL || instanceID > m_spriteInstances.size()) { return nullptr; }
+	SpriteInstance& instance = m_spriteInstances[instanceID - 1];
+	if (!instance.m_alive) { return nullptr; }
+	if (!instance.m_dirty) {
+		instance.m_dirty = true;
+		m_dirtySpriteInstances.push_back(std::size_t(instanceID - 1));
+	}
+	return &instance.m_sprite;
+}
+
+const Sprite* SpriteRenderer::GetSpriteInstance(SpriteInstanceID instanceID) const {
+	if (instanceID == SPRITE_INSTANCE_ID_NULL || instanceID > m_spriteInstances.size()) { return nullptr; }
+	const SpriteInstance& instance = m_spriteInstances[instanceID - 1];
+	return (instance.m_alive) ? &instance.m_sprite : nullptr;
+}
+
+StaticSpriteID SpriteRenderer::CreateStaticSprite(const Sprite& sprite) {
+	if (!sprite.IsValid()) { return STATIC_SPRITE_ID_NULL; }
+
+	// Reuse the slot of a destroyed static sprite if there is one
+	std::size_t index = m_staticSprites.size();
+	if (!m_freeStaticSprites.empty()) {
+		index = m_freeStaticSprites.back();
+		m_freeStaticSprites.pop_back();
+	}
+	else { m_staticSprites.emplace_back(); }
+	m_staticSprites[index].m_alive = true;
+	SetStaticSprite(StaticSpriteID(index + 1), sprite);
+	return StaticSpriteID(index + 1);
+}
+
+void SpriteRenderer::DestroyStaticSprite(StaticSpriteID staticSpriteID) {
+	if (staticSpriteID == STATIC_SPRITE_ID_NULL || staticSpriteID > m_staticSprites.size()) { return; }
+	std::size_t index = std::size_t(staticSpriteID - 1);
+	StaticSprite& staticSprite = m_staticSprites[index];
+	if (!staticSprite.m_alive) { return; }
+	const ShapeAABB& bounds = staticSprite.m_bounds;
+	m_staticSpriteGrid.erase(std::uint32_t(index), bounds.left, bounds.top, bounds.right, bounds.bottom);
+	staticSprite = StaticSprite();
+	m_freeStaticSprites.push_back(index);
+}
+
+bool SpriteRenderer::SetStaticSprite(StaticSpriteID staticSpriteID, const Sprite& sprite) {
+	if (staticSpriteID == STATIC_SPRITE_ID_NULL || staticSpriteID > m_staticSprites.size() || !sprite.IsValid()) { return false; }
+	std::size_t index = std::size_t(staticSpriteID - 1);
+	StaticSprite& staticSprite = m_staticSprites[index];
+	if (!staticSprite.m_alive) { return false; }
+
+	// Refile under the box around the sprite's bounding circle, which holds at any rotation; a sprite
+	// that was just created has no sort key yet, and is not filed anywhere
+	if (staticSprite.m_sortKey != 0) {
+		const ShapeAABB& bounds = staticSprite.m_bounds;
+		m_staticSpriteGrid.erase(std::uint32_t(index), bounds.left, bounds.top, bounds.right, bounds.bottom);
+	}
+	ShapeCircle circle = sprite.GetShapeCircle();
+	staticSprite.m_sprite = sprite;
+	staticSprite.m_bounds = ShapeAABB(circle.x - circle.radius, circle.y - circle.radius, circle.x + circle.radius, circle.y + circle.radius);
+	staticSprite.m_sortKey = SpriteSortKey(sprite);
+	const ShapeAABB& bounds = staticSprite.m_bounds;
+	m_staticSpriteGrid.insert(std::uint32_t(index), bounds.left, bounds.top, bounds.right, bounds.bottom);
+	return true;
+}
+
+const Sprite* SpriteRenderer::GetStaticSprite(StaticSpriteID staticSpriteID) const {
+	if (staticSpriteID == STATIC_SPRITE_ID_NULL || staticSpriteID > m_staticSprites.size()) { return nullptr; }
+	const StaticSprite& staticSprite = m_staticSprites[staticSpriteID - 1];
+	return (staticSprite.m_alive) ? &staticSprite.m_sprite : nullptr;
+}
+
+ParticleEmitterID SpriteRenderer::CreateParticleEmitter(const ParticleEmitterSettings& settings, float x, float y) {
+	auto emitter = std::make_unique<ParticleEmitter>(settings, x, y);
+	if (!emitter->IsValid()) {
+		SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Particle emitter has no valid texture!");
+		return PARTICLE_EMITTER_ID_NULL;
+	}
+	std::size_t index = 0;
+	if (!m_freeParticleEmitters.empty()) {
+		index = m_freeParticleEmitters.back();
+		m_freeParticleEmitters.pop_back();
+		m_particleEmitters[index] = std::move(emitter);
+	}
+	else {
+		index = m_particleEmitters.size();
+		m_particleEmitters.push_back(std::move(emitter));
+	}
+	return ParticleEmitterID(index + 1);
+}
+
+void SpriteRenderer::DestroyParticleEmitter(ParticleEmitterID emitterID) {
+	if (!GetParticleEmitter(emitterID)) { return; }
+	m_particleEmitters[emitterID - 1].reset();
+	m_freeParticleEmitters.push_back(std::size_t(emitterID - 1));
+}
+
+ParticleEmitter* SpriteRenderer::GetParticleEmitter(ParticleEmitterID emitterID) {
+	if (emitterID == PARTICLE_EMITTER_ID_NULL || emitterID > m_particleEmitters.size()) { return nullptr; }
+	return m_particleEmitters[emitterID - 1].get();
+}
+
+RenderTargetID SpriteRenderer::CreateRenderTarget(std::uint32_t width, std::uint32_t height) {
+	if (width == 0 || height == 0) { return RENDER_TARGET_ID_NULL; }
+	if (m_freeRenderTargets.empty() && m_renderTargets.size() + 1 >= SPRITE_SORT_GLYPH_PAGE) {
+		SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Too many render targets!");
+		return RENDER_TARGET_ID_NULL;
+	}
+	SDL_GPUDevice* device = Game::GetGPUDevice();
+
+	// Create color & depth textures; without a device the target only has a size
+	RenderTarget renderTarget;
+	if (!m_nullDevice) {
+		SDL_GPUTextureCreateInfo textureCreateInfo = {};
+		textureCreateInfo.type = SDL_GPU_TEXTURETYPE_2D;
+		textureCreateInfo.format = detail::GetColorTargetFormat(device);
+		textureCreateInfo.width = width;
+		textureCreateInfo.height = height;
+		textureCreateInfo.layer_count_or_depth = 1;
+		textureCreateInfo.num_levels = 1;
+		textureCreateInfo.sample_count = SDL_GPU_SAMPLECOUNT_1;
+		textureCreateInfo.usage = SDL_GPU_TEXTUREUSAGE_COLOR_TARGET | SDL_GPU_TEXTUREUSAGE_SAMPLER;
+		renderTarget.m_sdlTexture = SDL_CreateGPUTexture(device, &textureCreateInfo);
+		if (!renderTarget.m_sdlTexture) {
+			SDL_LogError(SDL_LOG_CATEGORY_ERROR, "SDL_CreateGPUTexture failed! %s", SDL_GetError());
+			return RENDER_TARGET_ID_NULL;
 		}
+		textureCreateInfo.format = detail::GetDepthStencilFormat(device);
+		textureCreateInfo.usage = SDL_GPU_TEXTUREUSAGE_DEPTH_STENCIL_TARGET;
+		renderTarget.m_sdlDepthTexture = SDL_CreateGPUTexture(device, &textureCreateInfo);
+		if (!renderTarget.m_sdlDepthTexture) {
+			SDL_LogError(SDL_LOG_CATEGORY_ERROR, "SDL_CreateGPUTexture failed! %s", SDL_GetError());
+			SDL_ReleaseGPUTexture(device, renderTarget.m_sdlTexture);
+			return RENDER_TARGET_ID_NULL;
+		}
+	}
+	renderTarget.m_width = width;
+	renderTarget.m_height = height;
+	renderTarget.m_alive = true;
+
+	// Reuse the slot of a destroyed render target if there is one
+	std::size_t index = m_renderTargets.size();
+	if (!m_freeRenderTargets.empty()) {
+		index = m_freeRenderTargets.back();
+		m_freeRenderTargets.pop_back();
 	}
+	else { m_renderTargets.emplace_back(); }
+	m_renderTargets[index] = renderTarget;
+	return RenderTargetID(index + 1);
+}
+
+void SpriteRenderer::DestroyRenderTarget(RenderTargetID renderTargetID) {
+	// Textures are kept alive by SDL until commands already recorded with them have run
+	RenderTarget* renderTarget = GetRenderTarget(renderTargetID);
+	if (!renderTarget || renderTargetID == m_frameTarget) { return; }
+	SDL_GPUDevice* device = Game::GetGPUDevice();
+	SDL_ReleaseGPUTexture(device, renderTarget->m_sdlTexture);
+	SDL_ReleaseGPUTexture(device, renderTarget->m_sdlDepthTexture);
+	*renderTarget = RenderTarget();
+	m_freeRenderTargets.push_back(std::size_t(renderTargetID - 1));
+}
+
+bool SpriteRenderer::ReadRenderTarget(RenderTargetID renderTargetID, RenderTargetReadFunc func) {
+	if (m_nullDevice || !GetRenderTarget(renderTargetID) || !func) { return false; }
+	RenderTargetRead read;
+	read.m_renderTarget = renderTargetID;
+	read.m_func = std::move(func);
+	m_requestedReads.push_back(std::move(read));
+	return true;
+}
+
+RenderTargetID SpriteRenderer::GetFrameTarget() const {
+	return m_frameTarget;
+}
+
+const RenderCounts& SpriteRenderer::GetFrameCounts() const {
+	return m_frameCounts;
+}
+
+const RenderTimings& SpriteRenderer::GetFrameTimings() const {
+	return m_frameTimings;
+}
+
+bool SpriteRenderer::StartCapture(const std::string& filename, std::uint32_t frameCount) {
+	StopCapture();
+	m_captureWriter = new detail::RenderCaptureWriter(filename);
+	if (!m_captureWriter->IsOpen()) {
+		StopCapture();
+		return false;
+	}
+	m_captureFramesLeft = frameCount;
+	return true;
+}
 
-	// Add to draw queue
-	if (primitive.GetAlpha() < 1.f) { m_translucentRenderables.emplace_back(this, m_primitives.size(), RenderableType::PrimitiveType, false); }
-	else { m_opaqueRenderables.emplace_back(this, m_primitives.size(), RenderableType::PrimitiveType, true); }
-	m_primitives.push_back(primitive);
+void SpriteRenderer::StopCapture() {
+	delete m_captureWriter;
+	m_captureWriter = nullptr;
+	m_captureFramesLeft = 0;
+}
+
+bool SpriteRenderer::IsCapturing() const {
+	return m_captureWriter != nullptr;
+}
+
+void SpriteRenderer::Tick(float dt) {
+	for (auto& emitter : m_particleEmitters) {
+		if (emitter) { emitter->Update(dt, m_threadPool); }
+	}
+}
+
+bool SpriteRenderer::WaitForFrame(std::uint64_t timeoutNS) {
+	// Headless frames wait for their slot in Draw instead, so every frame is drawn
+	if (!Game::GetWindow()) { return true; }
+	std::uint32_t frameSlot = std::uint32_t(m_frameIndex % RENDER_FRAMES_IN_FLIGHT);
+	std::uint64_t waitStart = SDL_GetTicksNS();
+	while (!AcquireFrameSlot(frameSlot, false)) {
+		std::uint64_t waited = SDL_GetTicksNS() - waitStart;
+		if (waited >= timeoutNS) { return false; }
+		SDL_DelayNS(std::min(RENDER_FRAME_WAIT_STEP_NS, timeoutNS - waited));
+	}
+	return true;
 }
 
 void SpriteRenderer::PreDraw() {
 	m_sprites.clear();
 	m_primitives.clear();
-	m_opaqueRenderables.clear();
-	m_translucentRenderables.clear();
+	m_renderables.clear();
+	std::lock_guard<std::mutex> lock(m_queueMutex);
+	for (auto& queue : m_queues) {
+		queue->m_sprites.clear();
+		queue->m_primitives.clear();
+		queue->m_renderables.clear();
+	}
+	m_glyphAtlas->BeginFrame();
 }
 
 void SpriteRenderer::Draw() {
@@ -81,98 +432,522 @@ void SpriteRenderer::Draw() {
 		SDL_LogError(SDL_LOG_CATEGORY_ERROR, "SpriteRenderer::Draw failed: Room stack is empty!");
 		return;
 	}
-	if (m_opaqueRenderables.empty() && m_translucentRenderables.empty()) { return; }
-
-	// Stitch together lists from multiple threads
-
-	// Sort opaque & translucent renderables seperately
-	merge_sort(m_opaqueRenderables.begin(), m_opaqueRenderables.end(), CompRenderableSpriteTexturePage());
-	merge_sort(m_opaqueRenderables.begin(), m_opaqueRenderables.end(), CompRenderablePrimitiveWireframe());
-	merge_sort(m_opaqueRenderables.begin(), m_opaqueRenderables.end(), CompRenderableType());
-	merge_sort(m_translucentRenderables.begin(), m_translucentRenderables.end(), CompRenderableSpriteTexturePage());
-	merge_sort(m_translucentRenderables.begin(), m_translucentRenderables.end(), CompRenderablePrimitiveWireframe());
-	merge_sort(m_translucentRenderables.begin(), m_translucentRenderables.end(), CompRenderableType());
-	merge_sort(m_translucentRenderables.begin(), m_translucentRenderables.end(), CompRenderableDepth());
-
-	// Stitch together opaque & translucent renderables
-	RenderableList completeList;
-	completeList.insert(completeList.end(), std::make_move_iterator(m_opaqueRenderables.begin()), std::make_move_iterator(m_opaqueRenderables.end()));
-	completeList.insert(completeList.end(), std::make_move_iterator(m_translucentRenderables.begin()), std::make_move_iterator(m_translucentRenderables.end()));
+	SDL_Window* window = Game::GetWindow();
+	SDL_GPUDevice* device = Game::GetGPUDevice();
+	m_frameCounts = RenderCounts();
+	m_frameTimings = RenderTimings();
+
+	// Make sure the GPU is done with the staging buffers this frame will reuse, and that no more frames than
+	// allowed are in flight. With a window the game has already waited for WaitForFrame, so this never blocks
+	std::uint32_t frameSlot = std::uint32_t(m_frameIndex % RENDER_FRAMES_IN_FLIGHT);
+	auto stageStart = detail::StatsClock::now();
+	AcquireFrameSlot(frameSlot, true);
+	m_frameTimings.fenceWaitMs = detail::ElapsedMs(stageStart);
+	FinishRenderTargetReads();
+	m_spriteDataRing->BeginFrame(m_frameIndex);
+	m_primitiveVertexRing->BeginFrame(m_frameIndex);
+	m_primitiveIndexRing->BeginFrame(m_frameIndex);
+	m_spriteInstanceRing->BeginFrame(m_frameIndex);
+	m_shapeDataRing->BeginFrame(m_frameIndex);
+	m_drawIndexRing->BeginFrame(m_frameIndex);
+
+	// Gather this frame's objects once for every camera, and stage any sprite instances that changed
+	stageStart = detail::StatsClock::now();
+	GatherCameraViews(currentRoom);
+	MergeThreadQueues();
+	if (m_captureWriter) { CaptureFrame(currentRoom); }
+	m_frameTimings.gatherMs = detail::ElapsedMs(stageStart);
+	stageStart = detail::StatsClock::now();
+	CullRenderables();
+	SubmitStaticSprites();
+	m_frameTimings.cullMs = detail::ElapsedMs(stageStart);
+	stageStart = detail::StatsClock::now();
+	SubmitParticleEmitters();
+	if (!UpdateSpriteInstances()) { return; }
+	SubmitSpriteInstances();
+	m_frameTimings.prepareMs = detail::ElapsedMs(stageStart);
+	if (m_renderables.empty() && m_spriteInstanceBatches.empty() && m_spriteInstanceUploads.empty() && m_requestedReads.empty()) { return; }
+
+	// Sort by packed key, putting opaque renderables first, solid sprites ahead of the rest & each batch front to back, and translucent ones after them back to front
+	stageStart = detail::StatsClock::now();
+	radix_sort(m_renderables.begin(), m_renderables.end(), [](const Renderable& renderable) { return renderable.m_sortKey; });
+	m_frameTimings.sortMs = detail::ElapsedMs(stageStart);
 
 	// Split into batches
+	stageStart = detail::StatsClock::now();
 	std::vector<RenderableBatch> batches;
 	RenderableBatch currentBatch;
-	for (std::size_t i = 0; i < completeList.size(); ++i) {
-		Renderable currRendereable = completeList[i];
+	for (std::size_t i = 0; i < m_renderables.size(); ++i) {
+		const Renderable& currRendereable = m_renderables[i];
 		if (!currentBatch.MatchRenderable(currRendereable)) {
 			batches.push_back(std::move(currentBatch));
 			currentBatch = RenderableBatch();
 		}
 		currentBatch.AddRenderable(currRendereable);
 	}
-	batches.push_back(std::move(currentBatch));
-	 
-	// Get GPU resources
-	SDL_Window* window = Game::GetWindow();
-	SDL_GPUDevice* device = Game::GetGPUDevice();
+	if (!currentBatch.m_renderableList.empty()) { batches.push_back(std::move(currentBatch)); }
+
+	// Lay out the whole frame's instance, vertex & index data, remembering where each batch starts
+	m_primitiveArena.Clear();
+	std::uint32_t spriteCount = 0;
+	std::uint32_t shapeCount = 0;
+	std::uint32_t largestPrimitiveBatch = 0;
+	for (auto& batch : batches) {
+		if (batch.m_renderableType == RenderableType::SpriteType) {
+			batch.m_firstElement = spriteCount;
+			batch.m_elementCount = std::uint32_t(batch.m_renderableList.size());
+			spriteCount += batch.m_elementCount;
+		}
+		else if (batch.m_renderableType == RenderableType::PrimitiveType && m_analyticPrimitives) {
+			batch.m_firstElement = shapeCount;
+			batch.m_elementCount = 0;
+			for (auto& renderable : batch.m_renderableList) {
+				batch.m_elementOffsets.push_back(batch.m_elementCount);
+				batch.m_elementCount += GetShapeCount(*renderable.GetPrimitive());
+			}
+			batch.m_elementOffsets.push_back(batch.m_elementCount);
+			shapeCount += batch.m_elementCount;
+		}
+		else if (batch.m_renderableType == RenderableType::PrimitiveType) {
+			// Primitives write straight into the arena, with indices relative to the start of the batch
+			batch.m_firstElement = m_primitiveArena.GetIndexCount();
+			batch.m_vertexOffset = std::int32_t(m_primitiveArena.GetVertexCount());
+			for (auto& renderable : batch.m_renderableList) {
+				batch.m_elementOffsets.push_back(m_primitiveArena.GetIndexCount() - batch.m_firstElement);
+				renderable.GetPrimitive()->WriteGeometry(m_primitiveArena, std::uint32_t(batch.m_vertexOffset));
+			}
+			batch.m_elementCount = m_primitiveArena.GetIndexCount() - batch.m_firstElement;
+			batch.m_elementOffsets.push_back(batch.m_elementCount);
+			largestPrimitiveBatch = std::max(largestPrimitiveBatch, m_primitiveArena.GetVertexCount() - std::uint32_t(batch.m_vertexOffset));
+		}
+	}
+	// Particles go after every sprite, so sprites can still be packed back to back
+	for (auto& batch : batches) {
+		if (batch.m_renderableType != RenderableType::ParticleType) { continue; }
+		batch.m_firstElement = spriteCount;
+		batch.m_elementCount = batch.m_renderableList[0].GetParticleEmitter()->GetParticleCount();
+		spriteCount += batch.m_elementCount;
+	}
+
+	// Split every batch into the part each camera sees. Sprites & shapes are drawn through a list of
+	// indices into the shared data; primitives get their own copy of the visible triangles' indices.
+	// Emitters are seen whole or not at all, so their particles are read in place
+	std::uint32_t drawIndexCount = 0;
+	std::uint32_t primitiveIndexCount = 0;
+	for (std::size_t v = 0; v < m_cameraViews.size(); ++v) {
+		std::uint32_t cameraBit = std::uint32_t(1) << v;
+		for (std::size_t b = 0; b < batches.size(); ++b) {
+			const RenderableBatch& batch = batches[b];
+			if (batch.m_renderableType == RenderableType::ParticleType) {
+				if (batch.m_renderableList[0].m_cameraMask & cameraBit) { m_cameraViews[v].m_batches.push_back({ b, batch.m_firstElement, batch.m_elementCount }); }
+				continue;
+			}
+			bool spriteBatch = (batch.m_renderableType == RenderableType::SpriteType);
+			std::uint32_t count = 0;
+			for (std::size_t k = 0; k < batch.m_renderableList.size(); ++k) {
+				if (!(batch.m_renderableList[k].m_cameraMask & cameraBit)) { continue; }
+				count += (spriteBatch) ? 1 : batch.m_elementOffsets[k + 1] - batch.m_elementOffsets[k];
+			}
+			if (count == 0) { continue; }
+			std::uint32_t& total = (spriteBatch || m_analyticPrimitives) ? drawIndexCount : primitiveIndexCount;
+			m_cameraViews[v].m_batches.push_back({ b, total, count });
+			total += count;
+		}
+	}
+	m_frameTimings.batchMs = detail::ElapsedMs(stageStart);
+
+	// Write the frame's data into the staging buffers
+	stageStart = detail::StatsClock::now();
+	std::uint32_t spriteDataSize = spriteCount * m_spriteDataStride;
+	// Indices are only widened to 32 bits for frames with a batch too big for 16
+	bool wideIndices = (largestPrimitiveBatch > 0x10000);
+	std::uint32_t indexStride = (wideIndices) ? sizeof(std::uint32_t) : sizeof(std::uint16_t);
+	std::uint32_t vertexSize = m_primitiveArena.GetVertexCount() * m_primitiveVertexStride;
+	std::uint32_t indexSize = primitiveIndexCount * indexStride;
+	std::uint32_t shapeDataSize = shapeCount * sizeof(ShapeBatchInfo);
+	std::uint32_t drawIndexSize = drawIndexCount * sizeof(std::uint32_t);
+	std::uint32_t spriteDataOffset = 0, vertexOffset = 0, indexOffset = 0, shapeDataOffset = 0, drawIndexOffset = 0;
+	if (spriteDataSize > 0) {
+		std::uint8_t* dataPtr = m_spriteDataRing->Map(spriteDataSize, m_spriteDataStride, spriteDataOffset);
+		if (!dataPtr) {
+			SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to map GPU transfer buffer: %s", SDL_GetError());
+			m_spriteInstanceLayoutDirty = true;
+			return;
+		}
+		// Pack in parallel chunks; chunks may span batches, which are laid out back to back
+		std::vector<const Renderable*> spriteRenderables;
+		spriteRenderables.reserve(spriteCount);
+		for (auto& batch : batches) {
+			if (batch.m_renderableType != RenderableType::SpriteType) { continue; }
+			for (auto& renderable : batch.m_renderableList) { spriteRenderables.push_back(&renderable); }
+		}
+		m_threadPool.parallel_for(spriteRenderables.size(), SPRITE_BATCH_PACK_GRAIN, [&](std::size_t begin, std::size_t end) {
+			WriteSpriteBatch(dataPtr + begin * m_spriteDataStride, spriteRenderables.data() + begin, end - begin);
+		});
+		for (auto& batch : batches) {
+			if (batch.m_renderableType != RenderableType::ParticleType) { continue; }
+			const ParticleEmitter& emitter = *batch.m_renderableList[0].GetParticleEmitter();
+			std::uint8_t* batchPtr = dataPtr + std::size_t(batch.m_firstElement) * m_spriteDataStride;
+			m_threadPool.parallel_for(batch.m_elementCount, SPRITE_BATCH_PACK_GRAIN, [&](std::size_t begin, std::size_t end) {
+				WriteParticles(batchPtr + begin * m_spriteDataStride, emitter, begin, end);
+			});
+		}
+		m_spriteDataRing->Unmap();
+	}
+	if (vertexSize > 0 && indexSize > 0) {
+		std::uint8_t* vertexDataPtr = m_primitiveVertexRing->Map(vertexSize, m_primitiveVertexStride, vertexOffset);
+		if (!vertexDataPtr) {
+			SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to map GPU transfer buffer: %s", SDL_GetError());
+			m_spriteInstanceLayoutDirty = true;
+			return;
+		}
+		if (m_compactFormats) {
+			VertexPosPackedColor* packedVertexPtr = (VertexPosPackedColor*)vertexDataPtr;
+			const VertexPosColor* vertices = m_primitiveArena.GetVertices();
+			for (std::uint32_t i = 0; i < m_primitiveArena.GetVertexCount(); ++i) { packedVertexPtr[i] = VertexPosPackedColor(vertices[i]); }
+		}
+		else { SDL_memcpy(vertexDataPtr, m_primitiveArena.GetVertices(), vertexSize); }
+		m_primitiveVertexRing->Unmap();
+		std::uint8_t* indexDataPtr = m_primitiveIndexRing->Map(indexSize, indexStride, indexOffset);
+		if (!indexDataPtr) {
+			SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to map GPU transfer buffer: %s", SDL_GetError());
+			m_spriteInstanceLayoutDirty = true;
+			return;
+		}
+		const std::uint32_t* indices = m_primitiveArena.GetIndices();
+		for (std::size_t v = 0; v < m_cameraViews.size(); ++v) {
+			std::uint32_t cameraBit = std::uint32_t(1) << v;
+			for (auto& cameraBatch : m_cameraViews[v].m_batches) {
+				const RenderableBatch& batch = batches[cameraBatch.m_batchIndex];
+				if (batch.m_renderableType != RenderableType::PrimitiveType || m_analyticPrimitives) { continue; }
+				std::uint8_t* batchPtr = indexDataPtr + std::size_t(cameraBatch.m_firstElement) * indexStride;
+				for (std::size_t k = 0; k < batch.m_renderableList.size(); ++k) {
+					if (!(batch.m_renderableList[k].m_cameraMask & cameraBit)) { continue; }
+					const std::uint32_t* first = indices + batch.m_firstElement + batch.m_elementOffsets[k];
+					std::uint32_t count = batch.m_elementOffsets[k + 1] - batch.m_elementOffsets[k];
+					if (wideIndices) { SDL_memcpy(batchPtr, first, count * sizeof(std::uint32_t)); }
+					else {
+						std::uint16_t* narrowIndexPtr = (std::uint16_t*)batchPtr;
+						for (std::uint32_t i = 0; i < count; ++i) { narrowIndexPtr[i] = std::uint16_t(first[i]); }
+					}
+					batchPtr += std::size_t(count) * indexStride;
+				}
+			}
+		}
+		m_primitiveIndexRing->Unmap();
+	}
+	if (shapeDataSize > 0) {
+		ShapeBatchInfo* shapeDataPtr = (ShapeBatchInfo*)m_shapeDataRing->Map(shapeDataSize, sizeof(ShapeBatchInfo), shapeDataOffset);
+		if (!shapeDataPtr) {
+			SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to map GPU transfer buffer: %s", SDL_GetError());
+			m_spriteInstanceLayoutDirty = true;
+			return;
+		}
+		for (auto& batch : batches) {
+			if (batch.m_renderableType != RenderableType::PrimitiveType) { continue; }
+			ShapeBatchInfo* batchPtr = shapeDataPtr + batch.m_firstElement;
+			for (auto& renderable : batch.m_renderableList) {
+				const Primitive& primitive = *renderable.GetPrimitive();
+				WriteShapes(batchPtr, primitive);
+				batchPtr += GetShapeCount(primitive);
+			}
+		}
+		m_shapeDataRing->Unmap();
+	}
+	if (drawIndexSize > 0) {
+		std::uint32_t* drawIndexPtr = (std::uint32_t*)m_drawIndexRing->Map(drawIndexSize, sizeof(std::uint32_t), drawIndexOffset);
+		if (!drawIndexPtr) {
+			SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to map GPU transfer buffer: %s", SDL_GetError());
+			m_spriteInstanceLayoutDirty = true;
+			return;
+		}
+		// Indices point at the data written above, wherever it landed in its buffer
+		std::uint32_t baseSprite = spriteDataOffset / m_spriteDataStride;
+		std::uint32_t baseShape = shapeDataOffset / sizeof(ShapeBatchInfo);
+		for (std::size_t v = 0; v < m_cameraViews.size(); ++v) {
+			std::uint32_t cameraBit = std::uint32_t(1) << v;
+			for (auto& cameraBatch : m_cameraViews[v].m_batches) {
+				const RenderableBatch& batch = batches[cameraBatch.m_batchIndex];
+				bool spriteBatch = (batch.m_renderableType == RenderableType::SpriteType);
+				if (batch.m_renderableType == RenderableType::ParticleType || (!spriteBatch && !m_analyticPrimitives)) { continue; }
+				std::uint32_t* batchPtr = drawIndexPtr + cameraBatch.m_firstElement;
+				std::uint32_t first = ((spriteBatch) ? baseSprite : baseShape) + batch.m_firstElement;
+				for (std::size_t k = 0; k < batch.m_renderableList.size(); ++k) {
+					if (!(batch.m_renderableList[k].m_cameraMask & cameraBit)) { continue; }
+					if (spriteBatch) { *batchPtr++ = first + std::uint32_t(k); }
+					else {
+						for (std::uint32_t e = batch.m_elementOffsets[k]; e < batch.m_elementOffsets[k + 1]; ++e) { *batchPtr++ = first + e; }
+					}
+				}
+			}
+		}
+		m_drawIndexRing->Unmap();
+	}
+	m_frameTimings.packMs = detail::ElapsedMs(stageStart);
+
+	// Render targets are drawn first, so sprites showing them see this frame's contents. The window, or the
+	// frame target when headless, goes last and is drawn even if no camera looks at it, to clear it
+	std::vector<RenderTargetID> passTargets;
+	for (auto& view : m_cameraViews) {
+		if (view.m_renderTarget == m_frameTarget) { continue; }
+		if (std::find(passTargets.begin(), passTargets.end(), view.m_renderTarget) == passTargets.end()) { passTargets.push_back(view.m_renderTarget); }
+	}
+	passTargets.push_back(m_frameTarget);
+
+	// Count the frame's work, one draw per instance batch & camera batch in every view
+	m_frameCounts.renderables = std::uint32_t(m_renderables.size());
+	m_frameCounts.batches = std::uint32_t(batches.size() + m_spriteInstanceBatches.size());
+	m_frameCounts.renderPasses = std::uint32_t(passTargets.size());
+	for (auto& view : m_cameraViews) { m_frameCounts.renderPasses += (view.m_splitPass) ? 1 : 0; }
+	m_frameCounts.uploadBytes = std::uint64_t(spriteDataSize) + vertexSize + indexSize + shapeDataSize + drawIndexSize;
+	for (auto& upload : m_spriteInstanceUploads) { m_frameCounts.uploadBytes += upload.m_size; }
+	for (auto& view : m_cameraViews) { m_frameCounts.drawCalls += std::uint32_t(m_spriteInstanceBatches.size() + view.m_batches.size()); }
+
+	// A texture is bound for every sprite draw, but only a change of texture from the draw before breaks the GPU's caches
+	for (auto passTarget : passTargets) {
+		std::tuple<RenderTargetID, GlyphPageID, TexturePageID> boundTexture = { RENDER_TARGET_ID_NULL, GLYPH_PAGE_ID_NULL, -1 };
+		auto bindTexture = [&](const Sprite& sprite) {
+			std::tuple<RenderTargetID, GlyphPageID, TexturePageID> texture = { sprite.GetRenderTargetID(), sprite.GetGlyphPageID(), sprite.GetTexturePageID() };
+			if (texture != boundTexture) { ++m_frameCounts.texturePageSwitches; }
+			boundTexture = texture;
+		};
+		for (auto& view : m_cameraViews) {
+			if (view.m_renderTarget != passTarget) { continue; }
+			if (view.m_splitPass) { boundTexture = { RENDER_TARGET_ID_NULL, GLYPH_PAGE_ID_NULL, -1 }; }
+			for (auto& batch : m_spriteInstanceBatches) { bindTexture(m_spriteInstances[batch.m_instanceIndex].m_sprite); }
+			for (auto& cameraBatch : view.m_batches) {
+				const RenderableBatch& batch = batches[cameraBatch.m_batchIndex];
+				if (batch.m_renderableType == RenderableType::SpriteType) { bindTexture(*batch.m_renderableList[0].GetSprite()); }
+				else if (batch.m_renderableType == RenderableType::ParticleType) { bindTexture(batch.m_renderableList[0].GetParticleEmitter()->GetSprite()); }
+			}
+		}
+	}
+	if (m_nullDevice) {
+		UploadGlyphPages(nullptr);
+		++m_frameIndex;
+		return;
+	}
+
+	stageStart = detail::StatsClock::now();
 	SDL_GPUCommandBuffer* commandBuffer = SDL_AcquireGPUCommandBuffer(device);
 	if (!commandBuffer) {
 		SDL_LogError(SDL_LOG_CATEGORY_ERROR, "SDL_AcquireGPUCommandBuffer failed! %s", SDL_GetError());
+		m_spriteInstanceLayoutDirty = true;
 		return;
 	}
-	SDL_GPUTexture* swapchainTexture;
-	if (!SDL_WaitAndAcquireGPUSwapchainTexture(commandBuffer, window, &swapchainTexture, nullptr, nullptr)) {
-		SDL_LogError(SDL_LOG_CATEGORY_ERROR, "SDL_WaitAndAcquireGPUSwapchainTexture failed! %s", SDL_GetError());
-		return;
+	UpdateSampler();
+	ReleaseUnusedTexturePages();
+
+	// Upload the frame's data, and any texture pages that are not on the GPU yet, in one copy pass.
+	// This happens even if there is nothing to draw to, since sprite instance edits are only uploaded once
+	std::vector<SDL_GPUTexture*> batchTextures(batches.size(), nullptr);
+	std::vector<SDL_GPUTexture*> instanceBatchTextures(m_spriteInstanceBatches.size(), nullptr);
+	SDL_GPUCopyPass* copyPass = SDL_BeginGPUCopyPass(commandBuffer);
+	m_spriteDataRing->Upload(copyPass, spriteDataOffset, spriteDataSize);
+	m_primitiveVertexRing->Upload(copyPass, vertexOffset, vertexSize);
+	m_primitiveIndexRing->Upload(copyPass, indexOffset, indexSize);
+	m_shapeDataRing->Upload(copyPass, shapeDataOffset, shapeDataSize);
+	m_drawIndexRing->Upload(copyPass, drawIndexOffset, drawIndexSize);
+	for (auto& upload : m_spriteInstanceUploads) {
+		m_spriteInstanceRing->UploadTo(copyPass, upload.m_offset, upload.m_size, m_sdlSpriteInstanceBuffer, upload.m_bufferOffset);
+	}
+	UploadGlyphPages(copyPass);
+	for (std::size_t i = 0; i < batches.size(); ++i) {
+		if (batches[i].m_renderableType == RenderableType::SpriteType) { batchTextures[i] = GetSpriteTexture(copyPass, *batches[i].m_renderableList[0].GetSprite()); }
+		else if (batches[i].m_renderableType == RenderableType::ParticleType) { batchTextures[i] = GetSpriteTexture(copyPass, batches[i].m_renderableList[0].GetParticleEmitter()->GetSprite()); }
+	}
+	for (std::size_t i = 0; i < m_spriteInstanceBatches.size(); ++i) {
+		const Sprite& firstSprite = m_spriteInstances[m_spriteInstanceBatches[i].m_instanceIndex].m_sprite;
+		instanceBatchTextures[i] = GetSpriteTexture(copyPass, firstSprite);
+	}
+	SDL_EndGPUCopyPass(copyPass);
+
+	// Never wait for a swapchain image; without one the frame's uploads & render targets are still drawn, but it is not shown
+	SDL_GPUTexture* swapchainTexture = nullptr;
+	if (window && !SDL_AcquireGPUSwapchainTexture(commandBuffer, window, &swapchainTexture, nullptr, nullptr)) {
+		SDL_LogError(SDL_LOG_CATEGORY_ERROR, "SDL_AcquireGPUSwapchainTexture failed! %s", SDL_GetError());
+		swapchainTexture = nullptr;
 	}
-	if (swapchainTexture) {
+	if (window && !swapchainTexture) { m_frameCounts.framesSkipped = 1; }
+	if (swapchainTexture && !m_sdlGPUDepthTexture) {
 		// Initialize depth texture
-		if (!m_sdlGPUDepthTexture) {
-			SDL_GPUTextureCreateInfo depthTextureCreateInfo = {};
-			depthTextureCreateInfo.type = SDL_GPU_TEXTURETYPE_2D;
-			depthTextureCreateInfo.format = detail::GetDepthStencilFormat(device);
-			depthTextureCreateInfo.width = Game::GetWindowWidth();
-			depthTextureCreateInfo.height = Game::GetWindowHeight();
-			depthTextureCreateInfo.layer_count_or_depth = 1;
-			depthTextureCreateInfo.num_levels = 1;
-			depthTextureCreateInfo.sample_count = SDL_GPU_SAMPLECOUNT_1;
-			depthTextureCreateInfo.usage = SDL_GPU_TEXTUREUSAGE_DEPTH_STENCIL_TARGET;
-			m_sdlGPUDepthTexture = SDL_CreateGPUTexture(Game::GetGPUDevice(), &depthTextureCreateInfo);
+		SDL_GPUTextureCreateInfo depthTextureCreateInfo = {};
+		depthTextureCreateInfo.type = SDL_GPU_TEXTURETYPE_2D;
+		depthTextureCreateInfo.format = detail::GetDepthStencilFormat(device);
+		depthTextureCreateInfo.width = Game::GetWindowWidth();
+		depthTextureCreateInfo.height = Game::GetWindowHeight();
+		depthTextureCreateInfo.layer_count_or_depth = 1;
+		depthTextureCreateInfo.num_levels = 1;
+		depthTextureCreateInfo.sample_count = SDL_GPU_SAMPLECOUNT_1;
+		depthTextureCreateInfo.usage = SDL_GPU_TEXTUREUSAGE_DEPTH_STENCIL_TARGET;
+		m_sdlGPUDepthTexture = SDL_CreateGPUTexture(Game::GetGPUDevice(), &depthTextureCreateInfo);
+	}
+
+	// Each target is drawn in a single render pass, only switching viewports, pipelines & bindings between batches
+	SDL_GPURenderPass* renderPass = nullptr;
+	SDL_GPUTexture* passTexture = nullptr;
+	SDL_GPUGraphicsPipeline* boundPipeline = nullptr;
+	SDL_GPUBuffer* boundSpriteBuffer = nullptr;
+	SDL_GPUBuffer* drawIndexBuffer = m_drawIndexRing->GetBuffer();
+	std::uint32_t baseDrawIndex = drawIndexOffset / sizeof(std::uint32_t);
+	glm::mat4 cameraMatrix = glm::mat4(1.f);
+	auto drawSprites = [&](const Sprite& firstSprite, bool translucent, SDL_GPUBuffer* spriteBuffer, SDL_GPUTexture* texture, std::uint32_t baseSprite, std::uint32_t count, bool indexed) {
+		// Targets cannot be sampled while they are being drawn into
+		if (!texture || texture == passTexture) { return; }
+
+		// Premultiplied pages blend normal & additive sprites in the same pipeline, as do render targets & glyphs
+		bool premultiplied = (
+			firstSprite.GetRenderTargetID() != RENDER_TARGET_ID_NULL ||
+			firstSprite.GetGlyphPageID() != GLYPH_PAGE_ID_NULL ||
+			firstSprite.GetTexturePage()->IsPremultiplied()
+		);
+		SDL_GPUGraphicsPipeline* pipeline = nullptr;
+		if (translucent) { pipeline = (premultiplied) ? m_spriteBatchTranslucentPipeline->GetPipeline() : m_spriteBatchTranslucentStraightPipeline->GetPipeline(); }
+		else if (firstSprite.GetSolid()) { pipeline = m_spriteBatchSolidPipeline->GetPipeline(); }
+		else { pipeline = (premultiplied) ? m_spriteBatchPipeline->GetPipeline() : m_spriteBatchStraightPipeline->GetPipeline(); }
+		if (pipeline != boundPipeline) {
+			SDL_BindGPUGraphicsPipeline(renderPass, pipeline);
+			boundPipeline = pipeline;
+			boundSpriteBuffer = nullptr;
+		}
+		if (spriteBuffer != boundSpriteBuffer) {
+			// Draws that are not indexed never read the index list, but the slot still has to be bound
+			SDL_GPUBuffer* storageBuffers[2] = { spriteBuffer, (drawIndexBuffer) ? drawIndexBuffer : spriteBuffer };
+			SDL_BindGPUVertexStorageBuffers(renderPass, 0, storageBuffers, 2);
+			boundSpriteBuffer = spriteBuffer;
+		}
+		SDL_GPUTextureSamplerBinding renderTextureSamplerBinding = {};
+		renderTextureSamplerBinding.texture = texture;
+		renderTextureSamplerBinding.sampler = m_sdlGPUSampler;
+		SDL_BindGPUFragmentSamplers(renderPass, 0, &renderTextureSamplerBinding, 1);
+		SpriteBatchUniforms uniforms = {};
+		uniforms.viewProjection = cameraMatrix;
+		uniforms.baseSprite = baseSprite;
+		uniforms.indexed = (indexed) ? 1 : 0;
+		SDL_PushGPUVertexUniformData(commandBuffer, 0, &uniforms, sizeof(SpriteBatchUniforms));
+		SDL_DrawGPUPrimitives(renderPass, count * 6, 1, 0, 0);
+	};
+
+	SDL_GPUBufferBinding vertexBufferBinding = {};
+	vertexBufferBinding.buffer = m_primitiveVertexRing->GetBuffer();
+	vertexBufferBinding.offset = vertexOffset;
+	SDL_GPUBufferBinding indexBufferBinding = {};
+	indexBufferBinding.buffer = m_primitiveIndexRing->GetBuffer();
+	indexBufferBinding.offset = indexOffset;
+	auto drawView = [&](const CameraView& view) {
+		SDL_SetGPUViewport(renderPass, &view.m_viewport);
+		SDL_SetGPUScissor(renderPass, &view.m_scissor);
+		cameraMatrix = view.m_camera->ProjectionOrtho();
+
+		// Opaque sprite instances come from their own buffer, and can go first since they are depth tested
+		for (std::size_t i = 0; i < m_spriteInstanceBatches.size(); ++i) {
+			const SpriteInstanceBatch& batch = m_spriteInstanceBatches[i];
+			const Sprite& firstSprite = m_spriteInstances[batch.m_instanceIndex].m_sprite;
+			drawSprites(firstSprite, firstSprite.GetTranslucent(), m_sdlSpriteInstanceBuffer, instanceBatchTextures[i], batch.m_firstElement, batch.m_elementCount, false);
+		}
+
+		for (auto& cameraBatch : view.m_batches) {
+			const RenderableBatch& batch = batches[cameraBatch.m_batchIndex];
+			SDL_assert(!batch.m_renderableList.empty());
+			switch (batch.m_renderableType) {
+			case RenderableType::SpriteType: {
+				std::uint32_t baseSprite = baseDrawIndex + cameraBatch.m_firstElement;
+				drawSprites(*batch.m_renderableList[0].GetSprite(), batch.m_renderableList[0].GetSprite()->GetTranslucent(), m_spriteDataRing->GetBuffer(), batchTextures[cameraBatch.m_batchIndex], baseSprite, cameraBatch.m_elementCount, true);
+			} break;
+			case RenderableType::ParticleType: {
+				// Particles fading out need blending even when the emitter's sprite alone would not
+				std::uint32_t baseSprite = spriteDataOffset / m_spriteDataStride + cameraBatch.m_firstElement;
+				drawSprites(batch.m_renderableList[0].GetParticleEmitter()->GetSprite(), !batch.m_opaque, m_spriteDataRing->GetBuffer(), batchTextures[cameraBatch.m_batchIndex], baseSprite, cameraBatch.m_elementCount, false);
+			} break;
+			case RenderableType::PrimitiveType: {
+				if (m_analyticPrimitives) {
+					// Each shape expands to a quad in the vertex shader
+					auto pipeline = m_shapeBatchPipeline->GetPipeline();
+					if (pipeline != boundPipeline) {
+						SDL_GPUBuffer* storageBuffers[2] = { m_shapeDataRing->GetBuffer(), drawIndexBuffer };
+						SDL_BindGPUGraphicsPipeline(renderPass, pipeline);
+						SDL_BindGPUVertexStorageBuffers(renderPass, 0, storageBuffers, 2);
+						boundPipeline = pipeline;
+						boundSpriteBuffer = nullptr;
+					}
+					ShapeBatchUniforms uniforms = {};
+					uniforms.viewProjection = cameraMatrix;
+					uniforms.baseShape = baseDrawIndex + cameraBatch.m_firstElement;
+					uniforms.pixelSize = view.m_pixelSize;
+					SDL_PushGPUVertexUniformData(commandBuffer, 0, &uniforms, sizeof(ShapeBatchUniforms));
+					SDL_DrawGPUPrimitives(renderPass, cameraBatch.m_elementCount * 6, 1, 0, 0);
+					break;
+				}
+				const Primitive* firstPrimitive = batch.m_renderableList[0].GetPrimitive();
+				auto pipeline = (firstPrimitive->IsWireframe()) ? m_primitiveLineBatchPipeline->GetPipeline() : m_primitiveBatchPipeline->GetPipeline();
+				if (pipeline != boundPipeline) {
+					SDL_BindGPUGraphicsPipeline(renderPass, pipeline);
+					SDL_BindGPUVertexBuffers(renderPass, 0, &vertexBufferBinding, 1);
+					SDL_BindGPUIndexBuffer(renderPass, &indexBufferBinding, (wideIndices) ? SDL_GPU_INDEXELEMENTSIZE_32BIT : SDL_GPU_INDEXELEMENTSIZE_16BIT);
+					boundPipeline = pipeline;
+				}
+				SDL_PushGPUVertexUniformData(commandBuffer, 0, &cameraMatrix, sizeof(glm::mat4));
+				SDL_DrawGPUIndexedPrimitives(renderPass, cameraBatch.m_elementCount, 1, cameraBatch.m_firstElement, batch.m_vertexOffset, 0);
+			} break;
+			default: break;
+			}
 		}
+	};
 
+	for (auto passTarget : passTargets) {
 		// Initialize render targets
-		Camera* currentCamera = currentRoom->GetActiveCamera();
-		auto cameraMatrix = currentCamera->ProjectionOrtho();
+		bool framePass = (passTarget == m_frameTarget);
+		SDL_GPUTexture* depthTexture = m_sdlGPUDepthTexture;
+		passTexture = swapchainTexture;
+		if (passTarget != RENDER_TARGET_ID_NULL) {
+			const RenderTarget* renderTarget = GetRenderTarget(passTarget);
+			passTexture = renderTarget->m_sdlTexture;
+			depthTexture = renderTarget->m_sdlDepthTexture;
+		}
+		if (!passTexture) { continue; }
+		const CameraView* firstView = nullptr;
+		for (auto& view : m_cameraViews) {
+			if (view.m_renderTarget == passTarget) { firstView = &view; break; }
+		}
 		m_sdlRenderColorTargetInfo = {};
-		m_sdlRenderColorTargetInfo.texture = swapchainTexture;
+		m_sdlRenderColorTargetInfo.texture = passTexture;
 		m_sdlRenderColorTargetInfo.cycle = false;
 		m_sdlRenderColorTargetInfo.load_op = SDL_GPU_LOADOP_CLEAR;
 		m_sdlRenderColorTargetInfo.store_op = SDL_GPU_STOREOP_STORE;
-		m_sdlRenderColorTargetInfo.clear_color = ConvertToFColor(currentRoom->GetClearColor());
+		// Other targets start out transparent, so they can be laid over the frame as premultiplied sprites
+		m_sdlRenderColorTargetInfo.clear_color = (framePass) ? ConvertToFColor(currentRoom->GetClearColor()) : SDL_FColor{ 0.f, 0.f, 0.f, 0.f };
 		m_sdlRenderDepthStencilTargetInfo = {};
-		m_sdlRenderDepthStencilTargetInfo.texture = m_sdlGPUDepthTexture;
+		m_sdlRenderDepthStencilTargetInfo.texture = depthTexture;
 		m_sdlRenderDepthStencilTargetInfo.cycle = false;
-		m_sdlRenderDepthStencilTargetInfo.clear_depth = currentCamera->GetNearPlane();
+		m_sdlRenderDepthStencilTargetInfo.clear_depth = (firstView) ? float(firstView->m_camera->GetNearPlane()) : 0.f;
 		m_sdlRenderDepthStencilTargetInfo.clear_stencil = 0;
 		m_sdlRenderDepthStencilTargetInfo.load_op = SDL_GPU_LOADOP_CLEAR;
-		m_sdlRenderDepthStencilTargetInfo.store_op = SDL_GPU_STOREOP_STORE;
+		m_sdlRenderDepthStencilTargetInfo.store_op = SDL_GPU_STOREOP_DONT_CARE;
 		m_sdlRenderDepthStencilTargetInfo.stencil_load_op = SDL_GPU_LOADOP_CLEAR;
 		m_sdlRenderDepthStencilTargetInfo.stencil_store_op = SDL_GPU_STOREOP_DONT_CARE;
-		m_clearTarget = true;
 
-		// Render batches one at a time
-		for (auto& batch : batches) {
-			SDL_assert(!batch.m_renderableList.empty());
-			switch (batch.m_renderableType) {
-			case RenderableType::SpriteType: RenderSpriteListBatch(commandBuffer, &cameraMatrix, batch.m_renderableList); break;
-			case RenderableType::PrimitiveType: 
-				auto primitive = batch.m_renderableList[0].GetPrimitive();
-				RenderPrimitiveListBatch(commandBuffer, &cameraMatrix, batch.m_renderableList, primitive->IsWireframe()); 
-			break;
+		renderPass = SDL_BeginGPURenderPass(commandBuffer, &m_sdlRenderColorTargetInfo, 1, &m_sdlRenderDepthStencilTargetInfo);
+		boundPipeline = nullptr;
+		boundSpriteBuffer = nullptr;
+		for (auto& view : m_cameraViews) {
+			if (view.m_renderTarget != passTarget) { continue; }
+			if (view.m_splitPass) {
+				// Keep what the earlier views drew, but give this view a depth buffer of its own
+				SDL_EndGPURenderPass(renderPass);
+				m_sdlRenderColorTargetInfo.load_op = SDL_GPU_LOADOP_LOAD;
+				m_sdlRenderDepthStencilTargetInfo.clear_depth = float(view.m_camera->GetNearPlane());
+				renderPass = SDL_BeginGPURenderPass(commandBuffer, &m_sdlRenderColorTargetInfo, 1, &m_sdlRenderDepthStencilTargetInfo);
+				boundPipeline = nullptr;
+				boundSpriteBuffer = nullptr;
 			}
+			drawView(view);
 		}
+		SDL_EndGPURenderPass(renderPass);
 	}
-	SDL_SubmitGPUCommandBuffer(commandBuffer);
+	DownloadRenderTargets(commandBuffer);
+	m_sdlFrameFences[frameSlot] = SDL_SubmitGPUCommandBufferAndAcquireFence(commandBuffer);
+	m_frameTimings.submitMs = detail::ElapsedMs(stageStart);
+	++m_frameIndex;
 }
 
 void SpriteRenderer::PostDraw() {}
@@ -181,25 +956,33 @@ SpriteRenderer::Renderable::Renderable() :
 	m_renderer(nullptr),
 	m_renderableType(RenderableType::Unknown),
 	m_renderableIndex(0),
-	m_opaque(false) {}
+	m_opaque(false),
+	m_sortKey(0),
+	m_cameraMask(0) {}
 
-SpriteRenderer::Renderable::Renderable(SpriteRenderer* renderer, std::size_t renderableIndex, RenderableType renderableType, bool opaque) :
+SpriteRenderer::Renderable::Renderable(SpriteRenderer* renderer, std::size_t renderableIndex, RenderableType renderableType, bool opaque, std::uint64_t sortKey) :
 	m_renderer(renderer),
 	m_renderableIndex(renderableIndex),
 	m_renderableType(renderableType),
-	m_opaque(opaque) {}
+	m_opaque(opaque),
+	m_sortKey(sortKey),
+	m_cameraMask(~std::uint32_t(0)) {}
 
 SpriteRenderer::Renderable::Renderable(const Renderable& renderable) :
 	m_renderer(renderable.m_renderer),
 	m_renderableIndex(renderable.m_renderableIndex),
 	m_renderableType(renderable.m_renderableType),
-	m_opaque(renderable.m_opaque) {}
+	m_opaque(renderable.m_opaque),
+	m_sortKey(renderable.m_sortKey),
+	m_cameraMask(renderable.m_cameraMask) {}
 
 SpriteRenderer::Renderable::Renderable(Renderable&& renderable) noexcept :
 	m_renderer(std::move(renderable.m_renderer)),
 	m_renderableIndex(std::move(renderable.m_renderableIndex)),
 	m_renderableType(std::move(renderable.m_renderableType)),
-	m_opaque(std::move(renderable.m_opaque)) {}
+	m_opaque(std::move(renderable.m_opaque)),
+	m_sortKey(std::move(renderable.m_sortKey)),
+	m_cameraMask(std::move(renderable.m_cameraMask)) {}
 
 bool SpriteRenderer::Renderable::IsValid() const {
 	return (m_renderer && m_renderableType != RenderableType::Unknown);
@@ -219,12 +1002,21 @@ Primitive* SpriteRenderer::Renderable::GetPrimitive() const {
 	else return nullptr;
 }
 
+ParticleEmitter* SpriteRenderer::Renderable::GetParticleEmitter() const {
+	if (m_renderableType == RenderableType::ParticleType) {
+		return m_renderer->m_particleEmitters[m_renderableIndex].get();
+	}
+	else return nullptr;
+}
+
 SpriteRenderer::Renderable& SpriteRenderer::Renderable::operator=(const Renderable& other) {
 	if (this == &other) { return *this; }
 	m_renderer = other.m_renderer;
 	m_renderableIndex = other.m_renderableIndex;
 	m_renderableType = other.m_renderableType;
 	m_opaque = other.m_opaque;
+	m_sortKey = other.m_sortKey;
+	m_cameraMask = other.m_cameraMask;
 	return *this;
 }
 
@@ -234,6 +1026,8 @@ SpriteRenderer::Renderable& SpriteRenderer::Renderable::operator=(Renderable&& o
 	m_renderableIndex = std::move(other.m_renderableIndex);
 	m_renderableType = std::move(other.m_renderableType);
 	m_opaque = std::move(other.m_opaque);
+	m_sortKey = std::move(other.m_sortKey);
+	m_cameraMask = std::move(other.m_cameraMask);
 	return *this;
 }
 
@@ -242,53 +1036,59 @@ bool SpriteRenderer::Renderable::operator==(const Renderable& other) const {
 		m_renderer == other.m_renderer &&
 		m_renderableIndex == other.m_renderableIndex &&
 		m_renderableType == other.m_renderableType &&
-		m_opaque == other.m_opaque
+		m_opaque == other.m_opaque &&
+		m_sortKey == other.m_sortKey &&
+		m_cameraMask == other.m_cameraMask
 		);
 }
 
 SpriteRenderer::RenderableBatch::RenderableBatch() :
 	m_renderableType(RenderableType::Unknown),
 	m_renderableList(),
-	m_opaque(false) {
+	m_opaque(false),
+	m_firstElement(0),
+	m_elementCount(0),
+	m_vertexOffset(0),
+	m_elementOffsets() {
 }
 
 SpriteRenderer::RenderableBatch::RenderableBatch(RenderableType type, const RenderableList& renderableList, bool opaque) :
 	m_renderableType(type),
 	m_renderableList(renderableList),
-	m_opaque(opaque) {
+	m_opaque(opaque),
+	m_firstElement(0),
+	m_elementCount(0),
+	m_vertexOffset(0),
+	m_elementOffsets() {
 }
 
 SpriteRenderer::RenderableBatch::RenderableBatch(const RenderableBatch& other) :
 	m_renderableType(other.m_renderableType),
 	m_renderableList(other.m_renderableList),
-	m_opaque(other.m_opaque) {
+	m_opaque(other.m_opaque),
+	m_firstElement(other.m_firstElement),
+	m_elementCount(other.m_elementCount),
+	m_vertexOffset(other.m_vertexOffset),
+	m_elementOffsets(other.m_elementOffsets) {
 }
 
 SpriteRenderer::RenderableBatch::RenderableBatch(RenderableBatch&& other) noexcept :
 	m_renderableType(std::move(other.m_renderableType)),
 	m_renderableList(std::move(other.m_renderableList)),
-	m_opaque(std::move(other.m_opaque)) {
+	m_opaque(std::move(other.m_opaque)),
+	m_firstElement(std::move(other.m_firstElement)),
+	m_elementCount(std::move(other.m_elementCount)),
+	m_vertexOffset(std::move(other.m_vertexOffset)),
+	m_elementOffsets(std::move(other.m_elementOffsets)) {
 }
 
 bool SpriteRenderer::RenderableBatch::MatchRenderable(const Renderable& renderable) const {
 	if (!m_renderableList.empty()) {
-		// Split if its a different transparency
-		if (renderable.m_opaque != m_opaque) { return false; }
-		// Split if its a different type of renderable
-		if (renderable.m_renderableType != m_renderableType) { return false; }
-		else if (renderable.m_renderableType == RenderableType::SpriteType) {
-			// Split if a new texture page needs to be loaded
-			Sprite* matchSprite = renderable.GetSprite();
-			Sprite* thisSprite = m_renderableList[0].GetSprite();
-			if (matchSprite->GetTexturePageID() != thisSprite->GetTexturePageID()) { return false; }
-		}
-		else if (renderable.m_renderableType == RenderableType::PrimitiveType) {
-			// Split if a new shape type needs to be drawn
-			Primitive* matchPrimitive = renderable.GetPrimitive();
-			Primitive* thisPrimitive = m_renderableList[0].GetPrimitive();
-			if (matchPrimitive->IsWireframe() != thisPrimitive->IsWireframe()) { return false; }
-		}
-		else { return false; }
+		// Split if the transparency, type, pipeline or texture page changes
+		if (renderable.m_renderableType == RenderableType::Unknown) { return false; }
+		// Each emitter is drawn on its own, straight from its particles
+		if (renderable.m_renderableType == RenderableType::ParticleType) { return false; }
+		return detail::RenderSortKeyState(renderable.m_sortKey) == detail::RenderSortKeyState(m_renderableList[0].m_sortKey);
 	}
 	return true;
 }
@@ -306,6 +1106,10 @@ SpriteRenderer::RenderableBatch& SpriteRenderer::RenderableBatch::operator=(cons
 	m_renderableType = other.m_renderableType;
 	m_renderableList = other.m_renderableList;
 	m_opaque = other.m_opaque;
+	m_firstElement = other.m_firstElement;
+	m_elementCount = other.m_elementCount;
+	m_vertexOffset = other.m_vertexOffset;
+	m_elementOffsets = other.m_elementOffsets;
 	return *this;
 }
 
@@ -314,6 +1118,10 @@ SpriteRenderer::RenderableBatch& SpriteRenderer::RenderableBatch::operator=(Rend
 	m_renderableType = std::move(other.m_renderableType);
 	m_renderableList = std::move(other.m_renderableList);
 	m_opaque = std::move(other.m_opaque);
+	m_firstElement = std::move(other.m_firstElement);
+	m_elementCount = std::move(other.m_elementCount);
+	m_vertexOffset = std::move(other.m_vertexOffset);
+	m_elementOffsets = std::move(other.m_elementOffsets);
 	return *this;
 }
 
@@ -325,305 +1133,961 @@ bool SpriteRenderer::RenderableBatch::operator==(const RenderableBatch& other) c
 		);
 }
 
-void SpriteRenderer::RenderSpriteListBatch(SDL_GPUCommandBuffer* commandBuffer, glm::mat4* cameraMatrix, const RenderableList& sprites) {
-	SDL_GPUDevice* device = Game::GetGPUDevice();
+SpriteRenderer::DrawQueue& SpriteRenderer::GetThreadQueue() {
+	// Each thread keeps a queue for every renderer it draws with, registered the first time it draws. A queue
+	// expires with its renderer, or once dropped for sitting idle, and the thread then registers a new one
+	struct CachedQueue {
+		std::uint64_t m_rendererSerial;
+		std::weak_ptr<DrawQueue> m_owner;
+		DrawQueue* m_queue;
+	};
+	thread_local std::vector<CachedQueue> cachedQueues;
+	for (auto& cached : cachedQueues) {
+		if (cached.m_rendererSerial == m_rendererSerial && !cached.m_owner.expired()) { return *cached.m_queue; }
+	}
+	cachedQueues.erase(std::remove_if(cachedQueues.begin(), cachedQueues.end(), [](const CachedQueue& cached) {
+		return cached.m_owner.expired();
+	}), cachedQueues.end());
+	std::lock_guard<std::mutex> lock(m_queueMutex);
+	m_queues.push_back(std::make_shared<DrawQueue>());
+	cachedQueues.push_back({ m_rendererSerial, m_queues.back(), m_queues.back().get() });
+	return *m_queues.back();
+}
+
+void SpriteRenderer::MergeThreadQueues() {
+	// Stitch together lists from multiple threads, moving each queue's objects to the end of the frame's lists
+	std::lock_guard<std::mutex> lock(m_queueMutex);
+	for (auto& queue : m_queues) {
+		if (queue->m_renderables.empty()) {
+			++queue->m_idleFrames;
+			continue;
+		}
+		queue->m_idleFrames = 0;
+		std::size_t spriteOffset = m_sprites.size();
+		std::size_t primitiveOffset = m_primitives.size();
+		for (auto& renderable : queue->m_renderables) {
+			renderable.m_renderableIndex += (renderable.m_renderableType == RenderableType::SpriteType) ? spriteOffset : primitiveOffset;
+		}
+		m_renderables.insert(m_renderables.end(), std::make_move_iterator(queue->m_renderables.begin()), std::make_move_iterator(queue->m_renderables.end()));
+		m_sprites.insert(m_sprites.end(), std::make_move_iterator(queue->m_sprites.begin()), std::make_move_iterator(queue->m_sprites.end()));
+		m_primitives.insert(m_primitives.end(), std::make_move_iterator(queue->m_primitives.begin()), std::make_move_iterator(queue->m_primitives.end()));
+		queue->m_renderables.clear();
+		queue->m_sprites.clear();
+		queue->m_primitives.clear();
+	}
+
+	// Drop queues nothing has been drawn into for a while, such as those of threads that have exited
+	m_queues.erase(std::remove_if(m_queues.begin(), m_queues.end(), [](const std::shared_ptr<DrawQueue>& queue) {
+		return queue->m_idleFrames > RENDER_QUEUE_IDLE_FRAMES;
+	}), m_queues.end());
+}
+
+void SpriteRenderer::GatherCameraViews(const Room* room) {
+	// Viewports are clipped to their target, and cameras past the last bit of the camera mask are left out.
+	// Cameras without a target of their own draw into the window, or the frame target when headless
+	std::size_t viewCount = 0;
+	for (std::size_t i = 0; i < room->GetNumCameras() && viewCount < RENDER_MAX_CAMERAS; ++i) {
+		const Camera* camera = room->GetCamera(i);
+		if (!camera->IsEnabled()) { continue; }
+		RenderTargetID renderTargetID = (camera->GetRenderTarget() != RENDER_TARGET_ID_NULL) ? camera->GetRenderTarget() : m_frameTarget;
+		std::uint32_t targetWidth = Game::GetWindowWidth();
+		std::uint32_t targetHeight = Game::GetWindowHeight();
+		if (renderTargetID != RENDER_TARGET_ID_NULL) {
+			const RenderTarget* renderTarget = GetRenderTarget(renderTargetID);
+			if (!renderTarget) { continue; }
+			targetWidth = renderTarget->m_width;
+			targetHeight = renderTarget->m_height;
+		}
+		std::uint32_t x = std::min(camera->GetViewportX(), targetWidth);
+		std::uint32_t y = std::min(camera->GetViewportY(), targetHeight);
+		std::uint32_t width = (camera->GetViewportWidth() > 0) ? std::min(camera->GetViewportWidth(), targetWidth - x) : targetWidth - x;
+		std::uint32_t height = (camera->GetViewportHeight() > 0) ? std::min(camera->GetViewportHeight(), targetHeight - y) : targetHeight - y;
+		if (width == 0 || height == 0) { continue; }
+
+		// Views are reused between frames, so their batch lists keep their storage
+		if (viewCount == m_cameraViews.size()) { m_cameraViews.emplace_back(); }
+		CameraView& view = m_cameraViews[viewCount++];
+		view.m_camera = camera;
+		view.m_renderTarget = renderTargetID;
+		view.m_viewport = { float(x), float(y), float(width), float(height), 0.f, 1.f };
+		view.m_scissor = { int(x), int(y), int(width), int(height) };
+		view.m_pixelSize = float(camera->GetWidth()) / float(width);
+		view.m_batches.clear();
+	}
+	m_cameraViews.resize(viewCount);
+
+	// A target's views share its depth attachment, cleared to the near plane of the view that starts the pass. Views
+	// that would see an earlier view's depth, or need a different clear, start a pass of their own
+	for (std::size_t v = 0; v < viewCount; ++v) {
+		CameraView& view = m_cameraViews[v];
+		view.m_splitPass = false;
+		for (std::size_t u = v; u-- > 0;) {
+			const CameraView& other = m_cameraViews[u];
+			if (other.m_renderTarget != view.m_renderTarget) { continue; }
+			view.m_splitPass = SDL_HasRectIntersection(&view.m_scissor, &other.m_scissor) || other.m_camera->GetNearPlane() != view.m_camera->GetNearPlane();
+			if (view.m_splitPass || other.m_splitPass) { break; }
+		}
+	}
+}
 
-	// Change texture page if needed
-	const Sprite* firstSprite = &m_sprites[sprites[0].m_renderableIndex];
-	if (m_currentTexturePageID != firstSprite->GetTexturePageID()) {
-		m_currentTexturePageID = firstSprite->GetTexturePageID();
-		SetTexturePage(commandBuffer, firstSprite->GetTexturePage());
+void SpriteRenderer::CaptureFrame(const Room* room) {
+	// Sprite instances & static sprites are written out every frame along with the frame's own sprites,
+	// so that any frame can be replayed on its own. Particle emitters are simulated, and are not captured
+	CapturedFrame& frame = m_capturedFrame;
+	frame.Clear();
+	frame.windowWidth = Game::GetWindowWidth();
+	frame.windowHeight = Game::GetWindowHeight();
+	frame.clearColor = room->GetClearColor();
+	for (std::size_t i = 0; i < room->GetNumCameras(); ++i) { frame.cameras.push_back(*room->GetCamera(i)); }
+	for (std::size_t i = 0; i < m_renderTargets.size(); ++i) {
+		RenderTargetID renderTargetID = RenderTargetID(i + 1);
+		const RenderTarget& renderTarget = m_renderTargets[i];
+		if (!renderTarget.m_alive || renderTargetID == m_frameTarget) { continue; }
+		frame.renderTargets.push_back({ renderTargetID, renderTarget.m_width, renderTarget.m_height });
+	}
+
+	// Each texture is written once, named by its resource file so it can be found again in another run
+	std::unordered_map<ResourceID, std::uint32_t> textureIndices;
+	auto captureSprite = [&](const Sprite& sprite, CapturedSpriteKind kind) {
+		// Glyphs only live in this renderer's atlas, so text cannot be replayed
+		if (sprite.GetGlyphPageID() != GLYPH_PAGE_ID_NULL) { return; }
+		CapturedSprite captured;
+		captured.kind = kind;
+		captured.blendMode = sprite.GetBlendMode();
+		captured.renderTarget = sprite.GetRenderTargetID();
+		captured.image = sprite.GetImage();
+		captured.depth = sprite.GetDepth();
+		captured.x = sprite.GetPositionX();
+		captured.y = sprite.GetPositionY();
+		captured.width = sprite.GetWidth();
+		captured.height = sprite.GetHeight();
+		captured.scaleX = sprite.GetScaleX();
+		captured.scaleY = sprite.GetScaleY();
+		captured.rotation = sprite.GetRotation();
+		captured.originX = sprite.GetOriginX();
+		captured.originY = sprite.GetOriginY();
+		captured.blend = sprite.GetBlend();
+		if (captured.renderTarget == RENDER_TARGET_ID_NULL) {
+			ResourceID textureID = sprite.GetTextureID();
+			auto it = textureIndices.find(textureID);
+			if (it == textureIndices.end()) {
+				CapturedTexture texture;
+				texture.textureID = textureID;
+				const ResourceTexture* resourceTexture = ResourceManager::GetTexture(textureID);
+				const ResourceFile* resourceFile = (resourceTexture) ? ResourceManager::GetResourceFile(resourceTexture->GetFileID()) : nullptr;
+				if (resourceFile) {
+					texture.file = resourceFile->GetFilename();
+					texture.name = resourceFile->GetTextureName(textureID);
+				}
+				it = textureIndices.emplace(textureID, std::uint32_t(frame.textures.size())).first;
+				frame.textures.push_back(std::move(texture));
+			}
+			captured.texture = it->second;
+		}
+		frame.sprites.push_back(captured);
+	};
+	for (auto& sprite : m_sprites) { captureSprite(sprite, CapturedSpriteKind::Dynamic); }
+	for (auto& instance : m_spriteInstances) {
+		if (instance.m_alive) { captureSprite(instance.m_sprite, CapturedSpriteKind::Instance); }
+	}
+	for (auto& staticSprite : m_staticSprites) {
+		if (staticSprite.m_alive) { captureSprite(staticSprite.m_sprite, CapturedSpriteKind::Static); }
 	}
+	frame.primitives = m_primitives;
 
-	// Resize transfer buffer if needed
-	std::size_t spriteCount = sprites.size();
-	if (spriteCount != m_lastSpriteBatchCount) {
-		m_lastSpriteBatchCount = spriteCount;
-		SDL_ReleaseGPUTransferBuffer(device, m_sdlSpriteDataTransferBuffer);
-		SDL_ReleaseGPUBuffer(device, m_sdlSpriteDataBuffer);
+	// A capture that cannot be written is given up on, rather than failing every frame
+	bool written = m_captureWriter->WriteFrame(frame);
+	if (!written || (m_captureFramesLeft > 0 && --m_captureFramesLeft == 0)) { StopCapture(); }
+}
 
-		SDL_GPUTransferBufferCreateInfo spriteDataTransferBufferCreateInfo = {};
-		spriteDataTransferBufferCreateInfo.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
-		spriteDataTransferBufferCreateInfo.size = spriteCount * sizeof(SpriteBatchInfo);
-		m_sdlSpriteDataTransferBuffer = SDL_CreateGPUTransferBuffer(device, &spriteDataTransferBufferCreateInfo);
+void SpriteRenderer::CullRenderables() {
+	std::size_t viewCount = m_cameraViews.size();
+	if (viewCount == 0) { m_renderables.clear(); }
+	if (m_renderables.empty()) { return; }
+	CullingBounds& bounds = m_cullingBounds;
+
+	// Sort primitives by the bounds they are tested with
+	bounds.m_circlePrimitives.clear();
+	bounds.m_boxPrimitives.clear();
+	bounds.m_boxLeft.clear();
+	bounds.m_boxTop.clear();
+	bounds.m_boxRight.clear();
+	bounds.m_boxBottom.clear();
+	auto pushBox = [&bounds](std::size_t index, float left, float top, float right, float bottom) {
+		bounds.m_boxPrimitives.push_back(index);
+		bounds.m_boxLeft.push_back(left);
+		bounds.m_boxTop.push_back(top);
+		bounds.m_boxRight.push_back(right);
+		bounds.m_boxBottom.push_back(bottom);
+	};
+
+	// Strokes reach past their points by half their thickness; lines are a pixel thick, plus their anti-aliased edge
+	float pixelPadding = 0.f;
+	for (auto& view : m_cameraViews) { pixelPadding = std::max(pixelPadding, view.m_pixelSize); }
+	for (std::size_t i = 0; i < m_primitives.size(); ++i) {
+		const Primitive& primitive = m_primitives[i];
+		const AnyShape& shape = primitive.GetShape();
+		switch (primitive.GetShapeType()) {
+		case ShapeType::LineType: {
+			const ShapeLine& shapeLine = std::get<ShapeLine>(shape);
+			pushBox(
+				i, std::min(shapeLine.x1, shapeLine.x2) - pixelPadding, std::min(shapeLine.y1, shapeLine.y2) - pixelPadding,
+				std::max(shapeLine.x1, shapeLine.x2) + pixelPadding, std::max(shapeLine.y1, shapeLine.y2) + pixelPadding
+			);
+		} break;
+		case ShapeType::AABBType: {
+			const ShapeAABB& shapeAABB = std::get<ShapeAABB>(shape);
+			pushBox(i, shapeAABB.left, shapeAABB.top, shapeAABB.right, shapeAABB.bottom);
+		} break;
+		case ShapeType::CircleType: bounds.m_circlePrimitives.push_back(i); break;
+		case ShapeType::PolylineType: {
+			// Polylines stick out of their points by up to a miter's length, twice their width, plus their anti-aliased edge
+			ShapeAABB box = std::get<ShapePolyline>(shape).GetShapeAABB();
+			float padding = std::abs(primitive.GetWidth()) * 2.f + pixelPadding;
+			pushBox(i, box.left - padding, box.top - padding, box.right + padding, box.bottom + padding);
+		} break;
+		default: break;
+		}
+	}
 
-		SDL_GPUBufferCreateInfo spriteDataBufferCreateInfo = {};
-		spriteDataBufferCreateInfo.usage = SDL_GPU_BUFFERUSAGE_GRAPHICS_STORAGE_READ;
-		spriteDataBufferCreateInfo.size = spriteCount * sizeof(SpriteBatchInfo);
-		m_sdlSpriteDataBuffer = SDL_CreateGPUBuffer(device, &spriteDataBufferCreateInfo);
+	// Gather the bounding circles once & test them against every camera; sprites are split across the workers
+	std::size_t spriteCount = m_sprites.size();
+	std::size_t circleCount = spriteCount + bounds.m_circlePrimitives.size();
+	std::size_t boxCount = bounds.m_boxPrimitives.size();
+	bounds.m_circleX.resize(circleCount);
+	bounds.m_circleY.resize(circleCount);
+	bounds.m_circleRadius.resize(circleCount);
+	bounds.m_circleVisible.resize(circleCount * viewCount);
+	m_threadPool.parallel_for(spriteCount, SPRITE_CULL_GRAIN, [&](std::size_t begin, std::size_t end) {
+		for (std::size_t i = begin; i < end; ++i) {
+			ShapeCircle circle = m_sprites[i].GetShapeCircle();
+			bounds.m_circleX[i] = circle.x;
+			bounds.m_circleY[i] = circle.y;
+			bounds.m_circleRadius[i] = circle.radius;
+		}
+		for (std::size_t v = 0; v < viewCount; ++v) {
+			CullCircles(
+				bounds.m_circleX.data() + begin, bounds.m_circleY.data() + begin, bounds.m_circleRadius.data() + begin,
+				end - begin, m_cameraViews[v].m_camera->GetBoundingBox(), bounds.m_circleVisible.data() + v * circleCount + begin
+			);
+		}
+	});
+	for (std::size_t i = 0; i < bounds.m_circlePrimitives.size(); ++i) {
+		const ShapeCircle& circle = std::get<ShapeCircle>(m_primitives[bounds.m_circlePrimitives[i]].GetShape());
+		bounds.m_circleX[spriteCount + i] = circle.x;
+		bounds.m_circleY[spriteCount + i] = circle.y;
+		bounds.m_circleRadius[spriteCount + i] = circle.radius;
+	}
+	bounds.m_boxVisible.resize(boxCount * viewCount);
+	for (std::size_t v = 0; v < viewCount; ++v) {
+		const ShapeAABB& view = m_cameraViews[v].m_camera->GetBoundingBox();
+		CullCircles(
+			bounds.m_circleX.data() + spriteCount, bounds.m_circleY.data() + spriteCount, bounds.m_circleRadius.data() + spriteCount,
+			bounds.m_circlePrimitives.size(), view, bounds.m_circleVisible.data() + v * circleCount + spriteCount
+		);
+		CullAABBs(
+			bounds.m_boxLeft.data(), bounds.m_boxTop.data(), bounds.m_boxRight.data(), bounds.m_boxBottom.data(),
+			boxCount, view, bounds.m_boxVisible.data() + v * boxCount
+		);
 	}
 
-	// Build sprite instance buffer
-	SpriteBatchInfo* dataPtr = (SpriteBatchInfo*)SDL_MapGPUTransferBuffer(device, m_sdlSpriteDataTransferBuffer, true);
-	if (!dataPtr) {
-		SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to map GPU transfer buffer: %s", SDL_GetError());
+	// Note which cameras see each renderable, and drop whatever none of them see.
+	// The sprite & primitive lists keep their order, so indices stay valid
+	bounds.m_primitiveMasks.assign(m_primitives.size(), 0);
+	for (std::size_t v = 0; v < viewCount; ++v) {
+		const std::uint8_t* circleVisible = bounds.m_circleVisible.data() + v * circleCount + spriteCount;
+		const std::uint8_t* boxVisible = bounds.m_boxVisible.data() + v * boxCount;
+		for (std::size_t i = 0; i < bounds.m_circlePrimitives.size(); ++i) { bounds.m_primitiveMasks[bounds.m_circlePrimitives[i]] |= std::uint32_t(circleVisible[i]) << v; }
+		for (std::size_t i = 0; i < boxCount; ++i) { bounds.m_primitiveMasks[bounds.m_boxPrimitives[i]] |= std::uint32_t(boxVisible[i]) << v; }
+	}
+	auto isCulled = [&](Renderable& renderable) {
+		switch (renderable.m_renderableType) {
+		case RenderableType::SpriteType: {
+			renderable.m_cameraMask = 0;
+			for (std::size_t v = 0; v < viewCount; ++v) { renderable.m_cameraMask |= std::uint32_t(bounds.m_circleVisible[v * circleCount + renderable.m_renderableIndex]) << v; }
+		} break;
+		case RenderableType::PrimitiveType: renderable.m_cameraMask = bounds.m_primitiveMasks[renderable.m_renderableIndex]; break;
+		default: renderable.m_cameraMask = 0; break;
+		}
+		return renderable.m_cameraMask == 0;
+	};
+	m_renderables.erase(std::remove_if(m_renderables.begin(), m_renderables.end(), isCulled), m_renderables.end());
+}
+
+bool SpriteRenderer::UpdateSpriteInstances() {
+	m_spriteInstanceUploads.clear();
+
+	// Edits that move an instance to another batch need the buffer laid out again
+	for (auto index : m_dirtySpriteInstances) {
+		SpriteInstance& instance = m_spriteInstances[index];
+		if (!instance.m_alive) { continue; }
+		if (!instance.m_sprite.IsValid()) {
+			// Leave it out of the layout, and make sure it is laid out again once it is valid
+			instance.m_sortKey = 0;
+			m_spriteInstanceLayoutDirty = true;
+			continue;
+		}
+		std::uint64_t sortKey = SpriteSortKey(instance.m_sprite);
+		if (detail::RenderSortKeyState(sortKey) != detail::RenderSortKeyState(instance.m_sortKey)) { m_spriteInstanceLayoutDirty = true; }
+		instance.m_sortKey = sortKey;
+	}
+	for (auto index : m_dirtySpriteInstances) { m_spriteInstances[index].m_dirty = false; }
+
+	if (m_spriteInstanceLayoutDirty) {
+		// Sort the opaque instances into batches, giving each its place in the buffer
+		m_spriteInstanceOrder.clear();
+		m_translucentSpriteInstances.clear();
+		for (std::size_t i = 0; i < m_spriteInstances.size(); ++i) {
+			const SpriteInstance& instance = m_spriteInstances[i];
+			if (!instance.m_alive || !instance.m_sprite.IsValid()) { continue; }
+			if (instance.m_sortKey >> 63) { m_translucentSpriteInstances.push_back(i); }
+			else { m_spriteInstanceOrder.push_back(i); }
+		}
+		radix_sort(m_spriteInstanceOrder.begin(), m_spriteInstanceOrder.end(), [this](std::size_t index) { return m_spriteInstances[index].m_sortKey; });
+		m_spriteInstanceBatches.clear();
+		for (std::size_t i = 0; i < m_spriteInstanceOrder.size(); ++i) {
+			SpriteInstance& instance = m_spriteInstances[m_spriteInstanceOrder[i]];
+			instance.m_bufferIndex = std::uint32_t(i);
+			if (m_spriteInstanceBatches.empty() || detail::RenderSortKeyState(m_spriteInstanceBatches.back().m_sortKey) != detail::RenderSortKeyState(instance.m_sortKey)) {
+				m_spriteInstanceBatches.push_back({ instance.m_sortKey, m_spriteInstanceOrder[i], std::uint32_t(i), 0 });
+			}
+			++m_spriteInstanceBatches.back().m_elementCount;
+		}
+
+		// Grow the instance buffer; the old one is released once the GPU is done with it
+		std::uint32_t size = std::uint32_t(m_spriteInstanceOrder.size()) * m_spriteDataStride;
+		if (size > m_spriteInstanceCapacity && m_nullDevice) { m_spriteInstanceCapacity = std::max(size, m_spriteInstanceCapacity * 2); }
+		else if (size > m_spriteInstanceCapacity) {
+			SDL_GPUDevice* device = Game::GetGPUDevice();
+			SDL_ReleaseGPUBuffer(device, m_sdlSpriteInstanceBuffer);
+			m_spriteInstanceCapacity = std::max(size, m_spriteInstanceCapacity * 2);
+			SDL_GPUBufferCreateInfo bufferCreateInfo = {};
+			bufferCreateInfo.usage = SDL_GPU_BUFFERUSAGE_GRAPHICS_STORAGE_READ;
+			bufferCreateInfo.size = m_spriteInstanceCapacity;
+			m_sdlSpriteInstanceBuffer = SDL_CreateGPUBuffer(device, &bufferCreateInfo);
+			if (!m_sdlSpriteInstanceBuffer) {
+				SDL_LogError(SDL_LOG_CATEGORY_ERROR, "SDL_CreateGPUBuffer failed! %s", SDL_GetError());
+				m_spriteInstanceCapacity = 0;
+				m_spriteInstanceBatches.clear();
+				m_dirtySpriteInstances.clear();
+				return false;
+			}
+		}
+
+		// Upload every instance
+		if (size > 0) {
+			std::uint32_t offset = 0;
+			std::uint8_t* dataPtr = m_spriteInstanceRing->Map(size, m_spriteDataStride, offset);
+			if (!dataPtr) {
+				SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to map GPU transfer buffer: %s", SDL_GetError());
+				m_dirtySpriteInstances.clear();
+				return false;
+			}
+			m_threadPool.parallel_for(m_spriteInstanceOrder.size(), SPRITE_BATCH_PACK_GRAIN, [&](std::size_t begin, std::size_t end) {
+				for (std::size_t i = begin; i < end; ++i) { WriteSprite(dataPtr + i * m_spriteDataStride, m_spriteInstances[m_spriteInstanceOrder[i]].m_sprite); }
+			});
+			m_spriteInstanceRing->Unmap();
+			m_spriteInstanceUploads.push_back({ offset, 0, size });
+		}
+		m_spriteInstanceLayoutDirty = false;
+	}
+	else if (!m_dirtySpriteInstances.empty()) {
+		// Only upload the opaque instances that were edited; translucent ones are drawn from the frame's sprites
+		auto isStale = [this](std::size_t index) {
+			const SpriteInstance& instance = m_spriteInstances[index];
+			return !instance.m_alive || (instance.m_sortKey >> 63);
+		};
+		m_dirtySpriteInstances.erase(std::remove_if(m_dirtySpriteInstances.begin(), m_dirtySpriteInstances.end(), isStale), m_dirtySpriteInstances.end());
+		std::sort(m_dirtySpriteInstances.begin(), m_dirtySpriteInstances.end(), [this](std::size_t lhs, std::size_t rhs) {
+			return m_spriteInstances[lhs].m_bufferIndex < m_spriteInstances[rhs].m_bufferIndex;
+		});
+		m_dirtySpriteInstances.erase(std::unique(m_dirtySpriteInstances.begin(), m_dirtySpriteInstances.end()), m_dirtySpriteInstances.end());
+		if (!m_dirtySpriteInstances.empty()) {
+			std::uint32_t offset = 0;
+			std::uint32_t size = std::uint32_t(m_dirtySpriteInstances.size()) * m_spriteDataStride;
+			std::uint8_t* dataPtr = m_spriteInstanceRing->Map(size, m_spriteDataStride, offset);
+			if (!dataPtr) {
+				SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to map GPU transfer buffer: %s", SDL_GetError());
+				m_spriteInstanceLayoutDirty = true;
+				m_dirtySpriteInstances.clear();
+				return false;
+			}
+
+			// Instances next to each other in the buffer share one copy
+			for (std::size_t i = 0; i < m_dirtySpriteInstances.size(); ++i) {
+				const SpriteInstance& instance = m_spriteInstances[m_dirtySpriteInstances[i]];
+				WriteSprite(dataPtr + i * m_spriteDataStride, instance.m_sprite);
+				std::uint32_t bufferOffset = instance.m_bufferIndex * m_spriteDataStride;
+				if (!m_spriteInstanceUploads.empty()) {
+					SpriteInstanceUpload& last = m_spriteInstanceUploads.back();
+					if (last.m_bufferOffset + last.m_size == bufferOffset) {
+						last.m_size += m_spriteDataStride;
+						continue;
+					}
+				}
+				m_spriteInstanceUploads.push_back({ offset + std::uint32_t(i) * m_spriteDataStride, bufferOffset, m_spriteDataStride });
+			}
+			m_spriteInstanceRing->Unmap();
+		}
+	}
+	m_dirtySpriteInstances.clear();
+	return true;
+}
+
+void SpriteRenderer::SubmitSpriteInstances() {
+	// Translucent instances are depth sorted along with everything else drawn this frame, and drawn by every camera
+	if (m_cameraViews.empty()) { return; }
+	for (auto index : m_translucentSpriteInstances) {
+		const SpriteInstance& instance = m_spriteInstances[index];
+		m_renderables.emplace_back(this, m_sprites.size(), RenderableType::SpriteType, false, instance.m_sortKey);
+		m_sprites.push_back(instance.m_sprite);
+	}
+}
+
+void SpriteRenderer::SubmitStaticSprites() {
+	// Only the cells under each camera are visited, and sprites seen by several cameras are submitted once
+	m_staticSpriteMasks.resize(m_staticSprites.size(), 0);
+	m_visibleStaticSprites.clear();
+	for (std::size_t v = 0; v < m_cameraViews.size(); ++v) {
+		const ShapeAABB& view = m_cameraViews[v].m_camera->GetBoundingBox();
+		m_staticSpriteGrid.query(view.left, view.top, view.right, view.bottom, [&](std::uint32_t index) {
+			if (!ShapeIntersects(m_staticSprites[index].m_bounds, view)) { return; }
+			if (m_staticSpriteMasks[index] == 0) { m_visibleStaticSprites.push_back(index); }
+			m_staticSpriteMasks[index] |= std::uint32_t(1) << v;
+		});
+	}
+	for (auto index : m_visibleStaticSprites) {
+		const StaticSprite& staticSprite = m_staticSprites[index];
+		m_renderables.emplace_back(this, m_sprites.size(), RenderableType::SpriteType, !(staticSprite.m_sortKey >> 63), staticSprite.m_sortKey);
+		m_renderables.back().m_cameraMask = m_staticSpriteMasks[index];
+		m_sprites.push_back(staticSprite.m_sprite);
+		m_staticSpriteMasks[index] = 0;
+	}
+}
+
+void SpriteRenderer::SubmitParticleEmitters() {
+	// Emitters are culled as a whole, by the box around their particles grown by the furthest a corner can reach
+	CullingBounds& bounds = m_cullingBounds;
+	bounds.m_emitters.clear();
+	bounds.m_emitterLeft.clear();
+	bounds.m_emitterTop.clear();
+	bounds.m_emitterRight.clear();
+	bounds.m_emitterBottom.clear();
+	for (std::size_t i = 0; i < m_particleEmitters.size(); ++i) {
+		const ParticleEmitter* emitter = m_particleEmitters[i].get();
+		if (!emitter || emitter->GetParticleCount() == 0) { continue; }
+		if (!ResourceManager::GetTexture(emitter->GetSettings().textureID)) { continue; }
+		const Sprite& sprite = emitter->GetSprite();
+		const ParticleEmitterSettings& settings = emitter->GetSettings();
+		float extentX = std::max(std::abs(sprite.GetOriginX()), std::abs(sprite.GetWidth() - sprite.GetOriginX()));
+		float extentY = std::max(std::abs(sprite.GetOriginY()), std::abs(sprite.GetHeight() - sprite.GetOriginY()));
+		float extent = std::sqrt(extentX * extentX + extentY * extentY) * std::max(std::abs(settings.scaleStart), std::abs(settings.scaleEnd));
+		ShapeAABB box = emitter->GetBounds();
+		bounds.m_emitters.push_back(i);
+		bounds.m_emitterLeft.push_back(box.left - extent);
+		bounds.m_emitterTop.push_back(box.top - extent);
+		bounds.m_emitterRight.push_back(box.right + extent);
+		bounds.m_emitterBottom.push_back(box.bottom + extent);
+	}
+	std::size_t emitterCount = bounds.m_emitters.size();
+	if (emitterCount == 0) { return; }
+	bounds.m_emitterVisible.resize(emitterCount * m_cameraViews.size());
+	for (std::size_t v = 0; v < m_cameraViews.size(); ++v) {
+		CullAABBs(
+			bounds.m_emitterLeft.data(), bounds.m_emitterTop.data(), bounds.m_emitterRight.data(), bounds.m_emitterBottom.data(),
+			emitterCount, m_cameraViews[v].m_camera->GetBoundingBox(), bounds.m_emitterVisible.data() + v * emitterCount
+		);
+	}
+	for (std::size_t i = 0; i < emitterCount; ++i) {
+		std::uint32_t cameraMask = 0;
+		for (std::size_t v = 0; v < m_cameraViews.size(); ++v) { cameraMask |= std::uint32_t(bounds.m_emitterVisible[v * emitterCount + i]) << v; }
+		if (cameraMask == 0) { continue; }
+
+		// Sorted like the emitter's sprite, but only opaque if every particle stays opaque as it fades
+		const ParticleEmitter& emitter = *m_particleEmitters[bounds.m_emitters[i]];
+		const Sprite& sprite = emitter.GetSprite();
+		bool opaque = !emitter.GetTranslucent();
+		std::uint32_t pipeline = (sprite.GetTexturePage()->IsPremultiplied()) ? SPRITE_PIPELINE_PREMULTIPLIED : SPRITE_PIPELINE_STRAIGHT;
+		if (opaque && sprite.GetSolid()) { pipeline = SPRITE_PIPELINE_SOLID; }
+		std::uint64_t sortKey = detail::MakeRenderSortKey(opaque, RenderableType::ParticleType, pipeline, sprite.GetTexturePageID(), sprite.GetDepth());
+		m_renderables.emplace_back(this, bounds.m_emitters[i], RenderableType::ParticleType, opaque, sortKey);
+		m_renderables.back().m_cameraMask = cameraMask;
+		m_frameCounts.particles += emitter.GetParticleCount();
+	}
+}
+
+std::uint64_t SpriteRenderer::SpriteSortKey(const Sprite& sprite) {
+	// Sprites showing a render target batch by target, in place of the texture page
+	if (sprite.GetRenderTargetID() != RENDER_TARGET_ID_NULL) {
+		SDL_assert(sprite.GetRenderTargetID() < SPRITE_SORT_GLYPH_PAGE);
+		return detail::MakeRenderSortKey(false, RenderableType::SpriteType, SPRITE_PIPELINE_RENDER_TARGET, TexturePageID(sprite.GetRenderTargetID()), sprite.GetDepth());
+	}
+	if (sprite.GetGlyphPageID() != GLYPH_PAGE_ID_NULL) {
+		return detail::MakeRenderSortKey(false, RenderableType::SpriteType, SPRITE_PIPELINE_RENDER_TARGET, SPRITE_SORT_GLYPH_PAGE | TexturePageID(sprite.GetGlyphPageID()), sprite.GetDepth());
+	}
+	std::uint32_t pipeline = (sprite.GetTexturePage()->IsPremultiplied()) ? SPRITE_PIPELINE_PREMULTIPLIED : SPRITE_PIPELINE_STRAIGHT;
+	if (sprite.GetSolid()) { pipeline = SPRITE_PIPELINE_SOLID; }
+	return detail::MakeRenderSortKey(!sprite.GetTranslucent(), RenderableType::SpriteType, pipeline, sprite.GetTexturePageID(), sprite.GetDepth());
+}
+
+void SpriteRenderer::WriteSprite(std::uint8_t* dataPtr, const Sprite& sprite) const {
+	SpriteTextureCoords spriteTextureCoords = sprite.GetTextureCoords();
+	SDL_FColor spriteColor = ConvertToFColor(sprite.GetBlend());
+	bool additive = (sprite.GetBlendMode() == SpriteBlendMode::Additive);
+	if (m_compactFormats) {
+		// Rotation wraps to a 16 bit fraction of a turn, fine enough to stay within a tenth of a pixel at 1000 pixels out
+		float turns = sprite.GetRotation() / 6.28318530718f;
+		std::uint32_t rotation = std::uint32_t(std::int64_t(std::floor((turns - std::floor(turns)) * 65536.f + 0.5f)) & 0xFFFF);
+		std::uint32_t flags = (additive) ? PACKED_SPRITE_FLAG_ADDITIVE : 0;
+		PackedSpriteBatchInfo& info = *(PackedSpriteBatchInfo*)dataPtr;
+		info.x = sprite.GetPositionX();
+		info.y = sprite.GetPositionY();
+		info.z = -float(sprite.GetDepth());
+		info.rotationFlags = rotation | (flags << 16);
+		info.size = detail::PackHalf2(sprite.GetWidth(), sprite.GetHeight());
+		info.scale = detail::PackHalf2(sprite.GetScaleX(), sprite.GetScaleY());
+		info.origin = detail::PackHalf2(sprite.GetOriginX(), sprite.GetOriginY());
+		info.color = detail::PackUnorm4x8(spriteColor.r, spriteColor.g, spriteColor.b, spriteColor.a);
+		info.texUV = detail::PackUnorm2x16(spriteTextureCoords.textureU, spriteTextureCoords.textureV);
+		info.texWH = detail::PackUnorm2x16(spriteTextureCoords.textureW, spriteTextureCoords.textureH);
 		return;
 	}
-	for(std::size_t i = 0; i < spriteCount; ++i) {
-		const Sprite* sprite = &m_sprites[sprites[i].m_renderableIndex];
-		SpriteTextureCoords spriteTextureCoords = sprite->GetTextureCoords();
-		SDL_FColor spriteColor = ConvertToFColor(sprite->GetBlend());
-		dataPtr[i].x = sprite->GetPositionX();
-		dataPtr[i].y = sprite->GetPositionY();
-		dataPtr[i].z = -float(sprite->GetDepth());
-		dataPtr[i].rotation = sprite->GetRotation();
-		dataPtr[i].w = sprite->GetWidth();
-		dataPtr[i].h = sprite->GetHeight();
-		dataPtr[i].scaleX = sprite->GetScaleX();
-		dataPtr[i].scaleY = sprite->GetScaleY();
-		dataPtr[i].originX = sprite->GetOriginX();
-		dataPtr[i].originY = sprite->GetOriginY();
-		dataPtr[i].texU = spriteTextureCoords.textureU;
-		dataPtr[i].texV = spriteTextureCoords.textureV;
-		dataPtr[i].texW = spriteTextureCoords.textureW;
-		dataPtr[i].texH = spriteTextureCoords.textureH;
-		dataPtr[i].r = spriteColor.r;
-		dataPtr[i].g = spriteColor.g;
-		dataPtr[i].b = spriteColor.b;
-		dataPtr[i].a = spriteColor.a;
-	}
-	SDL_UnmapGPUTransferBuffer(device, m_sdlSpriteDataTransferBuffer);
-
-	// Upload instance data
-	SDL_GPUCopyPass* copyPass = SDL_BeginGPUCopyPass(commandBuffer);
-	SDL_GPUTransferBufferLocation spriteDataTransferBufferLocation = {};
-	spriteDataTransferBufferLocation.transfer_buffer = m_sdlSpriteDataTransferBuffer;
-	spriteDataTransferBufferLocation.offset = 0;
-	SDL_GPUBufferRegion spriteDataBufferRegion = {};
-	spriteDataBufferRegion.buffer = m_sdlSpriteDataBuffer;
-	spriteDataBufferRegion.offset = 0;
-	spriteDataBufferRegion.size = spriteCount * sizeof(SpriteBatchInfo);
-	SDL_UploadToGPUBuffer(copyPass, &spriteDataTransferBufferLocation, &spriteDataBufferRegion, true);
-	SDL_EndGPUCopyPass(copyPass);
+	SpriteBatchInfo& info = *(SpriteBatchInfo*)dataPtr;
+	info.x = sprite.GetPositionX();
+	info.y = sprite.GetPositionY();
+	info.z = -float(sprite.GetDepth());
+	info.rotation = sprite.GetRotation();
+	info.w = sprite.GetWidth();
+	info.h = sprite.GetHeight();
+	info.additive = (additive) ? 1.f : 0.f;
+	info._padding = 0.f;
+	info.scaleX = sprite.GetScaleX();
+	info.scaleY = sprite.GetScaleY();
+	info.originX = sprite.GetOriginX();
+	info.originY = sprite.GetOriginY();
+	info.texU = spriteTextureCoords.textureU;
+	info.texV = spriteTextureCoords.textureV;
+	info.texW = spriteTextureCoords.textureW;
+	info.texH = spriteTextureCoords.textureH;
+	info.r = spriteColor.r;
+	info.g = spriteColor.g;
+	info.b = spriteColor.b;
+	info.a = spriteColor.a;
+}
 
-	// Render sprites
-	if (m_clearTarget) m_clearTarget = false;
-	else {
-		m_sdlRenderColorTargetInfo.load_op = SDL_GPU_LOADOP_LOAD;
-		m_sdlRenderDepthStencilTargetInfo.load_op = SDL_GPU_LOADOP_LOAD;
-	}
-	SDL_GPURenderPass* renderPass = SDL_BeginGPURenderPass(commandBuffer, &m_sdlRenderColorTargetInfo, 1, &m_sdlRenderDepthStencilTargetInfo);
-	SDL_BindGPUGraphicsPipeline(renderPass, m_spriteBatchPipeline->GetPipeline());
-	SDL_BindGPUVertexStorageBuffers(renderPass, 0, &m_sdlSpriteDataBuffer, 1);
-	SDL_GPUTextureSamplerBinding renderTextureSamplerBinding = {};
-	renderTextureSamplerBinding.texture = m_sdlGPUAtlasTexture;
-	renderTextureSamplerBinding.sampler = m_sdlGPUSampler;
-	SDL_BindGPUFragmentSamplers(renderPass, 0, &renderTextureSamplerBinding, 1);
-	SDL_PushGPUVertexUniformData(commandBuffer, 0, &(cameraMatrix[0][0]), sizeof(glm::mat4));
-	SDL_DrawGPUPrimitives(renderPass, spriteCount * 6, 1, 0, 0);
-	SDL_EndGPURenderPass(renderPass);
-}
-
-void SpriteRenderer::SetTexturePage(SDL_GPUCommandBuffer* commandBuffer, const TexturePage* texturePage) {
+void SpriteRenderer::WriteParticles(std::uint8_t* dataPtr, const ParticleEmitter& emitter, std::size_t begin, std::size_t end) const {
+	// Everything but position, rotation, scale & color is shared with the emitter's sprite
+	const Sprite& sprite = emitter.GetSprite();
+	const ParticleEmitterSettings& settings = emitter.GetSettings();
+	SpriteTextureCoords spriteTextureCoords = sprite.GetTextureCoords();
+	SDL_FColor colorStart = ConvertToFColor(settings.colorStart);
+	SDL_FColor colorEnd = ConvertToFColor(settings.colorEnd);
+	bool additive = (sprite.GetBlendMode() == SpriteBlendMode::Additive);
+	float z = -float(sprite.GetDepth());
+	for (std::size_t i = begin; i < end; ++i) {
+		float t = std::min(emitter.m_age[i] * emitter.m_inverseLifetime[i], 1.f);
+		float scale = settings.scaleStart + (settings.scaleEnd - settings.scaleStart) * t;
+		SDL_FColor color = {
+			colorStart.r + (colorEnd.r - colorStart.r) * t,
+			colorStart.g + (colorEnd.g - colorStart.g) * t,
+			colorStart.b + (colorEnd.b - colorStart.b) * t,
+			colorStart.a + (colorEnd.a - colorStart.a) * t
+		};
+		if (m_compactFormats) {
+			float turns = emitter.m_rotation[i] / 6.28318530718f;
+			std::uint32_t rotation = std::uint32_t(std::int64_t(std::floor((turns - std::floor(turns)) * 65536.f + 0.5f)) & 0xFFFF);
+			std::uint32_t flags = (additive) ? PACKED_SPRITE_FLAG_ADDITIVE : 0;
+			PackedSpriteBatchInfo& info = *(PackedSpriteBatchInfo*)dataPtr;
+			info.x = emitter.m_x[i];
+			info.y = emitter.m_y[i];
+			info.z = z;
+			info.rotationFlags = rotation | (flags << 16);
+			info.size = detail::PackHalf2(sprite.GetWidth(), sprite.GetHeight());
+			info.scale = detail::PackHalf2(scale, scale);
+			info.origin = detail::PackHalf2(sprite.GetOriginX(), sprite.GetOriginY());
+			info.color = detail::PackUnorm4x8(color.r, color.g, color.b, color.a);
+			info.texUV = detail::PackUnorm2x16(spriteTextureCoords.textureU, spriteTextureCoords.textureV);
+			info.texWH = detail::PackUnorm2x16(spriteTextureCoords.textureW, spriteTextureCoords.textureH);
+		}
+		else {
+			SpriteBatchInfo& info = *(SpriteBatchInfo*)dataPtr;
+			info.x = emitter.m_x[i];
+			info.y = emitter.m_y[i];
+			info.z = z;
+			info.rotation = emitter.m_rotation[i];
+			info.w = sprite.GetWidth();
+			info.h = sprite.GetHeight();
+			info.additive = (additive) ? 1.f : 0.f;
+			info._padding = 0.f;
+			info.scaleX = scale;
+			info.scaleY = scale;
+			info.originX = sprite.GetOriginX();
+			info.originY = sprite.GetOriginY();
+			info.texU = spriteTextureCoords.textureU;
+			info.texV = spriteTextureCoords.textureV;
+			info.texW = spriteTextureCoords.textureW;
+			info.texH = spriteTextureCoords.textureH;
+			info.r = color.r;
+			info.g = color.g;
+			info.b = color.b;
+			info.a = color.a;
+		}
+		dataPtr += m_spriteDataStride;
+	}
+}
+
+std::uint32_t SpriteRenderer::GetShapeCount(const Primitive& primitive) {
+	switch (primitive.GetShapeType()) {
+	case ShapeType::LineType:
+	case ShapeType::AABBType:
+	case ShapeType::CircleType: return 1;
+	case ShapeType::PolylineType: return std::get<ShapePolyline>(primitive.GetShape()).GetSegmentCount();
+	default: return 0;
+	}
+}
+
+void SpriteRenderer::WriteShapes(ShapeBatchInfo* dataPtr, const Primitive& primitive) {
+	SDL_FColor color = ConvertToFColor(primitive.GetBlend());
+	ShapeBatchInfo info = {};
+	info.z = -float(primitive.GetDepth());
+	info.color = detail::PackUnorm4x8(color.r, color.g, color.b, color.a);
+
+	// Lines & outlines are a pixel wide, matching the line list pipeline
+	const AnyShape& shape = primitive.GetShape();
+	switch (primitive.GetShapeType()) {
+	case ShapeType::LineType: {
+		const ShapeLine& shapeLine = std::get<ShapeLine>(shape);
+		info.geometry[0] = shapeLine.x1;
+		info.geometry[1] = shapeLine.y1;
+		info.geometry[2] = shapeLine.x2;
+		info.geometry[3] = shapeLine.y2;
+		info.type = SHAPE_BATCH_TYPE_LINE;
+		info.thickness = 1.f;
+		dataPtr[0] = info;
+	} break;
+	case ShapeType::AABBType: {
+		const ShapeAABB& shapeAABB = std::get<ShapeAABB>(shape);
+		info.geometry[0] = shapeAABB.left;
+		info.geometry[1] = shapeAABB.top;
+		info.geometry[2] = shapeAABB.right;
+		info.geometry[3] = shapeAABB.bottom;
+		info.type = SHAPE_BATCH_TYPE_AABB;
+		info.thickness = (primitive.GetOutline()) ? 1.f : 0.f;
+		dataPtr[0] = info;
+	} break;
+	case ShapeType::CircleType: {
+		const ShapeCircle& shapeCircle = std::get<ShapeCircle>(shape);
+		info.geometry[0] = shapeCircle.x;
+		info.geometry[1] = shapeCircle.y;
+		info.geometry[2] = shapeCircle.radius;
+		info.type = SHAPE_BATCH_TYPE_CIRCLE;
+		info.thickness = (primitive.GetOutline()) ? 1.f : 0.f;
+		dataPtr[0] = info;
+	} break;
+	case ShapeType::PolylineType: {
+		const ShapePolyline& shapePolyline = std::get<ShapePolyline>(shape);
+		std::uint32_t segmentCount = shapePolyline.GetSegmentCount();
+		std::uint32_t joinEnd = SHAPE_SEGMENT_END_MITER;
+		if (primitive.GetLineJoin() == LineJoin::Bevel) { joinEnd = SHAPE_SEGMENT_END_BEVEL; }
+		else if (primitive.GetLineJoin() == LineJoin::Round) { joinEnd = SHAPE_SEGMENT_END_ROUND; }
+		std::uint32_t capEnd = SHAPE_SEGMENT_END_BUTT;
+		if (primitive.GetLineCap() == LineCap::Square) { capEnd = SHAPE_SEGMENT_END_SQUARE; }
+		else if (primitive.GetLineCap() == LineCap::Round) { capEnd = SHAPE_SEGMENT_END_ROUND; }
+
+		// Closing joins reach the far end of the polyline; past 16 bits they fall back to round, which needs no neighbor
+		std::uint32_t wrap = segmentCount - 1;
+		bool wraps = shapePolyline.closed && segmentCount > 1 && wrap <= 0xFFFF;
+		std::uint32_t wrapEnd = (wraps) ? joinEnd : SHAPE_SEGMENT_END_ROUND;
+		info.thickness = primitive.GetWidth();
+		for (std::uint32_t i = 0; i < segmentCount; ++i) {
+			const VertexPos& p1 = shapePolyline.points[i];
+			const VertexPos& p2 = shapePolyline.points[(i + 1) % shapePolyline.points.size()];
+			std::uint32_t startEnd = (i > 0) ? joinEnd : ((shapePolyline.closed) ? wrapEnd : capEnd);
+			std::uint32_t endEnd = (i + 1 < segmentCount) ? joinEnd : ((shapePolyline.closed) ? wrapEnd : capEnd);
+			bool startWraps = wraps && i == 0;
+			bool endWraps = wraps && i + 1 == segmentCount;
+			info.geometry[0] = p1[0];
+			info.geometry[1] = p1[1];
+			info.geometry[2] = p2[0];
+			info.geometry[3] = p2[1];
+			info.type = SHAPE_BATCH_TYPE_SEGMENT | (startEnd << 8) | (endEnd << 11) |
+				((startWraps) ? (1u << 14) : 0) | ((endWraps) ? (1u << 15) : 0) | ((wraps) ? (wrap << 16) : 0);
+			dataPtr[i] = info;
+		}
+	} break;
+	default: break;
+	}
+}
+
+void SpriteRenderer::WriteSpriteBatch(std::uint8_t* dataPtr, const Renderable* const* sprites, std::size_t count) {
+	for (std::size_t i = 0; i < count; ++i) {
+		WriteSprite(dataPtr + i * m_spriteDataStride, m_sprites[sprites[i]->m_renderableIndex]);
+	}
+}
+
+SDL_GPUTexture* SpriteRenderer::GetTexturePageTexture(SDL_GPUCopyPass* copyPass, TexturePageID texturePageID, const TexturePage* texturePage) {
+	// Pages stay on the GPU until their resource file is unloaded
+	std::uint64_t key = (std::uint64_t(texturePage->GetFileID()) << 32) | std::uint32_t(texturePageID);
+	auto it = m_sdlTexturePages.find(key);
+	if (it != m_sdlTexturePages.end()) { return it->second; }
 	SDL_GPUDevice* device = Game::GetGPUDevice();
+	std::uint32_t levelCount = texturePage->GetMipLevelCount();
 
 	// Create GPU texture
-	if (m_sdlGPUAtlasTexture) { SDL_ReleaseGPUTexture(device, m_sdlGPUAtlasTexture); }
 	SDL_GPUTextureCreateInfo atlasTextureCreateInfo = {};
 	atlasTextureCreateInfo.type = SDL_GPU_TEXTURETYPE_2D;
 	atlasTextureCreateInfo.format = SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM;
 	atlasTextureCreateInfo.width = texturePage->GetWidth();
 	atlasTextureCreateInfo.height = texturePage->GetHeight();
 	atlasTextureCreateInfo.layer_count_or_depth = 1;
-	atlasTextureCreateInfo.num_levels = 1;
+	atlasTextureCreateInfo.num_levels = levelCount;
 	atlasTextureCreateInfo.usage = SDL_GPU_TEXTUREUSAGE_SAMPLER;
-	m_sdlGPUAtlasTexture = SDL_CreateGPUTexture(device, &atlasTextureCreateInfo);
-
-	// Create GPU sampler
-	if (m_sdlGPUSampler) { SDL_ReleaseGPUSampler(device, m_sdlGPUSampler); }
-	SDL_GPUSamplerCreateInfo atlasSamplerCreateInfo = {};
-	atlasSamplerCreateInfo.min_filter = SDL_GPU_FILTER_NEAREST;
-	atlasSamplerCreateInfo.mag_filter = SDL_GPU_FILTER_NEAREST;
-	atlasSamplerCreateInfo.mipmap_mode = SDL_GPU_SAMPLERMIPMAPMODE_NEAREST;
-	atlasSamplerCreateInfo.address_mode_u = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE;
-	atlasSamplerCreateInfo.address_mode_v = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE;
-	atlasSamplerCreateInfo.address_mode_w = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE;
-	m_sdlGPUSampler = SDL_CreateGPUSampler(device, &atlasSamplerCreateInfo);
+	SDL_GPUTexture* texture = SDL_CreateGPUTexture(device, &atlasTextureCreateInfo);
+	if (!texture) {
+		SDL_LogError(SDL_LOG_CATEGORY_ERROR, "SDL_CreateGPUTexture failed! %s", SDL_GetError());
+		return nullptr;
+	}
 
-	// Upload image data to transfer buffer
-	if (m_sdlTextureTransferBuffer) { SDL_ReleaseGPUTransferBuffer(device, m_sdlTextureTransferBuffer); }
-	std::uint32_t bufferSize = texturePage->GetWidth() * texturePage->GetHeight() * 4u;
+	// Upload image data for every mip level to transfer buffer
+	std::uint32_t bufferSize = 0;
+	for (std::uint32_t level = 0; level < levelCount; ++level) {
+		bufferSize += texturePage->GetMipWidth(level) * texturePage->GetMipHeight(level) * 4u;
+	}
 	SDL_GPUTransferBufferCreateInfo textureTransferBufferCreateInfo = {};
 	textureTransferBufferCreateInfo.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
 	textureTransferBufferCreateInfo.size = bufferSize;
-	m_sdlTextureTransferBuffer = SDL_CreateGPUTransferBuffer(device, &textureTransferBufferCreateInfo);
-	std::uint8_t* textureTransferPtr = (std::uint8_t*)SDL_MapGPUTransferBuffer(device, m_sdlTextureTransferBuffer, false);
-	std::uint8_t* data = texturePage->GetData();
-	SDL_memcpy(textureTransferPtr, texturePage->GetData(), bufferSize);
-	SDL_UnmapGPUTransferBuffer(device, m_sdlTextureTransferBuffer);
+	SDL_GPUTransferBuffer* textureTransferBuffer = SDL_CreateGPUTransferBuffer(device, &textureTransferBufferCreateInfo);
+	std::uint8_t* textureTransferPtr = (std::uint8_t*)SDL_MapGPUTransferBuffer(device, textureTransferBuffer, false);
+	if (!textureTransferPtr) {
+		SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to map GPU transfer buffer: %s", SDL_GetError());
+		SDL_ReleaseGPUTransferBuffer(device, textureTransferBuffer);
+		SDL_ReleaseGPUTexture(device, texture);
+		return nullptr;
+	}
+	std::uint32_t levelOffset = 0;
+	for (std::uint32_t level = 0; level < levelCount; ++level) {
+		std::uint32_t levelSize = texturePage->GetMipWidth(level) * texturePage->GetMipHeight(level) * 4u;
+		SDL_memcpy(textureTransferPtr + levelOffset, texturePage->GetMipData(level), levelSize);
+		levelOffset += levelSize;
+	}
+	SDL_UnmapGPUTransferBuffer(device, textureTransferBuffer);
+
+	// Use transfer buffer to copy each level to texture
+	levelOffset = 0;
+	for (std::uint32_t level = 0; level < levelCount; ++level) {
+		SDL_GPUTextureTransferInfo textureTransferInfo = {};
+		textureTransferInfo.transfer_buffer = textureTransferBuffer;
+		textureTransferInfo.offset = levelOffset;
+		SDL_GPUTextureRegion textureRegion = {};
+		textureRegion.texture = texture;
+		textureRegion.mip_level = level;
+		textureRegion.w = texturePage->GetMipWidth(level);
+		textureRegion.h = texturePage->GetMipHeight(level);
+		textureRegion.d = 1;
+		SDL_UploadToGPUTexture(copyPass, &textureTransferInfo, &textureRegion, false);
+		levelOffset += textureRegion.w * textureRegion.h * 4u;
+	}
 
-	// Use transfer buffer to copy data to texture
-	SDL_GPUCopyPass* copyPass = SDL_BeginGPUCopyPass(commandBuffer);
-	SDL_GPUTextureTransferInfo textureTransferInfo = {};
-	textureTransferInfo.transfer_buffer = m_sdlTextureTransferBuffer;
-	textureTransferInfo.offset = 0;
-	SDL_GPUTextureRegion textureRegion = {};
-	textureRegion.texture = m_sdlGPUAtlasTexture;
-	textureRegion.w = texturePage->GetWidth();
-	textureRegion.h = texturePage->GetHeight();
-	textureRegion.d = 1;
-	SDL_UploadToGPUTexture(copyPass, &textureTransferInfo, &textureRegion, false);
-	SDL_EndGPUCopyPass(copyPass);
+	// The transfer buffer is freed once the copy has run
+	SDL_ReleaseGPUTransferBuffer(device, textureTransferBuffer);
+	m_sdlTexturePages[key] = texture;
+	return texture;
 }
 
-void SpriteRenderer::RenderPrimitiveListBatch(SDL_GPUCommandBuffer* commandBuffer, glm::mat4* cameraMatrix, const RenderableList& primitives, bool wireframe) {
-	SDL_GPUDevice* device = Game::GetGPUDevice();
+SDL_GPUTexture* SpriteRenderer::GetSpriteTexture(SDL_GPUCopyPass* copyPass, const Sprite& sprite) {
+	if (sprite.GetRenderTargetID() != RENDER_TARGET_ID_NULL) {
+		const RenderTarget* renderTarget = GetRenderTarget(sprite.GetRenderTargetID());
+		return (renderTarget) ? renderTarget->m_sdlTexture : nullptr;
+	}
+	if (sprite.GetGlyphPageID() != GLYPH_PAGE_ID_NULL) {
+		return (sprite.GetGlyphPageID() <= m_sdlGlyphPages.size()) ? m_sdlGlyphPages[sprite.GetGlyphPageID() - 1] : nullptr;
+	}
+	return GetTexturePageTexture(copyPass, sprite.GetTexturePageID(), sprite.GetTexturePage());
+}
 
-	// Build vertex & instance buffers
-	std::size_t primitiveCount = primitives.size();
-	std::vector<VertexPosColor> vertices;
-	std::vector<std::uint16_t> indices;
-	for (std::size_t i = 0; i < primitiveCount; ++i) {
-		Primitive* primitive = &m_primitives[primitives[i].m_renderableIndex];
-		auto primitiveVertices = primitive->GetVertices();
-		auto primitiveIndices = primitive->GetIndices();
-
-		// Offset indices
-		std::uint16_t offset = vertices.size();
-		for (auto& index : primitiveIndices) {
-			index += offset;
-		}
-
-		// Add to master list
-		vertices.insert(vertices.end(), primitiveVertices.begin(), primitiveVertices.end());
-		indices.insert(indices.end(), primitiveIndices.begin(), primitiveIndices.end());
-	}
-
-	// Resize transfer buffer if needed
-	std::size_t vertexCount = vertices.size();
-	std::size_t indexCount = indices.size();
-	std::size_t vertexSize = vertexCount * sizeof(VertexPosColor);
-	std::size_t indexSize = indexCount * sizeof(std::uint16_t);
-	if (vertexCount != m_lastPrimitiveVertexCount || indexCount != m_lastPrimitiveIndexCount) {
-		m_lastPrimitiveVertexCount = vertexCount;
-		m_lastPrimitiveIndexCount = indexCount;
-
-		SDL_ReleaseGPUTransferBuffer(device, m_sdlPrimitiveDataTransferBuffer);
-		SDL_ReleaseGPUBuffer(device, m_sdlPrimitiveDataVertexBuffer);
-		SDL_ReleaseGPUBuffer(device, m_sdlPrimitiveDataIndexBuffer);
-
-		SDL_GPUTransferBufferCreateInfo primitiveDataTransferBufferCreateInfo = {};
-		primitiveDataTransferBufferCreateInfo.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
-		primitiveDataTransferBufferCreateInfo.size = vertexSize + indexSize;
-		m_sdlPrimitiveDataTransferBuffer = SDL_CreateGPUTransferBuffer(device, &primitiveDataTransferBufferCreateInfo);
-
-		SDL_GPUBufferCreateInfo primitiveDataVertexBufferCreateInfo = {};
-		primitiveDataVertexBufferCreateInfo.usage = SDL_GPU_BUFFERUSAGE_VERTEX;
-		primitiveDataVertexBufferCreateInfo.size = vertexSize;
-		m_sdlPrimitiveDataVertexBuffer = SDL_CreateGPUBuffer(device, &primitiveDataVertexBufferCreateInfo);
-
-		SDL_GPUBufferCreateInfo primitiveDataIndexBufferCreateInfo = {};
-		primitiveDataIndexBufferCreateInfo.usage = SDL_GPU_BUFFERUSAGE_INDEX;
-		primitiveDataIndexBufferCreateInfo.size = indexSize;
-		m_sdlPrimitiveDataIndexBuffer = SDL_CreateGPUBuffer(device, &primitiveDataIndexBufferCreateInfo);
-	}
-
-	// Build vertex buffer
-	/*
-	{
-		std::uint8_t* testBuffer = new std::uint8_t[vertexSize + indexSize];
-		SDL_memcpy(testBuffer, &vertices[0][0], vertexSize);
-		std::uint16_t* indexDataPtr = (std::uint16_t*)&testBuffer[vertexSize];
-		SDL_memcpy(indexDataPtr, &indices[0], indexSize);
-		for (std::size_t v = 0; v < vertexCount; ++v) {
-			VertexPosColor* p = reinterpret_cast<VertexPosColor*>(&testBuffer[v * sizeof(VertexPosColor)]);
-			std::cout << "Vertex " << v << ": " << *p << std::endl;
-		}
-		for (std::size_t i = 0; i < indexCount; ++i) {
-			std::uint16_t* p = reinterpret_cast<std::uint16_t*>(&testBuffer[vertexSize + (i * sizeof(std::uint16_t))]);
-			std::cout << "Index " << i << ": " << *p << std::endl;
-		}
-		std::cout << "---" << std::endl;
-	}
-	*/
-
-	std::uint8_t* vertexDataPtr = (std::uint8_t*)SDL_MapGPUTransferBuffer(device, m_sdlPrimitiveDataTransferBuffer, false);
-	if (!vertexDataPtr) {
-		SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to map GPU transfer buffer: %s", SDL_GetError());
-		return;
+void SpriteRenderer::UploadGlyphPages(SDL_GPUCopyPass* copyPass) {
+	// Only the part of each page written since the last upload is copied, in a transfer buffer of its own
+	SDL_GPUDevice* device = Game::GetGPUDevice();
+	std::uint32_t pageSize = m_glyphAtlas->GetPageSize();
+	for (GlyphPageID page = 1; page <= m_glyphAtlas->GetPageCount(); ++page) {
+		if (!m_nullDevice && m_sdlGlyphPages.size() < page) { m_sdlGlyphPages.resize(page, nullptr); }
+		if (!m_nullDevice && !m_sdlGlyphPages[page - 1]) {
+			SDL_GPUTextureCreateInfo glyphTextureCreateInfo = {};
+			glyphTextureCreateInfo.type = SDL_GPU_TEXTURETYPE_2D;
+			glyphTextureCreateInfo.format = SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM;
+			glyphTextureCreateInfo.width = pageSize;
+			glyphTextureCreateInfo.height = pageSize;
+			glyphTextureCreateInfo.layer_count_or_depth = 1;
+			glyphTextureCreateInfo.num_levels = 1;
+			glyphTextureCreateInfo.usage = SDL_GPU_TEXTUREUSAGE_SAMPLER;
+			m_sdlGlyphPages[page - 1] = SDL_CreateGPUTexture(device, &glyphTextureCreateInfo);
+			if (!m_sdlGlyphPages[page - 1]) {
+				SDL_LogError(SDL_LOG_CATEGORY_ERROR, "SDL_CreateGPUTexture failed! %s", SDL_GetError());
+				continue;
+			}
+		}
+		SDL_Rect rect = {};
+		if (!m_glyphAtlas->TakeDirtyRect(page, rect)) { continue; }
+		std::uint32_t rowSize = std::uint32_t(rect.w) * 4u;
+		m_frameCounts.uploadBytes += std::uint64_t(rowSize) * std::uint32_t(rect.h);
+		if (m_nullDevice) { continue; }
+
+		SDL_GPUTransferBufferCreateInfo glyphTransferBufferCreateInfo = {};
+		glyphTransferBufferCreateInfo.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
+		glyphTransferBufferCreateInfo.size = rowSize * std::uint32_t(rect.h);
+		SDL_GPUTransferBuffer* glyphTransferBuffer = SDL_CreateGPUTransferBuffer(device, &glyphTransferBufferCreateInfo);
+		std::uint8_t* glyphTransferPtr = (glyphTransferBuffer) ? (std::uint8_t*)SDL_MapGPUTransferBuffer(device, glyphTransferBuffer, false) : nullptr;
+		if (!glyphTransferPtr) {
+			SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to map GPU transfer buffer: %s", SDL_GetError());
+			SDL_ReleaseGPUTransferBuffer(device, glyphTransferBuffer);
+			continue;
+		}
+		const std::uint8_t* pixels = m_glyphAtlas->GetPagePixels(page);
+		for (int y = 0; y < rect.h; ++y) {
+			SDL_memcpy(glyphTransferPtr + std::size_t(y) * rowSize, pixels + (std::size_t(rect.y + y) * pageSize + std::size_t(rect.x)) * 4u, rowSize);
+		}
+		SDL_UnmapGPUTransferBuffer(device, glyphTransferBuffer);
+		SDL_GPUTextureTransferInfo textureTransferInfo = {};
+		textureTransferInfo.transfer_buffer = glyphTransferBuffer;
+		textureTransferInfo.pixels_per_row = std::uint32_t(rect.w);
+		textureTransferInfo.rows_per_layer = std::uint32_t(rect.h);
+		SDL_GPUTextureRegion textureRegion = {};
+		textureRegion.texture = m_sdlGlyphPages[page - 1];
+		textureRegion.x = std::uint32_t(rect.x);
+		textureRegion.y = std::uint32_t(rect.y);
+		textureRegion.w = std::uint32_t(rect.w);
+		textureRegion.h = std::uint32_t(rect.h);
+		textureRegion.d = 1;
+		SDL_UploadToGPUTexture(copyPass, &textureTransferInfo, &textureRegion, false);
+		SDL_ReleaseGPUTransferBuffer(device, glyphTransferBuffer);
 	}
-	SDL_memcpy(vertexDataPtr, &vertices[0][0], vertexSize);
-	std::uint16_t* indexDataPtr = (std::uint16_t*)&vertexDataPtr[vertexSize];
-	SDL_memcpy(indexDataPtr, &indices[0], indexSize);
-	SDL_UnmapGPUTransferBuffer(device, m_sdlPrimitiveDataTransferBuffer);
+}
 
-	// Upload vertex data
-	SDL_GPUCopyPass* copyPass = SDL_BeginGPUCopyPass(commandBuffer);
-	SDL_GPUTransferBufferLocation primitiveVertexDataTransferBufferLocation = {};
-	primitiveVertexDataTransferBufferLocation.transfer_buffer = m_sdlPrimitiveDataTransferBuffer;
-	primitiveVertexDataTransferBufferLocation.offset = 0;
-	SDL_GPUBufferRegion primitiveVertexDataBufferRegion = {};
-	primitiveVertexDataBufferRegion.buffer = m_sdlPrimitiveDataVertexBuffer;
-	primitiveVertexDataBufferRegion.offset = 0;
-	primitiveVertexDataBufferRegion.size = vertexSize;
-	SDL_GPUTransferBufferLocation primitiveIndexDataTransferBufferLocation = {};
-	primitiveIndexDataTransferBufferLocation.transfer_buffer = m_sdlPrimitiveDataTransferBuffer;
-	primitiveIndexDataTransferBufferLocation.offset = vertexSize;
-	SDL_GPUBufferRegion primitiveIndexDataBufferRegion = {};
-	primitiveIndexDataBufferRegion.buffer = m_sdlPrimitiveDataIndexBuffer;
-	primitiveIndexDataBufferRegion.offset = 0;
-	primitiveIndexDataBufferRegion.size = indexSize;
-	SDL_UploadToGPUBuffer(copyPass, &primitiveVertexDataTransferBufferLocation, &primitiveVertexDataBufferRegion, false);
-	SDL_UploadToGPUBuffer(copyPass, &primitiveIndexDataTransferBufferLocation, &primitiveIndexDataBufferRegion, false);
-	SDL_EndGPUCopyPass(copyPass);
+SpriteRenderer::RenderTarget* SpriteRenderer::GetRenderTarget(RenderTargetID renderTargetID) {
+	if (renderTargetID == RENDER_TARGET_ID_NULL || renderTargetID > m_renderTargets.size()) { return nullptr; }
+	RenderTarget& renderTarget = m_renderTargets[renderTargetID - 1];
+	return (renderTarget.m_alive) ? &renderTarget : nullptr;
+}
 
-	// Render primitives
-	SDL_GPUBufferBinding vertexBufferBinding = {};
-	vertexBufferBinding.buffer = m_sdlPrimitiveDataVertexBuffer;
-	vertexBufferBinding.offset = 0;
-	SDL_GPUBufferBinding indexBufferBinding = {};
-	indexBufferBinding.buffer = m_sdlPrimitiveDataIndexBuffer;
-	indexBufferBinding.offset = 0;
-	if (m_clearTarget) m_clearTarget = false;
-	else {
-		m_sdlRenderColorTargetInfo.load_op = SDL_GPU_LOADOP_LOAD;
-		m_sdlRenderDepthStencilTargetInfo.load_op = SDL_GPU_LOADOP_LOAD;
+void SpriteRenderer::DownloadRenderTargets(SDL_GPUCommandBuffer* commandBuffer) {
+	if (m_requestedReads.empty()) { return; }
+	SDL_GPUDevice* device = Game::GetGPUDevice();
+	std::uint32_t texelSize = SDL_GPUTextureFormatTexelBlockSize(detail::GetColorTargetFormat(device));
+
+	// Copy each target into a buffer of its own, which is read once the frame's fence has signaled
+	SDL_GPUCopyPass* copyPass = SDL_BeginGPUCopyPass(commandBuffer);
+	for (auto& read : m_requestedReads) {
+		const RenderTarget* renderTarget = GetRenderTarget(read.m_renderTarget);
+		if (!renderTarget) { continue; }
+		SDL_GPUTransferBufferCreateInfo transferBufferCreateInfo = {};
+		transferBufferCreateInfo.usage = SDL_GPU_TRANSFERBUFFERUSAGE_DOWNLOAD;
+		transferBufferCreateInfo.size = renderTarget->m_width * renderTarget->m_height * texelSize;
+		read.m_sdlTransferBuffer = SDL_CreateGPUTransferBuffer(device, &transferBufferCreateInfo);
+		if (!read.m_sdlTransferBuffer) {
+			SDL_LogError(SDL_LOG_CATEGORY_ERROR, "SDL_CreateGPUTransferBuffer failed! %s", SDL_GetError());
+			continue;
+		}
+		SDL_GPUTextureRegion textureRegion = {};
+		textureRegion.texture = renderTarget->m_sdlTexture;
+		textureRegion.w = renderTarget->m_width;
+		textureRegion.h = renderTarget->m_height;
+		textureRegion.d = 1;
+		SDL_GPUTextureTransferInfo textureTransferInfo = {};
+		textureTransferInfo.transfer_buffer = read.m_sdlTransferBuffer;
+		textureTransferInfo.offset = 0;
+		SDL_DownloadFromGPUTexture(copyPass, &textureRegion, &textureTransferInfo);
+		read.m_width = renderTarget->m_width;
+		read.m_height = renderTarget->m_height;
+		read.m_frameIndex = m_frameIndex;
+		m_pendingReads.push_back(std::move(read));
 	}
-	SDL_GPURenderPass* renderPass = SDL_BeginGPURenderPass(commandBuffer, &m_sdlRenderColorTargetInfo, 1, &m_sdlRenderDepthStencilTargetInfo);
-	auto pipeline = (wireframe) ? m_primitiveLineBatchPipeline->GetPipeline() : m_primitiveBatchPipeline->GetPipeline();
-	SDL_BindGPUGraphicsPipeline(renderPass, pipeline);
-	SDL_BindGPUVertexBuffers(renderPass, 0, &vertexBufferBinding, 1);
-	SDL_BindGPUIndexBuffer(renderPass, &indexBufferBinding, SDL_GPU_INDEXELEMENTSIZE_16BIT);
-	SDL_PushGPUVertexUniformData(commandBuffer, 0, &(cameraMatrix[0][0]), sizeof(glm::mat4));
-	SDL_DrawGPUIndexedPrimitives(renderPass, indexCount, 1, 0, 0, 0);
-	SDL_EndGPURenderPass(renderPass);
+	SDL_EndGPUCopyPass(copyPass);
+	m_requestedReads.clear();
 }
 
-bool SpriteRenderer::CompRenderableDepth::operator()(const Renderable& lhs, const Renderable& rhs) {
-	float d1 = 0.f, d2 = 0.f;
-	switch (lhs.m_renderableType) {
-	case RenderableType::SpriteType: d1 = lhs.m_renderer->m_sprites[lhs.m_renderableIndex].GetDepth(); break;
-	case RenderableType::PrimitiveType: d1 = lhs.m_renderer->m_primitives[lhs.m_renderableIndex].GetDepth(); break;
+bool SpriteRenderer::AcquireFrameSlot(std::uint32_t frameSlot, bool wait) {
+	SDL_GPUDevice* device = Game::GetGPUDevice();
+
+	// Retire every frame the GPU has finished. Slots are visited oldest frame first, starting with the one being reused
+	std::uint32_t inFlight = 0;
+	for (std::uint32_t i = 0; i < RENDER_FRAMES_IN_FLIGHT; ++i) {
+		SDL_GPUFence*& fence = m_sdlFrameFences[(frameSlot + i) % RENDER_FRAMES_IN_FLIGHT];
+		if (fence && SDL_QueryGPUFence(device, fence)) {
+			SDL_ReleaseGPUFence(device, fence);
+			fence = nullptr;
+		}
+		if (fence) { ++inFlight; }
 	}
-	switch (rhs.m_renderableType) {
-	case RenderableType::SpriteType: d2 = rhs.m_renderer->m_sprites[rhs.m_renderableIndex].GetDepth(); break;
-	case RenderableType::PrimitiveType: d2 = rhs.m_renderer->m_sprites[rhs.m_renderableIndex].GetDepth(); break;
+
+	// Wait out the oldest frames until the slot is free and there is room for one more frame
+	std::uint32_t maxLatency = Game::GetMaxFrameLatency();
+	for (std::uint32_t i = 0; i < RENDER_FRAMES_IN_FLIGHT && (inFlight >= maxLatency || m_sdlFrameFences[frameSlot]); ++i) {
+		SDL_GPUFence*& fence = m_sdlFrameFences[(frameSlot + i) % RENDER_FRAMES_IN_FLIGHT];
+		if (!fence) { continue; }
+		if (!wait) { return false; }
+		SDL_WaitForGPUFences(device, true, &fence, 1);
+		SDL_ReleaseGPUFence(device, fence);
+		fence = nullptr;
+		--inFlight;
 	}
-	return d1 < d2;
+	return true;
 }
 
-bool SpriteRenderer::CompRenderableType::operator()(const Renderable& lhs, const Renderable& rhs) {
-	return lhs.m_renderableType < rhs.m_renderableType;
+void SpriteRenderer::FinishRenderTargetReads() {
+	// Reads finish in the order they were recorded, so stop at the first frame the GPU is still working on.
+	// Frames older than the frames in flight have already been waited on
+	SDL_GPUDevice* device = Game::GetGPUDevice();
+	std::size_t finished = 0;
+	for (; finished < m_pendingReads.size(); ++finished) {
+		RenderTargetRead& read = m_pendingReads[finished];
+		SDL_GPUFence* fence = (m_frameIndex - read.m_frameIndex < RENDER_FRAMES_IN_FLIGHT) ? m_sdlFrameFences[read.m_frameIndex % RENDER_FRAMES_IN_FLIGHT] : nullptr;
+		if (fence && !SDL_QueryGPUFence(device, fence)) { break; }
+		const std::uint8_t* pixels = (const std::uint8_t*)SDL_MapGPUTransferBuffer(device, read.m_sdlTransferBuffer, false);
+		if (pixels) {
+			read.m_func(pixels, read.m_width, read.m_height);
+			SDL_UnmapGPUTransferBuffer(device, read.m_sdlTransferBuffer);
+		}
+		else { SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to map GPU transfer buffer: %s", SDL_GetError()); }
+		SDL_ReleaseGPUTransferBuffer(device, read.m_sdlTransferBuffer);
+	}
+	m_pendingReads.erase(m_pendingReads.begin(), m_pendingReads.begin() + finished);
 }
 
-bool SpriteRenderer::CompRenderableSpriteTexturePage::operator()(const Renderable& lhs, const Renderable& rhs) {
-	TexturePageID t1 = TEXTURE_PAGE_ID_NULL, t2 = TEXTURE_PAGE_ID_NULL;
-	if (lhs.m_renderableType == RenderableType::SpriteType) { t1 = lhs.m_renderer->m_sprites[lhs.m_renderableIndex].GetTexturePageID(); }
-	else { return false; }
-	if (rhs.m_renderableType == RenderableType::SpriteType) { t2 = lhs.m_renderer->m_sprites[lhs.m_renderableIndex].GetTexturePageID(); }
-	else { return true; }
-	return t1 < t2;
+void SpriteRenderer::ReleaseUnusedTexturePages() {
+	SDL_GPUDevice* device = Game::GetGPUDevice();
+	for (auto it = m_sdlTexturePages.begin(); it != m_sdlTexturePages.end();) {
+		ResourceID resourceFileID = ResourceID(it->first >> 32);
+		if (!ResourceManager::GetResourceFile(resourceFileID)) {
+			SDL_ReleaseGPUTexture(device, it->second);
+			it = m_sdlTexturePages.erase(it);
+		}
+		else { ++it; }
+	}
 }
 
-bool SpriteRenderer::CompRenderablePrimitiveWireframe::operator()(const Renderable& lhs, const Renderable& rhs) {
-	bool t1, t2;
-	if (lhs.m_renderableType == RenderableType::PrimitiveType) { t1 = lhs.m_renderer->m_primitives[lhs.m_renderableIndex].IsWireframe(); }
-	else { return false; }
-	if (rhs.m_renderableType == RenderableType::PrimitiveType) { t2 = lhs.m_renderer->m_primitives[lhs.m_renderableIndex].IsWireframe(); }
-	else { return true; }
-	return t1 < t2;
+void SpriteRenderer::UpdateSampler() {
+	bool trilinear = Game::GetTrilinearFilteringEnabled();
+	if (m_sdlGPUSampler && trilinear == m_samplerTrilinear) { return; }
+	SDL_GPUDevice* device = Game::GetGPUDevice();
+
+	// Create GPU sampler, clamping to however many mip levels each page has
+	if (m_sdlGPUSampler) { SDL_ReleaseGPUSampler(device, m_sdlGPUSampler); }
+	SDL_GPUSamplerCreateInfo atlasSamplerCreateInfo = {};
+	atlasSamplerCreateInfo.min_filter = (trilinear) ? SDL_GPU_FILTER_LINEAR : SDL_GPU_FILTER_NEAREST;
+	atlasSamplerCreateInfo.mag_filter = (trilinear) ? SDL_GPU_FILTER_LINEAR : SDL_GPU_FILTER_NEAREST;
+	atlasSamplerCreateInfo.mipmap_mode = (trilinear) ? SDL_GPU_SAMPLERMIPMAPMODE_LINEAR : SDL_GPU_SAMPLERMIPMAPMODE_NEAREST;
+	atlasSamplerCreateInfo.address_mode_u = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE;
+	atlasSamplerCreateInfo.address_mode_v = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE;
+	atlasSamplerCreateInfo.address_mode_w = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE;
+	atlasSamplerCreateInfo.min_lod = 0.f;
+	atlasSamplerCreateInfo.max_lod = 1000.f;
+	m_sdlGPUSampler = SDL_CreateGPUSampler(device, &atlasSamplerCreateInfo);
+	m_samplerTrilinear = trilinear;
 }
 
+NullRenderer::NullRenderer() :
+	SpriteRenderer(true) {}
+
 namespace detail {
 
 SDL_GPUTextureFormat GetDepthStencilFormat(SDL_GPUDevice* device) {
@@ -648,6 +2112,11 @@ SDL_GPUTextureFormat GetDepthStencilFormat(SDL_GPUDevice* device) {
 	return format;
 }
 
+SDL_GPUTextureFormat GetColorTargetFormat(SDL_GPUDevice* device) {
+	SDL_Window* window = Game::GetWindow();
+	return (window) ? SDL_GetGPUSwapchainTextureFormat(device, window) : SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM;
+}
+
 } // detail
 
 } // luna
\ No newline at end of file
@@ -2,7 +2,21 @@
 
 namespace luna {
 
-static Buffer ProcessAssetBlock(const Buffer& block) {
+/// <summary>
+/// Compare a stored checksum against the calculated one.
+/// Fuzzing builds accept any checksum so that mutated inputs reach the rest of the parser.
+/// </summary>
+#if defined(FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION)
+static bool CrcMatches(std::uint32_t, std::uint32_t) {
+	return true;
+}
+#else
+static bool CrcMatches(std::uint32_t expected, std::uint32_t actual) {
+	return expected == actual;
+}
+#endif
+
+static Buffer ProcessAssetBlock(const Buffer& block, ResourceFileLoadStats& stats) {
 	// Get header data
 	std::uint32_t headerCRC = block.get_uint32(4);
 	std::string headerName = block.get_string(16, 32);
@@ -10,8 +24,16 @@ static Buffer ProcessAssetBlock(const Buffer& block) {
 	std::uint64_t headerCompressedSize = block.get_uint64(72);
 
 	// Decompress data
+	if (headerUncompressedSize > SDL_MAX_SINT32 || headerCompressedSize > SDL_MAX_SINT32) {
+		std::stringstream msg;
+		msg << "Asset is too large (" << headerName << ")";
+		throw std::exception(msg.str().c_str());
+	}
 	Buffer assetData = block.get_chunk(80, headerCompressedSize);
+	stats.compressedBytes += headerCompressedSize;
+	stats.uncompressedBytes += headerUncompressedSize;
 	if (headerUncompressedSize != headerCompressedSize) {
+		std::uint64_t decompressStart = SDL_GetTicksNS();
 		Buffer uncompressedAssetData(headerUncompressedSize, 0);
 		if (LZ4_decompress_safe((char*)assetData.data(), (char*)uncompressedAssetData.data(), (int)headerCompressedSize, (int)headerUncompressedSize) != headerUncompressedSize) {
 			std::stringstream msg;
@@ -20,11 +42,14 @@ static Buffer ProcessAssetBlock(const Buffer& block) {
 		}
 		using detail::swap;
 		swap(assetData, uncompressedAssetData);
+		stats.decompressNS += SDL_GetTicksNS() - decompressStart;
 	}
 
 	// Verify CRC
-	std::uint32_t dataCRC = Crc32Calculate(assetData.data(), headerUncompressedSize);
-	if (headerCRC != dataCRC) {
+	std::uint64_t crcStart = SDL_GetTicksNS();
+	std::uint32_t dataCRC = Crc32Calculate(assetData.data(), assetData.size());
+	stats.crcNS += SDL_GetTicksNS() - crcStart;
+	if (!CrcMatches(headerCRC, dataCRC)) {
 		std::stringstream msg;
 		msg << "Failed to decode asset (" << headerName << ")";
 		throw std::exception(msg.str().c_str());
@@ -60,7 +85,7 @@ void ResourceTexture::Load(ResourceFile* file, const Buffer& block) {
 	try {
 		// Validate
 		if (!file) { throw std::exception("Invalid resource file reference"); }
-		Buffer assetData = ProcessAssetBlock(block);
+		Buffer assetData = ProcessAssetBlock(block, file->m_loadStats);
 
 		// Validate texture page
 		m_resourceFileID = file->GetID();
@@ -88,10 +113,30 @@ void ResourceTexture::Load(ResourceFile* file, const Buffer& block) {
 		m_originY = assetData.get_int32(52);
 		m_properties = assetData.get_uint8(56);
 
+		// Validate layout
+		if (std::uint64_t(m_texturePageXOffset) + m_texturePageWidth > m_texturePage->GetWidth() ||
+			std::uint64_t(m_texturePageYOffset) + m_texturePageHeight > m_texturePage->GetHeight()) {
+			throw std::exception("Texture is outside of its texture page");
+		}
+		if (m_animationFrameCount == 0 || m_animationFramesPerRow == 0 ||
+			m_animationXOffset > m_texturePageWidth || m_animationYOffset > m_texturePageHeight) {
+			throw std::exception("Invalid animation layout");
+		}
+
 		// Calculate size
 		std::uint32_t cols = (std::uint32_t)std::ceilf((float)m_animationFrameCount / m_animationFramesPerRow);
 		m_frameWidth = ((m_texturePageWidth - m_animationXOffset) / cols) - m_animationXSpacing;
 		m_frameHeight = ((m_texturePageHeight - m_animationYOffset) / m_animationFramesPerRow) - m_animationYSpacing;
+
+		if (((m_texturePageWidth - m_animationXOffset) / cols) < m_animationXSpacing ||
+			((m_texturePageHeight - m_animationYOffset) / m_animationFramesPerRow) < m_animationYSpacing) {
+			throw std::exception("Invalid animation layout");
+		}
+
+		// Build collision masks
+		std::uint64_t processStart = SDL_GetTicksNS();
+		GenerateCollisionMasks();
+		file->m_loadStats.processNS += SDL_GetTicksNS() - processStart;
 	}
 	catch (std::exception& e) {
 		m_errorMessage = e.what();
@@ -99,6 +144,41 @@ void ResourceTexture::Load(ResourceFile* file, const Buffer& block) {
 	}
 }
 
+void ResourceTexture::GenerateCollisionMasks() {
+	m_collisionMasks.clear();
+	m_solid = false;
+	if (!m_texturePage || m_frameWidth == 0 || m_frameHeight == 0) { return; }
+	std::uint32_t pageWidth = m_texturePage->GetWidth();
+	std::uint32_t pageHeight = m_texturePage->GetHeight();
+	const std::uint8_t* pageData = m_texturePage->GetData();
+	const SDL_PixelFormatDetails* formatDetails = SDL_GetPixelFormatDetails(m_texturePage->GetFormat());
+	bool directAlpha = (pageData && formatDetails && formatDetails->bytes_per_pixel == 4 && formatDetails->Abits == 8);
+	std::uint32_t alphaIndex = (directAlpha) ? (formatDetails->Ashift / 8) : 0;
+
+	m_collisionMasks.reserve(m_animationFrameCount);
+	m_solid = true;
+	for (std::uint32_t i = 0; i < m_animationFrameCount; ++i) {
+		CollisionMask mask(m_frameWidth, m_frameHeight);
+		std::uint32_t offsetX = GetOffsetX(std::int32_t(i));
+		std::uint32_t offsetY = GetOffsetY(std::int32_t(i));
+		if (offsetX + m_frameWidth > pageWidth || offsetY + m_frameHeight > pageHeight) { m_solid = false; }
+		for (std::uint32_t y = 0; y < m_frameHeight && (offsetY + y) < pageHeight; ++y) {
+			for (std::uint32_t x = 0; x < m_frameWidth && (offsetX + x) < pageWidth; ++x) {
+				std::uint8_t alpha = 0;
+				if (directAlpha) { alpha = pageData[((std::size_t(offsetY + y) * pageWidth) + (offsetX + x)) * 4 + alphaIndex]; }
+				else { alpha = m_texturePage->GetPixel(offsetX + x, offsetY + y).a; }
+				if (alpha > 0) { mask.SetBit(x, y, true); }
+				if (alpha < 255) { m_solid = false; }
+			}
+		}
+		m_collisionMasks.push_back(std::move(mask));
+	}
+}
+
+bool ResourceTexture::IsSolid() const {
+	return m_solid;
+}
+
 bool ResourceTexture::IsValid() const {
 	return m_texturePage != nullptr;
 }
@@ -151,12 +231,118 @@ std::uint8_t ResourceTexture::GetProperties() const {
 	return m_properties;
 }
 
-bool ResourceSound::IsValid() const {
-	return false;
+const CollisionMask* ResourceTexture::GetCollisionMask(std::int32_t animationFrame) const {
+	if (m_collisionMasks.empty()) { return nullptr; }
+	std::uint32_t i = (animationFrame < 0) ? 0 : ((std::uint32_t)animationFrame % m_animationFrameCount);
+	return (i < m_collisionMasks.size()) ? &m_collisionMasks[i] : nullptr;
 }
 
 void ResourceSound::Load(ResourceFile* file, const Buffer& block) {
+	m_errorMessage.clear();
+	m_spec = {};
+	m_chunks.clear();
+
+	try {
+		// Validate
+		if (!file) { throw std::exception("Invalid resource file reference"); }
+		Buffer assetData = ProcessAssetBlock(block, file->m_loadStats);
+		m_resourceFileID = file->GetID();
+
+		// Get format
+		SDL_AudioSpec spec = {};
+		spec.format = SDL_AudioFormat(assetData.get_uint32(0));
+		spec.channels = int(assetData.get_uint32(4));
+		spec.freq = int(assetData.get_uint32(8));
+		std::uint32_t flags = assetData.get_uint32(12);
+		std::uint64_t size = assetData.get_uint64(16);
+		std::uint32_t chunkCount = assetData.get_uint32(24);
+		std::uint32_t frameSize = SDL_AUDIO_FRAMESIZE(spec);
+		if (frameSize == 0 || spec.channels <= 0 || spec.channels > 8 || spec.freq <= 0) {
+			throw std::exception("Unsupported audio format");
+		}
+
+		// Read chunk table, checking the count against the asset before trusting it with an allocation
+		if (32 + std::uint64_t(chunkCount) * 16 > assetData.size()) { throw std::exception("Invalid audio chunk table"); }
+		std::uint64_t total = 0;
+		m_chunks.reserve(chunkCount);
+		for (std::uint32_t i = 0; i < chunkCount; ++i) {
+			Chunk chunk = {};
+			chunk.offset = assetData.get_uint64(32 + (std::size_t(i) * 16));
+			chunk.compressedSize = assetData.get_uint32(40 + (std::size_t(i) * 16));
+			chunk.uncompressedSize = assetData.get_uint32(44 + (std::size_t(i) * 16));
+			if (chunk.offset > assetData.size() || chunk.compressedSize > assetData.size() - chunk.offset ||
+				chunk.uncompressedSize > SDL_MAX_SINT32 || chunk.uncompressedSize % frameSize != 0) {
+				throw std::exception("Invalid audio chunk");
+			}
+			total += chunk.uncompressedSize;
+			m_chunks.push_back(chunk);
+		}
+		if (total != size) { throw std::exception("Audio chunks do not match sound length"); }
+		m_size = size;
+		m_streamed = (flags & 0x1) != 0;
+
+		// Keep the encoded chunks around, and decode everything up front unless streaming
+		using detail::swap;
+		swap(m_encoded, assetData);
+		if (!m_streamed) {
+			std::uint64_t decompressStart = SDL_GetTicksNS();
+			Buffer data(std::size_t(m_size), 0);
+			std::uint64_t offset = 0;
+			for (std::size_t i = 0; i < m_chunks.size(); ++i) {
+				if (!DecodeChunk(i, data.data(offset))) { throw std::exception("Failed to decompress audio"); }
+				offset += m_chunks[i].uncompressedSize;
+			}
+			swap(m_data, data);
+			m_encoded = Buffer();
+			file->m_loadStats.decompressNS += SDL_GetTicksNS() - decompressStart;
+		}
+		m_spec = spec;
+	}
+	catch (std::exception& e) {
+		m_errorMessage = e.what();
+		m_spec = {};
+		m_chunks.clear();
+	}
+}
+
+bool ResourceSound::IsValid() const {
+	return m_spec.freq > 0;
+}
+
+const SDL_AudioSpec& ResourceSound::GetSpec() const {
+	return m_spec;
+}
 
+bool ResourceSound::IsStreamed() const {
+	return m_streamed;
+}
+
+std::uint64_t ResourceSound::GetSize() const {
+	return m_size;
+}
+
+const std::uint8_t* ResourceSound::GetData() const {
+	return m_streamed ? nullptr : m_data.data();
+}
+
+std::size_t ResourceSound::GetChunkCount() const {
+	return m_chunks.size();
+}
+
+std::uint32_t ResourceSound::GetChunkSize(std::size_t chunk) const {
+	return (chunk < m_chunks.size()) ? m_chunks[chunk].uncompressedSize : 0;
+}
+
+bool ResourceSound::DecodeChunk(std::size_t chunk, std::uint8_t* dst) const {
+	if (chunk >= m_chunks.size() || !dst) { return false; }
+	const Chunk& info = m_chunks[chunk];
+	const std::uint8_t* src = m_encoded.data(std::size_t(info.offset));
+	if (info.compressedSize == info.uncompressedSize) {
+		memcpy_s(dst, info.uncompressedSize, src, info.compressedSize);
+		return true;
+	}
+	int decoded = LZ4_decompress_safe((const char*)src, (char*)dst, int(info.compressedSize), int(info.uncompressedSize));
+	return decoded == int(info.uncompressedSize);
 }
 
 bool ResourceMesh::IsValid() const {
@@ -182,7 +368,7 @@ void ResourceText::Load(ResourceFile* file, const Buffer& block) {
 	try {
 		// Validate
 		if (!file) { throw std::exception("Invalid resource file reference"); }
-		Buffer assetData = ProcessAssetBlock(block);
+		Buffer assetData = ProcessAssetBlock(block, file->m_loadStats);
 
 		// Extract contents
 		m_contents = std::string((char*)assetData.data(), assetData.size());
@@ -213,6 +399,10 @@ std::string TexturePage::GetName() const {
 	return m_name;
 }
 
+ResourceID TexturePage::GetFileID() const {
+	return m_resourceFileID;
+}
+
 std::uint8_t* TexturePage::GetData() const {
 	return m_buffer.data();
 }
@@ -242,6 +432,27 @@ std::uint32_t TexturePage::GetHeight() const {
 	return m_height;
 }
 
+bool TexturePage::IsPremultiplied() const {
+	return m_premultiplied;
+}
+
+std::uint32_t TexturePage::GetMipLevelCount() const {
+	return 1 + std::uint32_t(m_mipLevels.size());
+}
+
+std::uint8_t* TexturePage::GetMipData(std::uint32_t level) const {
+	if (level == 0) { return m_buffer.data(); }
+	return (level <= m_mipLevels.size()) ? m_mipLevels[level - 1].data() : nullptr;
+}
+
+std::uint32_t TexturePage::GetMipWidth(std::uint32_t level) const {
+	return std::max(1u, m_width >> level);
+}
+
+std::uint32_t TexturePage::GetMipHeight(std::uint32_t level) const {
+	return std::max(1u, m_height >> level);
+}
+
 bool TexturePage::WriteToFile(std::filesystem::path outputFile) const {
 	// Set default output path
 	if (outputFile.empty()) {
@@ -258,8 +469,28 @@ bool TexturePage::WriteToFile(std::filesystem::path outputFile) const {
 	return true;
 }
 
+void TexturePage::GenerateMipmaps(std::uint32_t padding) {
+	m_mipLevels.clear();
+	if (SDL_BYTESPERPIXEL(m_format) != 4) { return; }
+
+	// A 2x2 box filter at level N reads (2^N - 1) texels past a texture's edge,
+	// so stop before neighbouring textures on the page would bleed together.
+	std::uint32_t levelCount = 1;
+	while ((std::max(m_width, m_height) >> levelCount) > 0 && ((1ull << levelCount) - 1) <= padding) {
+		++levelCount;
+	}
+
+	// Downsample each level from the previous one
+	for (std::uint32_t level = 1; level < levelCount; ++level) {
+		std::uint32_t srcWidth = GetMipWidth(level - 1);
+		std::uint32_t srcHeight = GetMipHeight(level - 1);
+		Buffer mipData(std::size_t(GetMipWidth(level)) * GetMipHeight(level) * 4, 0);
+		DownsampleBox(GetMipData(level - 1), srcWidth, srcHeight, mipData.data());
+		m_mipLevels.push_back(std::move(mipData));
+	}
+}
+
 void TexturePage::Load(ResourceFile* file, const Buffer& block) {
-	SDL_UNUSED(file);
 	m_errorMessage.clear();
 	m_name.clear();
 
@@ -273,8 +504,17 @@ void TexturePage::Load(ResourceFile* file, const Buffer& block) {
 	std::uint32_t headerHeight = block.get_uint32(60);
 
 	// Decompress data
+	if (headerUncompressedSize > SDL_MAX_SINT32 || headerCompressedSize > SDL_MAX_SINT32) {
+		std::stringstream msg;
+		msg << "Texture page is too large (" << headerName << ")";
+		m_errorMessage = msg.str();
+		return;
+	}
 	Buffer imageData = block.get_chunk(64, headerCompressedSize);
+	file->m_loadStats.compressedBytes += headerCompressedSize;
+	file->m_loadStats.uncompressedBytes += headerUncompressedSize;
 	if (headerCompressedSize != headerUncompressedSize) {
+		std::uint64_t decompressStart = SDL_GetTicksNS();
 		Buffer uncompressedData(headerUncompressedSize, 0);
 		if (LZ4_decompress_safe((char*)imageData.data(), (char*)uncompressedData.data(), (int)headerCompressedSize, (int)headerUncompressedSize) != (int)headerUncompressedSize) {
 			std::stringstream msg;
@@ -284,11 +524,14 @@ void TexturePage::Load(ResourceFile* file, const Buffer& block) {
 		}
 		using detail::swap;
 		swap(imageData, uncompressedData);
+		file->m_loadStats.decompressNS += SDL_GetTicksNS() - decompressStart;
 	}
 
 	// Verify data
-	std::uint32_t dataCRC = Crc32Calculate(imageData.data(), headerUncompressedSize);
-	if (headerCrc != dataCRC) {
+	std::uint64_t crcStart = SDL_GetTicksNS();
+	std::uint32_t dataCRC = Crc32Calculate(imageData.data(), imageData.size());
+	file->m_loadStats.crcNS += SDL_GetTicksNS() - crcStart;
+	if (!CrcMatches(headerCrc, dataCRC)) {
 		std::stringstream msg;
 		msg << "Failed to decode texture page" << headerName << ")";
 		m_errorMessage = msg.str();
@@ -298,6 +541,23 @@ void TexturePage::Load(ResourceFile* file, const Buffer& block) {
 		m_errorMessage = "Unknown image format";
 		return;
 	}
+	const SDL_PixelFormatDetails* formatDetails = SDL_GetPixelFormatDetails(SDL_PixelFormat(headerFormat));
+	if (!formatDetails || std::uint64_t(headerWidth) * headerHeight * formatDetails->bytes_per_pixel > imageData.size()) {
+		std::stringstream msg;
+		msg << "Texture page data does not match its size (" << headerName << ")";
+		m_errorMessage = msg.str();
+		return;
+	}
+
+	// Convert to premultiplied alpha
+	std::uint64_t processStart = SDL_GetTicksNS();
+	m_premultiplied = false;
+	if (formatDetails->bytes_per_pixel == 4 && formatDetails->Abits == 8) {
+		std::size_t pixelCount = std::min<std::size_t>(std::size_t(headerWidth) * headerHeight, imageData.size() / 4);
+		PremultiplyAlpha(imageData.data(), pixelCount, formatDetails->Ashift / 8);
+		m_premultiplied = true;
+	}
+	file->m_loadStats.processNS += SDL_GetTicksNS() - processStart;
 
 	// Save data
 	m_name = headerName;
@@ -305,6 +565,7 @@ void TexturePage::Load(ResourceFile* file, const Buffer& block) {
 	m_width = headerWidth;
 	m_height = headerHeight;
 	m_buffer = imageData;
+	m_mipLevels.clear();
 	m_resourceFileID = file->GetID();
 }
 
@@ -315,6 +576,7 @@ ResourceFile::ResourceFile(ResourceID resourceFileID, const std::string& filenam
 
 	try {
 		// Open file & read contents
+		std::uint64_t readStart = SDL_GetTicksNS();
 		std::ifstream file(filename, std::ios::in | std::ios::ate | std::ios::binary);
 		if (!file.is_open()) { throw std::exception("Failed to open file"); }
 		std::size_t fileSize = file.tellg();
@@ -323,111 +585,209 @@ ResourceFile::ResourceFile(ResourceID resourceFileID, const std::string& filenam
 		file.read((char*)fileBuffer.data(), fileSize);
 		file.close();
 		if (fileBuffer.empty()) { throw std::exception("Empty file"); }
+		m_loadStats.readNS += SDL_GetTicksNS() - readStart;
 
-		// Parse signature
-		std::string headerSignature = fileBuffer.get_string(0, 4);
-		if (headerSignature != "ARCF") { throw std::exception("Incompatible file format"); }
+		Parse(fileBuffer, password);
+	}
+	catch (std::exception& e) {
+		m_errorMessage = std::string(e.what());
+		m_filename.clear();
+	}
+}
 
-		// Parse version
-		uint8_t headerVersionMajor = fileBuffer.get_uint8(4);
-		uint8_t headerVersionMinor = fileBuffer.get_uint8(5);
-		uint8_t headerVersionPatch = fileBuffer.get_uint8(6);
-		std::stringstream msg;
-		msg << std::to_string(headerVersionMajor) << "." << std::to_string(headerVersionMinor) << "." << std::to_string(headerVersionPatch);
-		std::string headerVersion = msg.str();
-		if (!VersionStringMatch(headerVersion, APOLLO_VERSION_STR)) { throw std::exception("Outdated file format"); }
-
-		// Decode file
-		bool encoded = false;
-		std::string headerAES = fileBuffer.get_string(16, 32);
-		for (char c : headerAES) {
-			if (c != 0) {
-				encoded = true;
-				break;
-			}
+ResourceFile::ResourceFile(ResourceID resourceFileID, const Buffer& fileBuffer, const std::string& password) :
+	m_resourceFileID(resourceFileID) {
+	m_errorMessage.clear();
+
+	try {
+		// Decryption works in place, so parse a copy
+		std::uint64_t readStart = SDL_GetTicksNS();
+		if (fileBuffer.empty()) { throw std::exception("Empty file"); }
+		Buffer buffer(fileBuffer.data(), fileBuffer.size());
+		m_loadStats.readNS += SDL_GetTicksNS() - readStart;
+
+		Parse(buffer, password);
+	}
+	catch (std::exception& e) {
+		m_errorMessage = std::string(e.what());
+		m_filename.clear();
+	}
+}
+
+void ResourceFile::Parse(Buffer& fileBuffer, const std::string& password) {
+	m_loadStats.fileBytes = fileBuffer.size();
+
+	// Parse signature
+	std::string headerSignature = fileBuffer.get_string(0, 4);
+	if (headerSignature != "ARCF") { throw std::exception("Incompatible file format"); }
+
+	// Parse version
+	uint8_t headerVersionMajor = fileBuffer.get_uint8(4);
+	uint8_t headerVersionMinor = fileBuffer.get_uint8(5);
+	uint8_t headerVersionPatch = fileBuffer.get_uint8(6);
+	std::stringstream msg;
+	msg << std::to_string(headerVersionMajor) << "." << std::to_string(headerVersionMinor) << "." << std::to_string(headerVersionPatch);
+	std::string headerVersion = msg.str();
+	if (!VersionStringMatch(headerVersion, APOLLO_VERSION_STR)) { throw std::exception("Outdated file format"); }
+
+	// Decode file
+	bool encoded = false;
+	std::string headerAES = fileBuffer.get_string(16, 32);
+	for (char c : headerAES) {
+		if (c != 0) {
+			encoded = true;
+			break;
 		}
-		if (encoded) {
-			// Check for password
-			if (password.empty()) { throw std::exception("File is encrypted, password must not be empty"); }
-
-			// Pad out password to 32 characters
-			uint8_t key[32] = { 0 };
-			for (size_t i = 0; i < password.size(); ++i) { key[i] = (uint8_t)password[i]; }
-			AES_ctx ctx;
-			AES_init_ctx_iv(&ctx, &key[0], (uint8_t*)headerAES.data());
-			AES_CBC_decrypt_buffer(&ctx, fileBuffer.data(48), fileBuffer.size() - 48);
-		}
-
-		// Parse CRC
-		std::uint32_t headerCRC = fileBuffer.get_uint32(8);
-		std::uint32_t fileCRC = Crc32Calculate(fileBuffer.data(48), fileBuffer.size() - 48);
-		if (headerCRC != fileCRC) { throw std::exception("Invalid password"); }
-		std::uint64_t offsetTexturePages = fileBuffer.get_uint64(48);
-		std::uint64_t offsetDataChunks = fileBuffer.get_uint64(56);
-		std::uint64_t offsetAssetTable = fileBuffer.get_uint64(64);
-
-		// Read texture pages
-		std::string textureHeaderSignature = fileBuffer.get_string(offsetTexturePages, 4);
-		if (textureHeaderSignature != "ATXG") { throw std::exception("Invalid texture page format"); }
-		std::uint32_t textureHeaderPageCount = fileBuffer.get_uint32(offsetTexturePages + 4);
-		std::uint64_t textureHeaderPageStride = fileBuffer.get_uint64(offsetTexturePages + 8);
-		for (std::uint64_t pageNum = 0; pageNum < textureHeaderPageCount; ++pageNum) {
-			std::uint64_t pageOffset = offsetTexturePages + 16 + (pageNum * textureHeaderPageStride);
-			TexturePage page;
-			page.Load(this, fileBuffer.get_chunk(pageOffset, textureHeaderPageStride));
-			if (!page.IsValid()) {
-				std::stringstream msg;
-				msg << "Failed to initialize texture page; " << page.ErrorMessage();
-				throw std::exception(msg.str().c_str());
-			}
-			m_texturePages.push_back(std::move(page));
-		}
-
-		// Read resources
-		std::string assetTableSignature = fileBuffer.get_string(offsetAssetTable, 4);
-		if (assetTableSignature != "ARFT") { throw std::exception("Invalid file table format"); }
-		std::uint32_t assetTableCount = fileBuffer.get_uint32(offsetAssetTable + 4);
-		std::uint32_t assetTableCapacity = fileBuffer.get_uint32(offsetAssetTable + 8);
-		Buffer assetTableCtrlBlock = fileBuffer.get_chunk(offsetAssetTable + 16, assetTableCapacity);
-		for (std::size_t i = 0; i < assetTableCapacity; ++i) {
-			// Iterate through control bytes
-			std::uint8_t ctrl = assetTableCtrlBlock.get_uint8(i);
-			if (ctrl & 0x80) {
-				// Get asset data
-				std::uint64_t offsetAssetBucket = offsetAssetTable + 16 + assetTableCapacity + (i * 40);
-				std::uint64_t offsetAsset = fileBuffer.get_uint64(offsetAssetBucket + 32);
-				std::string assetType = fileBuffer.get_string(offsetAsset, 4);
-				std::string assetName = fileBuffer.get_string(offsetAsset + 16, 32);
-				std::uint64_t assetCompressedSize = fileBuffer.get_uint64(offsetAsset + 72);
-
-				// Create resource
-				Buffer assetData = fileBuffer.get_chunk(offsetAsset, 80 + assetCompressedSize);
-				if (assetType == "AIMG") {
-					ResourceTexture assetTexture;
-					assetTexture.Load(this, assetData);
-					if (!assetTexture.IsValid()) {
-						std::stringstream msg;
-						msg << "Failed to initialize texture (" << assetName << "); " << assetTexture.ErrorMessage();
-						throw std::exception(msg.str().c_str());
-					}
-					ResourceID id = ResourceManager::GenerateID();
-					assetTexture.SetID(id);
-					m_resourceIDMap.insert(std::make_pair(id, m_textures.size()));
-					m_resourceNameMap.insert(std::make_pair(assetName, m_textures.size()));
-					m_textures.push_back(std::move(assetTexture));
+	}
+	if (encoded) {
+		// Check for password
+		if (password.empty()) { throw std::exception("File is encrypted, password must not be empty"); }
+		if ((fileBuffer.size() - 48) % AES_BLOCKLEN != 0) { throw std::exception("Encrypted file is not block aligned"); }
+
+		// Pad out password to 32 characters
+		uint8_t key[32] = { 0 };
+		for (size_t i = 0; i < password.size(); ++i) { key[i] = (uint8_t)password[i]; }
+		AES_ctx ctx;
+		AES_init_ctx_iv(&ctx, &key[0], (uint8_t*)headerAES.data());
+		std::uint64_t decryptStart = SDL_GetTicksNS();
+		AES_CBC_decrypt_buffer(&ctx, fileBuffer.data(48), fileBuffer.size() - 48);
+		m_loadStats.decryptNS += SDL_GetTicksNS() - decryptStart;
+	}
+
+	// Parse CRC
+	std::uint32_t headerCRC = fileBuffer.get_uint32(8);
+	std::uint64_t crcStart = SDL_GetTicksNS();
+	std::uint32_t fileCRC = Crc32Calculate(fileBuffer.data(48), fileBuffer.size() - 48);
+	m_loadStats.crcNS += SDL_GetTicksNS() - crcStart;
+	if (!CrcMatches(headerCRC, fileCRC)) { throw std::exception("Invalid password"); }
+	std::uint64_t offsetTexturePages = fileBuffer.get_uint64(48);
+	std::uint64_t offsetDataChunks = fileBuffer.get_uint64(56);
+	std::uint64_t offsetAssetTable = fileBuffer.get_uint64(64);
+
+	// Everything from here on is indexing, apart from the nested stages timed separately
+	std::uint64_t indexStart = SDL_GetTicksNS();
+	ResourceFileLoadStats nestedStart = m_loadStats;
+
+	// Read texture pages
+	std::string textureHeaderSignature = fileBuffer.get_string(offsetTexturePages, 4);
+	if (textureHeaderSignature != "ATXG") { throw std::exception("Invalid texture page format"); }
+	std::uint32_t textureHeaderPageCount = fileBuffer.get_uint32(offsetTexturePages + 4);
+	std::uint64_t textureHeaderPageStride = fileBuffer.get_uint64(offsetTexturePages + 8);
+	for (std::uint64_t pageNum = 0; pageNum < textureHeaderPageCount; ++pageNum) {
+		std::uint64_t pageOffset = offsetTexturePages + 16 + (pageNum * textureHeaderPageStride);
+		TexturePage page;
+		page.Load(this, fileBuffer.get_chunk(pageOffset, textureHeaderPageStride));
+		if (!page.IsValid()) {
+			std::stringstream msg;
+			msg << "Failed to initialize texture page; " << page.ErrorMessage();
+			throw std::exception(msg.str().c_str());
+		}
+		m_texturePages.push_back(std::move(page));
+	}
+
+	// Read resources
+	std::string assetTableSignature = fileBuffer.get_string(offsetAssetTable, 4);
+	if (assetTableSignature != "ARFT") { throw std::exception("Invalid file table format"); }
+	std::uint32_t assetTableCount = fileBuffer.get_uint32(offsetAssetTable + 4);
+	std::uint32_t assetTableCapacity = fileBuffer.get_uint32(offsetAssetTable + 8);
+	Buffer assetTableCtrlBlock = fileBuffer.get_chunk(offsetAssetTable + 16, assetTableCapacity);
+	for (std::size_t i = 0; i < assetTableCapacity; ++i) {
+		// Iterate through control bytes
+		std::uint8_t ctrl = assetTableCtrlBlock.get_uint8(i);
+		if (ctrl & 0x80) {
+			// Get asset data
+			std::uint64_t offsetAssetBucket = offsetAssetTable + 16 + assetTableCapacity + (i * 40);
+			std::uint64_t offsetAsset = fileBuffer.get_uint64(offsetAssetBucket + 32);
+			std::string assetType = fileBuffer.get_string(offsetAsset, 4);
+			std::string assetName = fileBuffer.get_string(offsetAsset + 16, 32);
+			std::uint64_t assetCompressedSize = fileBuffer.get_uint64(offsetAsset + 72);
+
+			// Create resource
+			Buffer assetData = fileBuffer.get_chunk(offsetAsset, 80 + assetCompressedSize);
+			if (assetType == "AIMG") {
+				ResourceTexture assetTexture;
+				assetTexture.Load(this, assetData);
+				if (!assetTexture.IsValid()) {
+					std::stringstream msg;
+					msg << "Failed to initialize texture (" << assetName << "); " << assetTexture.ErrorMessage();
+					throw std::exception(msg.str().c_str());
 				}
-				else {
+				ResourceID id = ResourceManager::GenerateID();
+				assetTexture.SetID(id);
+				m_resourceIDMap.insert(std::make_pair(id, m_textures.size()));
+				m_resourceNameMap.insert(std::make_pair(assetName, m_textures.size()));
+				m_textures.push_back(std::move(assetTexture));
+			}
+			else if (assetType == "ASND") {
+				ResourceSound assetSound;
+				assetSound.Load(this, assetData);
+				if (!assetSound.IsValid()) {
 					std::stringstream msg;
-					msg << "Unknown asset type (" << assetType << ")";
+					msg << "Failed to initialize sound (" << assetName << "); " << assetSound.ErrorMessage();
 					throw std::exception(msg.str().c_str());
 				}
+				ResourceID id = ResourceManager::GenerateID();
+				assetSound.SetID(id);
+				m_soundIDMap.insert(std::make_pair(id, m_sounds.size()));
+				m_soundNameMap.insert(std::make_pair(assetName, m_sounds.size()));
+				m_sounds.push_back(std::move(assetSound));
+			}
+			else {
+				std::stringstream msg;
+				msg << "Unknown asset type (" << assetType << ")";
+				throw std::exception(msg.str().c_str());
 			}
 		}
 	}
-	catch (std::exception& e) {
-		m_errorMessage = std::string(e.what());
-		m_filename.clear();
+
+	// Build mip chains, now that the texture layout of each page is known
+	std::uint64_t processStart = SDL_GetTicksNS();
+	std::vector<std::vector<std::size_t>> pageTextures(m_texturePages.size());
+	for (std::size_t i = 0; i < m_textures.size(); ++i) {
+		TexturePageID pageNum = m_textures[i].m_texturePageID;
+		if (pageNum >= 0 && std::size_t(pageNum) < pageTextures.size()) { pageTextures[std::size_t(pageNum)].push_back(i); }
 	}
+	for (std::size_t pageNum = 0; pageNum < m_texturePages.size(); ++pageNum) {
+		m_texturePages[pageNum].GenerateMipmaps(CalculateTexturePagePadding(pageTextures[pageNum]));
+	}
+	m_loadStats.processNS += SDL_GetTicksNS() - processStart;
+
+	std::uint64_t nestedNS =
+		(m_loadStats.crcNS - nestedStart.crcNS) +
+		(m_loadStats.decompressNS - nestedStart.decompressNS) +
+		(m_loadStats.processNS - nestedStart.processNS);
+	m_loadStats.indexNS += (SDL_GetTicksNS() - indexStart) - nestedNS;
+}
+
+std::uint32_t ResourceFile::CalculateTexturePagePadding(std::vector<std::size_t>& pageTextures) const {
+	// Find the smallest gap between any two textures (or animation frames) on the page. Sweeping the textures
+	// left to right, a texture starting at least the best gap past another's right edge can't be any closer
+	std::sort(pageTextures.begin(), pageTextures.end(), [this](std::size_t a, std::size_t b) {
+		return m_textures[a].m_texturePageXOffset < m_textures[b].m_texturePageXOffset;
+	});
+	std::uint32_t padding = UINT32_MAX;
+	for (std::size_t i = 0; i < pageTextures.size() && padding > 0; ++i) {
+		const ResourceTexture& a = m_textures[pageTextures[i]];
+		if (a.m_animationFrameCount > 1) {
+			std::uint32_t cols = (std::uint32_t)std::ceilf((float)a.m_animationFrameCount / a.m_animationFramesPerRow);
+			if (cols > 1) { padding = std::min(padding, a.m_animationXSpacing); }
+			if (a.m_animationFrameCount > cols) { padding = std::min(padding, a.m_animationYSpacing); }
+		}
+		for (std::size_t j = i + 1; j < pageTextures.size(); ++j) {
+			const ResourceTexture& b = m_textures[pageTextures[j]];
+			if (std::int64_t(b.m_texturePageXOffset) - std::int64_t(a.m_texturePageXOffset + a.m_texturePageWidth) >= std::int64_t(padding)) { break; }
+			std::int64_t dx = std::max(
+				std::int64_t(b.m_texturePageXOffset) - std::int64_t(a.m_texturePageXOffset + a.m_texturePageWidth),
+				std::int64_t(a.m_texturePageXOffset) - std::int64_t(b.m_texturePageXOffset + b.m_texturePageWidth)
+			);
+			std::int64_t dy = std::max(
+				std::int64_t(b.m_texturePageYOffset) - std::int64_t(a.m_texturePageYOffset + a.m_texturePageHeight),
+				std::int64_t(a.m_texturePageYOffset) - std::int64_t(b.m_texturePageYOffset + b.m_texturePageHeight)
+			);
+			padding = std::min(padding, std::uint32_t(std::max<std::int64_t>(0, std::max(dx, dy))));
+		}
+	}
+	return padding;
 }
 
 std::string ResourceFile::GetFilename() const {
@@ -438,6 +798,10 @@ ResourceID ResourceFile::GetID() const {
 	return m_resourceFileID;
 }
 
+const ResourceFileLoadStats& ResourceFile::GetLoadStats() const {
+	return m_loadStats;
+}
+
 TexturePageID ResourceFile::GetTexturePageID(const std::string& name) const {
 	TexturePageID index = TEXTURE_PAGE_ID_NULL;
 	for (auto& texturePage : m_texturePages) {
@@ -469,8 +833,31 @@ std::size_t ResourceFile::GetTextureCount() const {
 	return m_texturePages.size();
 }
 
+std::string ResourceFile::GetTextureName(ResourceID resourceTextureID) const {
+	auto it = m_resourceIDMap.find(resourceTextureID);
+	if (it == m_resourceIDMap.end()) { return ""; }
+	for (auto& pair : m_resourceNameMap) {
+		if (pair.second == it->second) { return pair.first; }
+	}
+	return "";
+}
+
+ResourceID ResourceFile::GetSoundID(const std::string& name) const {
+	auto it = m_soundNameMap.find(name);
+	return it == m_soundNameMap.end() ? RESOURCE_ID_NULL : m_sounds[it->second].GetID();
+}
+
+const ResourceSound* ResourceFile::GetSound(ResourceID resourceSoundID) const {
+	auto it = m_soundIDMap.find(resourceSoundID);
+	return it == m_soundIDMap.end() ? nullptr : &m_sounds[it->second];
+}
+
+std::size_t ResourceFile::GetSoundCount() const {
+	return m_sounds.size();
+}
+
 bool ResourceFile::IsValid() const {
-	return !m_filename.empty();
+	return m_errorMessage.empty();
 }
 
 std::string ResourceFile::ErrorMessage() const {
@@ -672,6 +1059,58 @@ const ResourceTexture* ResourceManager::GetTexture(ResourceID resourceTextureID,
 	}
 }
 
+ResourceID ResourceManager::GetSoundID(const std::string& name, ResourceID resourceFileID) {
+	m_errorMessage.clear();
+
+	if (resourceFileID == RESOURCE_ID_NULL) {
+		// Search all resource files
+		for (auto& pair : m_resourceFiles) {
+			ResourceID asset = pair.second.GetSoundID(name);
+			if (asset) { return asset; }
+		}
+		m_errorMessage = "Failed to find sound";
+		return RESOURCE_ID_NULL;
+	}
+	else {
+		auto file = GetResourceFile(resourceFileID);
+		if (!file) { return RESOURCE_ID_NULL; }
+		ResourceID asset = file->GetSoundID(name);
+		if (asset == RESOURCE_ID_NULL) {
+			m_errorMessage = "Failed to find sound";
+			return RESOURCE_ID_NULL;
+		}
+		return asset;
+	}
+}
+
+const ResourceSound* ResourceManager::GetSound(ResourceID resourceSoundID, ResourceID resourceFileID) {
+	m_errorMessage.clear();
+	if (resourceSoundID == RESOURCE_ID_NULL) {
+		m_errorMessage = "Sound ID is null";
+		return nullptr;
+	}
+
+	if (resourceFileID == RESOURCE_ID_NULL) {
+		// Search all resource files
+		for (auto& pair : m_resourceFiles) {
+			const ResourceSound* asset = pair.second.GetSound(resourceSoundID);
+			if (asset) { return asset; }
+		}
+		m_errorMessage = "Failed to find sound";
+		return nullptr;
+	}
+	else {
+		auto file = GetResourceFile(resourceFileID);
+		if (!file) { return nullptr; }
+		const ResourceSound* asset = file->GetSound(resourceSoundID);
+		if (!asset) {
+			m_errorMessage = "Failed to find sound";
+			return nullptr;
+		}
+		return asset;
+	}
+}
+
 ResourceID ResourceManager::GenerateID() {
 	return ++m_resourceIDCounter;
 }
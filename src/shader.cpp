@@ -41,13 +41,20 @@ static SDL_GPUShader* CompileDefaultShaderHLSL(SDL_GPUDevice* device, const Shad
 	return shaderCompiled;
 }
 
-SpriteBatchShaderPipeline::SpriteBatchShaderPipeline() {
+SpriteBatchShaderPipeline::SpriteBatchShaderPipeline(bool premultipliedAlpha, bool packedData, SpriteBatchPass pass) {
 	SDL_GPUDevice* device = Game::GetGPUDevice();
-	SDL_Window* window = Game::GetWindow();
 
 	// Decode & compile shaders
-	m_fragShader = CompileDefaultShaderHLSL(device, SpriteBatch_frag_hlsl, SDL_SHADERCROSS_SHADERSTAGE_FRAGMENT);
-	m_vertShader = CompileDefaultShaderHLSL(device, SpriteBatch_vert_hlsl, SDL_SHADERCROSS_SHADERSTAGE_VERTEX);
+	char premultipliedAlphaDefine[] = "PREMULTIPLIED_ALPHA";
+	char solidDefine[] = "SOLID";
+	SDL_ShaderCross_HLSL_Define fragDefines[2] = {};
+	if (pass == SpriteBatchPass::Solid) { fragDefines[0].name = solidDefine; }
+	else if (premultipliedAlpha) { fragDefines[0].name = premultipliedAlphaDefine; }
+	m_fragShader = CompileDefaultShaderHLSL(device, SpriteBatch_frag_hlsl, SDL_SHADERCROSS_SHADERSTAGE_FRAGMENT, "main", fragDefines);
+	char packedDataDefine[] = "PACKED_SPRITE_DATA";
+	SDL_ShaderCross_HLSL_Define vertDefines[2] = {};
+	if (packedData) { vertDefines[0].name = packedDataDefine; }
+	m_vertShader = CompileDefaultShaderHLSL(device, SpriteBatch_vert_hlsl, SDL_SHADERCROSS_SHADERSTAGE_VERTEX, "main", vertDefines);
 	if (!m_fragShader || !m_vertShader) {
 		Clear();
 		return; 
@@ -55,14 +62,15 @@ SpriteBatchShaderPipeline::SpriteBatchShaderPipeline() {
 
 	// Build pipeline
 	SDL_GPUColorTargetDescription colorTargetDescription{};
-	colorTargetDescription.format = SDL_GetGPUSwapchainTextureFormat(device, window);
+	colorTargetDescription.format = detail::GetColorTargetFormat(device);
 	colorTargetDescription.blend_state = {};
-	colorTargetDescription.blend_state.enable_blend = true;
+	colorTargetDescription.blend_state.enable_blend = (pass != SpriteBatchPass::Solid);
 	colorTargetDescription.blend_state.color_blend_op = SDL_GPU_BLENDOP_ADD;
 	colorTargetDescription.blend_state.alpha_blend_op = SDL_GPU_BLENDOP_ADD;
-	colorTargetDescription.blend_state.src_color_blendfactor = SDL_GPU_BLENDFACTOR_SRC_ALPHA;
+	// Both variants output premultiplied color, so additive sprites blend in either
+	colorTargetDescription.blend_state.src_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE;
 	colorTargetDescription.blend_state.dst_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA;
-	colorTargetDescription.blend_state.src_alpha_blendfactor = SDL_GPU_BLENDFACTOR_SRC_ALPHA;
+	colorTargetDescription.blend_state.src_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE;
 	colorTargetDescription.blend_state.dst_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA;
 	
 	SDL_GPUGraphicsPipelineCreateInfo createInfo{};
@@ -90,7 +98,8 @@ SpriteBatchShaderPipeline::SpriteBatchShaderPipeline() {
 	createInfo.depth_stencil_state.write_mask = 0xFF;
 	createInfo.depth_stencil_state.compare_op = SDL_GPU_COMPAREOP_GREATER;
 	createInfo.depth_stencil_state.enable_depth_test = true;
-	createInfo.depth_stencil_state.enable_depth_write = true;
+	// Translucent sprites are drawn back to front over everything opaque, so they never need to hide what follows
+	createInfo.depth_stencil_state.enable_depth_write = (pass != SpriteBatchPass::Translucent);
 	createInfo.depth_stencil_state.enable_stencil_test = false;
 
 	createInfo.rasterizer_state = {};
@@ -127,9 +136,8 @@ bool SpriteBatchShaderPipeline::IsValid() const {
 	return (m_pipeline);
 }
 
-PrimitiveBatchShaderPipeline::PrimitiveBatchShaderPipeline(bool wireframe) {
+PrimitiveBatchShaderPipeline::PrimitiveBatchShaderPipeline(bool wireframe, bool packedColor) {
 	SDL_GPUDevice* device = Game::GetGPUDevice();
-	SDL_Window* window = Game::GetWindow();
 
 	// Decode & compile shaders
 	m_fragShader = CompileDefaultShaderHLSL(device, PrimitiveBatch_frag_hlsl, SDL_SHADERCROSS_SHADERSTAGE_FRAGMENT);
@@ -141,7 +149,7 @@ PrimitiveBatchShaderPipeline::PrimitiveBatchShaderPipeline(bool wireframe) {
 
 	// Build pipeline
 	SDL_GPUColorTargetDescription colorTargetDescription{};
-	colorTargetDescription.format = SDL_GetGPUSwapchainTextureFormat(device, window);
+	colorTargetDescription.format = detail::GetColorTargetFormat(device);
 	colorTargetDescription.blend_state = {};
 	colorTargetDescription.blend_state.enable_blend = true;
 	colorTargetDescription.blend_state.color_blend_op = SDL_GPU_BLENDOP_ADD;
@@ -188,14 +196,14 @@ PrimitiveBatchShaderPipeline::PrimitiveBatchShaderPipeline(bool wireframe) {
 	vertexBufferDescription.slot = 0;
 	vertexBufferDescription.input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX;
 	vertexBufferDescription.instance_step_rate = 0;
-	vertexBufferDescription.pitch = sizeof(VertexPosColor);
+	vertexBufferDescription.pitch = (packedColor) ? sizeof(VertexPosPackedColor) : sizeof(VertexPosColor);
 
 	SDL_GPUVertexAttribute vertexAttributes[2] = {};
 	vertexAttributes[0].format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3;
 	vertexAttributes[0].buffer_slot = 0;
 	vertexAttributes[0].location = 0;
 	vertexAttributes[0].offset = 0;
-	vertexAttributes[1].format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4;
+	vertexAttributes[1].format = (packedColor) ? SDL_GPU_VERTEXELEMENTFORMAT_UBYTE4_NORM : SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4;
 	vertexAttributes[1].buffer_slot = 0;
 	vertexAttributes[1].location = 1;
 	vertexAttributes[1].offset = sizeof(float) * 3;
@@ -235,4 +243,91 @@ bool PrimitiveBatchShaderPipeline::IsValid() const {
 	return (m_pipeline);
 }
 
+ShapeBatchShaderPipeline::ShapeBatchShaderPipeline() {
+	SDL_GPUDevice* device = Game::GetGPUDevice();
+
+	// Decode & compile shaders
+	m_fragShader = CompileDefaultShaderHLSL(device, ShapeBatch_frag_hlsl, SDL_SHADERCROSS_SHADERSTAGE_FRAGMENT);
+	m_vertShader = CompileDefaultShaderHLSL(device, ShapeBatch_vert_hlsl, SDL_SHADERCROSS_SHADERSTAGE_VERTEX);
+	if (!m_fragShader || !m_vertShader) {
+		Clear();
+		return; 
+	}
+
+	// Build pipeline
+	SDL_GPUColorTargetDescription colorTargetDescription{};
+	colorTargetDescription.format = detail::GetColorTargetFormat(device);
+	colorTargetDescription.blend_state = {};
+	colorTargetDescription.blend_state.enable_blend = true;
+	colorTargetDescription.blend_state.color_blend_op = SDL_GPU_BLENDOP_ADD;
+	colorTargetDescription.blend_state.alpha_blend_op = SDL_GPU_BLENDOP_ADD;
+	colorTargetDescription.blend_state.src_color_blendfactor = SDL_GPU_BLENDFACTOR_SRC_ALPHA;
+	colorTargetDescription.blend_state.dst_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA;
+	colorTargetDescription.blend_state.src_alpha_blendfactor = SDL_GPU_BLENDFACTOR_SRC_ALPHA;
+	colorTargetDescription.blend_state.dst_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA;
+	
+	SDL_GPUGraphicsPipelineCreateInfo createInfo{};
+	createInfo.vertex_shader = m_vertShader;
+	createInfo.fragment_shader = m_fragShader;
+	createInfo.primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST;
+
+	createInfo.target_info = {};
+	createInfo.target_info.num_color_targets = 1;
+	createInfo.target_info.color_target_descriptions = &colorTargetDescription;
+	createInfo.target_info.has_depth_stencil_target = true;
+	createInfo.target_info.depth_stencil_format = detail::GetDepthStencilFormat(device);
+	
+	createInfo.depth_stencil_state = {};
+	createInfo.depth_stencil_state.front_stencil_state = {};
+	createInfo.depth_stencil_state.front_stencil_state.compare_op = SDL_GPU_COMPAREOP_NEVER;
+	createInfo.depth_stencil_state.front_stencil_state.fail_op = SDL_GPU_STENCILOP_REPLACE;
+	createInfo.depth_stencil_state.front_stencil_state.pass_op = SDL_GPU_STENCILOP_KEEP;
+	createInfo.depth_stencil_state.front_stencil_state.depth_fail_op = SDL_GPU_STENCILOP_KEEP;
+	createInfo.depth_stencil_state.back_stencil_state = {};
+	createInfo.depth_stencil_state.back_stencil_state.compare_op = SDL_GPU_COMPAREOP_NEVER;
+	createInfo.depth_stencil_state.back_stencil_state.fail_op = SDL_GPU_STENCILOP_REPLACE;
+	createInfo.depth_stencil_state.back_stencil_state.pass_op = SDL_GPU_STENCILOP_KEEP;
+	createInfo.depth_stencil_state.back_stencil_state.depth_fail_op = SDL_GPU_STENCILOP_KEEP;
+	createInfo.depth_stencil_state.write_mask = 0xFF;
+	// Polyline segments overlap at round & bevel joins; letting equal depths through keeps the
+	// anti-aliased edge of one segment from masking the next
+	createInfo.depth_stencil_state.compare_op = SDL_GPU_COMPAREOP_GREATER_OR_EQUAL;
+	createInfo.depth_stencil_state.enable_depth_test = true;
+	createInfo.depth_stencil_state.enable_depth_write = true;
+	createInfo.depth_stencil_state.enable_stencil_test = false;
+
+	createInfo.rasterizer_state = {};
+	createInfo.rasterizer_state.cull_mode = SDL_GPU_CULLMODE_NONE;
+	createInfo.rasterizer_state.fill_mode = SDL_GPU_FILLMODE_FILL;
+	createInfo.rasterizer_state.front_face = SDL_GPU_FRONTFACE_COUNTER_CLOCKWISE;
+
+	m_pipeline = SDL_CreateGPUGraphicsPipeline(device, &createInfo);
+	SDL_ReleaseGPUShader(device, m_fragShader);
+	SDL_ReleaseGPUShader(device, m_vertShader);
+	m_fragShader = nullptr;
+	m_vertShader = nullptr;
+}
+
+ShapeBatchShaderPipeline::~ShapeBatchShaderPipeline() {
+	Clear();
+}
+
+SDL_GPUGraphicsPipeline* ShapeBatchShaderPipeline::GetPipeline() const {
+	return m_pipeline;
+}
+
+void ShapeBatchShaderPipeline::Clear() {
+	SDL_GPUDevice* device = Game::GetGPUDevice();
+	if (m_pipeline) { SDL_ReleaseGPUGraphicsPipeline(device, m_pipeline); }
+	if (m_fragShader) { SDL_ReleaseGPUShader(device, m_fragShader); }
+	if (m_vertShader) { SDL_ReleaseGPUShader(device, m_vertShader); }
+	m_pipeline = nullptr;
+	m_fragShader = nullptr;
+	m_vertShader = nullptr;
+}
+
+bool ShapeBatchShaderPipeline::IsValid() const {
+	return (m_pipeline);
+}
+
 } // luna
\ No newline at end of file
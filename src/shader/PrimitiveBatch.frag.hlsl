@@ -7,7 +7,6 @@ struct Input
 struct Output
 {
     float4 Color : SV_Target0;
-    float Depth : SV_Depth;
 };
 
 Output main(Input input) {
@@ -15,6 +14,5 @@ Output main(Input input) {
     result.Color = input.Color;
     if (result.Color.a == 0.0f)
         discard;
-    result.Depth = input.Position.z;
     return result;
 }
\ No newline at end of file
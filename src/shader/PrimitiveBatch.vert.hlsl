@@ -1,7 +1,7 @@
 struct Input 
 {
     float3 Position : SV_Position;
-    float4 Color : TEXCOORD0;
+    float4 Color : TEXCOORD0;  // Either four floats, or RGBA8 normalized by the input assembler
 };
 
 struct Output 
@@ -0,0 +1,81 @@
+struct Input
+{
+    float2 Local : TEXCOORD0;         // Position relative to the shape's center, or along & across a segment
+    float4 Params : TEXCOORD1;        // Half extents or segment length, half stroke thickness, size of a pixel
+    nointerpolation uint Type : TEXCOORD2;
+    float4 Color : TEXCOORD3;
+    nointerpolation float4 StartEnd : TEXCOORD4;  // Segment end style, bisector & bevel distance
+    nointerpolation float4 EndEnd : TEXCOORD5;
+    float4 Position : SV_Position;
+};
+
+struct Output
+{
+    float4 Color : SV_Target0;
+};
+
+static const uint SHAPE_CIRCLE = 0;
+static const uint SHAPE_AABB = 1;
+static const uint SHAPE_LINE = 2;
+static const uint SHAPE_SEGMENT = 3;
+
+static const uint END_BUTT = 0;
+static const uint END_SQUARE = 1;
+static const uint END_ROUND = 2;
+static const uint END_MITER = 3;
+static const uint END_BEVEL = 4;
+
+// Distance past one end of a segment, where p is measured out from the end along the segment & across it
+float SegmentEndDistance(float4 end, float2 p, float halfWidth, float d)
+{
+    uint style = uint(end.x);
+    if (style == END_BUTT)
+        return max(d, p.x);
+    if (style == END_SQUARE)
+        return max(d, p.x - halfWidth);
+    if (style == END_ROUND)
+        return length(p) - halfWidth;
+    if (style == END_BEVEL)
+        return max(max(d, p.x - halfWidth), abs(dot(p, end.yz)) - end.w);
+    return d;
+}
+
+Output main(Input input) {
+    // Signed distance to the shape's edge, negative inside
+    float2 halfExtents = input.Params.xy;
+    float halfThickness = input.Params.z;
+    float d;
+    if (input.Type == SHAPE_CIRCLE) {
+        d = length(input.Local) - halfExtents.x;
+    }
+    else if (input.Type == SHAPE_AABB) {
+        float2 q = abs(input.Local) - halfExtents;
+        d = length(max(q, 0.0f)) + min(max(q.x, q.y), 0.0f);
+    }
+    else if (input.Type == SHAPE_LINE) {
+        d = length(float2(max(abs(input.Local.x) - halfExtents.x, 0.0f), input.Local.y)) - halfThickness;
+    }
+    else {
+        // Segments are a band across their length, finished at each end by a cap or join
+        float len = halfExtents.x;
+        d = abs(input.Local.y) - halfThickness;
+        if (input.Local.x < 0.0f)
+            d = SegmentEndDistance(input.StartEnd, float2(-input.Local.x, input.Local.y), halfThickness, d);
+        else if (input.Local.x > len)
+            d = SegmentEndDistance(input.EndEnd, float2(input.Local.x - len, input.Local.y), halfThickness, d);
+    }
+
+    // Outlines keep a band of the stroke's thickness just inside the edge
+    if ((input.Type == SHAPE_CIRCLE || input.Type == SHAPE_AABB) && halfThickness > 0.0f) {
+        d = abs(d + halfThickness) - halfThickness;
+    }
+
+    // Cover by how far the pixel is from the edge
+    float coverage = saturate(0.5f - (d / input.Params.w));
+    if (coverage == 0.0f || input.Color.a == 0.0f)
+        discard;
+
+    Output result;
+    result.Color = float4(input.Color.rgb, input.Color.a * coverage);
+    return result;
+}
\ No newline at end of file
@@ -0,0 +1,155 @@
+struct ShapeData
+{
+    float4 Geometry;   // Circle: x, y, radius | AABB: left, top, right, bottom | Line & segment: x1, y1, x2, y2
+    float Depth;
+    float Thickness;   // Outline or line width in pixels, segment width in world units, 0 for filled shapes
+    uint Type;         // Shape type, then segment end styles & wrapping
+    uint Color;        // RGBA8
+};
+
+struct Output
+{
+    float2 Local : TEXCOORD0;
+    float4 Params : TEXCOORD1;
+    nointerpolation uint Type : TEXCOORD2;
+    float4 Color : TEXCOORD3;
+    nointerpolation float4 StartEnd : TEXCOORD4;
+    nointerpolation float4 EndEnd : TEXCOORD5;
+    float4 Position : SV_Position;
+};
+
+static const uint SHAPE_CIRCLE = 0;
+static const uint SHAPE_AABB = 1;
+static const uint SHAPE_LINE = 2;
+static const uint SHAPE_SEGMENT = 3;
+
+static const uint END_BUTT = 0;
+static const uint END_SQUARE = 1;
+static const uint END_ROUND = 2;
+static const uint END_MITER = 3;
+static const uint END_BEVEL = 4;
+
+// Longest a miter may get, relative to half the width, before it is beveled instead
+static const float MITER_LIMIT = 4.0f;
+
+static const uint triangleIndices[6] = { 0, 1, 2, 3, 2, 1 };
+static const float2 vertexPos[4] = {
+    { -1.0f, -1.0f },
+    { 1.0f, -1.0f },
+    { -1.0f, 1.0f },
+    { 1.0f, 1.0f }
+};
+
+StructuredBuffer<ShapeData> DataBuffer : register(t0, space0);
+
+// Shapes a camera sees, as indices into the data buffer
+StructuredBuffer<uint> DrawIndexBuffer : register(t1, space0);
+
+cbuffer UniformBlock : register(b0, space1)
+{
+    float4x4 ViewProjectionMatrix : packoffset(c0);
+    uint BaseShape : packoffset(c4.x);
+    float PixelSize : packoffset(c4.y);
+};
+
+// Style of one end of a segment, after looking at the segment it joins: the end style, the
+// bisector of the two segments' normals in the end's own frame (x out of the segment, y across),
+// and how far out the bevel sits along it
+float4 ResolveSegmentEnd(uint style, uint neighborIndex, float2 dir, float2 nrm, float outward, float halfWidth)
+{
+    if (style != END_MITER && style != END_BEVEL)
+        return float4(style, 0.0f, 0.0f, 0.0f);
+
+    // Joins that double back on themselves, or meet an empty segment, have no bisector
+    ShapeData neighbor = DataBuffer[neighborIndex];
+    float2 neighborDelta = neighbor.Geometry.zw - neighbor.Geometry.xy;
+    float neighborLength = length(neighborDelta);
+    float2 neighborDir = (neighborLength > 0.0f) ? neighborDelta / neighborLength : dir;
+    float2 bisector = nrm + float2(-neighborDir.y, neighborDir.x);
+    if (neighborLength <= 0.0f || dot(bisector, bisector) < 1e-6f)
+        return float4(END_ROUND, 0.0f, 0.0f, 0.0f);
+    bisector = normalize(bisector);
+    float cosine = dot(bisector, nrm);
+    if (style == END_MITER && cosine * MITER_LIMIT < 1.0f)
+        style = END_BEVEL;
+    return float4(style, dot(bisector, dir * outward), cosine, halfWidth * cosine);
+}
+
+Output main(uint id : SV_VertexID)
+{
+    uint shapeIndex = DrawIndexBuffer[BaseShape + (id / 6)];
+    uint vert = triangleIndices[id % 6];
+    ShapeData shape = DataBuffer[shapeIndex];
+    uint type = shape.Type & 0xFF;
+
+    Output output;
+    output.StartEnd = float4(0.0f, 0.0f, 0.0f, 0.0f);
+    output.EndEnd = float4(0.0f, 0.0f, 0.0f, 0.0f);
+    float2 world;
+    if (type == SHAPE_SEGMENT) {
+        // Lay the segment along its own x axis, starting at its first point
+        float2 p1 = shape.Geometry.xy;
+        float2 p2 = shape.Geometry.zw;
+        float len = length(p2 - p1);
+        float2 dir = (len > 0.0f) ? (p2 - p1) / len : float2(1.0f, 0.0f);
+        float2 nrm = float2(-dir.y, dir.x);
+        float halfWidth = shape.Thickness * 0.5f;
+        uint wrap = shape.Type >> 16;
+        uint prevIndex = ((shape.Type >> 14) & 1) ? shapeIndex + wrap : shapeIndex - 1;
+        uint nextIndex = ((shape.Type >> 15) & 1) ? shapeIndex - wrap : shapeIndex + 1;
+        output.StartEnd = ResolveSegmentEnd((shape.Type >> 8) & 0x7, prevIndex, dir, nrm, -1.0f, halfWidth);
+        output.EndEnd = ResolveSegmentEnd((shape.Type >> 11) & 0x7, nextIndex, dir, nrm, 1.0f, halfWidth);
+
+        // Miters put the corner on the bisector, so neighbors meet without overlapping; every
+        // other end reaches past the point far enough to cover its cap & anti-aliasing
+        bool atEnd = vertexPos[vert].x > 0.0f;
+        float side = vertexPos[vert].y;
+        float4 end = (atEnd) ? output.EndEnd : output.StartEnd;
+        float outward = (atEnd) ? 1.0f : -1.0f;
+        float2 p = (atEnd) ? p2 : p1;
+        float pad = halfWidth + PixelSize;
+        if (uint(end.x) == END_MITER) {
+            float2 bisector = (dir * outward * end.y) + (nrm * end.z);
+            world = p + (bisector * (side * pad / end.z));
+        }
+        else {
+            float extend = (uint(end.x) == END_BUTT) ? PixelSize : pad;
+            world = p + (dir * (outward * extend)) + (nrm * (side * pad));
+        }
+        output.Local = float2(dot(world - p1, dir), dot(world - p1, nrm));
+        output.Params = float4(len, 0.0f, halfWidth, PixelSize);
+    }
+    else {
+        // Find the shape's center, half extents & orientation; lines run along their own x axis
+        float2 center;
+        float2 halfExtents;
+        float2 axis = float2(1.0f, 0.0f);
+        if (type == SHAPE_CIRCLE) {
+            center = shape.Geometry.xy;
+            halfExtents = shape.Geometry.zz;
+        }
+        else if (type == SHAPE_AABB) {
+            center = (shape.Geometry.xy + shape.Geometry.zw) * 0.5f;
+            halfExtents = abs(shape.Geometry.zw - shape.Geometry.xy) * 0.5f;
+        }
+        else {
+            float2 delta = shape.Geometry.zw - shape.Geometry.xy;
+            float len = length(delta);
+            center = (shape.Geometry.xy + shape.Geometry.zw) * 0.5f;
+            halfExtents = float2(len * 0.5f, 0.0f);
+            if (len > 0.0f) { axis = delta / len; }
+        }
+
+        // Pad the quad to cover the stroke & a pixel of anti-aliasing
+        float halfThickness = shape.Thickness * 0.5f * PixelSize;
+        float2 local = vertexPos[vert] * (halfExtents + halfThickness + PixelSize);
+        world = center + (axis * local.x) + (float2(-axis.y, axis.x) * local.y);
+        output.Local = local;
+        output.Params = float4(halfExtents, halfThickness, PixelSize);
+    }
+
+    output.Position = mul(ViewProjectionMatrix, float4(world, shape.Depth, 1.0f));
+    output.Type = type;
+    output.Color = float4(shape.Color & 0xFF, (shape.Color >> 8) & 0xFF, (shape.Color >> 16) & 0xFF, shape.Color >> 24) / 255.0f;
+    return output;
+}
\ No newline at end of file
@@ -5,20 +5,36 @@ struct Input
 {
     float2 TexCoord : TEXCOORD0;
     float4 Color : TEXCOORD1;
+    float Additive : TEXCOORD2;
     float4 Position : SV_Position;
 };
 
 struct Output
 {
     float4 Color : SV_Target0;
-    float Depth : SV_Depth;
 };
 
+// Depth is left to the rasterizer, and only alpha tested sprites discard, so solid
+// sprites keep early depth testing and are rejected before they are shaded
 Output main(Input input) {
     Output result;
-    result.Color = input.Color * Texture.Sample(Sampler, input.TexCoord);
-    if (result.Color.a == 0.0f)
+#if defined(SOLID)
+    // Solid sprites have no transparent texels and an opaque tint, and are drawn without blending
+    result.Color = float4(input.Color.rgb * Texture.Sample(Sampler, input.TexCoord).rgb, 1.0f);
+#elif defined(PREMULTIPLIED_ALPHA)
+    // Texels are premultiplied, so the tint has to be as well. Additive sprites
+    // zero their output alpha so the ONE/ONE_MINUS_SRC_ALPHA blend adds them.
+    float4 texel = Texture.Sample(Sampler, input.TexCoord);
+    if (texel.a == 0.0f || input.Color.a == 0.0f)
         discard;
-    result.Depth = input.Position.z;
+    result.Color = texel * float4(input.Color.rgb * input.Color.a, input.Color.a);
+    result.Color.a *= (1.0f - input.Additive);
+#else
+    // Straight alpha texels are premultiplied here, so additive sprites blend the same way
+    float4 color = input.Color * Texture.Sample(Sampler, input.TexCoord);
+    if (color.a == 0.0f)
+        discard;
+    result.Color = float4(color.rgb * color.a, color.a * (1.0f - input.Additive));
+#endif
     return result;
 }
\ No newline at end of file
@@ -3,7 +3,8 @@ struct SpriteData
     float3 Position;
     float Rotation;
     float2 Size;
-    float2 _Padding;
+    float Additive;
+    float _Padding;
     float2 Scale;
     float2 Origin;
     float TexU, TexV, TexW, TexH;
@@ -14,6 +15,7 @@ struct Output
 {
     float2 Texcoord : TEXCOORD0;
     float4 Color : TEXCOORD1;
+    float Additive : TEXCOORD2;
     float4 Position : SV_Position;
 };
 
@@ -25,18 +27,69 @@ static const float2 vertexPos[4] = {
     { 1.0f, 1.0f }
 };
 
+#ifdef PACKED_SPRITE_DATA
+struct PackedSpriteData
+{
+    float3 Position;
+    uint RotationFlags;  // Rotation as a fraction of a turn in the low 16 bits, flags in the high 16
+    uint Size;           // Half precision width, height
+    uint Scale;          // Half precision x, y
+    uint Origin;         // Half precision x, y
+    uint Color;          // RGBA8
+    uint TexUV;          // 16 bit normalized u, v
+    uint TexWH;          // 16 bit normalized w, h
+};
+
+static const uint SPRITE_FLAG_ADDITIVE = 0x1;
+
+StructuredBuffer<PackedSpriteData> DataBuffer : register(t0, space0);
+
+SpriteData LoadSprite(uint index)
+{
+    PackedSpriteData packed = DataBuffer[index];
+    uint flags = packed.RotationFlags >> 16;
+    float2 texUV = float2(packed.TexUV & 0xFFFF, packed.TexUV >> 16) / 65535.0f;
+    float2 texWH = float2(packed.TexWH & 0xFFFF, packed.TexWH >> 16) / 65535.0f;
+
+    SpriteData sprite;
+    sprite.Position = packed.Position;
+    sprite.Rotation = float(packed.RotationFlags & 0xFFFF) * (6.28318530718f / 65536.0f);
+    sprite.Size = f16tof32(uint2(packed.Size, packed.Size >> 16));
+    sprite.Additive = (flags & SPRITE_FLAG_ADDITIVE) ? 1.0f : 0.0f;
+    sprite._Padding = 0.0f;
+    sprite.Scale = f16tof32(uint2(packed.Scale, packed.Scale >> 16));
+    sprite.Origin = f16tof32(uint2(packed.Origin, packed.Origin >> 16));
+    sprite.TexU = texUV.x;
+    sprite.TexV = texUV.y;
+    sprite.TexW = texWH.x;
+    sprite.TexH = texWH.y;
+    sprite.Color = float4(packed.Color & 0xFF, (packed.Color >> 8) & 0xFF, (packed.Color >> 16) & 0xFF, packed.Color >> 24) / 255.0f;
+    return sprite;
+}
+#else
 StructuredBuffer<SpriteData> DataBuffer : register(t0, space0);
 
+SpriteData LoadSprite(uint index)
+{
+    return DataBuffer[index];
+}
+#endif
+
+// Sprites a camera sees, as indices into the data buffer
+StructuredBuffer<uint> DrawIndexBuffer : register(t1, space0);
+
 cbuffer UniformBlock : register(b0, space1) 
 {
     float4x4 ViewProjectionMatrix : packoffset(c0);
+    uint BaseSprite : packoffset(c4.x);
+    uint Indexed : packoffset(c4.y);
 };
 
 Output main(uint id : SV_VertexID) 
 {
-    uint spriteIndex = id / 6;
+    uint spriteIndex = (Indexed != 0) ? DrawIndexBuffer[BaseSprite + (id / 6)] : BaseSprite + (id / 6);
     uint vert = triangleIndices[id % 6];
-    SpriteData sprite = DataBuffer[spriteIndex];
+    SpriteData sprite = LoadSprite(spriteIndex);
 
     float2 texcoord[4] = {
         { sprite.TexU, sprite.TexV },
@@ -63,6 +116,7 @@ Output main(uint id : SV_VertexID)
     output.Position = mul(ViewProjectionMatrix, float4(coordWithDepth, 1.0f));
     output.Texcoord = texcoord[vert];
     output.Color = sprite.Color;
+    output.Additive = sprite.Additive;
 
     return output;
 }
\ No newline at end of file
@@ -1,7 +1,7 @@
 #include <luna/detail/shader/shader_encoded.hpp>
 const ShaderInfo SpriteBatch_frag_hlsl = {
 	"SpriteBatch_frag_hlsl",
-	"VGV4dHVyZTJEPGZsb2F0ND4gVGV4dHVyZSA6IHJlZ2lzdGVyKHQwLCBzcGFjZTIpOwpTYW1wbGVyU3RhdGUgU2FtcGxlciA6IHJlZ2lzdGVyKHMwLCBzcGFjZTIpOwoKc3RydWN0IElucHV0IAp7CiAgICBmbG9hdDIgVGV4Q29vcmQgOiBURVhDT09SRDA7CiAgICBmbG9hdDQgQ29sb3IgOiBURVhDT09SRDE7CiAgICBmbG9hdDQgUG9zaXRpb24gOiBTVl9Qb3NpdGlvbjsKfTsKCnN0cnVjdCBPdXRwdXQKewogICAgZmxvYXQ0IENvbG9yIDogU1ZfVGFyZ2V0MDsKICAgIGZsb2F0IERlcHRoIDogU1ZfRGVwdGg7Cn07CgpPdXRwdXQgbWFpbihJbnB1dCBpbnB1dCkgewogICAgT3V0cHV0IHJlc3VsdDsKICAgIHJlc3VsdC5Db2xvciA9IGlucHV0LkNvbG9yICogVGV4dHVyZS5TYW1wbGUoU2FtcGxlciwgaW5wdXQuVGV4Q29vcmQpOwogICAgaWYgKHJlc3VsdC5Db2xvci5hID09IDAuMGYpCiAgICAgICAgZGlzY2FyZDsKICAgIHJlc3VsdC5EZXB0aCA9IGlucHV0LlBvc2l0aW9uLno7CiAgICByZXR1cm4gcmVzdWx0Owp9AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA=",
+	"VGV4dHVyZTJEPGZsb2F0ND4gVGV4dHVyZSA6IHJlZ2lzdGVyKHQwLCBzcGFjZTIpOwpTYW1wbGVyU3RhdGUgU2FtcGxlciA6IHJlZ2lzdGVyKHMwLCBzcGFjZTIpOwoKc3RydWN0IElucHV0IAp7CiAgICBmbG9hdDIgVGV4Q29vcmQgOiBURVhDT09SRDA7CiAgICBmbG9hdDQgQ29sb3IgOiBURVhDT09SRDE7CiAgICBmbG9hdCBBZGRpdGl2ZSA6IFRFWENPT1JEMjsKICAgIGZsb2F0NCBQb3NpdGlvbiA6IFNWX1Bvc2l0aW9uOwp9OwoKc3RydWN0IE91dHB1dAp7CiAgICBmbG9hdDQgQ29sb3IgOiBTVl9UYXJnZXQwOwp9OwoKLy8gRGVwdGggaXMgbGVmdCB0byB0aGUgcmFzdGVyaXplciwgYW5kIG9ubHkgYWxwaGEgdGVzdGVkIHNwcml0ZXMgZGlzY2FyZCwgc28gc29saWQKLy8gc3ByaXRlcyBrZWVwIGVhcmx5IGRlcHRoIHRlc3RpbmcgYW5kIGFyZSByZWplY3RlZCBiZWZvcmUgdGhleSBhcmUgc2hhZGVkCk91dHB1dCBtYWluKElucHV0IGlucHV0KSB7CiAgICBPdXRwdXQgcmVzdWx0OwojaWYgZGVmaW5lZChTT0xJRCkKICAgIC8vIFNvbGlkIHNwcml0ZXMgaGF2ZSBubyB0cmFuc3BhcmVudCB0ZXhlbHMgYW5kIGFuIG9wYXF1ZSB0aW50LCBhbmQgYXJlIGRyYXduIHdpdGhvdXQgYmxlbmRpbmcKICAgIHJlc3VsdC5Db2xvciA9IGZsb2F0NChpbnB1dC5Db2xvci5yZ2IgKiBUZXh0dXJlLlNhbXBsZShTYW1wbGVyLCBpbnB1dC5UZXhDb29yZCkucmdiLCAxLjBmKTsKI2VsaWYgZGVmaW5lZChQUkVNVUxUSVBMSUVEX0FMUEhBKQogICAgLy8gVGV4ZWxzIGFyZSBwcmVtdWx0aXBsaWVkLCBzbyB0aGUgdGludCBoYXMgdG8gYmUgYXMgd2VsbC4gQWRkaXRpdmUgc3ByaXRlcwogICAgLy8gemVybyB0aGVpciBvdXRwdXQgYWxwaGEgc28gdGhlIE9ORS9PTkVfTUlOVVNfU1JDX0FMUEhBIGJsZW5kIGFkZHMgdGhlbS4KICAgIGZsb2F0NCB0ZXhlbCA9IFRleHR1cmUuU2FtcGxlKFNhbXBsZXIsIGlucHV0LlRleENvb3JkKTsKICAgIGlmICh0ZXhlbC5hID09IDAuMGYgfHwgaW5wdXQuQ29sb3IuYSA9PSAwLjBmKQogICAgICAgIGRpc2NhcmQ7CiAgICByZXN1bHQuQ29sb3IgPSB0ZXhlbCAqIGZsb2F0NChpbnB1dC5Db2xvci5yZ2IgKiBpbnB1dC5Db2xvci5hLCBpbnB1dC5Db2xvci5hKTsKICAgIHJlc3VsdC5Db2xvci5hICo9ICgxLjBmIC0gaW5wdXQuQWRkaXRpdmUpOwojZWxzZQogICAgLy8gU3RyYWlnaHQgYWxwaGEgdGV4ZWxzIGFyZSBwcmVtdWx0aXBsaWVkIGhlcmUsIHNvIGFkZGl0aXZlIHNwcml0ZXMgYmxlbmQgdGhlIHNhbWUgd2F5CiAgICBmbG9hdDQgY29sb3IgPSBpbnB1dC5Db2xvciAqIFRleHR1cmUuU2FtcGxlKFNhbXBsZXIsIGlucHV0LlRleENvb3JkKTsKICAgIGlmIChjb2xvci5hID09IDAuMGYpCiAgICAgICAgZGlzY2FyZDsKICAgIHJlc3VsdC5Db2xvciA9IGZsb2F0NChjb2xvci5yZ2IgKiBjb2xvci5hLCBjb2xvci5hICogKDEuMGYgLSBpbnB1dC5BZGRpdGl2ZSkpOwojZW5kaWYKICAgIHJldHVybiByZXN1bHQ7Cn0AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA=",
 	1,
 	0,
 	0,
@@ -9,7 +9,15 @@ const ShaderInfo SpriteBatch_frag_hlsl = {
 };
 const ShaderInfo PrimitiveBatch_frag_hlsl = {
 	"PrimitiveBatch_frag_hlsl",
-	"c3RydWN0IElucHV0IAp7CiAgICBmbG9hdDQgUG9zaXRpb24gOiBTVl9Qb3NpdGlvbjsKICAgIGZsb2F0NCBDb2xvciA6IFRFWENPT1JEMDsKfTsKCnN0cnVjdCBPdXRwdXQKewogICAgZmxvYXQ0IENvbG9yIDogU1ZfVGFyZ2V0MDsKICAgIGZsb2F0IERlcHRoIDogU1ZfRGVwdGg7Cn07CgpPdXRwdXQgbWFpbihJbnB1dCBpbnB1dCkgewogICAgT3V0cHV0IHJlc3VsdDsKICAgIHJlc3VsdC5Db2xvciA9IGlucHV0LkNvbG9yOwogICAgaWYgKHJlc3VsdC5Db2xvci5hID09IDAuMGYpCiAgICAgICAgZGlzY2FyZDsKICAgIHJlc3VsdC5EZXB0aCA9IGlucHV0LlBvc2l0aW9uLno7CiAgICByZXR1cm4gcmVzdWx0Owp9AAAAAAAAAAAAAAAAAAAAAAAAAA==",
+	"c3RydWN0IElucHV0IAp7CiAgICBmbG9hdDQgUG9zaXRpb24gOiBTVl9Qb3NpdGlvbjsKICAgIGZsb2F0NCBDb2xvciA6IFRFWENPT1JEMDsKfTsKCnN0cnVjdCBPdXRwdXQKewogICAgZmxvYXQ0IENvbG9yIDogU1ZfVGFyZ2V0MDsKfTsKCk91dHB1dCBtYWluKElucHV0IGlucHV0KSB7CiAgICBPdXRwdXQgcmVzdWx0OwogICAgcmVzdWx0LkNvbG9yID0gaW5wdXQuQ29sb3I7CiAgICBpZiAocmVzdWx0LkNvbG9yLmEgPT0gMC4wZikKICAgICAgICBkaXNjYXJkOwogICAgcmV0dXJuIHJlc3VsdDsKfQAAAAAAAAAAAAAAAAAAAAAA",
+	0,
+	0,
+	0,
+	0
+};
+const ShaderInfo ShapeBatch_frag_hlsl = {
+	"ShapeBatch_frag_hlsl",
+	"c3RydWN0IElucHV0CnsKICAgIGZsb2F0MiBMb2NhbCA6IFRFWENPT1JEMDsgICAgICAgICAvLyBQb3NpdGlvbiByZWxhdGl2ZSB0byB0aGUgc2hhcGUncyBjZW50ZXIsIG9yIGFsb25nICYgYWNyb3NzIGEgc2VnbWVudAogICAgZmxvYXQ0IFBhcmFtcyA6IFRFWENPT1JEMTsgICAgICAgIC8vIEhhbGYgZXh0ZW50cyBvciBzZWdtZW50IGxlbmd0aCwgaGFsZiBzdHJva2UgdGhpY2tuZXNzLCBzaXplIG9mIGEgcGl4ZWwKICAgIG5vaW50ZXJwb2xhdGlvbiB1aW50IFR5cGUgOiBURVhDT09SRDI7CiAgICBmbG9hdDQgQ29sb3IgOiBURVhDT09SRDM7CiAgICBub2ludGVycG9sYXRpb24gZmxvYXQ0IFN0YXJ0RW5kIDogVEVYQ09PUkQ0OyAgLy8gU2VnbWVudCBlbmQgc3R5bGUsIGJpc2VjdG9yICYgYmV2ZWwgZGlzdGFuY2UKICAgIG5vaW50ZXJwb2xhdGlvbiBmbG9hdDQgRW5kRW5kIDogVEVYQ09PUkQ1OwogICAgZmxvYXQ0IFBvc2l0aW9uIDogU1ZfUG9zaXRpb247Cn07CgpzdHJ1Y3QgT3V0cHV0CnsKICAgIGZsb2F0NCBDb2xvciA6IFNWX1RhcmdldDA7Cn07CgpzdGF0aWMgY29uc3QgdWludCBTSEFQRV9DSVJDTEUgPSAwOwpzdGF0aWMgY29uc3QgdWludCBTSEFQRV9BQUJCID0gMTsKc3RhdGljIGNvbnN0IHVpbnQgU0hBUEVfTElORSA9IDI7CnN0YXRpYyBjb25zdCB1aW50IFNIQVBFX1NFR01FTlQgPSAzOwoKc3RhdGljIGNvbnN0IHVpbnQgRU5EX0JVVFQgPSAwOwpzdGF0aWMgY29uc3QgdWludCBFTkRfU1FVQVJFID0gMTsKc3RhdGljIGNvbnN0IHVpbnQgRU5EX1JPVU5EID0gMjsKc3RhdGljIGNvbnN0IHVpbnQgRU5EX01JVEVSID0gMzsKc3RhdGljIGNvbnN0IHVpbnQgRU5EX0JFVkVMID0gNDsKCi8vIERpc3RhbmNlIHBhc3Qgb25lIGVuZCBvZiBhIHNlZ21lbnQsIHdoZXJlIHAgaXMgbWVhc3VyZWQgb3V0IGZyb20gdGhlIGVuZCBhbG9uZyB0aGUgc2VnbWVudCAmIGFjcm9zcyBpdApmbG9hdCBTZWdtZW50RW5kRGlzdGFuY2UoZmxvYXQ0IGVuZCwgZmxvYXQyIHAsIGZsb2F0IGhhbGZXaWR0aCwgZmxvYXQgZCkKewogICAgdWludCBzdHlsZSA9IHVpbnQoZW5kLngpOwogICAgaWYgKHN0eWxlID09IEVORF9CVVRUKQogICAgICAgIHJldHVybiBtYXgoZCwgcC54KTsKICAgIGlmIChzdHlsZSA9PSBFTkRfU1FVQVJFKQogICAgICAgIHJldHVybiBtYXgoZCwgcC54IC0gaGFsZldpZHRoKTsKICAgIGlmIChzdHlsZSA9PSBFTkRfUk9VTkQpCiAgICAgICAgcmV0dXJuIGxlbmd0aChwKSAtIGhhbGZXaWR0aDsKICAgIGlmIChzdHlsZSA9PSBFTkRfQkVWRUwpCiAgICAgICAgcmV0dXJuIG1heChtYXgoZCwgcC54IC0gaGFsZldpZHRoKSwgYWJzKGRvdChwLCBlbmQueXopKSAtIGVuZC53KTsKICAgIHJldHVybiBkOwp9CgpPdXRwdXQgbWFpbihJbnB1dCBpbnB1dCkgewogICAgLy8gU2lnbmVkIGRpc3RhbmNlIHRvIHRoZSBzaGFwZSdzIGVkZ2UsIG5lZ2F0aXZlIGluc2lkZQogICAgZmxvYXQyIGhhbGZFeHRlbnRzID0gaW5wdXQuUGFyYW1zLnh5OwogICAgZmxvYXQgaGFsZlRoaWNrbmVzcyA9IGlucHV0LlBhcmFtcy56OwogICAgZmxvYXQgZDsKICAgIGlmIChpbnB1dC5UeXBlID09IFNIQVBFX0NJUkNMRSkgewogICAgICAgIGQgPSBsZW5ndGgoaW5wdXQuTG9jYWwpIC0gaGFsZkV4dGVudHMueDsKICAgIH0KICAgIGVsc2UgaWYgKGlucHV0LlR5cGUgPT0gU0hBUEVfQUFCQikgewogICAgICAgIGZsb2F0MiBxID0gYWJzKGlucHV0LkxvY2FsKSAtIGhhbGZFeHRlbnRzOwogICAgICAgIGQgPSBsZW5ndGgobWF4KHEsIDAuMGYpKSArIG1pbihtYXgocS54LCBxLnkpLCAwLjBmKTsKICAgIH0KICAgIGVsc2UgaWYgKGlucHV0LlR5cGUgPT0gU0hBUEVfTElORSkgewogICAgICAgIGQgPSBsZW5ndGgoZmxvYXQyKG1heChhYnMoaW5wdXQuTG9jYWwueCkgLSBoYWxmRXh0ZW50cy54LCAwLjBmKSwgaW5wdXQuTG9jYWwueSkpIC0gaGFsZlRoaWNrbmVzczsKICAgIH0KICAgIGVsc2UgewogICAgICAgIC8vIFNlZ21lbnRzIGFyZSBhIGJhbmQgYWNyb3NzIHRoZWlyIGxlbmd0aCwgZmluaXNoZWQgYXQgZWFjaCBlbmQgYnkgYSBjYXAgb3Igam9pbgogICAgICAgIGZsb2F0IGxlbiA9IGhhbGZFeHRlbnRzLng7CiAgICAgICAgZCA9IGFicyhpbnB1dC5Mb2NhbC55KSAtIGhhbGZUaGlja25lc3M7CiAgICAgICAgaWYgKGlucHV0LkxvY2FsLnggPCAwLjBmKQogICAgICAgICAgICBkID0gU2VnbWVudEVuZERpc3RhbmNlKGlucHV0LlN0YXJ0RW5kLCBmbG9hdDIoLWlucHV0LkxvY2FsLngsIGlucHV0LkxvY2FsLnkpLCBoYWxmVGhpY2tuZXNzLCBkKTsKICAgICAgICBlbHNlIGlmIChpbnB1dC5Mb2NhbC54ID4gbGVuKQogICAgICAgICAgICBkID0gU2VnbWVudEVuZERpc3RhbmNlKGlucHV0LkVuZEVuZCwgZmxvYXQyKGlucHV0LkxvY2FsLnggLSBsZW4sIGlucHV0LkxvY2FsLnkpLCBoYWxmVGhpY2tuZXNzLCBkKTsKICAgIH0KCiAgICAvLyBPdXRsaW5lcyBrZWVwIGEgYmFuZCBvZiB0aGUgc3Ryb2tlJ3MgdGhpY2tuZXNzIGp1c3QgaW5zaWRlIHRoZSBlZGdlCiAgICBpZiAoKGlucHV0LlR5cGUgPT0gU0hBUEVfQ0lSQ0xFIHx8IGlucHV0LlR5cGUgPT0gU0hBUEVfQUFCQikgJiYgaGFsZlRoaWNrbmVzcyA+IDAuMGYpIHsKICAgICAgICBkID0gYWJzKGQgKyBoYWxmVGhpY2tuZXNzKSAtIGhhbGZUaGlja25lc3M7CiAgICB9CgogICAgLy8gQ292ZXIgYnkgaG93IGZhciB0aGUgcGl4ZWwgaXMgZnJvbSB0aGUgZWRnZQogICAgZmxvYXQgY292ZXJhZ2UgPSBzYXR1cmF0ZSgwLjVmIC0gKGQgLyBpbnB1dC5QYXJhbXMudykpOwogICAgaWYgKGNvdmVyYWdlID09IDAuMGYgfHwgaW5wdXQuQ29sb3IuYSA9PSAwLjBmKQogICAgICAgIGRpc2NhcmQ7CgogICAgT3V0cHV0IHJlc3VsdDsKICAgIHJlc3VsdC5Db2xvciA9IGZsb2F0NChpbnB1dC5Db2xvci5yZ2IsIGlucHV0LkNvbG9yLmEgKiBjb3ZlcmFnZSk7CiAgICByZXR1cm4gcmVzdWx0Owp9AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA=",
 	0,
 	0,
 	0,
@@ -17,17 +25,25 @@ const ShaderInfo PrimitiveBatch_frag_hlsl = {
 };
 const ShaderInfo SpriteBatch_vert_hlsl = {
 	"SpriteBatch_vert_hlsl",
-	"c3RydWN0IFNwcml0ZURhdGEgCnsKICAgIGZsb2F0MyBQb3NpdGlvbjsKICAgIGZsb2F0IFJvdGF0aW9uOwogICAgZmxvYXQyIFNpemU7CiAgICBmbG9hdDIgX1BhZGRpbmc7CiAgICBmbG9hdDIgU2NhbGU7CiAgICBmbG9hdDIgT3JpZ2luOwogICAgZmxvYXQgVGV4VSwgVGV4ViwgVGV4VywgVGV4SDsKICAgIGZsb2F0NCBDb2xvcjsKfTsKCnN0cnVjdCBPdXRwdXQgCnsKICAgIGZsb2F0MiBUZXhjb29yZCA6IFRFWENPT1JEMDsKICAgIGZsb2F0NCBDb2xvciA6IFRFWENPT1JEMTsKICAgIGZsb2F0NCBQb3NpdGlvbiA6IFNWX1Bvc2l0aW9uOwp9OwoKc3RhdGljIGNvbnN0IHVpbnQgdHJpYW5nbGVJbmRpY2VzWzZdID0geyAwLCAxLCAyLCAzLCAyLCAxIH07CnN0YXRpYyBjb25zdCBmbG9hdDIgdmVydGV4UG9zWzRdID0gewogICAgeyAwLjBmLCAwLjBmIH0sCiAgICB7IDEuMGYsIDAuMGYgfSwKICAgIHsgMC4wZiwgMS4wZiB9LAogICAgeyAxLjBmLCAxLjBmIH0KfTsKClN0cnVjdHVyZWRCdWZmZXI8U3ByaXRlRGF0YT4gRGF0YUJ1ZmZlciA6IHJlZ2lzdGVyKHQwLCBzcGFjZTApOwoKY2J1ZmZlciBVbmlmb3JtQmxvY2sgOiByZWdpc3RlcihiMCwgc3BhY2UxKSAKewogICAgZmxvYXQ0eDQgVmlld1Byb2plY3Rpb25NYXRyaXggOiBwYWNrb2Zmc2V0KGMwKTsKfTsKCk91dHB1dCBtYWluKHVpbnQgaWQgOiBTVl9WZXJ0ZXhJRCkgCnsKICAgIHVpbnQgc3ByaXRlSW5kZXggPSBpZCAvIDY7CiAgICB1aW50IHZlcnQgPSB0cmlhbmdsZUluZGljZXNbaWQgJSA2XTsKICAgIFNwcml0ZURhdGEgc3ByaXRlID0gRGF0YUJ1ZmZlcltzcHJpdGVJbmRleF07CgogICAgZmxvYXQyIHRleGNvb3JkWzRdID0gewogICAgICAgIHsgc3ByaXRlLlRleFUsIHNwcml0ZS5UZXhWIH0sCiAgICAgICAgeyBzcHJpdGUuVGV4VSArIHNwcml0ZS5UZXhXLCBzcHJpdGUuVGV4ViB9LAogICAgICAgIHsgc3ByaXRlLlRleFUsIHNwcml0ZS5UZXhWICsgc3ByaXRlLlRleEggfSwKICAgICAgICB7IHNwcml0ZS5UZXhVICsgc3ByaXRlLlRleFcsIHNwcml0ZS5UZXhWICsgc3ByaXRlLlRleEggfQogICAgfTsKCiAgICBmbG9hdCBjID0gY29zKHNwcml0ZS5Sb3RhdGlvbik7CiAgICBmbG9hdCBzID0gc2luKHNwcml0ZS5Sb3RhdGlvbik7CgogICAgZmxvYXQyIGNvb3JkID0gdmVydGV4UG9zW3ZlcnRdOwogICAgY29vcmQgLT0gc3ByaXRlLk9yaWdpbiAvIHNwcml0ZS5TaXplOwogICAgY29vcmQgKj0gc3ByaXRlLlNpemU7CiAgICBjb29yZCAqPSBzcHJpdGUuU2NhbGU7CiAgICBmbG9hdDJ4MiByb3RhdGlvbiA9IHsgYywgcywgLXMsIGMgfTsKICAgIGNvb3JkID0gbXVsKGNvb3JkLCByb3RhdGlvbik7CiAgICBjb29yZCArPSBzcHJpdGUuT3JpZ2luIC8gc3ByaXRlLlNpemU7CgogICAgZmxvYXQzIGNvb3JkV2l0aERlcHRoID0gZmxvYXQzKGNvb3JkICsgc3ByaXRlLlBvc2l0aW9uLnh5LCBzcHJpdGUuUG9zaXRpb24ueik7CgogICAgT3V0cHV0IG91dHB1dDsKICAgIAogICAgb3V0cHV0LlBvc2l0aW9uID0gbXVsKFZpZXdQcm9qZWN0aW9uTWF0cml4LCBmbG9hdDQoY29vcmRXaXRoRGVwdGgsIDEuMGYpKTsKICAgIG91dHB1dC5UZXhjb29yZCA9IHRleGNvb3JkW3ZlcnRdOwogICAgb3V0cHV0LkNvbG9yID0gc3ByaXRlLkNvbG9yOwoKICAgIHJldHVybiBvdXRwdXQ7Cn0AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA",
+	"c3RydWN0IFNwcml0ZURhdGEgCnsKICAgIGZsb2F0MyBQb3NpdGlvbjsKICAgIGZsb2F0IFJvdGF0aW9uOwogICAgZmxvYXQyIFNpemU7CiAgICBmbG9hdCBBZGRpdGl2ZTsKICAgIGZsb2F0IF9QYWRkaW5nOwogICAgZmxvYXQyIFNjYWxlOwogICAgZmxvYXQyIE9yaWdpbjsKICAgIGZsb2F0IFRleFUsIFRleFYsIFRleFcsIFRleEg7CiAgICBmbG9hdDQgQ29sb3I7Cn07CgpzdHJ1Y3QgT3V0cHV0IAp7CiAgICBmbG9hdDIgVGV4Y29vcmQgOiBURVhDT09SRDA7CiAgICBmbG9hdDQgQ29sb3IgOiBURVhDT09SRDE7CiAgICBmbG9hdCBBZGRpdGl2ZSA6IFRFWENPT1JEMjsKICAgIGZsb2F0NCBQb3NpdGlvbiA6IFNWX1Bvc2l0aW9uOwp9OwoKc3RhdGljIGNvbnN0IHVpbnQgdHJpYW5nbGVJbmRpY2VzWzZdID0geyAwLCAxLCAyLCAzLCAyLCAxIH07CnN0YXRpYyBjb25zdCBmbG9hdDIgdmVydGV4UG9zWzRdID0gewogICAgeyAwLjBmLCAwLjBmIH0sCiAgICB7IDEuMGYsIDAuMGYgfSwKICAgIHsgMC4wZiwgMS4wZiB9LAogICAgeyAxLjBmLCAxLjBmIH0KfTsKCiNpZmRlZiBQQUNLRURfU1BSSVRFX0RBVEEKc3RydWN0IFBhY2tlZFNwcml0ZURhdGEKewogICAgZmxvYXQzIFBvc2l0aW9uOwogICAgdWludCBSb3RhdGlvbkZsYWdzOyAgLy8gUm90YXRpb24gYXMgYSBmcmFjdGlvbiBvZiBhIHR1cm4gaW4gdGhlIGxvdyAxNiBiaXRzLCBmbGFncyBpbiB0aGUgaGlnaCAxNgogICAgdWludCBTaXplOyAgICAgICAgICAgLy8gSGFsZiBwcmVjaXNpb24gd2lkdGgsIGhlaWdodAogICAgdWludCBTY2FsZTsgICAgICAgICAgLy8gSGFsZiBwcmVjaXNpb24geCwgeQogICAgdWludCBPcmlnaW47ICAgICAgICAgLy8gSGFsZiBwcmVjaXNpb24geCwgeQogICAgdWludCBDb2xvcjsgICAgICAgICAgLy8gUkdCQTgKICAgIHVpbnQgVGV4VVY7ICAgICAgICAgIC8vIDE2IGJpdCBub3JtYWxpemVkIHUsIHYKICAgIHVpbnQgVGV4V0g7ICAgICAgICAgIC8vIDE2IGJpdCBub3JtYWxpemVkIHcsIGgKfTsKCnN0YXRpYyBjb25zdCB1aW50IFNQUklURV9GTEFHX0FERElUSVZFID0gMHgxOwoKU3RydWN0dXJlZEJ1ZmZlcjxQYWNrZWRTcHJpdGVEYXRhPiBEYXRhQnVmZmVyIDogcmVnaXN0ZXIodDAsIHNwYWNlMCk7CgpTcHJpdGVEYXRhIExvYWRTcHJpdGUodWludCBpbmRleCkKewogICAgUGFja2VkU3ByaXRlRGF0YSBwYWNrZWQgPSBEYXRhQnVmZmVyW2luZGV4XTsKICAgIHVpbnQgZmxhZ3MgPSBwYWNrZWQuUm90YXRpb25GbGFncyA+PiAxNjsKICAgIGZsb2F0MiB0ZXhVViA9IGZsb2F0MihwYWNrZWQuVGV4VVYgJiAweEZGRkYsIHBhY2tlZC5UZXhVViA+PiAxNikgLyA2NTUzNS4wZjsKICAgIGZsb2F0MiB0ZXhXSCA9IGZsb2F0MihwYWNrZWQuVGV4V0ggJiAweEZGRkYsIHBhY2tlZC5UZXhXSCA+PiAxNikgLyA2NTUzNS4wZjsKCiAgICBTcHJpdGVEYXRhIHNwcml0ZTsKICAgIHNwcml0ZS5Qb3NpdGlvbiA9IHBhY2tlZC5Qb3NpdGlvbjsKICAgIHNwcml0ZS5Sb3RhdGlvbiA9IGZsb2F0KHBhY2tlZC5Sb3RhdGlvbkZsYWdzICYgMHhGRkZGKSAqICg2LjI4MzE4NTMwNzE4ZiAvIDY1NTM2LjBmKTsKICAgIHNwcml0ZS5TaXplID0gZjE2dG9mMzIodWludDIocGFja2VkLlNpemUsIHBhY2tlZC5TaXplID4+IDE2KSk7CiAgICBzcHJpdGUuQWRkaXRpdmUgPSAoZmxhZ3MgJiBTUFJJVEVfRkxBR19BRERJVElWRSkgPyAxLjBmIDogMC4wZjsKICAgIHNwcml0ZS5fUGFkZGluZyA9IDAuMGY7CiAgICBzcHJpdGUuU2NhbGUgPSBmMTZ0b2YzMih1aW50MihwYWNrZWQuU2NhbGUsIHBhY2tlZC5TY2FsZSA+PiAxNikpOwogICAgc3ByaXRlLk9yaWdpbiA9IGYxNnRvZjMyKHVpbnQyKHBhY2tlZC5PcmlnaW4sIHBhY2tlZC5PcmlnaW4gPj4gMTYpKTsKICAgIHNwcml0ZS5UZXhVID0gdGV4VVYueDsKICAgIHNwcml0ZS5UZXhWID0gdGV4VVYueTsKICAgIHNwcml0ZS5UZXhXID0gdGV4V0gueDsKICAgIHNwcml0ZS5UZXhIID0gdGV4V0gueTsKICAgIHNwcml0ZS5Db2xvciA9IGZsb2F0NChwYWNrZWQuQ29sb3IgJiAweEZGLCAocGFja2VkLkNvbG9yID4+IDgpICYgMHhGRiwgKHBhY2tlZC5Db2xvciA+PiAxNikgJiAweEZGLCBwYWNrZWQuQ29sb3IgPj4gMjQpIC8gMjU1LjBmOwogICAgcmV0dXJuIHNwcml0ZTsKfQojZWxzZQpTdHJ1Y3R1cmVkQnVmZmVyPFNwcml0ZURhdGE+IERhdGFCdWZmZXIgOiByZWdpc3Rlcih0MCwgc3BhY2UwKTsKClNwcml0ZURhdGEgTG9hZFNwcml0ZSh1aW50IGluZGV4KQp7CiAgICByZXR1cm4gRGF0YUJ1ZmZlcltpbmRleF07Cn0KI2VuZGlmCgovLyBTcHJpdGVzIGEgY2FtZXJhIHNlZXMsIGFzIGluZGljZXMgaW50byB0aGUgZGF0YSBidWZmZXIKU3RydWN0dXJlZEJ1ZmZlcjx1aW50PiBEcmF3SW5kZXhCdWZmZXIgOiByZWdpc3Rlcih0MSwgc3BhY2UwKTsKCmNidWZmZXIgVW5pZm9ybUJsb2NrIDogcmVnaXN0ZXIoYjAsIHNwYWNlMSkgCnsKICAgIGZsb2F0NHg0IFZpZXdQcm9qZWN0aW9uTWF0cml4IDogcGFja29mZnNldChjMCk7CiAgICB1aW50IEJhc2VTcHJpdGUgOiBwYWNrb2Zmc2V0KGM0LngpOwogICAgdWludCBJbmRleGVkIDogcGFja29mZnNldChjNC55KTsKfTsKCk91dHB1dCBtYWluKHVpbnQgaWQgOiBTVl9WZXJ0ZXhJRCkgCnsKICAgIHVpbnQgc3ByaXRlSW5kZXggPSAoSW5kZXhlZCAhPSAwKSA/IERyYXdJbmRleEJ1ZmZlcltCYXNlU3ByaXRlICsgKGlkIC8gNildIDogQmFzZVNwcml0ZSArIChpZCAvIDYpOwogICAgdWludCB2ZXJ0ID0gdHJpYW5nbGVJbmRpY2VzW2lkICUgNl07CiAgICBTcHJpdGVEYXRhIHNwcml0ZSA9IExvYWRTcHJpdGUoc3ByaXRlSW5kZXgpOwoKICAgIGZsb2F0MiB0ZXhjb29yZFs0XSA9IHsKICAgICAgICB7IHNwcml0ZS5UZXhVLCBzcHJpdGUuVGV4ViB9LAogICAgICAgIHsgc3ByaXRlLlRleFUgKyBzcHJpdGUuVGV4Vywgc3ByaXRlLlRleFYgfSwKICAgICAgICB7IHNwcml0ZS5UZXhVLCBzcHJpdGUuVGV4ViArIHNwcml0ZS5UZXhIIH0sCiAgICAgICAgeyBzcHJpdGUuVGV4VSArIHNwcml0ZS5UZXhXLCBzcHJpdGUuVGV4ViArIHNwcml0ZS5UZXhIIH0KICAgIH07CgogICAgZmxvYXQgYyA9IGNvcyhzcHJpdGUuUm90YXRpb24pOwogICAgZmxvYXQgcyA9IHNpbihzcHJpdGUuUm90YXRpb24pOwoKICAgIGZsb2F0MiBjb29yZCA9IHZlcnRleFBvc1t2ZXJ0XTsKICAgIGNvb3JkIC09IHNwcml0ZS5PcmlnaW4gLyBzcHJpdGUuU2l6ZTsKICAgIGNvb3JkICo9IHNwcml0ZS5TaXplOwogICAgY29vcmQgKj0gc3ByaXRlLlNjYWxlOwogICAgZmxvYXQyeDIgcm90YXRpb24gPSB7IGMsIHMsIC1zLCBjIH07CiAgICBjb29yZCA9IG11bChjb29yZCwgcm90YXRpb24pOwogICAgY29vcmQgKz0gc3ByaXRlLk9yaWdpbiAvIHNwcml0ZS5TaXplOwoKICAgIGZsb2F0MyBjb29yZFdpdGhEZXB0aCA9IGZsb2F0Myhjb29yZCArIHNwcml0ZS5Qb3NpdGlvbi54eSwgc3ByaXRlLlBvc2l0aW9uLnopOwoKICAgIE91dHB1dCBvdXRwdXQ7CiAgICAKICAgIG91dHB1dC5Qb3NpdGlvbiA9IG11bChWaWV3UHJvamVjdGlvbk1hdHJpeCwgZmxvYXQ0KGNvb3JkV2l0aERlcHRoLCAxLjBmKSk7CiAgICBvdXRwdXQuVGV4Y29vcmQgPSB0ZXhjb29yZFt2ZXJ0XTsKICAgIG91dHB1dC5Db2xvciA9IHNwcml0ZS5Db2xvcjsKICAgIG91dHB1dC5BZGRpdGl2ZSA9IHNwcml0ZS5BZGRpdGl2ZTsKCiAgICByZXR1cm4gb3V0cHV0Owp9AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA==",
 	0,
 	0,
-	1,
+	2,
 	1
 };
 const ShaderInfo PrimitiveBatch_vert_hlsl = {
 	"PrimitiveBatch_vert_hlsl",
-	"c3RydWN0IElucHV0IAp7CiAgICBmbG9hdDMgUG9zaXRpb24gOiBTVl9Qb3NpdGlvbjsKICAgIGZsb2F0NCBDb2xvciA6IFRFWENPT1JEMDsKfTsKCnN0cnVjdCBPdXRwdXQgCnsKICAgIGZsb2F0NCBQb3NpdGlvbiA6IFNWX1Bvc2l0aW9uOwogICAgZmxvYXQ0IENvbG9yIDogVEVYQ09PUkQwOwp9OwoKY2J1ZmZlciBVbmlmb3JtQmxvY2sgOiByZWdpc3RlcihiMCwgc3BhY2UxKSAKewogICAgZmxvYXQ0eDQgVmlld1Byb2plY3Rpb25NYXRyaXggOiBwYWNrb2Zmc2V0KGMwKTsKfTsKCk91dHB1dCBtYWluKGluIElucHV0IGlucHV0KQp7CiAgICBPdXRwdXQgb3V0cHV0OwogICAgb3V0cHV0LkNvbG9yID0gaW5wdXQuQ29sb3I7CiAgICBvdXRwdXQuUG9zaXRpb24gPSBtdWwoVmlld1Byb2plY3Rpb25NYXRyaXgsIGZsb2F0NChpbnB1dC5Qb3NpdGlvbiwgMS4wZikpOwogICAgcmV0dXJuIG91dHB1dDsKfQAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA",
+	"c3RydWN0IElucHV0IAp7CiAgICBmbG9hdDMgUG9zaXRpb24gOiBTVl9Qb3NpdGlvbjsKICAgIGZsb2F0NCBDb2xvciA6IFRFWENPT1JEMDsgIC8vIEVpdGhlciBmb3VyIGZsb2F0cywgb3IgUkdCQTggbm9ybWFsaXplZCBieSB0aGUgaW5wdXQgYXNzZW1ibGVyCn07CgpzdHJ1Y3QgT3V0cHV0IAp7CiAgICBmbG9hdDQgUG9zaXRpb24gOiBTVl9Qb3NpdGlvbjsKICAgIGZsb2F0NCBDb2xvciA6IFRFWENPT1JEMDsKfTsKCmNidWZmZXIgVW5pZm9ybUJsb2NrIDogcmVnaXN0ZXIoYjAsIHNwYWNlMSkgCnsKICAgIGZsb2F0NHg0IFZpZXdQcm9qZWN0aW9uTWF0cml4IDogcGFja29mZnNldChjMCk7Cn07CgpPdXRwdXQgbWFpbihpbiBJbnB1dCBpbnB1dCkKewogICAgT3V0cHV0IG91dHB1dDsKICAgIG91dHB1dC5Db2xvciA9IGlucHV0LkNvbG9yOwogICAgb3V0cHV0LlBvc2l0aW9uID0gbXVsKFZpZXdQcm9qZWN0aW9uTWF0cml4LCBmbG9hdDQoaW5wdXQuUG9zaXRpb24sIDEuMGYpKTsKICAgIHJldHVybiBvdXRwdXQ7Cn0AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA==",
+	0,
+	0,
 	0,
+	1
+};
+const ShaderInfo ShapeBatch_vert_hlsl = {
+	"ShapeBatch_vert_hlsl",
+	"c3RydWN0IFNoYXBlRGF0YQp7CiAgICBmbG9hdDQgR2VvbWV0cnk7ICAgLy8gQ2lyY2xlOiB4LCB5LCByYWRpdXMgfCBBQUJCOiBsZWZ0LCB0b3AsIHJpZ2h0LCBib3R0b20gfCBMaW5lICYgc2VnbWVudDogeDEsIHkxLCB4MiwgeTIKICAgIGZsb2F0IERlcHRoOwogICAgZmxvYXQgVGhpY2tuZXNzOyAgIC8vIE91dGxpbmUgb3IgbGluZSB3aWR0aCBpbiBwaXhlbHMsIHNlZ21lbnQgd2lkdGggaW4gd29ybGQgdW5pdHMsIDAgZm9yIGZpbGxlZCBzaGFwZXMKICAgIHVpbnQgVHlwZTsgICAgICAgICAvLyBTaGFwZSB0eXBlLCB0aGVuIHNlZ21lbnQgZW5kIHN0eWxlcyAmIHdyYXBwaW5nCiAgICB1aW50IENvbG9yOyAgICAgICAgLy8gUkdCQTgKfTsKCnN0cnVjdCBPdXRwdXQKewogICAgZmxvYXQyIExvY2FsIDogVEVYQ09PUkQwOwogICAgZmxvYXQ0IFBhcmFtcyA6IFRFWENPT1JEMTsKICAgIG5vaW50ZXJwb2xhdGlvbiB1aW50IFR5cGUgOiBURVhDT09SRDI7CiAgICBmbG9hdDQgQ29sb3IgOiBURVhDT09SRDM7CiAgICBub2ludGVycG9sYXRpb24gZmxvYXQ0IFN0YXJ0RW5kIDogVEVYQ09PUkQ0OwogICAgbm9pbnRlcnBvbGF0aW9uIGZsb2F0NCBFbmRFbmQgOiBURVhDT09SRDU7CiAgICBmbG9hdDQgUG9zaXRpb24gOiBTVl9Qb3NpdGlvbjsKfTsKCnN0YXRpYyBjb25zdCB1aW50IFNIQVBFX0NJUkNMRSA9IDA7CnN0YXRpYyBjb25zdCB1aW50IFNIQVBFX0FBQkIgPSAxOwpzdGF0aWMgY29uc3QgdWludCBTSEFQRV9MSU5FID0gMjsKc3RhdGljIGNvbnN0IHVpbnQgU0hBUEVfU0VHTUVOVCA9IDM7CgpzdGF0aWMgY29uc3QgdWludCBFTkRfQlVUVCA9IDA7CnN0YXRpYyBjb25zdCB1aW50IEVORF9TUVVBUkUgPSAxOwpzdGF0aWMgY29uc3QgdWludCBFTkRfUk9VTkQgPSAyOwpzdGF0aWMgY29uc3QgdWludCBFTkRfTUlURVIgPSAzOwpzdGF0aWMgY29uc3QgdWludCBFTkRfQkVWRUwgPSA0OwoKLy8gTG9uZ2VzdCBhIG1pdGVyIG1heSBnZXQsIHJlbGF0aXZlIHRvIGhhbGYgdGhlIHdpZHRoLCBiZWZvcmUgaXQgaXMgYmV2ZWxlZCBpbnN0ZWFkCnN0YXRpYyBjb25zdCBmbG9hdCBNSVRFUl9MSU1JVCA9IDQuMGY7CgpzdGF0aWMgY29uc3QgdWludCB0cmlhbmdsZUluZGljZXNbNl0gPSB7IDAsIDEsIDIsIDMsIDIsIDEgfTsKc3RhdGljIGNvbnN0IGZsb2F0MiB2ZXJ0ZXhQb3NbNF0gPSB7CiAgICB7IC0xLjBmLCAtMS4wZiB9LAogICAgeyAxLjBmLCAtMS4wZiB9LAogICAgeyAtMS4wZiwgMS4wZiB9LAogICAgeyAxLjBmLCAxLjBmIH0KfTsKClN0cnVjdHVyZWRCdWZmZXI8U2hhcGVEYXRhPiBEYXRhQnVmZmVyIDogcmVnaXN0ZXIodDAsIHNwYWNlMCk7CgovLyBTaGFwZXMgYSBjYW1lcmEgc2VlcywgYXMgaW5kaWNlcyBpbnRvIHRoZSBkYXRhIGJ1ZmZlcgpTdHJ1Y3R1cmVkQnVmZmVyPHVpbnQ+IERyYXdJbmRleEJ1ZmZlciA6IHJlZ2lzdGVyKHQxLCBzcGFjZTApOwoKY2J1ZmZlciBVbmlmb3JtQmxvY2sgOiByZWdpc3RlcihiMCwgc3BhY2UxKQp7CiAgICBmbG9hdDR4NCBWaWV3UHJvamVjdGlvbk1hdHJpeCA6IHBhY2tvZmZzZXQoYzApOwogICAgdWludCBCYXNlU2hhcGUgOiBwYWNrb2Zmc2V0KGM0LngpOwogICAgZmxvYXQgUGl4ZWxTaXplIDogcGFja29mZnNldChjNC55KTsKfTsKCi8vIFN0eWxlIG9mIG9uZSBlbmQgb2YgYSBzZWdtZW50LCBhZnRlciBsb29raW5nIGF0IHRoZSBzZWdtZW50IGl0IGpvaW5zOiB0aGUgZW5kIHN0eWxlLCB0aGUKLy8gYmlzZWN0b3Igb2YgdGhlIHR3byBzZWdtZW50cycgbm9ybWFscyBpbiB0aGUgZW5kJ3Mgb3duIGZyYW1lICh4IG91dCBvZiB0aGUgc2VnbWVudCwgeSBhY3Jvc3MpLAovLyBhbmQgaG93IGZhciBvdXQgdGhlIGJldmVsIHNpdHMgYWxvbmcgaXQKZmxvYXQ0IFJlc29sdmVTZWdtZW50RW5kKHVpbnQgc3R5bGUsIHVpbnQgbmVpZ2hib3JJbmRleCwgZmxvYXQyIGRpciwgZmxvYXQyIG5ybSwgZmxvYXQgb3V0d2FyZCwgZmxvYXQgaGFsZldpZHRoKQp7CiAgICBpZiAoc3R5bGUgIT0gRU5EX01JVEVSICYmIHN0eWxlICE9IEVORF9CRVZFTCkKICAgICAgICByZXR1cm4gZmxvYXQ0KHN0eWxlLCAwLjBmLCAwLjBmLCAwLjBmKTsKCiAgICAvLyBKb2lucyB0aGF0IGRvdWJsZSBiYWNrIG9uIHRoZW1zZWx2ZXMsIG9yIG1lZXQgYW4gZW1wdHkgc2VnbWVudCwgaGF2ZSBubyBiaXNlY3RvcgogICAgU2hhcGVEYXRhIG5laWdoYm9yID0gRGF0YUJ1ZmZlcltuZWlnaGJvckluZGV4XTsKICAgIGZsb2F0MiBuZWlnaGJvckRlbHRhID0gbmVpZ2hib3IuR2VvbWV0cnkuencgLSBuZWlnaGJvci5HZW9tZXRyeS54eTsKICAgIGZsb2F0IG5laWdoYm9yTGVuZ3RoID0gbGVuZ3RoKG5laWdoYm9yRGVsdGEpOwogICAgZmxvYXQyIG5laWdoYm9yRGlyID0gKG5laWdoYm9yTGVuZ3RoID4gMC4wZikgPyBuZWlnaGJvckRlbHRhIC8gbmVpZ2hib3JMZW5ndGggOiBkaXI7CiAgICBmbG9hdDIgYmlzZWN0b3IgPSBucm0gKyBmbG9hdDIoLW5laWdoYm9yRGlyLnksIG5laWdoYm9yRGlyLngpOwogICAgaWYgKG5laWdoYm9yTGVuZ3RoIDw9IDAuMGYgfHwgZG90KGJpc2VjdG9yLCBiaXNlY3RvcikgPCAxZS02ZikKICAgICAgICByZXR1cm4gZmxvYXQ0KEVORF9ST1VORCwgMC4wZiwgMC4wZiwgMC4wZik7CiAgICBiaXNlY3RvciA9IG5vcm1hbGl6ZShiaXNlY3Rvcik7CiAgICBmbG9hdCBjb3NpbmUgPSBkb3QoYmlzZWN0b3IsIG5ybSk7CiAgICBpZiAoc3R5bGUgPT0gRU5EX01JVEVSICYmIGNvc2luZSAqIE1JVEVSX0xJTUlUIDwgMS4wZikKICAgICAgICBzdHlsZSA9IEVORF9CRVZFTDsKICAgIHJldHVybiBmbG9hdDQoc3R5bGUsIGRvdChiaXNlY3RvciwgZGlyICogb3V0d2FyZCksIGNvc2luZSwgaGFsZldpZHRoICogY29zaW5lKTsKfQoKT3V0cHV0IG1haW4odWludCBpZCA6IFNWX1ZlcnRleElEKQp7CiAgICB1aW50IHNoYXBlSW5kZXggPSBEcmF3SW5kZXhCdWZmZXJbQmFzZVNoYXBlICsgKGlkIC8gNildOwogICAgdWludCB2ZXJ0ID0gdHJpYW5nbGVJbmRpY2VzW2lkICUgNl07CiAgICBTaGFwZURhdGEgc2hhcGUgPSBEYXRhQnVmZmVyW3NoYXBlSW5kZXhdOwogICAgdWludCB0eXBlID0gc2hhcGUuVHlwZSAmIDB4RkY7CgogICAgT3V0cHV0IG91dHB1dDsKICAgIG91dHB1dC5TdGFydEVuZCA9IGZsb2F0NCgwLjBmLCAwLjBmLCAwLjBmLCAwLjBmKTsKICAgIG91dHB1dC5FbmRFbmQgPSBmbG9hdDQoMC4wZiwgMC4wZiwgMC4wZiwgMC4wZik7CiAgICBmbG9hdDIgd29ybGQ7CiAgICBpZiAodHlwZSA9PSBTSEFQRV9TRUdNRU5UKSB7CiAgICAgICAgLy8gTGF5IHRoZSBzZWdtZW50IGFsb25nIGl0cyBvd24geCBheGlzLCBzdGFydGluZyBhdCBpdHMgZmlyc3QgcG9pbnQKICAgICAgICBmbG9hdDIgcDEgPSBzaGFwZS5HZW9tZXRyeS54eTsKICAgICAgICBmbG9hdDIgcDIgPSBzaGFwZS5HZW9tZXRyeS56dzsKICAgICAgICBmbG9hdCBsZW4gPSBsZW5ndGgocDIgLSBwMSk7CiAgICAgICAgZmxvYXQyIGRpciA9IChsZW4gPiAwLjBmKSA/IChwMiAtIHAxKSAvIGxlbiA6IGZsb2F0MigxLjBmLCAwLjBmKTsKICAgICAgICBmbG9hdDIgbnJtID0gZmxvYXQyKC1kaXIueSwgZGlyLngpOwogICAgICAgIGZsb2F0IGhhbGZXaWR0aCA9IHNoYXBlLlRoaWNrbmVzcyAqIDAuNWY7CiAgICAgICAgdWludCB3cmFwID0gc2hhcGUuVHlwZSA+PiAxNjsKICAgICAgICB1aW50IHByZXZJbmRleCA9ICgoc2hhcGUuVHlwZSA+PiAxNCkgJiAxKSA/IHNoYXBlSW5kZXggKyB3cmFwIDogc2hhcGVJbmRleCAtIDE7CiAgICAgICAgdWludCBuZXh0SW5kZXggPSAoKHNoYXBlLlR5cGUgPj4gMTUpICYgMSkgPyBzaGFwZUluZGV4IC0gd3JhcCA6IHNoYXBlSW5kZXggKyAxOwogICAgICAgIG91dHB1dC5TdGFydEVuZCA9IFJlc29sdmVTZWdtZW50RW5kKChzaGFwZS5UeXBlID4+IDgpICYgMHg3LCBwcmV2SW5kZXgsIGRpciwgbnJtLCAtMS4wZiwgaGFsZldpZHRoKTsKICAgICAgICBvdXRwdXQuRW5kRW5kID0gUmVzb2x2ZVNlZ21lbnRFbmQoKHNoYXBlLlR5cGUgPj4gMTEpICYgMHg3LCBuZXh0SW5kZXgsIGRpciwgbnJtLCAxLjBmLCBoYWxmV2lkdGgpOwoKICAgICAgICAvLyBNaXRlcnMgcHV0IHRoZSBjb3JuZXIgb24gdGhlIGJpc2VjdG9yLCBzbyBuZWlnaGJvcnMgbWVldCB3aXRob3V0IG92ZXJsYXBwaW5nOyBldmVyeQogICAgICAgIC8vIG90aGVyIGVuZCByZWFjaGVzIHBhc3QgdGhlIHBvaW50IGZhciBlbm91Z2ggdG8gY292ZXIgaXRzIGNhcCAmIGFudGktYWxpYXNpbmcKICAgICAgICBib29sIGF0RW5kID0gdmVydGV4UG9zW3ZlcnRdLnggPiAwLjBmOwogICAgICAgIGZsb2F0IHNpZGUgPSB2ZXJ0ZXhQb3NbdmVydF0ueTsKICAgICAgICBmbG9hdDQgZW5kID0gKGF0RW5kKSA/IG91dHB1dC5FbmRFbmQgOiBvdXRwdXQuU3RhcnRFbmQ7CiAgICAgICAgZmxvYXQgb3V0d2FyZCA9IChhdEVuZCkgPyAxLjBmIDogLTEuMGY7CiAgICAgICAgZmxvYXQyIHAgPSAoYXRFbmQpID8gcDIgOiBwMTsKICAgICAgICBmbG9hdCBwYWQgPSBoYWxmV2lkdGggKyBQaXhlbFNpemU7CiAgICAgICAgaWYgKHVpbnQoZW5kLngpID09IEVORF9NSVRFUikgewogICAgICAgICAgICBmbG9hdDIgYmlzZWN0b3IgPSAoZGlyICogb3V0d2FyZCAqIGVuZC55KSArIChucm0gKiBlbmQueik7CiAgICAgICAgICAgIHdvcmxkID0gcCArIChiaXNlY3RvciAqIChzaWRlICogcGFkIC8gZW5kLnopKTsKICAgICAgICB9CiAgICAgICAgZWxzZSB7CiAgICAgICAgICAgIGZsb2F0IGV4dGVuZCA9ICh1aW50KGVuZC54KSA9PSBFTkRfQlVUVCkgPyBQaXhlbFNpemUgOiBwYWQ7CiAgICAgICAgICAgIHdvcmxkID0gcCArIChkaXIgKiAob3V0d2FyZCAqIGV4dGVuZCkpICsgKG5ybSAqIChzaWRlICogcGFkKSk7CiAgICAgICAgfQogICAgICAgIG91dHB1dC5Mb2NhbCA9IGZsb2F0Mihkb3Qod29ybGQgLSBwMSwgZGlyKSwgZG90KHdvcmxkIC0gcDEsIG5ybSkpOwogICAgICAgIG91dHB1dC5QYXJhbXMgPSBmbG9hdDQobGVuLCAwLjBmLCBoYWxmV2lkdGgsIFBpeGVsU2l6ZSk7CiAgICB9CiAgICBlbHNlIHsKICAgICAgICAvLyBGaW5kIHRoZSBzaGFwZSdzIGNlbnRlciwgaGFsZiBleHRlbnRzICYgb3JpZW50YXRpb247IGxpbmVzIHJ1biBhbG9uZyB0aGVpciBvd24geCBheGlzCiAgICAgICAgZmxvYXQyIGNlbnRlcjsKICAgICAgICBmbG9hdDIgaGFsZkV4dGVudHM7CiAgICAgICAgZmxvYXQyIGF4aXMgPSBmbG9hdDIoMS4wZiwgMC4wZik7CiAgICAgICAgaWYgKHR5cGUgPT0gU0hBUEVfQ0lSQ0xFKSB7CiAgICAgICAgICAgIGNlbnRlciA9IHNoYXBlLkdlb21ldHJ5Lnh5OwogICAgICAgICAgICBoYWxmRXh0ZW50cyA9IHNoYXBlLkdlb21ldHJ5Lnp6OwogICAgICAgIH0KICAgICAgICBlbHNlIGlmICh0eXBlID09IFNIQVBFX0FBQkIpIHsKICAgICAgICAgICAgY2VudGVyID0gKHNoYXBlLkdlb21ldHJ5Lnh5ICsgc2hhcGUuR2VvbWV0cnkuencpICogMC41ZjsKICAgICAgICAgICAgaGFsZkV4dGVudHMgPSBhYnMoc2hhcGUuR2VvbWV0cnkuencgLSBzaGFwZS5HZW9tZXRyeS54eSkgKiAwLjVmOwogICAgICAgIH0KICAgICAgICBlbHNlIHsKICAgICAgICAgICAgZmxvYXQyIGRlbHRhID0gc2hhcGUuR2VvbWV0cnkuencgLSBzaGFwZS5HZW9tZXRyeS54eTsKICAgICAgICAgICAgZmxvYXQgbGVuID0gbGVuZ3RoKGRlbHRhKTsKICAgICAgICAgICAgY2VudGVyID0gKHNoYXBlLkdlb21ldHJ5Lnh5ICsgc2hhcGUuR2VvbWV0cnkuencpICogMC41ZjsKICAgICAgICAgICAgaGFsZkV4dGVudHMgPSBmbG9hdDIobGVuICogMC41ZiwgMC4wZik7CiAgICAgICAgICAgIGlmIChsZW4gPiAwLjBmKSB7IGF4aXMgPSBkZWx0YSAvIGxlbjsgfQogICAgICAgIH0KCiAgICAgICAgLy8gUGFkIHRoZSBxdWFkIHRvIGNvdmVyIHRoZSBzdHJva2UgJiBhIHBpeGVsIG9mIGFudGktYWxpYXNpbmcKICAgICAgICBmbG9hdCBoYWxmVGhpY2tuZXNzID0gc2hhcGUuVGhpY2tuZXNzICogMC41ZiAqIFBpeGVsU2l6ZTsKICAgICAgICBmbG9hdDIgbG9jYWwgPSB2ZXJ0ZXhQb3NbdmVydF0gKiAoaGFsZkV4dGVudHMgKyBoYWxmVGhpY2tuZXNzICsgUGl4ZWxTaXplKTsKICAgICAgICB3b3JsZCA9IGNlbnRlciArIChheGlzICogbG9jYWwueCkgKyAoZmxvYXQyKC1heGlzLnksIGF4aXMueCkgKiBsb2NhbC55KTsKICAgICAgICBvdXRwdXQuTG9jYWwgPSBsb2NhbDsKICAgICAgICBvdXRwdXQuUGFyYW1zID0gZmxvYXQ0KGhhbGZFeHRlbnRzLCBoYWxmVGhpY2tuZXNzLCBQaXhlbFNpemUpOwogICAgfQoKICAgIG91dHB1dC5Qb3NpdGlvbiA9IG11bChWaWV3UHJvamVjdGlvbk1hdHJpeCwgZmxvYXQ0KHdvcmxkLCBzaGFwZS5EZXB0aCwgMS4wZikpOwogICAgb3V0cHV0LlR5cGUgPSB0eXBlOwogICAgb3V0cHV0LkNvbG9yID0gZmxvYXQ0KHNoYXBlLkNvbG9yICYgMHhGRiwgKHNoYXBlLkNvbG9yID4+IDgpICYgMHhGRiwgKHNoYXBlLkNvbG9yID4+IDE2KSAmIDB4RkYsIHNoYXBlLkNvbG9yID4+IDI0KSAvIDI1NS4wZjsKICAgIHJldHVybiBvdXRwdXQ7Cn0AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA",
 	0,
 	0,
+	2,
 	1
 };
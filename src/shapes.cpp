@@ -74,6 +74,184 @@ bool ShapeCircle::operator==(const ShapeCircle& other) const {
 		);
 }
 
+ShapePolyline::ShapePolyline(std::vector<VertexPos> _points, bool _closed) :
+	points(std::move(_points)),
+	closed(_closed) {}
+
+float ShapePolyline::Area() const {
+	if (!closed || points.size() < 3) { return 0.f; }
+	float area = 0.f;
+	for (std::size_t i = 0, j = points.size() - 1; i < points.size(); j = i++) {
+		area += (points[j][0] * points[i][1]) - (points[i][0] * points[j][1]);
+	}
+	return std::fabs(area) / 2.f;
+}
+
+ShapeAABB ShapePolyline::GetShapeAABB() const {
+	if (points.empty()) { return ShapeAABB(); }
+	ShapeAABB box(points[0][0], points[0][1], points[0][0], points[0][1]);
+	for (auto& point : points) {
+		box.left = std::min(box.left, point[0]);
+		box.top = std::min(box.top, point[1]);
+		box.right = std::max(box.right, point[0]);
+		box.bottom = std::max(box.bottom, point[1]);
+	}
+	return box;
+}
+
+std::uint32_t ShapePolyline::GetSegmentCount() const {
+	if (points.size() < 2) { return 0; }
+	return std::uint32_t(points.size() - ((closed) ? 0 : 1));
+}
+
+bool ShapePolyline::operator==(const ShapePolyline& other) const {
+	return (
+		points == other.points &&
+		closed == other.closed
+		);
+}
+
+static std::uint32_t BitCount(std::uint64_t bits) {
+#if defined(LUNA_CMP_MSVC)
+	return std::uint32_t(__popcnt64(bits));
+#elif defined(LUNA_CMP_GCC) || defined(LUNA_CMP_CLANG)
+	return std::uint32_t(__builtin_popcountll(bits));
+#else
+	std::uint32_t count = 0;
+	for (; bits; bits &= bits - 1) { ++count; }
+	return count;
+#endif
+}
+
+static std::uint64_t LowBits(std::int64_t count) {
+	return (count >= 64) ? ~0ull : ((1ull << count) - 1);
+}
+
+/// <summary>
+/// Get the range of mask texels covered by a region in world space.
+/// </summary>
+/// <returns>True if the range is not empty</returns>
+static bool MaskTexelRange(const ShapeMask& shape, const ShapeAABB& region, std::int64_t& c0, std::int64_t& c1, std::int64_t& r0, std::int64_t& r1) {
+	float tx0 = (region.left - shape.x) / shape.scaleX;
+	float tx1 = (region.right - shape.x) / shape.scaleX;
+	float ty0 = (region.top - shape.y) / shape.scaleY;
+	float ty1 = (region.bottom - shape.y) / shape.scaleY;
+	c0 = std::int64_t(std::floorf(std::min(tx0, tx1)));
+	c1 = std::max(c0 + 1, std::int64_t(std::ceilf(std::max(tx0, tx1))));
+	r0 = std::int64_t(std::floorf(std::min(ty0, ty1)));
+	r1 = std::max(r0 + 1, std::int64_t(std::ceilf(std::max(ty0, ty1))));
+	c0 = std::max<std::int64_t>(c0, 0);
+	r0 = std::max<std::int64_t>(r0, 0);
+	c1 = std::min<std::int64_t>(c1, shape.mask->GetWidth());
+	r1 = std::min<std::int64_t>(r1, shape.mask->GetHeight());
+	return (c0 < c1 && r0 < r1);
+}
+
+static bool MaskIsUsable(const ShapeMask& shape) {
+	return (shape.mask && shape.mask->IsValid() && shape.scaleX != 0.f && shape.scaleY != 0.f);
+}
+
+CollisionMask::CollisionMask() :
+	m_width(0),
+	m_height(0),
+	m_stride(0) {}
+
+CollisionMask::CollisionMask(std::uint32_t width, std::uint32_t height) :
+	m_width(width),
+	m_height(height),
+	m_stride((width + 63) / 64),
+	m_words(std::size_t((width + 63) / 64) * height, 0) {}
+
+bool CollisionMask::IsValid() const {
+	return (m_width > 0 && m_height > 0);
+}
+
+std::uint32_t CollisionMask::GetWidth() const {
+	return m_width;
+}
+
+std::uint32_t CollisionMask::GetHeight() const {
+	return m_height;
+}
+
+std::uint32_t CollisionMask::GetStride() const {
+	return m_stride;
+}
+
+std::uint32_t CollisionMask::GetCount() const {
+	std::uint32_t count = 0;
+	for (auto word : m_words) { count += BitCount(word); }
+	return count;
+}
+
+const std::uint64_t* CollisionMask::GetRow(std::uint32_t y) const {
+	return (y < m_height) ? &m_words[std::size_t(y) * m_stride] : nullptr;
+}
+
+bool CollisionMask::GetBit(std::int64_t x, std::int64_t y) const {
+	if (x < 0 || y < 0 || x >= m_width || y >= m_height) { return false; }
+	return (m_words[(std::size_t(y) * m_stride) + std::size_t(x / 64)] >> (x % 64)) & 1ull;
+}
+
+void CollisionMask::SetBit(std::uint32_t x, std::uint32_t y, bool value) {
+	if (x >= m_width || y >= m_height) { return; }
+	std::uint64_t& word = m_words[(std::size_t(y) * m_stride) + (x / 64)];
+	if (value) { word |= (1ull << (x % 64)); }
+	else { word &= ~(1ull << (x % 64)); }
+}
+
+std::uint64_t CollisionMask::ReadBits(std::int64_t x, std::uint32_t y) const {
+	if (y >= m_height) { return 0; }
+	const std::uint64_t* row = &m_words[std::size_t(y) * m_stride];
+	std::int64_t word = (x >= 0) ? (x / 64) : -((63 - x) / 64);
+	std::uint32_t shift = std::uint32_t(x - (word * 64));
+	auto load = [&](std::int64_t i) -> std::uint64_t { return (i >= 0 && i < m_stride) ? row[i] : 0; };
+	std::uint64_t bits = load(word) >> shift;
+	if (shift) { bits |= load(word + 1) << (64 - shift); }
+	return bits;
+}
+
+bool CollisionMask::AnyBits(std::int64_t x0, std::int64_t x1, std::uint32_t y) const {
+	x0 = std::max<std::int64_t>(x0, 0);
+	x1 = std::min<std::int64_t>(x1, m_width);
+	for (std::int64_t x = x0; x < x1; x += 64) {
+		if (ReadBits(x, y) & LowBits(x1 - x)) { return true; }
+	}
+	return false;
+}
+
+ShapeMask::ShapeMask(const CollisionMask* _mask, float _x, float _y, float _scaleX, float _scaleY) :
+	mask(_mask),
+	x(_x),
+	y(_y),
+	scaleX(_scaleX),
+	scaleY(_scaleY) {}
+
+float ShapeMask::Area() const {
+	return (mask) ? float(mask->GetCount()) * std::fabsf(scaleX * scaleY) : 0.f;
+}
+
+ShapeAABB ShapeMask::GetShapeAABB() const {
+	float w = (mask) ? float(mask->GetWidth()) * scaleX : 0.f;
+	float h = (mask) ? float(mask->GetHeight()) * scaleY : 0.f;
+	return ShapeAABB(
+		std::min(x, x + w),
+		std::min(y, y + h),
+		std::max(x, x + w),
+		std::max(y, y + h)
+	);
+}
+
+bool ShapeMask::operator==(const ShapeMask& other) const {
+	return (
+		mask == other.mask &&
+		x == other.x &&
+		y == other.y &&
+		scaleX == other.scaleX &&
+		scaleY == other.scaleY
+		);
+}
+
 float PointDistance(float x1, float y1, float x2, float y2) {
 	float xx = (x2 - x1);
 	float yy = (y2 - y1);
@@ -148,6 +326,14 @@ bool PointInShape(float x, float y, const ShapeCircle& shape) {
 	return (shape.radius * shape.radius) <= (dx * dx + dy * dy);
 }
 
+template<>
+bool PointInShape(float x, float y, const ShapeMask& shape) {
+	if (!MaskIsUsable(shape)) { return false; }
+	std::int64_t c = std::int64_t(std::floorf((x - shape.x) / shape.scaleX));
+	std::int64_t r = std::int64_t(std::floorf((y - shape.y) / shape.scaleY));
+	return shape.mask->GetBit(c, r);
+}
+
 template<>
 bool ShapeIntersects(const ShapeLine& shape1, const ShapeLine& shape2) {
 	float d  = (shape2.y2 - shape2.y1) * (shape1.x2 - shape1.x1) - (shape2.x2 - shape2.x1) * (shape1.y2 - shape1.y1);
@@ -227,59 +413,263 @@ bool ShapeIntersects(const ShapeCircle& shape1, const ShapeCircle& shape2) {
 	return (d * d) <= (dx * dx + dy * dy);
 }
 
+template<>
+bool ShapeIntersects(const ShapeMask& shape1, const ShapeMask& shape2) {
+	if (!MaskIsUsable(shape1) || !MaskIsUsable(shape2)) { return false; }
+	ShapeAABB box1 = shape1.GetShapeAABB();
+	ShapeAABB box2 = shape2.GetShapeAABB();
+	if (!ShapeIntersects(box1, box2)) { return false; }
+	ShapeAABB overlap(
+		std::max(box1.left, box2.left),
+		std::max(box1.top, box2.top),
+		std::min(box1.right, box2.right),
+		std::min(box1.bottom, box2.bottom)
+	);
+
+	// Walk the finer mask over the overlapping region
+	bool firstIsFiner = std::fabsf(shape1.scaleX * shape1.scaleY) <= std::fabsf(shape2.scaleX * shape2.scaleY);
+	const ShapeMask& fine = (firstIsFiner) ? shape1 : shape2;
+	const ShapeMask& coarse = (firstIsFiner) ? shape2 : shape1;
+	std::int64_t c0, c1, r0, r1;
+	if (!MaskTexelRange(fine, overlap, c0, c1, r0, r1)) { return false; }
+
+	if (fine.scaleX == coarse.scaleX && fine.scaleY == coarse.scaleY && fine.scaleX > 0.f && fine.scaleY > 0.f) {
+		// Texel grids line up, so compare whole words at a column offset
+		std::int64_t dx = std::int64_t(std::roundf((fine.x - coarse.x) / fine.scaleX));
+		std::int64_t dy = std::int64_t(std::roundf((fine.y - coarse.y) / fine.scaleY));
+		for (std::int64_t r = r0; r < r1; ++r) {
+			std::int64_t coarseRow = r + dy;
+			if (coarseRow < 0 || coarseRow >= coarse.mask->GetHeight()) { continue; }
+			for (std::int64_t c = c0; c < c1; c += 64) {
+				std::uint64_t bits = fine.mask->ReadBits(c, std::uint32_t(r)) & coarse.mask->ReadBits(c + dx, std::uint32_t(coarseRow));
+				if (bits & LowBits(c1 - c)) { return true; }
+			}
+		}
+		return false;
+	}
+
+	// Scaled or mirrored; skip empty words, then sample the coarse mask at each set texel
+	for (std::int64_t r = r0; r < r1; ++r) {
+		float wy = fine.y + ((float(r) + 0.5f) * fine.scaleY);
+		std::int64_t coarseRow = std::int64_t(std::floorf((wy - coarse.y) / coarse.scaleY));
+		if (coarseRow < 0 || coarseRow >= coarse.mask->GetHeight()) { continue; }
+		for (std::int64_t c = c0; c < c1; c += 64) {
+			std::uint64_t bits = fine.mask->ReadBits(c, std::uint32_t(r)) & LowBits(c1 - c);
+			while (bits) {
+				std::int64_t i = BitCount((bits & (~bits + 1)) - 1);
+				bits &= bits - 1;
+				float wx = fine.x + ((float(c + i) + 0.5f) * fine.scaleX);
+				std::int64_t coarseCol = std::int64_t(std::floorf((wx - coarse.x) / coarse.scaleX));
+				if (coarse.mask->GetBit(coarseCol, coarseRow)) { return true; }
+			}
+		}
+	}
+	return false;
+}
+
+template<>
+bool ShapeIntersects(const ShapeMask& shape1, const ShapeAABB& shape2) {
+	if (!MaskIsUsable(shape1)) { return false; }
+	if (!ShapeIntersects(shape1.GetShapeAABB(), shape2)) { return false; }
+	std::int64_t c0, c1, r0, r1;
+	if (!MaskTexelRange(shape1, shape2, c0, c1, r0, r1)) { return false; }
+	for (std::int64_t r = r0; r < r1; ++r) {
+		if (shape1.mask->AnyBits(c0, c1, std::uint32_t(r))) { return true; }
+	}
+	return false;
+}
+
+template<>
+bool ShapeIntersects(const ShapeAABB& shape1, const ShapeMask& shape2) {
+	return ShapeIntersects(shape2, shape1);
+}
+
+void CullCircles(const float* x, const float* y, const float* radius, std::size_t count, const ShapeAABB& bounds, std::uint8_t* visible) {
+	std::size_t i = 0;
+
+#if defined(LUNA_SIMD_AVX)
+	// Clamp 8 centers at a time into the box, and compare the distance to the clamped point against the radius
+	const __m256 left = _mm256_set1_ps(bounds.left);
+	const __m256 top = _mm256_set1_ps(bounds.top);
+	const __m256 right = _mm256_set1_ps(bounds.right);
+	const __m256 bottom = _mm256_set1_ps(bounds.bottom);
+	for (; i + 8 <= count; i += 8) {
+		__m256 cx = _mm256_loadu_ps(x + i);
+		__m256 cy = _mm256_loadu_ps(y + i);
+		__m256 r = _mm256_loadu_ps(radius + i);
+		__m256 dx = _mm256_sub_ps(_mm256_min_ps(_mm256_max_ps(cx, left), right), cx);
+		__m256 dy = _mm256_sub_ps(_mm256_min_ps(_mm256_max_ps(cy, top), bottom), cy);
+		__m256 distance = _mm256_fmadd_ps(dx, dx, _mm256_mul_ps(dy, dy));
+		int mask = _mm256_movemask_ps(_mm256_cmp_ps(distance, _mm256_mul_ps(r, r), _CMP_LE_OQ));
+		for (int lane = 0; lane < 8; ++lane) { visible[i + lane] = std::uint8_t((mask >> lane) & 1); }
+	}
+#elif defined(LUNA_SIMD_NEON)
+	// Clamp 8 centers at a time into the box, narrowing both halves' masks down to bytes
+	const float32x4_t left = vdupq_n_f32(bounds.left);
+	const float32x4_t top = vdupq_n_f32(bounds.top);
+	const float32x4_t right = vdupq_n_f32(bounds.right);
+	const float32x4_t bottom = vdupq_n_f32(bounds.bottom);
+	uint16x4_t halves[2];
+	for (; i + 8 <= count; i += 8) {
+		for (std::size_t half = 0; half < 2; ++half) {
+			std::size_t j = i + (half * 4);
+			float32x4_t cx = vld1q_f32(x + j);
+			float32x4_t cy = vld1q_f32(y + j);
+			float32x4_t r = vld1q_f32(radius + j);
+			float32x4_t dx = vsubq_f32(vminq_f32(vmaxq_f32(cx, left), right), cx);
+			float32x4_t dy = vsubq_f32(vminq_f32(vmaxq_f32(cy, top), bottom), cy);
+			float32x4_t distance = vmlaq_f32(vmulq_f32(dy, dy), dx, dx);
+			halves[half] = vmovn_u32(vcleq_f32(distance, vmulq_f32(r, r)));
+		}
+		vst1_u8(visible + i, vand_u8(vmovn_u16(vcombine_u16(halves[0], halves[1])), vdup_n_u8(1)));
+	}
+#endif
+
+	// Handle remaining circles
+	for (; i < count; ++i) {
+		visible[i] = ShapeIntersects(bounds, ShapeCircle(x[i], y[i], radius[i])) ? 1 : 0;
+	}
+}
+
+void CullAABBs(const float* left, const float* top, const float* right, const float* bottom, std::size_t count, const ShapeAABB& bounds, std::uint8_t* visible) {
+	std::size_t i = 0;
+
+#if defined(LUNA_SIMD_AVX)
+	// Compare 8 boxes at a time against each edge of the bounds
+	const __m256 boundsLeft = _mm256_set1_ps(bounds.left);
+	const __m256 boundsTop = _mm256_set1_ps(bounds.top);
+	const __m256 boundsRight = _mm256_set1_ps(bounds.right);
+	const __m256 boundsBottom = _mm256_set1_ps(bounds.bottom);
+	for (; i + 8 <= count; i += 8) {
+		__m256 overlap = _mm256_and_ps(
+			_mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(right + i), boundsLeft, _CMP_GE_OQ), _mm256_cmp_ps(_mm256_loadu_ps(left + i), boundsRight, _CMP_LE_OQ)),
+			_mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(bottom + i), boundsTop, _CMP_GE_OQ), _mm256_cmp_ps(_mm256_loadu_ps(top + i), boundsBottom, _CMP_LE_OQ))
+		);
+		int mask = _mm256_movemask_ps(overlap);
+		for (int lane = 0; lane < 8; ++lane) { visible[i + lane] = std::uint8_t((mask >> lane) & 1); }
+	}
+#elif defined(LUNA_SIMD_NEON)
+	// Compare 8 boxes at a time, narrowing both halves' masks down to bytes
+	const float32x4_t boundsLeft = vdupq_n_f32(bounds.left);
+	const float32x4_t boundsTop = vdupq_n_f32(bounds.top);
+	const float32x4_t boundsRight = vdupq_n_f32(bounds.right);
+	const float32x4_t boundsBottom = vdupq_n_f32(bounds.bottom);
+	uint16x4_t halves[2];
+	for (; i + 8 <= count; i += 8) {
+		for (std::size_t half = 0; half < 2; ++half) {
+			std::size_t j = i + (half * 4);
+			uint32x4_t overlap = vandq_u32(
+				vandq_u32(vcgeq_f32(vld1q_f32(right + j), boundsLeft), vcleq_f32(vld1q_f32(left + j), boundsRight)),
+				vandq_u32(vcgeq_f32(vld1q_f32(bottom + j), boundsTop), vcleq_f32(vld1q_f32(top + j), boundsBottom))
+			);
+			halves[half] = vmovn_u32(overlap);
+		}
+		vst1_u8(visible + i, vand_u8(vmovn_u16(vcombine_u16(halves[0], halves[1])), vdup_n_u8(1)));
+	}
+#endif
+
+	// Handle remaining boxes
+	for (; i < count; ++i) {
+		visible[i] = ShapeIntersects(ShapeAABB(left[i], top[i], right[i], bottom[i]), bounds) ? 1 : 0;
+	}
+}
+
+void PrimitiveArena::Clear() {
+	m_vertices.clear();
+	m_indices.clear();
+}
+
+std::uint32_t PrimitiveArena::GetVertexCount() const {
+	return std::uint32_t(m_vertices.size());
+}
+
+std::uint32_t PrimitiveArena::GetIndexCount() const {
+	return std::uint32_t(m_indices.size());
+}
+
+const VertexPosColor* PrimitiveArena::GetVertices() const {
+	return m_vertices.data();
+}
+
+const std::uint32_t* PrimitiveArena::GetIndices() const {
+	return m_indices.data();
+}
+
 Primitive::Primitive() :
 	m_shape(),
 	m_shapeType(ShapeType::Unknown),
 	m_outline(false),
+	m_width(1.f),
+	m_join(LineJoin::Miter),
+	m_cap(LineCap::Butt),
 	m_depth(0),
-	m_blend(LunaColorWhite),
-	m_dirty(true) {}
+	m_blend(LunaColorWhite) {}
 
 Primitive::Primitive(ShapeLine shape, bool outline, std::int32_t depth, SDL_Color blend) :
 	m_shape(shape),
 	m_shapeType(ShapeType::LineType),
 	m_outline(outline),
+	m_width(1.f),
+	m_join(LineJoin::Miter),
+	m_cap(LineCap::Butt),
 	m_depth(depth),
-	m_blend(blend),
-	m_dirty(true) {}
+	m_blend(blend) {}
 
 Primitive::Primitive(ShapeAABB shape, bool outline, std::int32_t depth, SDL_Color blend) :
 	m_shape(shape),
 	m_shapeType(ShapeType::AABBType),
 	m_outline(outline),
+	m_width(1.f),
+	m_join(LineJoin::Miter),
+	m_cap(LineCap::Butt),
 	m_depth(depth),
-	m_blend(blend),
-	m_dirty(true) {}
+	m_blend(blend) {}
 
 Primitive::Primitive(ShapeCircle shape, bool outline, std::int32_t depth, SDL_Color blend) :
 	m_shape(shape),
 	m_shapeType(ShapeType::CircleType),
 	m_outline(outline),
+	m_width(1.f),
+	m_join(LineJoin::Miter),
+	m_cap(LineCap::Butt),
+	m_depth(depth),
+	m_blend(blend) {}
+
+Primitive::Primitive(ShapePolyline shape, float width, LineJoin join, LineCap cap, std::int32_t depth, SDL_Color blend) :
+	m_shape(std::move(shape)),
+	m_shapeType(ShapeType::PolylineType),
+	m_outline(false),
+	m_width(width),
+	m_join(join),
+	m_cap(cap),
 	m_depth(depth),
-	m_blend(blend),
-	m_dirty(true) {}
+	m_blend(blend) {}
 
 Primitive::Primitive(const Primitive& primitive) :
 	m_shape(primitive.m_shape),
 	m_shapeType(primitive.m_shapeType),
 	m_outline(primitive.m_outline),
+	m_width(primitive.m_width),
+	m_join(primitive.m_join),
+	m_cap(primitive.m_cap),
 	m_depth(primitive.m_depth),
-	m_blend(primitive.m_blend),
-	m_dirty(primitive.m_dirty) {}
+	m_blend(primitive.m_blend) {}
 
 Primitive::Primitive(Primitive&& primitive) noexcept :
 	m_shape(std::move(primitive.m_shape)),
 	m_shapeType(std::move(primitive.m_shapeType)),
 	m_outline(std::move(primitive.m_outline)),
+	m_width(std::move(primitive.m_width)),
+	m_join(std::move(primitive.m_join)),
+	m_cap(std::move(primitive.m_cap)),
 	m_depth(std::move(primitive.m_depth)),
-	m_blend(std::move(primitive.m_blend)),
-	m_dirty(std::move(primitive.m_dirty)) {}
+	m_blend(std::move(primitive.m_blend)) {}
 
 bool Primitive::IsWireframe() const {
 	return m_shapeType == ShapeType::LineType || m_outline;
 }
 
-AnyShape Primitive::GetShape() const {
+const AnyShape& Primitive::GetShape() const {
 	return m_shape;
 }
 
@@ -291,6 +681,18 @@ bool Primitive::GetOutline() const {
 	return m_outline;
 }
 
+float Primitive::GetWidth() const {
+	return m_width;
+}
+
+LineJoin Primitive::GetLineJoin() const {
+	return m_join;
+}
+
+LineCap Primitive::GetLineCap() const {
+	return m_cap;
+}
+
 std::int32_t Primitive::GetDepth() const {
 	return m_depth;
 }
@@ -303,37 +705,52 @@ float Primitive::GetAlpha() const {
 	return m_blend.a / 255.f;
 }
 
-std::vector<VertexPosColor> Primitive::GetVertices() {
-	CalculateVertices();
-	return m_vertices;
+std::vector<VertexPosColor> Primitive::GetVertices() const {
+	PrimitiveArena arena;
+	WriteGeometry(arena);
+	return arena.m_vertices;
 }
 
-std::vector<std::uint16_t> Primitive::GetIndices() {
-	CalculateVertices();
-	return m_indices;
+std::vector<std::uint16_t> Primitive::GetIndices() const {
+	PrimitiveArena arena;
+	WriteGeometry(arena);
+	return std::vector<std::uint16_t>(arena.m_indices.begin(), arena.m_indices.end());
 }
 
 void Primitive::SetShape(ShapeLine shape) {
 	m_shape = shape;
 	m_shapeType = ShapeType::LineType;
-	m_dirty = true;
 }
 
 void Primitive::SetShape(ShapeAABB shape) {
 	m_shape = shape;
 	m_shapeType = ShapeType::AABBType;
-	m_dirty = true;
 }
 
 void Primitive::SetShape(ShapeCircle shape) {
 	m_shape = shape;
 	m_shapeType = ShapeType::CircleType;
-	m_dirty = true;
+}
+
+void Primitive::SetShape(ShapePolyline shape) {
+	m_shape = std::move(shape);
+	m_shapeType = ShapeType::PolylineType;
 }
 
 void Primitive::SetOutline(bool outline) {
 	m_outline = outline;
-	m_dirty = true;
+}
+
+void Primitive::SetWidth(float width) {
+	m_width = width;
+}
+
+void Primitive::SetLineJoin(LineJoin join) {
+	m_join = join;
+}
+
+void Primitive::SetLineCap(LineCap cap) {
+	m_cap = cap;
 }
 
 void Primitive::SetDepth(std::int32_t depth) {
@@ -353,10 +770,11 @@ Primitive& Primitive::operator=(const Primitive& other) {
 	m_shape = other.m_shape;
 	m_shapeType = other.m_shapeType;
 	m_outline = other.m_outline;
+	m_width = other.m_width;
+	m_join = other.m_join;
+	m_cap = other.m_cap;
 	m_depth = other.m_depth;
 	m_blend = other.m_blend;
-	m_vertices = other.m_vertices;
-	m_indices = other.m_indices;
 	return *this;
 }
 
@@ -365,10 +783,11 @@ Primitive& Primitive::operator=(Primitive&& other) noexcept {
 	m_shape = std::move(other.m_shape);
 	m_shapeType = std::move(other.m_shapeType);
 	m_outline = std::move(other.m_outline);
+	m_width = std::move(other.m_width);
+	m_join = std::move(other.m_join);
+	m_cap = std::move(other.m_cap);
 	m_depth = std::move(other.m_depth);
 	m_blend = std::move(other.m_blend);
-	m_vertices = std::move(other.m_vertices);
-	m_indices = std::move(other.m_indices);
 	return *this;
 }
 
@@ -377,58 +796,60 @@ bool Primitive::operator==(const Primitive& other) const {
 		m_shape == other.m_shape &&
 		m_shapeType == other.m_shapeType &&
 		m_outline == other.m_outline &&
+		m_width == other.m_width &&
+		m_join == other.m_join &&
+		m_cap == other.m_cap &&
 		m_depth == other.m_depth &&
 		m_blend.r == other.m_blend.r &&
 		m_blend.g == other.m_blend.g &&
 		m_blend.b == other.m_blend.b &&
-		m_blend.a == other.m_blend.a &&
-		m_vertices == other.m_vertices &&
-		m_indices == other.m_indices
+		m_blend.a == other.m_blend.a
 		);
 }
 
-void Primitive::CalculateVertices() {
-	if (!m_dirty) { return; }
-	m_dirty = false;
-	m_vertices.clear();
-	m_indices.clear();
+void Primitive::WriteGeometry(PrimitiveArena& arena, std::uint32_t baseVertex) const {
+	// Indices count from baseVertex, so they stay small when it is the start of the batch
+	std::vector<VertexPosColor>& vertices = arena.m_vertices;
+	std::vector<std::uint32_t>& indices = arena.m_indices;
+	std::uint32_t first = std::uint32_t(vertices.size());
+	std::uint32_t offset = first - baseVertex;
 	SDL_FColor color = ConvertToFColor(m_blend);
 	float z = -float(m_depth);
 	switch (m_shapeType) {
 	case ShapeType::LineType: {
 		ShapeLine shapeLine = std::get<ShapeLine>(m_shape);
-		m_vertices.push_back(VertexPosColor(shapeLine.x1, shapeLine.y1, z, color.r, color.g, color.b, color.a));
-		m_vertices.push_back(VertexPosColor(shapeLine.x2, shapeLine.y2, z, color.r, color.g, color.b, color.a));
-		m_indices.push_back(0);
-		m_indices.push_back(1);
+		vertices.push_back(VertexPosColor(shapeLine.x1, shapeLine.y1, z, color.r, color.g, color.b, color.a));
+		vertices.push_back(VertexPosColor(shapeLine.x2, shapeLine.y2, z, color.r, color.g, color.b, color.a));
+		indices.push_back(offset + 0);
+		indices.push_back(offset + 1);
 	} break;
 	case ShapeType::AABBType: {
 		ShapeAABB shapeAABB = std::get<ShapeAABB>(m_shape);
 		if (m_outline) {
-			m_vertices.push_back(VertexPosColor(shapeAABB.left, shapeAABB.top, z, color.r, color.g, color.b, color.a));
-			m_vertices.push_back(VertexPosColor(shapeAABB.left, shapeAABB.bottom, z, color.r, color.g, color.b, color.a));
-			m_vertices.push_back(VertexPosColor(shapeAABB.right, shapeAABB.bottom, z, color.r, color.g, color.b, color.a));
-			m_vertices.push_back(VertexPosColor(shapeAABB.right, shapeAABB.top, z, color.r, color.g, color.b, color.a));
-			m_indices.push_back(0);
-			m_indices.push_back(1);
-			m_indices.push_back(1);
-			m_indices.push_back(2);
-			m_indices.push_back(2);
-			m_indices.push_back(3);
-			m_indices.push_back(3);
-			m_indices.push_back(0);
+			vertices.push_back(VertexPosColor(shapeAABB.left, shapeAABB.top, z, color.r, color.g, color.b, color.a));
+			vertices.push_back(VertexPosColor(shapeAABB.left, shapeAABB.bottom, z, color.r, color.g, color.b, color.a));
+			vertices.push_back(VertexPosColor(shapeAABB.right, shapeAABB.bottom, z, color.r, color.g, color.b, color.a));
+			vertices.push_back(VertexPosColor(shapeAABB.right, shapeAABB.top, z, color.r, color.g, color.b, color.a));
+			indices.push_back(offset + 0);
+			indices.push_back(offset + 1);
+			indices.push_back(offset + 1);
+			indices.push_back(offset + 2);
+			indices.push_back(offset + 2);
+			indices.push_back(offset + 3);
+			indices.push_back(offset + 3);
+			indices.push_back(offset + 0);
 		}
 		else {
-			m_vertices.push_back(VertexPosColor(shapeAABB.left, shapeAABB.top, z, color.r, color.g, color.b, color.a));
-			m_vertices.push_back(VertexPosColor(shapeAABB.left, shapeAABB.bottom, z, color.r, color.g, color.b, color.a));
-			m_vertices.push_back(VertexPosColor(shapeAABB.right, shapeAABB.top, z, color.r, color.g, color.b, color.a));
-			m_vertices.push_back(VertexPosColor(shapeAABB.right, shapeAABB.bottom, z, color.r, color.g, color.b, color.a));
-			m_indices.push_back(0);
-			m_indices.push_back(1);
-			m_indices.push_back(2);
-			m_indices.push_back(3);
-			m_indices.push_back(2);
-			m_indices.push_back(1);
+			vertices.push_back(VertexPosColor(shapeAABB.left, shapeAABB.top, z, color.r, color.g, color.b, color.a));
+			vertices.push_back(VertexPosColor(shapeAABB.left, shapeAABB.bottom, z, color.r, color.g, color.b, color.a));
+			vertices.push_back(VertexPosColor(shapeAABB.right, shapeAABB.top, z, color.r, color.g, color.b, color.a));
+			vertices.push_back(VertexPosColor(shapeAABB.right, shapeAABB.bottom, z, color.r, color.g, color.b, color.a));
+			indices.push_back(offset + 0);
+			indices.push_back(offset + 1);
+			indices.push_back(offset + 2);
+			indices.push_back(offset + 3);
+			indices.push_back(offset + 2);
+			indices.push_back(offset + 1);
 		}
 	} break;
 	case ShapeType::CircleType: {
@@ -438,8 +859,8 @@ void Primitive::CalculateVertices() {
 			float min_angle = 1.0f / shapeCircle.radius;
 
 			// Push initial point
-			m_indices.push_back(0);
-			m_vertices.push_back(VertexPosColor(center[0] + shapeCircle.radius, center[1], z, color.r, color.g, color.b, color.a));
+			indices.push_back(offset + 0);
+			vertices.push_back(VertexPosColor(center[0] + shapeCircle.radius, center[1], z, color.r, color.g, color.b, color.a));
 
 			// Rotate around, pushing more points
 			float accum = 0.f;
@@ -447,16 +868,20 @@ void Primitive::CalculateVertices() {
 				accum += min_angle;
 				float dx = shapeCircle.radius * SDL_cosf(accum);
 				float dy = shapeCircle.radius * SDL_sinf(accum);
-				m_indices.push_back(m_vertices.size());
-				m_indices.push_back(m_vertices.size());
-				m_vertices.push_back(VertexPosColor(center[0] + dx, center[1] + dy, z, color.r, color.g, color.b, color.a));
+				std::uint32_t index = offset + std::uint32_t(vertices.size()) - first;
+				indices.push_back(index);
+				indices.push_back(index);
+				vertices.push_back(VertexPosColor(center[0] + dx, center[1] + dy, z, color.r, color.g, color.b, color.a));
 			}
 
 			// Connect back to first point
-			m_indices.push_back(0);
+			indices.push_back(offset + 0);
 		}
 		else {
-			std::queue<std::pair<std::size_t, std::size_t>> edges;
+			// Edges waiting to be split, oldest first; kept in the arena so its storage is reused between frames
+			std::vector<std::pair<std::uint32_t, std::uint32_t>>& edges = arena.m_edges;
+			edges.clear();
+			std::size_t nextEdge = 0;
 
 			// Create equilateral triangle
 			float a = shapeCircle.radius / 2.f;
@@ -464,22 +889,22 @@ void Primitive::CalculateVertices() {
 			VertexPos p1(shapeCircle.x, shapeCircle.y - shapeCircle.radius);
 			VertexPos p2(shapeCircle.x - b, shapeCircle.y + a);
 			VertexPos p3(shapeCircle.x + b, shapeCircle.y + a);
-			m_vertices.push_back(VertexPosColor(p1[0], p1[1], z, color.r, color.g, color.b, color.a));
-			m_vertices.push_back(VertexPosColor(p2[0], p2[1], z, color.r, color.g, color.b, color.a));
-			m_vertices.push_back(VertexPosColor(p3[0], p3[1], z, color.r, color.g, color.b, color.a));
-			m_indices.push_back(0);
-			m_indices.push_back(1);
-			m_indices.push_back(2);
-			edges.push(std::make_pair(0, 1));
-			edges.push(std::make_pair(1, 2));
-			edges.push(std::make_pair(2, 0));
+			vertices.push_back(VertexPosColor(p1[0], p1[1], z, color.r, color.g, color.b, color.a));
+			vertices.push_back(VertexPosColor(p2[0], p2[1], z, color.r, color.g, color.b, color.a));
+			vertices.push_back(VertexPosColor(p3[0], p3[1], z, color.r, color.g, color.b, color.a));
+			indices.push_back(offset + 0);
+			indices.push_back(offset + 1);
+			indices.push_back(offset + 2);
+			edges.push_back(std::make_pair(0, 1));
+			edges.push_back(std::make_pair(1, 2));
+			edges.push_back(std::make_pair(2, 0));
 
 			// Iterate on triangle edges
-			while (!edges.empty()) {
+			while (nextEdge < edges.size()) {
 				// Get midpoint of triangle side
-				auto& pair = edges.front();
-				VertexPos p1 = m_vertices[pair.first].xy();
-				VertexPos p2 = m_vertices[pair.second].xy();
+				auto pair = edges[nextEdge++];
+				VertexPos p1 = vertices[first + pair.first].xy();
+				VertexPos p2 = vertices[first + pair.second].xy();
 				VertexPos pm = Midpoint(p1, p2);
 
 				// Check for end condition
@@ -493,19 +918,51 @@ void Primitive::CalculateVertices() {
 				VertexPos p3(center[0] + dx, center[1] + dy);
 
 				// Add new point to vertex list
-				std::size_t new_index = m_vertices.size();
-				m_vertices.push_back(VertexPosColor(p3[0], p3[1], z, color.r, color.g, color.b, color.a));
-				m_indices.push_back(pair.first);
-				m_indices.push_back(pair.second);
-				m_indices.push_back(new_index);
+				std::uint32_t new_index = std::uint32_t(vertices.size()) - first;
+				vertices.push_back(VertexPosColor(p3[0], p3[1], z, color.r, color.g, color.b, color.a));
+				indices.push_back(offset + pair.first);
+				indices.push_back(offset + pair.second);
+				indices.push_back(offset + new_index);
 
 				// Add two new edges to the queue
-				edges.push(std::make_pair(new_index, pair.first));
-				edges.push(std::make_pair(pair.second, new_index));
-				edges.pop();
+				edges.push_back(std::make_pair(new_index, pair.first));
+				edges.push_back(std::make_pair(pair.second, new_index));
 			}
 		}
 	} break;
+	case ShapeType::PolylineType: {
+		// One quad per segment; joins & caps other than butt are approximated by squaring off the ends
+		const ShapePolyline& shapePolyline = std::get<ShapePolyline>(m_shape);
+		std::uint32_t segmentCount = shapePolyline.GetSegmentCount();
+		float halfWidth = m_width / 2.f;
+		for (std::uint32_t i = 0; i < segmentCount; ++i) {
+			const VertexPos& p1 = shapePolyline.points[i];
+			const VertexPos& p2 = shapePolyline.points[(i + 1) % shapePolyline.points.size()];
+			float length = PointDistance(p1, p2);
+			if (length <= 0.f) { continue; }
+			float dx = (p2[0] - p1[0]) / length;
+			float dy = (p2[1] - p1[1]) / length;
+			bool joinedStart = shapePolyline.closed || i > 0;
+			bool joinedEnd = shapePolyline.closed || i + 1 < segmentCount;
+			float startExtend = ((joinedStart) ? m_join != LineJoin::Miter : m_cap != LineCap::Butt) ? halfWidth : 0.f;
+			float endExtend = ((joinedEnd) ? m_join != LineJoin::Miter : m_cap != LineCap::Butt) ? halfWidth : 0.f;
+			float sx = p1[0] - dx * startExtend, sy = p1[1] - dy * startExtend;
+			float ex = p2[0] + dx * endExtend, ey = p2[1] + dy * endExtend;
+			float nx = -dy * halfWidth, ny = dx * halfWidth;
+			std::uint32_t index = offset + std::uint32_t(vertices.size()) - first;
+			vertices.push_back(VertexPosColor(sx + nx, sy + ny, z, color.r, color.g, color.b, color.a));
+			vertices.push_back(VertexPosColor(sx - nx, sy - ny, z, color.r, color.g, color.b, color.a));
+			vertices.push_back(VertexPosColor(ex + nx, ey + ny, z, color.r, color.g, color.b, color.a));
+			vertices.push_back(VertexPosColor(ex - nx, ey - ny, z, color.r, color.g, color.b, color.a));
+			indices.push_back(index + 0);
+			indices.push_back(index + 1);
+			indices.push_back(index + 2);
+			indices.push_back(index + 3);
+			indices.push_back(index + 2);
+			indices.push_back(index + 1);
+		}
+	} break;
+	default: break;
 	}
 }
 
@@ -4,6 +4,8 @@ namespace luna {
 
 Sprite::Sprite() :
 	m_textureID(RESOURCE_ID_NULL),
+	m_renderTargetID(RENDER_TARGET_ID_NULL),
+	m_glyphPageID(GLYPH_PAGE_ID_NULL),
 	m_positionX(0.f),
 	m_positionY(0.f),
 	m_animationSpeed(0.f),
@@ -11,7 +13,8 @@ Sprite::Sprite() :
 	m_scaleX(1.f),
 	m_scaleY(1.f),
 	m_rotation(0.f),
-	m_blend(LunaColorClear) {
+	m_blend(LunaColorClear),
+	m_blendMode(SpriteBlendMode::Normal) {
 	m_texture = nullptr;
 	m_width = 0.f;
 	m_height = 0.f;
@@ -26,6 +29,8 @@ Sprite::Sprite() :
 
 Sprite::Sprite(const Sprite& sprite) :
 	m_textureID(sprite.m_textureID),
+	m_renderTargetID(sprite.m_renderTargetID),
+	m_glyphPageID(sprite.m_glyphPageID),
 	m_positionX(sprite.m_positionX),
 	m_positionY(sprite.m_positionY),
 	m_animationSpeed(sprite.m_animationSpeed),
@@ -33,7 +38,8 @@ Sprite::Sprite(const Sprite& sprite) :
 	m_scaleX(sprite.m_scaleX),
 	m_scaleY(sprite.m_scaleY),
 	m_rotation(sprite.m_rotation),
-	m_blend(sprite.m_blend) {
+	m_blend(sprite.m_blend),
+	m_blendMode(sprite.m_blendMode) {
 	m_texture = sprite.m_texture;
 	m_width = sprite.m_width;
 	m_height = sprite.m_height;
@@ -48,6 +54,8 @@ Sprite::Sprite(const Sprite& sprite) :
 
 Sprite::Sprite(Sprite&& sprite) noexcept :
 	m_textureID(std::move(sprite.m_textureID)),
+	m_renderTargetID(std::move(sprite.m_renderTargetID)),
+	m_glyphPageID(std::move(sprite.m_glyphPageID)),
 	m_positionX(std::move(sprite.m_positionX)),
 	m_positionY(std::move(sprite.m_positionY)),
 	m_animationSpeed(std::move(sprite.m_animationSpeed)),
@@ -55,7 +63,8 @@ Sprite::Sprite(Sprite&& sprite) noexcept :
 	m_scaleX(std::move(sprite.m_scaleX)),
 	m_scaleY(std::move(sprite.m_scaleY)),
 	m_rotation(std::move(sprite.m_rotation)),
-	m_blend(std::move(sprite.m_blend)) {
+	m_blend(std::move(sprite.m_blend)),
+	m_blendMode(std::move(sprite.m_blendMode)) {
 	std::swap(m_texture, sprite.m_texture);
 	std::swap(m_width, sprite.m_width);
 	std::swap(m_height, sprite.m_height);
@@ -77,7 +86,8 @@ Sprite::Sprite(const ResourceID textureID, float x, float y, int32_t image, floa
 	m_scaleX(scaleX),
 	m_scaleY(scaleY),
 	m_rotation(rotation),
-	m_blend(blend) {
+	m_blend(blend),
+	m_blendMode(SpriteBlendMode::Normal) {
 	// Verify texture
 	m_texture = ResourceManager::GetTexture(m_textureID);
 	if (!m_texture) {
@@ -99,8 +109,45 @@ Sprite::Sprite(const ResourceID textureID, float x, float y, int32_t image, floa
 	CalculateUVs();
 }
 
+Sprite Sprite::FromRenderTarget(RenderTargetID renderTarget, std::uint32_t width, std::uint32_t height, float x, float y, int32_t depth, float scaleX, float scaleY, float rotation, SDL_Color blend) {
+	Sprite sprite;
+	if (renderTarget == RENDER_TARGET_ID_NULL) { return sprite; }
+	sprite.m_renderTargetID = renderTarget;
+	sprite.m_positionX = x;
+	sprite.m_positionY = y;
+	sprite.m_depth = depth;
+	sprite.m_scaleX = scaleX;
+	sprite.m_scaleY = scaleY;
+	sprite.m_rotation = rotation;
+	sprite.m_blend = blend;
+	sprite.m_width = float(width);
+	sprite.m_height = float(height);
+	sprite.m_textureW = 1.f;
+	sprite.m_textureH = 1.f;
+	return sprite;
+}
+
+Sprite Sprite::FromGlyph(GlyphPageID glyphPage, const SpriteTextureCoords& coords, float width, float height, float x, float y, int32_t depth, float scale, SDL_Color blend) {
+	Sprite sprite;
+	if (glyphPage == GLYPH_PAGE_ID_NULL) { return sprite; }
+	sprite.m_glyphPageID = glyphPage;
+	sprite.m_positionX = x;
+	sprite.m_positionY = y;
+	sprite.m_depth = depth;
+	sprite.m_scaleX = scale;
+	sprite.m_scaleY = scale;
+	sprite.m_blend = blend;
+	sprite.m_width = width;
+	sprite.m_height = height;
+	sprite.m_textureU = coords.textureU;
+	sprite.m_textureV = coords.textureV;
+	sprite.m_textureW = coords.textureW;
+	sprite.m_textureH = coords.textureH;
+	return sprite;
+}
+
 bool Sprite::IsValid() const {
-	return m_textureID != RESOURCE_ID_NULL;
+	return m_textureID != RESOURCE_ID_NULL || m_renderTargetID != RENDER_TARGET_ID_NULL || m_glyphPageID != GLYPH_PAGE_ID_NULL;
 }
 
 float Sprite::GetPositionX() const {
@@ -147,6 +194,14 @@ ResourceID Sprite::GetTextureID() const {
 	return m_textureID;
 }
 
+RenderTargetID Sprite::GetRenderTargetID() const {
+	return m_renderTargetID;
+}
+
+GlyphPageID Sprite::GetGlyphPageID() const {
+	return m_glyphPageID;
+}
+
 SpriteTextureCoords Sprite::GetTextureCoords() const {
 	SpriteTextureCoords coords = {};
 	coords.textureU = m_textureU;
@@ -157,11 +212,12 @@ SpriteTextureCoords Sprite::GetTextureCoords() const {
 }
 
 TexturePageID Sprite::GetTexturePageID() const {
-	auto resourceFile = ResourceManager::GetResourceFile(m_texture->GetFileID());
+	if (!m_texture) { return TEXTURE_PAGE_ID_NULL; }
 	return m_texture->GetTexturePageID();
 }
 
 const TexturePage* Sprite::GetTexturePage() const {
+	if (!m_texture) { return nullptr; }
 	auto resourceFile = ResourceManager::GetResourceFile(m_texture->GetFileID());
 	auto texturePage = resourceFile->GetTexturePage(m_texture->GetTexturePageID());
 	return texturePage;
@@ -175,6 +231,10 @@ float Sprite::GetAlpha() const {
 	return m_blend.a / 255.f;
 }
 
+SpriteBlendMode Sprite::GetBlendMode() const {
+	return m_blendMode;
+}
+
 float Sprite::GetOriginX() const {
 	return m_originX;
 }
@@ -186,10 +246,22 @@ float Sprite::GetOriginY() const {
 bool Sprite::GetTranslucent() const {
 	return (
 		(m_blend.a > 0 && m_blend.a < 255) ||
+		m_blendMode == SpriteBlendMode::Additive ||
+		!m_texture ||
 		m_texture->GetProperties() & 0x01
 	);
 }
 
+bool Sprite::GetSolid() const {
+	return (
+		m_blend.a == 255 &&
+		m_blendMode == SpriteBlendMode::Normal &&
+		m_texture &&
+		m_texture->IsSolid() &&
+		!(m_texture->GetProperties() & 0x01)
+	);
+}
+
 void Sprite::SetPositionX(float x) {
 	m_positionX = x;
 }
@@ -227,6 +299,10 @@ void Sprite::SetAlpha(float alpha) {
 	m_blend.a = Uint8(alpha * 255.f);
 }
 
+void Sprite::SetBlendMode(SpriteBlendMode blendMode) {
+	m_blendMode = blendMode;
+}
+
 void Sprite::SetOriginX(std::int32_t originX) {
 	m_originX = originX;
 }
@@ -254,9 +330,22 @@ ShapeCircle Sprite::GetShapeCircle() const {
 	return ShapeCircle(cx, cy, std::sqrtf(dw * dw + dh * dh));
 }
 
+ShapeMask Sprite::GetShapeMask() const {
+	const CollisionMask* mask = (m_texture) ? m_texture->GetCollisionMask(GetImage()) : nullptr;
+	return ShapeMask(
+		mask,
+		m_positionX - (m_originX * m_scaleX),
+		m_positionY - (m_originY * m_scaleY),
+		m_scaleX,
+		m_scaleY
+	);
+}
+
 Sprite& Sprite::operator=(const Sprite& other) {
 	if (this == &other) { return *this; }
 	m_textureID = other.m_textureID;
+	m_renderTargetID = other.m_renderTargetID;
+	m_glyphPageID = other.m_glyphPageID;
 	m_positionX = other.m_positionX;
 	m_positionY = other.m_positionY;
 	m_animationSpeed = other.m_animationSpeed;
@@ -265,6 +354,7 @@ Sprite& Sprite::operator=(const Sprite& other) {
 	m_scaleY = other.m_scaleY;
 	m_rotation = other.m_rotation;
 	m_blend = other.m_blend;
+	m_blendMode = other.m_blendMode;
 	m_texture = other.m_texture;
 	m_width = other.m_width;
 	m_height = other.m_height;
@@ -281,6 +371,8 @@ Sprite& Sprite::operator=(const Sprite& other) {
 Sprite& Sprite::operator=(Sprite&& other) noexcept {
 	if (this == &other) { return *this; }
 	std::swap(m_textureID, other.m_textureID);
+	std::swap(m_renderTargetID, other.m_renderTargetID);
+	std::swap(m_glyphPageID, other.m_glyphPageID);
 	std::swap(m_positionX, other.m_positionX);
 	std::swap(m_positionY, other.m_positionY);
 	std::swap(m_animationSpeed, other.m_animationSpeed);
@@ -289,6 +381,7 @@ Sprite& Sprite::operator=(Sprite&& other) noexcept {
 	std::swap(m_scaleY, other.m_scaleY);
 	std::swap(m_rotation, other.m_rotation);
 	std::swap(m_blend, other.m_blend);
+	std::swap(m_blendMode, other.m_blendMode);
 	std::swap(m_texture, other.m_texture);
 	std::swap(m_width, other.m_width);
 	std::swap(m_height, other.m_height);
@@ -305,6 +398,8 @@ Sprite& Sprite::operator=(Sprite&& other) noexcept {
 bool Sprite::operator==(const Sprite& other) const {
 	return (
 		m_textureID == other.m_textureID &&
+		m_renderTargetID == other.m_renderTargetID &&
+		m_glyphPageID == other.m_glyphPageID &&
 		m_positionX == other.m_positionX &&
 		m_positionY == other.m_positionY &&
 		m_animationSpeed == other.m_animationSpeed &&
@@ -316,6 +411,7 @@ bool Sprite::operator==(const Sprite& other) const {
 		m_blend.g == other.m_blend.g &&
 		m_blend.b == other.m_blend.b &&
 		m_blend.a == other.m_blend.a &&
+		m_blendMode == other.m_blendMode &&
 		m_texture == other.m_texture &&
 		m_width == other.m_width &&
 		m_height == other.m_height &&
@@ -330,6 +426,9 @@ bool Sprite::operator==(const Sprite& other) const {
 }
 
 bool Sprite::Tick(float dt) {
+	// Render targets & glyphs have no animation, and stay valid until the renderer is told otherwise
+	if (m_renderTargetID != RENDER_TARGET_ID_NULL || m_glyphPageID != GLYPH_PAGE_ID_NULL) { return true; }
+
 	// Check if sprite is no longer valid
 	auto texture = ResourceManager::GetTexture(m_textureID);
 	if (!texture) { m_textureID = RESOURCE_ID_NULL; }
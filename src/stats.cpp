@@ -0,0 +1,165 @@
+#include <luna/detail/stats.hpp>
+#include <luna/detail/game.hpp>
+#include <luna/detail/room.hpp>
+#include <luna/detail/camera.hpp>
+
+namespace luna {
+
+FrameTimeHistogram::FrameTimeHistogram(std::size_t windowSize, float bucketWidthMs, std::size_t bucketCount) :
+	m_buckets(std::max<std::size_t>(bucketCount, 1), 0),
+	m_windowSize(std::max<std::size_t>(windowSize, 1)),
+	m_bucketWidthMs((bucketWidthMs > 0.f) ? bucketWidthMs : 1.f) {
+	m_samples.reserve(m_windowSize);
+}
+
+void FrameTimeHistogram::Record(float frameMs) {
+	frameMs = std::max(frameMs, 0.f);
+	if (m_samples.size() < m_windowSize) { m_samples.push_back(frameMs); }
+	else {
+		// Evict the oldest frame in its place
+		float& oldest = m_samples[m_next];
+		--m_buckets[GetBucketIndex(oldest)];
+		m_sum -= oldest;
+		oldest = frameMs;
+	}
+	m_next = (m_next + 1) % m_windowSize;
+	++m_buckets[GetBucketIndex(frameMs)];
+	m_sum += frameMs;
+}
+
+void FrameTimeHistogram::Clear() {
+	m_samples.clear();
+	std::fill(m_buckets.begin(), m_buckets.end(), 0);
+	m_next = 0;
+	m_sum = 0.0;
+}
+
+std::size_t FrameTimeHistogram::GetSampleCount() const {
+	return m_samples.size();
+}
+
+std::size_t FrameTimeHistogram::GetWindowSize() const {
+	return m_windowSize;
+}
+
+float FrameTimeHistogram::GetRecent(std::size_t age) const {
+	if (age >= m_samples.size()) { return 0.f; }
+	return m_samples[(m_next + m_windowSize - 1 - age) % m_windowSize];
+}
+
+float FrameTimeHistogram::GetMean() const {
+	return (m_samples.empty()) ? 0.f : float(m_sum / double(m_samples.size()));
+}
+
+float FrameTimeHistogram::GetMax() const {
+	return (m_samples.empty()) ? 0.f : *std::max_element(m_samples.begin(), m_samples.end());
+}
+
+float FrameTimeHistogram::GetPercentile(float percent) const {
+	if (m_samples.empty()) { return 0.f; }
+	std::vector<float> sorted = m_samples;
+	std::size_t index = std::size_t(std::clamp(percent, 0.f, 100.f) / 100.f * float(sorted.size() - 1) + 0.5f);
+	std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+	return sorted[index];
+}
+
+float FrameTimeHistogram::GetLow(float percent) const {
+	if (m_samples.empty()) { return 0.f; }
+
+	// At least the slowest frame counts, however short the window
+	std::vector<float> sorted = m_samples;
+	std::size_t count = std::max<std::size_t>(std::size_t(std::clamp(percent, 0.f, 100.f) / 100.f * float(sorted.size())), 1);
+	std::nth_element(sorted.begin(), sorted.begin() + (count - 1), sorted.end(), std::greater<float>());
+	double sum = 0.0;
+	for (std::size_t i = 0; i < count; ++i) { sum += sorted[i]; }
+	return float(sum / double(count));
+}
+
+std::size_t FrameTimeHistogram::GetBucketCount() const {
+	return m_buckets.size();
+}
+
+float FrameTimeHistogram::GetBucketWidth() const {
+	return m_bucketWidthMs;
+}
+
+std::size_t FrameTimeHistogram::GetBucket(std::size_t index) const {
+	return (index < m_buckets.size()) ? m_buckets[index] : 0;
+}
+
+std::size_t FrameTimeHistogram::GetBucketIndex(float frameMs) const {
+	return std::min(std::size_t(frameMs / m_bucketWidthMs), m_buckets.size() - 1);
+}
+
+namespace detail {
+
+void DrawStatsOverlay(Renderer* renderer, const Room* room, const FrameStats& stats, const FrameTimeHistogram& histogram) {
+	if (!renderer || !room) { return; }
+
+	// Draw over the active camera if it shows the frame, or else the first camera that does
+	const Camera* camera = room->GetActiveCamera();
+	if (!camera || !camera->IsEnabled() || camera->GetRenderTarget() != RENDER_TARGET_ID_NULL) {
+		camera = nullptr;
+		for (std::size_t i = 0; i < room->GetNumCameras(); ++i) {
+			const Camera* other = room->GetCamera(i);
+			if (other->IsEnabled() && other->GetRenderTarget() == RENDER_TARGET_ID_NULL) { camera = other; break; }
+		}
+	}
+	if (!camera) { return; }
+
+	// Lay the overlay out in pixels, scaled into the camera's world units
+	const float GRAPH_WIDTH = 240.f;
+	const float GRAPH_HEIGHT = 80.f;
+	const float BAR_HEIGHT = 8.f;
+	const float MARGIN = 4.f;
+	const float GRAPH_MAX_MS = 50.f;
+	std::uint32_t viewportWidth = (camera->GetViewportWidth() > 0) ? camera->GetViewportWidth() : Game::GetWindowWidth();
+	std::uint32_t viewportHeight = (camera->GetViewportHeight() > 0) ? camera->GetViewportHeight() : Game::GetWindowHeight();
+	float scaleX = (viewportWidth > 0) ? float(camera->GetWidth()) / float(viewportWidth) : 1.f;
+	float scaleY = (viewportHeight > 0) ? float(camera->GetHeight()) / float(viewportHeight) : 1.f;
+	float left = float(camera->GetLeftEdge());
+	float top = float(camera->GetTopEdge());
+
+	// Layers count back from the near plane, so lines sit over bars and bars over the background
+	auto drawRect = [&](float x, float y, float w, float h, SDL_Color color, std::int32_t layer) {
+		if (w <= 0.f || h <= 0.f) { return; }
+		std::int32_t depth = std::min(camera->GetNearPlane() + layer, camera->GetFarPlane());
+		renderer->DrawPrimitive(Primitive(ShapeAABB(left + x * scaleX, top + y * scaleY, left + (x + w) * scaleX, top + (y + h) * scaleY), false, depth, color));
+	};
+	auto graphY = [&](float ms) { return MARGIN + GRAPH_HEIGHT - std::min(ms, GRAPH_MAX_MS) / GRAPH_MAX_MS * GRAPH_HEIGHT; };
+
+	// Background
+	drawRect(0.f, 0.f, GRAPH_WIDTH + MARGIN * 2.f, GRAPH_HEIGHT + BAR_HEIGHT + MARGIN * 3.f, SDL_Color{ 0, 0, 0, 160 }, 2);
+
+	// One bar per frame, newest on the right
+	std::size_t barCount = std::min(histogram.GetSampleCount(), std::size_t(GRAPH_WIDTH / 2.f));
+	for (std::size_t age = 0; age < barCount; ++age) {
+		float ms = histogram.GetRecent(age);
+		SDL_Color color = (ms <= 1000.f / 60.f) ? LunaColorGreen : ((ms <= 1000.f / 30.f) ? LunaColorYellow : LunaColorRed);
+		float x = MARGIN + GRAPH_WIDTH - float(age + 1) * 2.f;
+		drawRect(x, graphY(ms), 2.f, MARGIN + GRAPH_HEIGHT - graphY(ms), color, 1);
+	}
+	drawRect(MARGIN, graphY(1000.f / 60.f), GRAPH_WIDTH, 1.f, LunaColorDarkGray, 0);
+	drawRect(MARGIN, graphY(1000.f / 30.f), GRAPH_WIDTH, 1.f, LunaColorDarkGray, 0);
+	if (histogram.GetSampleCount() > 0) { drawRect(MARGIN, graphY(histogram.GetLow(1.f)), GRAPH_WIDTH, 1.f, LunaColorWhite, 0); }
+
+	// Last frame's stages, stacked to scale with the graph's time axis
+	const float stageMs[] = {
+		stats.tickMs, stats.drawSubmitMs, stats.render.gatherMs, stats.render.cullMs, stats.render.prepareMs, stats.render.sortMs,
+		stats.render.batchMs, stats.render.packMs, stats.render.submitMs, stats.render.fenceWaitMs
+	};
+	const SDL_Color stageColors[] = {
+		LunaColorBlue, LunaColorCyan, LunaColorLightBlue, LunaColorLightGreen, LunaColorGreen, LunaColorYellow,
+		LunaColorOrange, LunaColorMagenta, LunaColorPink, LunaColorRed
+	};
+	float x = MARGIN;
+	for (std::size_t i = 0; i < sizeof(stageMs) / sizeof(stageMs[0]); ++i) {
+		float w = std::min(stageMs[i] / GRAPH_MAX_MS * GRAPH_WIDTH, MARGIN + GRAPH_WIDTH - x);
+		drawRect(x, GRAPH_HEIGHT + MARGIN * 2.f, w, BAR_HEIGHT, stageColors[i], 1);
+		x += std::max(w, 0.f);
+	}
+}
+
+} // detail
+
+} // luna
\ No newline at end of file
@@ -0,0 +1,400 @@
+#include <luna/detail/text.hpp>
+
+namespace luna {
+
+Text::Text() {}
+
+Text::Text(FontID font, const std::string& string, float x, float y, std::int32_t depth, SDL_Color color, TextAlign align, float scale) :
+	m_font(font),
+	m_string(string),
+	m_positionX(x),
+	m_positionY(y),
+	m_depth(depth),
+	m_color(color),
+	m_align(align),
+	m_scale(scale) {}
+
+bool Text::IsValid() const {
+	return m_font != FONT_ID_NULL && !m_string.empty();
+}
+
+FontID Text::GetFont() const {
+	return m_font;
+}
+
+const std::string& Text::GetString() const {
+	return m_string;
+}
+
+float Text::GetPositionX() const {
+	return m_positionX;
+}
+
+float Text::GetPositionY() const {
+	return m_positionY;
+}
+
+std::int32_t Text::GetDepth() const {
+	return m_depth;
+}
+
+SDL_Color Text::GetColor() const {
+	return m_color;
+}
+
+TextAlign Text::GetAlign() const {
+	return m_align;
+}
+
+float Text::GetScale() const {
+	return m_scale;
+}
+
+void Text::SetFont(FontID font) {
+	m_font = font;
+}
+
+void Text::SetString(const std::string& string) {
+	m_string = string;
+}
+
+void Text::SetPositionX(float x) {
+	m_positionX = x;
+}
+
+void Text::SetPositionY(float y) {
+	m_positionY = y;
+}
+
+void Text::SetDepth(std::int32_t depth) {
+	m_depth = depth;
+}
+
+void Text::SetColor(const SDL_Color& color) {
+	m_color = color;
+}
+
+void Text::SetAlign(TextAlign align) {
+	m_align = align;
+}
+
+void Text::SetScale(float scale) {
+	m_scale = scale;
+}
+
+namespace detail {
+
+// Empty texels kept to the right of & below each glyph, so filtering never reads a neighbor
+static constexpr std::uint32_t GLYPH_PADDING = 1;
+
+// Shelves are opened in multiples of this height, so glyphs of similar sizes can share them
+static constexpr std::uint32_t GLYPH_SHELF_ROUNDING = 4;
+
+GlyphAtlas::GlyphAtlas(std::uint32_t pageSize, std::uint32_t maxPages) :
+	m_pageSize(std::max<std::uint32_t>(pageSize, 64)),
+	m_maxPages(std::max<std::uint32_t>(maxPages, 1)) {
+	m_pages.reserve(m_maxPages);
+}
+
+GlyphAtlas::~GlyphAtlas() {
+	for (auto& font : m_fonts) { TTF_CloseFont(font.second.m_ttfFont); }
+}
+
+FontID GlyphAtlas::OpenFont(const std::string& filename, float pointSize) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (auto& font : m_fonts) {
+		if (font.second.m_filename == filename && font.second.m_pointSize == pointSize) {
+			++font.second.m_references;
+			return font.first;
+		}
+	}
+	TTF_Font* ttfFont = TTF_OpenFont(filename.c_str(), pointSize);
+	if (!ttfFont) {
+		SDL_LogError(SDL_LOG_CATEGORY_ERROR, "TTF_OpenFont failed! %s", SDL_GetError());
+		return FONT_ID_NULL;
+	}
+
+	// Handles are never given out twice, so glyphs of a closed font can never be mistaken for a later one's
+	Font font;
+	font.m_ttfFont = ttfFont;
+	font.m_filename = filename;
+	font.m_pointSize = pointSize;
+	font.m_references = 1;
+	font.m_lineSkip = TTF_GetFontLineSkip(ttfFont);
+	FontID fontID = m_nextFontID++;
+	m_fonts.emplace(fontID, std::move(font));
+	return fontID;
+}
+
+void GlyphAtlas::CloseFont(FontID fontID) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto it = m_fonts.find(fontID);
+	if (it == m_fonts.end() || --it->second.m_references > 0) { return; }
+	TTF_CloseFont(it->second.m_ttfFont);
+	m_fonts.erase(it);
+
+	// Its space in the atlas is left to be evicted once the shelves holding it are the least recently used
+	for (auto glyph = m_glyphs.begin(); glyph != m_glyphs.end();) {
+		if (FontID(glyph->first >> 32) == fontID) { glyph = m_glyphs.erase(glyph); }
+		else { ++glyph; }
+	}
+}
+
+std::size_t GlyphAtlas::LayoutText(const Text& text, SpriteList& sprites) {
+	if (!text.IsValid()) { return 0; }
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto fontIt = m_fonts.find(text.GetFont());
+	if (fontIt == m_fonts.end()) { return 0; }
+	Font& font = fontIt->second;
+
+	// Lines are laid out from the left, then moved over by their width once it is known
+	float scale = text.GetScale();
+	std::size_t firstSprite = sprites.size();
+	std::size_t lineStart = firstSprite;
+	float penX = 0.f;
+	float lineY = 0.f;
+	auto finishLine = [&]() {
+		float shift = 0.f;
+		if (text.GetAlign() == TextAlign::Center) { shift = -penX * scale * 0.5f; }
+		else if (text.GetAlign() == TextAlign::Right) { shift = -penX * scale; }
+		if (shift != 0.f) {
+			for (std::size_t i = lineStart; i < sprites.size(); ++i) { sprites[i].SetPositionX(sprites[i].GetPositionX() + shift); }
+		}
+		lineStart = sprites.size();
+	};
+
+	const char* str = text.GetString().c_str();
+	std::size_t length = text.GetString().size();
+	Uint32 previous = 0;
+	float pageSize = float(m_pageSize);
+	while (length > 0) {
+		Uint32 codepoint = SDL_StepUTF8(&str, &length);
+		if (codepoint == 0) { break; }
+		if (codepoint == '\r') { continue; }
+		if (codepoint == '\n') {
+			finishLine();
+			penX = 0.f;
+			lineY += float(font.m_lineSkip);
+			previous = 0;
+			continue;
+		}
+		int kerning = 0;
+		if (previous != 0 && TTF_GetGlyphKerning(font.m_ttfFont, previous, codepoint, &kerning)) { penX += float(kerning); }
+		previous = codepoint;
+		const Glyph* glyph = GetGlyph(text.GetFont(), font, codepoint);
+		if (!glyph) { continue; }
+		if (glyph->m_page != GLYPH_PAGE_ID_NULL) {
+			SpriteTextureCoords coords = {};
+			coords.textureU = float(glyph->m_x) / pageSize;
+			coords.textureV = float(glyph->m_y) / pageSize;
+			coords.textureW = float(glyph->m_width) / pageSize;
+			coords.textureH = float(glyph->m_height) / pageSize;
+			sprites.push_back(Sprite::FromGlyph(
+				glyph->m_page,
+				coords,
+				float(glyph->m_width),
+				float(glyph->m_height),
+				text.GetPositionX() + (penX + glyph->m_offsetX) * scale,
+				text.GetPositionY() + (lineY + glyph->m_offsetY) * scale,
+				text.GetDepth(),
+				scale,
+				text.GetColor()
+			));
+		}
+		penX += glyph->m_advance;
+	}
+	finishLine();
+	return sprites.size() - firstSprite;
+}
+
+void GlyphAtlas::BeginFrame() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	++m_frameIndex;
+}
+
+std::uint32_t GlyphAtlas::GetPageSize() const {
+	return m_pageSize;
+}
+
+std::uint32_t GlyphAtlas::GetPageCount() const {
+	return std::uint32_t(m_pages.size());
+}
+
+const std::uint8_t* GlyphAtlas::GetPagePixels(GlyphPageID page) const {
+	if (page == GLYPH_PAGE_ID_NULL || page > m_pages.size()) { return nullptr; }
+	return m_pages[page - 1].m_pixels.data();
+}
+
+bool GlyphAtlas::TakeDirtyRect(GlyphPageID page, SDL_Rect& rect) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (page == GLYPH_PAGE_ID_NULL || page > m_pages.size()) { return false; }
+	SDL_Rect& dirtyRect = m_pages[page - 1].m_dirtyRect;
+	if (SDL_RectEmpty(&dirtyRect)) { return false; }
+	rect = dirtyRect;
+	dirtyRect = {};
+	return true;
+}
+
+std::uint64_t GlyphAtlas::GlyphKey(FontID font, Uint32 codepoint) {
+	return (std::uint64_t(font) << 32) | codepoint;
+}
+
+const GlyphAtlas::Glyph* GlyphAtlas::GetGlyph(FontID fontID, Font& font, Uint32 codepoint) {
+	std::uint64_t key = GlyphKey(fontID, codepoint);
+	auto it = m_glyphs.find(key);
+	if (it != m_glyphs.end()) {
+		if (it->second.m_page != GLYPH_PAGE_ID_NULL) { m_shelves[it->second.m_shelf].m_lastUsed = m_frameIndex; }
+		return &it->second;
+	}
+	int minX = 0, maxX = 0, minY = 0, maxY = 0, advance = 0;
+	if (!TTF_GetGlyphMetrics(font.m_ttfFont, codepoint, &minX, &maxX, &minY, &maxY, &advance)) { return nullptr; }
+	Glyph glyph;
+	glyph.m_advance = float(advance);
+
+	// Glyphs are rendered a line tall, with the pen at the left edge less any overhang; only the covered texels are kept
+	SDL_Surface* rendered = TTF_RenderGlyph_Blended(font.m_ttfFont, codepoint, LunaColorWhite);
+	SDL_Surface* surface = (rendered) ? SDL_ConvertSurface(rendered, SDL_PIXELFORMAT_BGRA32) : nullptr;
+	SDL_DestroySurface(rendered);
+	if (!surface) {
+		SDL_LogError(SDL_LOG_CATEGORY_ERROR, "TTF_RenderGlyph_Blended failed! %s", SDL_GetError());
+		return nullptr;
+	}
+	SDL_LockSurface(surface);
+	const std::uint8_t* pixels = (const std::uint8_t*)surface->pixels;
+	std::int32_t left = surface->w, top = surface->h, right = 0, bottom = 0;
+	for (std::int32_t y = 0; y < surface->h; ++y) {
+		const std::uint8_t* row = pixels + std::size_t(y) * surface->pitch;
+		for (std::int32_t x = 0; x < surface->w; ++x) {
+			if (row[x * 4 + 3] == 0) { continue; }
+			left = std::min(left, x);
+			right = std::max(right, x + 1);
+			top = std::min(top, y);
+			bottom = std::max(bottom, y + 1);
+		}
+	}
+
+	// Blank glyphs such as spaces only move the pen
+	std::size_t shelfIndex = 0;
+	std::uint32_t shelfX = 0;
+	if (left < right) {
+		glyph.m_width = std::uint32_t(right - left);
+		glyph.m_height = std::uint32_t(bottom - top);
+		if (!Allocate(glyph.m_width + GLYPH_PADDING, glyph.m_height + GLYPH_PADDING, shelfIndex, shelfX)) {
+			SDL_UnlockSurface(surface);
+			SDL_DestroySurface(surface);
+			return nullptr;
+		}
+		Shelf& shelf = m_shelves[shelfIndex];
+		shelf.m_glyphs.push_back(key);
+		shelf.m_lastUsed = m_frameIndex;
+		glyph.m_page = shelf.m_page;
+		glyph.m_shelf = shelfIndex;
+		glyph.m_x = shelfX;
+		glyph.m_y = shelf.m_y;
+		glyph.m_offsetX = float(left + std::min(minX, 0));
+		glyph.m_offsetY = float(top);
+
+		// Rendered in white, so premultiplying leaves every channel equal to coverage
+		Page& page = m_pages[glyph.m_page - 1];
+		for (std::uint32_t y = 0; y < glyph.m_height; ++y) {
+			const std::uint8_t* src = pixels + std::size_t(top + y) * surface->pitch + std::size_t(left) * 4;
+			std::uint8_t* dst = page.m_pixels.data() + (std::size_t(glyph.m_y + y) * m_pageSize + glyph.m_x) * 4;
+			for (std::uint32_t x = 0; x < glyph.m_width; ++x) {
+				std::uint8_t coverage = src[x * 4 + 3];
+				dst[x * 4 + 0] = coverage;
+				dst[x * 4 + 1] = coverage;
+				dst[x * 4 + 2] = coverage;
+				dst[x * 4 + 3] = coverage;
+			}
+		}
+		MarkDirty(glyph.m_page, SDL_Rect{ int(glyph.m_x), int(glyph.m_y), int(glyph.m_width), int(glyph.m_height) });
+	}
+	SDL_UnlockSurface(surface);
+	SDL_DestroySurface(surface);
+	return &m_glyphs.emplace(key, glyph).first->second;
+}
+
+bool GlyphAtlas::Allocate(std::uint32_t width, std::uint32_t height, std::size_t& shelfIndex, std::uint32_t& x) {
+	if (width > m_pageSize || height > m_pageSize) { return false; }
+	std::uint32_t shelfHeight = std::min(std::uint32_t(RoundUp(height, GLYPH_SHELF_ROUNDING)), m_pageSize);
+	auto place = [&](std::size_t index) {
+		Shelf& shelf = m_shelves[index];
+		shelfIndex = index;
+		x = shelf.m_nextX;
+		shelf.m_nextX += width;
+		return true;
+	};
+
+	// The shortest open shelf that fits, as long as it wastes no more than half the glyph's height
+	std::size_t best = m_shelves.size();
+	for (std::size_t i = 0; i < m_shelves.size(); ++i) {
+		const Shelf& shelf = m_shelves[i];
+		if (shelf.m_height < height || shelf.m_height > shelfHeight + shelfHeight / 2 || shelf.m_nextX + width > m_pageSize) { continue; }
+		if (best == m_shelves.size() || shelf.m_height < m_shelves[best].m_height) { best = i; }
+	}
+	if (best < m_shelves.size()) { return place(best); }
+
+	// Otherwise a new shelf, under the last one on a page or on a page of its own
+	GlyphPageID page = GLYPH_PAGE_ID_NULL;
+	for (std::size_t i = 0; i < m_pages.size(); ++i) {
+		if (m_pages[i].m_nextShelfY + shelfHeight <= m_pageSize) { page = GlyphPageID(i + 1); break; }
+	}
+	if (page == GLYPH_PAGE_ID_NULL && m_pages.size() < m_maxPages) {
+		// New pages are uploaded whole, since GPU textures start out undefined
+		Page newPage;
+		newPage.m_pixels.assign(std::size_t(m_pageSize) * m_pageSize * 4, 0);
+		m_pages.push_back(std::move(newPage));
+		page = GlyphPageID(m_pages.size());
+		MarkDirty(page, SDL_Rect{ 0, 0, int(m_pageSize), int(m_pageSize) });
+	}
+	if (page != GLYPH_PAGE_ID_NULL) {
+		Shelf shelf;
+		shelf.m_page = page;
+		shelf.m_y = m_pages[page - 1].m_nextShelfY;
+		shelf.m_height = shelfHeight;
+		m_pages[page - 1].m_nextShelfY += shelfHeight;
+		m_shelves.push_back(std::move(shelf));
+		return place(m_shelves.size() - 1);
+	}
+
+	// The atlas is full, so take any shelf with room, however much of it is wasted
+	for (std::size_t i = 0; i < m_shelves.size(); ++i) {
+		const Shelf& shelf = m_shelves[i];
+		if (shelf.m_height >= height && shelf.m_nextX + width <= m_pageSize) { return place(i); }
+	}
+
+	// Or empty the least recently used shelf tall enough, unless all of them hold glyphs in use this frame
+	best = m_shelves.size();
+	for (std::size_t i = 0; i < m_shelves.size(); ++i) {
+		const Shelf& shelf = m_shelves[i];
+		if (shelf.m_height < height || shelf.m_lastUsed >= m_frameIndex) { continue; }
+		if (best == m_shelves.size() || shelf.m_lastUsed < m_shelves[best].m_lastUsed) { best = i; }
+	}
+	if (best == m_shelves.size()) { return false; }
+	EvictShelf(best);
+	return place(best);
+}
+
+void GlyphAtlas::EvictShelf(std::size_t shelfIndex) {
+	Shelf& shelf = m_shelves[shelfIndex];
+	for (auto key : shelf.m_glyphs) { m_glyphs.erase(key); }
+	shelf.m_glyphs.clear();
+
+	// Clear the old texels, so glyphs placed here later never filter in what used to surround them
+	Page& page = m_pages[shelf.m_page - 1];
+	for (std::uint32_t y = shelf.m_y; y < shelf.m_y + shelf.m_height; ++y) {
+		SDL_memset(page.m_pixels.data() + std::size_t(y) * m_pageSize * 4, 0, std::size_t(shelf.m_nextX) * 4);
+	}
+	if (shelf.m_nextX > 0) { MarkDirty(shelf.m_page, SDL_Rect{ 0, int(shelf.m_y), int(shelf.m_nextX), int(shelf.m_height) }); }
+	shelf.m_nextX = 0;
+}
+
+void GlyphAtlas::MarkDirty(GlyphPageID page, const SDL_Rect& rect) {
+	SDL_Rect& dirtyRect = m_pages[page - 1].m_dirtyRect;
+	if (SDL_RectEmpty(&dirtyRect)) { dirtyRect = rect; }
+	else { SDL_GetRectUnion(&dirtyRect, &rect, &dirtyRect); }
+}
+
+} // detail
+
+} // luna
\ No newline at end of file
@@ -2,6 +2,9 @@
 
 namespace luna {
 
+// Must match the vertex attributes in PrimitiveBatchShaderPipeline
+static_assert(sizeof(VertexPosPackedColor) == 16);
+
 VertexPos::VertexPos(float x, float y, float z) {
 	m_data[0] = x;
 	m_data[1] = y;
@@ -86,4 +89,45 @@ std::ostream& operator<<(std::ostream& stream, const VertexPosColor& vertex) {
 	return stream;
 }
 
+VertexPosPackedColor::VertexPosPackedColor(float x, float y, float z, std::uint32_t color) {
+	m_position[0] = x;
+	m_position[1] = y;
+	m_position[2] = z;
+	m_color = color;
+}
+
+VertexPosPackedColor::VertexPosPackedColor(const VertexPosColor& vertex) {
+	m_position[0] = vertex[0];
+	m_position[1] = vertex[1];
+	m_position[2] = vertex[2];
+	m_color = detail::PackUnorm4x8(vertex[3], vertex[4], vertex[5], vertex[6]);
+}
+
+VertexPos VertexPosPackedColor::xyz() const {
+	return VertexPos(m_position[0], m_position[1], m_position[2]);
+}
+
+std::uint32_t VertexPosPackedColor::GetColor() const {
+	return m_color;
+}
+
+bool VertexPosPackedColor::operator==(const VertexPosPackedColor& other) const {
+	return (
+		m_position[0] == other.m_position[0] &&
+		m_position[1] == other.m_position[1] &&
+		m_position[2] == other.m_position[2] &&
+		m_color == other.m_color
+		);
+}
+
+bool VertexPosPackedColor::operator!=(const VertexPosPackedColor& other) const {
+	return !(*this == other);
+}
+
+std::ostream& operator<<(std::ostream& stream, const VertexPosPackedColor& vertex) {
+	stream << std::fixed << std::setprecision(2) << "{" << vertex.m_position[0] << "," << vertex.m_position[1] << "," << vertex.m_position[2] << " / "
+		<< std::hex << std::setw(8) << std::setfill('0') << vertex.m_color << std::dec << std::setfill(' ') << "}";
+	return stream;
+}
+
 } // luna
\ No newline at end of file
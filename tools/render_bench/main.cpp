@@ -0,0 +1,219 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <fstream>
+#include <filesystem>
+#include <vex/vex_cpp.hpp>
+#include <luna/luna.hpp>
+#include "../resource_bench/archive_generator.hpp"
+
+// Frame of generated renderables, submitted again every frame
+struct bench_scene {
+	std::vector<luna::Sprite> sprites;
+	std::vector<luna::Primitive> primitives;
+};
+
+// Everything the benchmark keeps between frames
+struct bench_state {
+	std::vector<std::size_t> counts;
+	std::vector<luna::ResourceID> textures;
+	std::vector<luna::RenderTargetID> render_targets;
+	int frames = 5;
+	int warmup_frames = 2;
+	std::size_t stage = 0;
+	int stage_frame = 0;
+	bench_scene scene;
+
+	// Totals over the timed frames of the current stage
+	double submit_ms = 0.0;
+	luna::RenderTimings timings;
+	std::uint64_t renderables = 0;
+	std::uint64_t batches = 0;
+	std::uint64_t draw_calls = 0;
+};
+
+static bench_state state;
+
+static bench_scene generate_scene(std::size_t count, float width, float height, std::uint32_t seed) {
+	std::mt19937 rng(seed);
+	std::uniform_int_distribution<std::size_t> texture_dist(0, state.textures.size() - 1);
+	std::uniform_int_distribution<std::size_t> target_dist(0, state.render_targets.size() - 1);
+	std::uniform_int_distribution<std::int32_t> depth_dist(-1000, 1000);
+	std::uniform_int_distribution<std::uint32_t> percent_dist(0, 99);
+	std::uniform_real_distribution<float> x_dist(-0.05f * width, 1.05f * width);
+	std::uniform_real_distribution<float> y_dist(-0.05f * height, 1.05f * height);
+	std::uniform_real_distribution<float> size_dist(4.f, 64.f);
+	bench_scene scene;
+	for (std::size_t i = 0; i < count; ++i) {
+		// Mostly texture page sprites, solid or translucent by their texture, a few tinted or additive. The rest are
+		// render target sprites & shapes with a quarter of them translucent. A few land off screen
+		float x = x_dist(rng), y = y_dist(rng), size = size_dist(rng);
+		std::int32_t depth = depth_dist(rng);
+		std::uint32_t kind = percent_dist(rng);
+		if (kind < 70) {
+			luna::Sprite sprite(state.textures[texture_dist(rng)], x, y, 0, 0.f, depth);
+			std::uint32_t style = percent_dist(rng);
+			if (style < 10) { sprite.SetAlpha(0.5f); }
+			else if (style < 15) { sprite.SetBlendMode(luna::SpriteBlendMode::Additive); }
+			scene.sprites.push_back(sprite);
+			continue;
+		}
+		if (kind < 80) {
+			luna::RenderTargetID target = state.render_targets[target_dist(rng)];
+			scene.sprites.push_back(luna::Sprite::FromRenderTarget(target, std::uint32_t(size), std::uint32_t(size), x, y, depth));
+			continue;
+		}
+		SDL_Color color = { Uint8(percent_dist(rng) * 2), Uint8(percent_dist(rng) * 2), 255, Uint8((percent_dist(rng) < 25) ? 128 : 255) };
+		bool outline = (percent_dist(rng) & 1) != 0;
+		if (percent_dist(rng) < 50) { scene.primitives.emplace_back(luna::ShapeCircle(x, y, size * 0.5f), outline, depth, color); }
+		else { scene.primitives.emplace_back(luna::ShapeAABB(x, y, x + size, y + size), outline, depth, color); }
+	}
+	return scene;
+}
+
+static void report_stage() {
+	double frames = double(state.frames);
+	std::size_t count = state.counts[state.stage];
+	std::cout << std::left << std::setw(12) << count << std::right << std::fixed << std::setprecision(3)
+		<< std::setw(11) << (state.submit_ms / frames)
+		<< std::setw(11) << (double(state.timings.gatherMs) / frames)
+		<< std::setw(11) << (double(state.timings.cullMs) / frames)
+		<< std::setw(11) << (double(state.timings.sortMs) / frames)
+		<< std::setw(11) << (double(state.timings.batchMs) / frames)
+		<< std::setw(11) << (double(state.timings.packMs) / frames)
+		<< std::setprecision(1)
+		<< std::setw(14) << (double(state.renderables) / frames)
+		<< std::setw(10) << (double(state.batches) / frames)
+		<< std::setw(12) << (double(state.draw_calls) / frames) << std::endl;
+}
+
+static void bench_frame(luna::Renderer* renderer) {
+	// Count the frame the renderer prepared since the last call, once past the warmup
+	if (state.stage_frame > state.warmup_frames) {
+		const luna::RenderTimings& timings = renderer->GetFrameTimings();
+		const luna::RenderCounts& counts = renderer->GetFrameCounts();
+		state.timings.gatherMs += timings.gatherMs;
+		state.timings.cullMs += timings.cullMs;
+		state.timings.sortMs += timings.sortMs;
+		state.timings.batchMs += timings.batchMs;
+		state.timings.packMs += timings.packMs;
+		state.renderables += counts.renderables;
+		state.batches += counts.batches;
+		state.draw_calls += counts.drawCalls;
+	}
+	if (state.stage_frame == state.warmup_frames + state.frames) {
+		report_stage();
+		state.stage_frame = 0;
+		if (++state.stage == state.counts.size()) {
+			luna::Game::Quit();
+			return;
+		}
+	}
+
+	// Start a stage with a fresh scene & totals
+	if (state.stage_frame == 0) {
+		state.scene = generate_scene(state.counts[state.stage], float(luna::Game::GetWindowWidth()), float(luna::Game::GetWindowHeight()), 1);
+		state.submit_ms = 0.0;
+		state.timings = luna::RenderTimings();
+		state.renderables = state.batches = state.draw_calls = 0;
+	}
+
+	// Submit the scene the way a game would, through the renderer's queues
+	auto start = std::chrono::steady_clock::now();
+	for (auto& sprite : state.scene.sprites) { renderer->DrawSprite(sprite); }
+	for (auto& primitive : state.scene.primitives) { renderer->DrawPrimitive(primitive); }
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	if (state.stage_frame >= state.warmup_frames) { state.submit_ms += ms; }
+	++state.stage_frame;
+}
+
+int main(int argc, char** argv) {
+	// Read arguments
+	vex parser(
+		"luna_render_bench",
+		"1.0",
+		"Times the frame preparation of the sprite renderer, through the CPU-only NullRenderer, over a generated scene of texture page sprites, render target sprites & shapes."
+	);
+	parser.add_arg("Number of renderables (defaults to 10k, 100k & 1M)", VEX_ARG_TYPE_INT, "count", 'c', 1);
+	parser.add_arg("Number of texture pages & render targets the sprites are spread over", VEX_ARG_TYPE_INT, "pages", 'p', 1);
+	parser.add_arg("Percentage of textures with translucent texels", VEX_ARG_TYPE_INT, "translucent", 't', 1);
+	parser.add_arg("Number of timed frames", VEX_ARG_TYPE_INT, "frames", 'n', 1);
+	parser.parse(argc, argv);
+	if (parser.arg_found("h")) {
+		std::cout << parser.get_help() << std::endl;
+		return 0;
+	}
+	if (parser.arg_found("v")) {
+		std::cout << parser.get_version() << std::endl;
+		return 0;
+	}
+	state.counts = { 10000, 100000, 1000000 };
+	archive_params params;
+	params.page_count = 16;
+	params.page_size = 256;
+	params.translucent_percent = 25;
+	for (auto& token : parser) {
+		switch (token.short_name) {
+		case 'c': state.counts = { std::size_t(std::max(1, token.arg[0].int_arg)) }; break;
+		case 'p': params.page_count = std::uint32_t(std::max(1, token.arg[0].int_arg)); break;
+		case 't': params.translucent_percent = std::uint32_t(std::clamp(token.arg[0].int_arg, 0, 100)); break;
+		case 'n': state.frames = std::max(1, token.arg[0].int_arg); break;
+		default: break;
+		}
+	}
+
+	// Prepare frames headless, drawing texture pages that are never uploaded
+	luna::GameInit init = {};
+	init.appName = "luna_render_bench";
+	init.appIdentifier = "com.luna_render_bench";
+	init.headless = true;
+	init.ticksPerSecond = 0;
+	init.windowW = 1920;
+	init.windowH = 1080;
+	init.postDrawFunc = bench_frame;
+	luna::NullRendererFactory null_renderer_factory;
+	init.rendererFactory = &null_renderer_factory;
+	if (!luna::Game::Init(&init)) { return 1; }
+	luna::Renderer* renderer = luna::Game::GetRenderer();
+	for (std::uint32_t i = 0; i < params.page_count; ++i) { state.render_targets.push_back(renderer->CreateRenderTarget(64, 64)); }
+
+	// Generate texture pages like the resource benchmark, & load them the way a game would
+	luna::Buffer archive = generate_archive(params);
+	std::string archive_file_name = (std::filesystem::temp_directory_path() / "luna_render_bench.arc").string();
+	std::ofstream archive_file(archive_file_name, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (archive_file.fail()) {
+		std::cerr << "Failed to open output file (" << archive_file_name << ")" << std::endl;
+		return 1;
+	}
+	archive_file.write((const char*)archive.data(), std::streamsize(archive.size()));
+	archive_file.close();
+	luna::ResourceID file_id = luna::ResourceManager::LoadResourceFile(archive_file_name, params.password);
+	std::filesystem::remove(archive_file_name);
+	if (file_id == luna::RESOURCE_ID_NULL) {
+		std::cerr << luna::ResourceManager::ErrorMessage() << std::endl;
+		return 1;
+	}
+	for (std::uint32_t page = 0; page < params.page_count; ++page) {
+		for (std::uint32_t i = 0; i < params.assets_per_page; ++i) {
+			luna::ResourceID texture = luna::ResourceManager::GetTextureID("page" + std::to_string(page) + "_tex" + std::to_string(i));
+			if (texture != luna::RESOURCE_ID_NULL) { state.textures.push_back(texture); }
+		}
+	}
+	if (state.textures.empty()) {
+		std::cerr << "Generated file holds no textures" << std::endl;
+		return 1;
+	}
+	luna::RoomManager::PushRoom(luna::RoomInit());
+	luna::RoomManager::GetCurrentRoom()->CreateCamera();
+
+	// Report
+	std::cout << std::left << std::setw(12) << "count" << std::right
+		<< std::setw(11) << "submit ms" << std::setw(11) << "gather ms" << std::setw(11) << "cull ms" << std::setw(11) << "sort ms"
+		<< std::setw(11) << "batch ms" << std::setw(11) << "pack ms"
+		<< std::setw(14) << "renderables" << std::setw(10) << "batches" << std::setw(12) << "draw calls" << std::endl;
+	luna::Game::Run();
+	return 0;
+}
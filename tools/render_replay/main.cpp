@@ -0,0 +1,258 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+#include <vex/vex_cpp.hpp>
+#include <luna/luna.hpp>
+
+// Everything the replay keeps between frames
+struct replay_state {
+	std::vector<luna::CapturedFrame> frames;
+	std::vector<std::vector<luna::ResourceID>> frame_textures;
+	std::unordered_map<luna::RenderTargetID, luna::RenderTargetID> render_targets;
+	std::size_t frames_to_draw = 1000;
+	std::size_t frames_drawn = 0;
+	std::size_t current_frame = SIZE_MAX;
+	std::size_t missing_textures = 0;
+
+	// Sprite instances & static sprites of the frame being replayed
+	std::vector<luna::CapturedSprite> persistent_sprites;
+	std::vector<luna::SpriteInstanceID> instances;
+	std::vector<luna::StaticSpriteID> static_sprites;
+
+	// Totals over every frame drawn
+	std::chrono::steady_clock::time_point last_frame;
+	double total_ms = 0.0;
+	double min_ms = 0.0;
+	double max_ms = 0.0;
+	std::uint64_t renderables = 0;
+	std::uint64_t batches = 0;
+	std::uint64_t draw_calls = 0;
+	std::uint64_t upload_bytes = 0;
+};
+
+static replay_state state;
+
+// Load every resource file the capture refers to, and look its textures up by name
+static bool load_resources(const std::string& resource_dir, const std::string& password) {
+	std::unordered_map<std::string, luna::ResourceID> files;
+	for (auto& frame : state.frames) {
+		std::vector<luna::ResourceID> textures;
+		for (auto& texture : frame.textures) {
+			luna::ResourceID texture_id = luna::RESOURCE_ID_NULL;
+			if (!texture.file.empty()) {
+				auto it = files.find(texture.file);
+				if (it == files.end()) {
+					std::string path = texture.file;
+					if (!resource_dir.empty()) { path = (std::filesystem::path(resource_dir) / std::filesystem::path(texture.file).filename()).string(); }
+					luna::ResourceID file_id = luna::ResourceManager::LoadResourceFile(path, password);
+					if (file_id == luna::RESOURCE_ID_NULL) { std::cerr << "Failed to load " << path << "; " << luna::ResourceManager::ErrorMessage() << std::endl; }
+					it = files.emplace(texture.file, file_id).first;
+				}
+				luna::ResourceFile* file = luna::ResourceManager::GetResourceFile(it->second);
+				if (file) { texture_id = file->GetTextureID(texture.name); }
+			}
+			if (texture_id == luna::RESOURCE_ID_NULL) { ++state.missing_textures; }
+			textures.push_back(texture_id);
+		}
+		state.frame_textures.push_back(std::move(textures));
+	}
+	return true;
+}
+
+// Create every render target the capture refers to, keyed by its captured handle
+static void create_render_targets(luna::SpriteRenderer* renderer) {
+	for (auto& frame : state.frames) {
+		for (auto& target : frame.renderTargets) {
+			if (state.render_targets.count(target.renderTarget)) { continue; }
+			state.render_targets[target.renderTarget] = renderer->CreateRenderTarget(target.width, target.height);
+		}
+	}
+}
+
+static luna::RenderTargetID map_render_target(luna::RenderTargetID render_target) {
+	auto it = state.render_targets.find(render_target);
+	return (it == state.render_targets.end()) ? luna::RENDER_TARGET_ID_NULL : it->second;
+}
+
+static luna::Sprite make_sprite(std::size_t frame_index, const luna::CapturedSprite& captured) {
+	luna::Sprite sprite;
+	if (captured.texture == luna::CAPTURED_TEXTURE_NONE) {
+		luna::RenderTargetID render_target = map_render_target(captured.renderTarget);
+		if (render_target == luna::RENDER_TARGET_ID_NULL) { return sprite; }
+		sprite = luna::Sprite::FromRenderTarget(
+			render_target, std::uint32_t(captured.width), std::uint32_t(captured.height), captured.x, captured.y,
+			captured.depth, captured.scaleX, captured.scaleY, captured.rotation, captured.blend
+		);
+	}
+	else {
+		luna::ResourceID texture_id = state.frame_textures[frame_index][captured.texture];
+		if (texture_id == luna::RESOURCE_ID_NULL) { return sprite; }
+		sprite = luna::Sprite(texture_id, captured.x, captured.y, captured.image, 0.f, captured.depth, captured.scaleX, captured.scaleY, captured.rotation, captured.blend);
+		sprite.SetOriginX(std::int32_t(captured.originX));
+		sprite.SetOriginY(std::int32_t(captured.originY));
+	}
+	sprite.SetBlendMode(captured.blendMode);
+	return sprite;
+}
+
+// Switch the room's cameras & the renderer's persistent sprites over to another captured frame
+static void enter_frame(luna::SpriteRenderer* renderer, std::size_t frame_index) {
+	const luna::CapturedFrame& frame = state.frames[frame_index];
+	luna::Room* room = luna::RoomManager::GetCurrentRoom();
+	while (room->GetNumCameras() > 0) { room->DestroyCamera(room->GetNumCameras() - 1); }
+	for (auto& captured : frame.cameras) {
+		luna::Camera camera = captured;
+		camera.SetRenderTarget(map_render_target(captured.GetRenderTarget()));
+		room->CreateCamera(camera);
+	}
+
+	// Persistent sprites are only touched where they changed, as a game editing them would
+	std::vector<luna::CapturedSprite> persistent;
+	for (auto& sprite : frame.sprites) {
+		if (sprite.kind != luna::CapturedSpriteKind::Dynamic) { persistent.push_back(sprite); }
+	}
+	if (persistent.size() != state.persistent_sprites.size()) {
+		for (auto instance : state.instances) { renderer->DestroySpriteInstance(instance); }
+		for (auto static_sprite : state.static_sprites) { renderer->DestroyStaticSprite(static_sprite); }
+		state.instances.clear();
+		state.static_sprites.clear();
+		state.persistent_sprites.clear();
+	}
+	for (std::size_t i = 0; i < persistent.size(); ++i) {
+		const luna::CapturedSprite& sprite = persistent[i];
+		if (i < state.persistent_sprites.size()) {
+			if (state.persistent_sprites[i] == sprite) { continue; }
+			if (sprite.kind == luna::CapturedSpriteKind::Instance && state.persistent_sprites[i].kind == sprite.kind) {
+				luna::Sprite* instance = renderer->EditSpriteInstance(state.instances[i]);
+				if (instance) { *instance = make_sprite(frame_index, sprite); }
+			}
+			else if (sprite.kind == luna::CapturedSpriteKind::Static && state.persistent_sprites[i].kind == sprite.kind) {
+				renderer->SetStaticSprite(state.static_sprites[i], make_sprite(frame_index, sprite));
+			}
+			state.persistent_sprites[i] = sprite;
+			continue;
+		}
+		luna::Sprite created = make_sprite(frame_index, sprite);
+		state.instances.push_back((sprite.kind == luna::CapturedSpriteKind::Instance) ? renderer->CreateSpriteInstance(created) : luna::SPRITE_INSTANCE_ID_NULL);
+		state.static_sprites.push_back((sprite.kind == luna::CapturedSpriteKind::Static) ? renderer->CreateStaticSprite(created) : luna::STATIC_SPRITE_ID_NULL);
+		state.persistent_sprites.push_back(sprite);
+	}
+	state.current_frame = frame_index;
+}
+
+static void replay_frame(luna::Renderer* base_renderer) {
+	luna::SpriteRenderer* renderer = static_cast<luna::SpriteRenderer*>(base_renderer);
+
+	// Count the frame drawn since the last call
+	auto now = std::chrono::steady_clock::now();
+	if (state.frames_drawn > 0) {
+		double ms = std::chrono::duration<double, std::milli>(now - state.last_frame).count();
+		state.min_ms = (state.frames_drawn == 1) ? ms : std::min(state.min_ms, ms);
+		state.max_ms = std::max(state.max_ms, ms);
+		state.total_ms += ms;
+		const luna::RenderCounts& counts = renderer->GetFrameCounts();
+		state.renderables += counts.renderables;
+		state.batches += counts.batches;
+		state.draw_calls += counts.drawCalls;
+		state.upload_bytes += counts.uploadBytes;
+	}
+	state.last_frame = now;
+	if (state.frames_drawn == state.frames_to_draw) {
+		luna::Game::Quit();
+		return;
+	}
+
+	// Loop over the captured frames, submitting each one's sprites & primitives again
+	std::size_t frame_index = state.frames_drawn % state.frames.size();
+	if (frame_index != state.current_frame) { enter_frame(renderer, frame_index); }
+	const luna::CapturedFrame& frame = state.frames[frame_index];
+	for (auto& sprite : frame.sprites) {
+		if (sprite.kind == luna::CapturedSpriteKind::Dynamic) { renderer->DrawSprite(make_sprite(frame_index, sprite)); }
+	}
+	for (auto& primitive : frame.primitives) { renderer->DrawPrimitive(primitive); }
+	++state.frames_drawn;
+}
+
+int main(int argc, char** argv) {
+	// Read arguments
+	vex parser(
+		"luna_render_replay",
+		"1.0",
+		"Replays frames recorded with SpriteRenderer::StartCapture in a loop, through the CPU-only NullRenderer or a headless SpriteRenderer, and reports the time & work per frame."
+	);
+	parser.add_arg("Capture file to replay", VEX_ARG_TYPE_STR, "input", 'i', 1);
+	parser.add_arg("Number of frames to draw", VEX_ARG_TYPE_INT, "frames", 'n', 1);
+	parser.add_arg("Draw with SpriteRenderer on the GPU instead of the NullRenderer", VEX_ARG_TYPE_FLAG, "gpu", 'g');
+	parser.add_arg("Directory to load the captured resource files from", VEX_ARG_TYPE_STR, "resources", 'r', 1);
+	parser.add_arg("Password for encrypted resource files", VEX_ARG_TYPE_STR, "password", 'k', 1);
+	parser.parse(argc, argv);
+	if (parser.arg_found("h")) {
+		std::cout << parser.get_help() << std::endl;
+		return 0;
+	}
+	if (parser.arg_found("v")) {
+		std::cout << parser.get_version() << std::endl;
+		return 0;
+	}
+	std::string input_file_name = "";
+	std::string resource_dir = "";
+	std::string password = "";
+	bool gpu = parser.arg_found("g");
+	for (auto& token : parser) {
+		switch (token.short_name) {
+		case 'i': input_file_name = std::string(token.arg[0].str_arg); break;
+		case 'n': state.frames_to_draw = std::size_t(std::max(1, token.arg[0].int_arg)); break;
+		case 'r': resource_dir = std::string(token.arg[0].str_arg); break;
+		case 'k': password = std::string(token.arg[0].str_arg); break;
+		default: break;
+		}
+	}
+	if (input_file_name.empty()) {
+		std::cerr << "No capture file given" << std::endl;
+		return 1;
+	}
+	if (!luna::ReadRenderCapture(input_file_name, state.frames) || state.frames.empty()) {
+		std::cerr << "Failed to read " << input_file_name << std::endl;
+		return 1;
+	}
+
+	// Draw headless, at the size the capture was drawn at
+	const luna::CapturedFrame& first_frame = state.frames[0];
+	luna::GameInit init = {};
+	init.appName = "luna_render_replay";
+	init.appIdentifier = "com.luna_render_replay";
+	init.headless = true;
+	init.ticksPerSecond = 0;
+	init.windowW = std::max(first_frame.windowWidth, 1u);
+	init.windowH = std::max(first_frame.windowHeight, 1u);
+	init.postDrawFunc = replay_frame;
+	luna::SpriteRendererFactory sprite_renderer_factory;
+	luna::NullRendererFactory null_renderer_factory;
+	init.rendererFactory = (gpu) ? (luna::detail::AbstractRendererFactory*)&sprite_renderer_factory : &null_renderer_factory;
+	if (!luna::Game::Init(&init)) { return 1; }
+	load_resources(resource_dir, password);
+	create_render_targets(static_cast<luna::SpriteRenderer*>(luna::Game::GetRenderer()));
+	luna::RoomInit room_init = {};
+	room_init.clearColor = first_frame.clearColor;
+	luna::RoomManager::PushRoom(room_init);
+	luna::Game::Run();
+
+	// Report
+	double frames = double(std::max<std::size_t>(state.frames_drawn - 1, 1));
+	std::cout << "captured frames   " << state.frames.size() << std::endl;
+	std::cout << "frames drawn      " << state.frames_drawn << std::endl;
+	std::cout << "missing textures  " << state.missing_textures << std::endl;
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << "mean ms           " << (state.total_ms / frames) << std::endl;
+	std::cout << "min ms            " << state.min_ms << std::endl;
+	std::cout << "max ms            " << state.max_ms << std::endl;
+	std::cout << std::setprecision(1);
+	std::cout << "renderables       " << (double(state.renderables) / frames) << std::endl;
+	std::cout << "batches           " << (double(state.batches) / frames) << std::endl;
+	std::cout << "draw calls        " << (double(state.draw_calls) / frames) << std::endl;
+	std::cout << "upload KB         " << (double(state.upload_bytes) / 1024.0 / frames) << std::endl;
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,261 @@
+#include "archive_generator.hpp"
+#include <cmath>
+
+static std::uint32_t xorshift32(std::uint32_t& state) {
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+static void push_bytes(luna::Buffer& buffer, const void* data, std::size_t len) {
+	buffer.push_string((const char*)data, len, len);
+}
+
+static void push_zeros(luna::Buffer& buffer, std::size_t len) {
+	for (std::size_t i = 0; i < len; ++i) { buffer.push_uint8(0); }
+}
+
+static void pad_to(luna::Buffer& buffer, std::size_t align) {
+	if (buffer.size() % align != 0) { push_zeros(buffer, align - (buffer.size() % align)); }
+}
+
+// The loader treats equal compressed & uncompressed sizes as raw data, so only keep
+// the LZ4 output when it is actually smaller
+static std::vector<std::uint8_t> compress_block(const std::vector<std::uint8_t>& data) {
+	std::vector<std::uint8_t> compressed(std::size_t(LZ4_compressBound(int(data.size()))));
+	int size = LZ4_compress_default((const char*)data.data(), (char*)compressed.data(), int(data.size()), int(compressed.size()));
+	if (size <= 0 || std::size_t(size) >= data.size()) { return data; }
+	compressed.resize(std::size_t(size));
+	return compressed;
+}
+
+struct texture_rect {
+	std::string name;
+	std::uint32_t page;
+	std::uint32_t x, y, w, h;
+	bool translucent;
+};
+
+static luna::Buffer generate_page_block(const archive_params& params, std::uint32_t page, const std::vector<texture_rect>& rects, std::uint32_t& rng) {
+	std::size_t page_bytes = std::size_t(params.page_size) * params.page_size * 4;
+	std::vector<std::uint8_t> pixels(page_bytes, 0);
+	if (params.compressible) {
+		// Flat color per texture, transparent everywhere else
+		for (const auto& rect : rects) {
+			if (rect.page != page) { continue; }
+			std::uint32_t color = xorshift32(rng) | 0xFF000000u;
+			if (rect.translucent) { color = (color & 0x00FFFFFFu) | 0x80000000u; }
+			for (std::uint32_t y = rect.y; y < rect.y + rect.h; ++y) {
+				for (std::uint32_t x = rect.x; x < rect.x + rect.w; ++x) {
+					memcpy(&pixels[(std::size_t(y) * params.page_size + x) * 4], &color, 4);
+				}
+			}
+		}
+	}
+	else {
+		for (std::size_t i = 0; i + 4 <= page_bytes; i += 4) {
+			std::uint32_t noise = xorshift32(rng);
+			memcpy(&pixels[i], &noise, 4);
+		}
+	}
+	std::vector<std::uint8_t> stored = compress_block(pixels);
+
+	luna::Buffer block;
+	block.push_string("page" + std::to_string(page), 32);
+	block.push_uint64(pixels.size());
+	block.push_uint64(stored.size());
+	block.push_uint32(luna::Crc32Calculate(pixels.data(), pixels.size()));
+	block.push_uint32(SDL_PIXELFORMAT_ABGR8888);
+	block.push_uint32(params.page_size);
+	block.push_uint32(params.page_size);
+	push_bytes(block, stored.data(), stored.size());
+	pad_to(block, 16);
+	return block;
+}
+
+static luna::Buffer generate_asset_block(const std::string& type, const std::string& name, const luna::Buffer& record) {
+	std::vector<std::uint8_t> data(record.data(), record.data() + record.size());
+	std::vector<std::uint8_t> stored = compress_block(data);
+
+	luna::Buffer block;
+	block.push_string(type, 4);
+	block.push_uint32(luna::Crc32Calculate(data.data(), data.size()));
+	push_zeros(block, 8);
+	block.push_string(name, 32);
+	push_zeros(block, 16);
+	block.push_uint64(data.size());
+	block.push_uint64(stored.size());
+	push_bytes(block, stored.data(), stored.size());
+	pad_to(block, 16);
+	return block;
+}
+
+static luna::Buffer generate_texture_block(const texture_rect& rect) {
+	luna::Buffer record;
+	record.push_uint32(rect.page);
+	record.push_uint32(rect.x);
+	record.push_uint32(rect.y);
+	record.push_uint32(rect.w);
+	record.push_uint32(rect.h);
+	record.push_uint32(1);	// Frame count
+	record.push_uint32(1);	// Frames per row
+	record.push_uint32(1);	// Frame rows
+	record.push_uint32(0);	// Animation x offset
+	record.push_uint32(0);	// Animation y offset
+	record.push_uint32(0);	// Animation x spacing
+	record.push_uint32(0);	// Animation y spacing
+	record.push_int32(std::int32_t(rect.w / 2));
+	record.push_int32(std::int32_t(rect.h / 2));
+	record.push_uint8(0);	// Properties
+	pad_to(record, 16);
+	return generate_asset_block("AIMG", rect.name, record);
+}
+
+static luna::Buffer generate_sound_block(const archive_sound& sound) {
+	// Chunks hold whole frames, & each is compressed on its own so it can be decoded while streaming
+	std::uint32_t frame_size = std::uint32_t(SDL_AUDIO_FRAMESIZE(sound.spec));
+	std::uint32_t chunk_size = std::max(frame_size, sound.chunk_size - (sound.chunk_size % frame_size));
+	std::vector<std::vector<std::uint8_t>> chunks;
+	std::vector<std::uint32_t> chunk_sizes;
+	for (std::size_t offset = 0; offset < sound.pcm.size(); offset += chunk_size) {
+		std::size_t len = std::min<std::size_t>(chunk_size, sound.pcm.size() - offset);
+		chunks.push_back(compress_block(std::vector<std::uint8_t>(sound.pcm.begin() + offset, sound.pcm.begin() + offset + len)));
+		chunk_sizes.push_back(std::uint32_t(len));
+	}
+
+	// Sound record, followed by its chunk table & the chunks
+	luna::Buffer record;
+	record.push_uint32(std::uint32_t(sound.spec.format));
+	record.push_uint32(std::uint32_t(sound.spec.channels));
+	record.push_uint32(std::uint32_t(sound.spec.freq));
+	record.push_uint32((sound.streamed) ? 1 : 0);	// Flags
+	record.push_uint64(sound.pcm.size());
+	record.push_uint32(std::uint32_t(chunks.size()));
+	push_zeros(record, 4);
+	std::uint64_t chunk_offset = 32 + std::uint64_t(chunks.size()) * 16;
+	for (std::size_t i = 0; i < chunks.size(); ++i) {
+		record.push_uint64(chunk_offset);
+		record.push_uint32(std::uint32_t(chunks[i].size()));
+		record.push_uint32(chunk_sizes[i]);
+		chunk_offset += chunks[i].size();
+	}
+	for (const auto& chunk : chunks) { push_bytes(record, chunk.data(), chunk.size()); }
+	pad_to(record, 16);
+	return generate_asset_block("ASND", sound.name, record);
+}
+
+luna::Buffer generate_archive(const archive_params& params) {
+	std::uint32_t rng = params.seed ? params.seed : 1;
+
+	// Lay textures out on a grid, leaving a 2 pixel gap between neighbours
+	std::vector<texture_rect> rects;
+	std::uint32_t grid = std::max(1u, std::uint32_t(std::ceil(std::sqrt(double(params.assets_per_page)))));
+	std::uint32_t cell = std::max(3u, params.page_size / grid);
+	for (std::uint32_t page = 0; page < params.page_count; ++page) {
+		for (std::uint32_t i = 0; i < params.assets_per_page; ++i) {
+			texture_rect rect;
+			rect.name = "page" + std::to_string(page) + "_tex" + std::to_string(i);
+			rect.page = page;
+			rect.x = ((i % grid) * cell) + 1;
+			rect.y = ((i / grid) * cell) + 1;
+			rect.w = std::min(cell - 2, params.page_size - rect.x);
+			rect.h = std::min(cell - 2, params.page_size - rect.y);
+			rect.translucent = std::uint64_t(i) * 100 < std::uint64_t(params.translucent_percent) * params.assets_per_page;
+			rects.push_back(rect);
+		}
+	}
+
+	// File header
+	luna::Buffer file;
+	file.push_string("ARCF", 4);
+	file.push_uint8(APOLLO_VERSION_MAJOR);
+	file.push_uint8(APOLLO_VERSION_MINOR);
+	file.push_uint8(APOLLO_VERSION_PATCH);
+	file.push_uint8(0);
+	file.push_uint32(0);	// CRC, filled in below
+	file.push_uint32(0);
+	std::uint8_t iv[32] = { 0 };
+	if (params.encrypted) {
+		for (std::size_t i = 0; i < AES_BLOCKLEN; ++i) { iv[i] = std::uint8_t(xorshift32(rng) | 1); }
+	}
+	push_bytes(file, iv, sizeof(iv));
+	file.push_uint64(0);	// Texture page offset
+	file.push_uint64(0);	// Data chunk offset
+	file.push_uint64(0);	// Asset table offset
+	file.push_uint64(0);
+
+	// Texture pages
+	std::uint64_t offset_texture_pages = file.size();
+	std::vector<luna::Buffer> pages;
+	std::uint64_t page_stride = 0;
+	for (std::uint32_t page = 0; page < params.page_count; ++page) {
+		pages.push_back(generate_page_block(params, page, rects, rng));
+		page_stride = std::max<std::uint64_t>(page_stride, pages.back().size());
+	}
+	file.push_string("ATXG", 4);
+	file.push_uint32(params.page_count);
+	file.push_uint64(page_stride);
+	for (const auto& page : pages) {
+		push_bytes(file, page.data(), page.size());
+		push_zeros(file, std::size_t(page_stride - page.size()));
+	}
+
+	// Data chunks
+	std::uint64_t offset_data_chunks = file.size();
+	std::vector<std::string> asset_names;
+	std::vector<std::uint64_t> asset_offsets;
+	for (const auto& rect : rects) {
+		asset_names.push_back(rect.name);
+		asset_offsets.push_back(file.size());
+		luna::Buffer block = generate_texture_block(rect);
+		push_bytes(file, block.data(), block.size());
+	}
+	for (const auto& sound : params.sounds) {
+		asset_names.push_back(sound.name);
+		asset_offsets.push_back(file.size());
+		luna::Buffer block = generate_sound_block(sound);
+		push_bytes(file, block.data(), block.size());
+	}
+
+	// Asset table, open addressed on the name hash
+	std::uint64_t offset_asset_table = file.size();
+	std::uint32_t capacity = std::uint32_t(std::max<std::uint64_t>(16, luna::NextPow2(std::uint64_t(asset_names.size()) * 2)));
+	std::vector<std::uint8_t> ctrl(capacity, 0);
+	std::vector<std::size_t> slots(capacity, SIZE_MAX);
+	for (std::size_t i = 0; i < asset_names.size(); ++i) {
+		std::uint32_t hash = luna::Crc32Calculate(asset_names[i].data(), asset_names[i].size());
+		std::uint32_t slot = hash & (capacity - 1);
+		while (ctrl[slot] & 0x80) { slot = (slot + 1) & (capacity - 1); }
+		ctrl[slot] = std::uint8_t(0x80 | ((hash >> 25) & 0x7F));
+		slots[slot] = i;
+	}
+	file.push_string("ARFT", 4);
+	file.push_uint32(std::uint32_t(asset_names.size()));
+	file.push_uint32(capacity);
+	file.push_uint32(0);
+	push_bytes(file, ctrl.data(), ctrl.size());
+	for (std::uint32_t slot = 0; slot < capacity; ++slot) {
+		if (slots[slot] == SIZE_MAX) {
+			push_zeros(file, 40);
+			continue;
+		}
+		file.push_string(asset_names[slots[slot]], 32);
+		file.push_uint64(asset_offsets[slots[slot]]);
+	}
+	pad_to(file, AES_BLOCKLEN);
+
+	// Fill in the header
+	file.set_uint64(offset_texture_pages, 48);
+	file.set_uint64(offset_data_chunks, 56);
+	file.set_uint64(offset_asset_table, 64);
+	file.set_uint32(luna::Crc32Calculate(file.data(48), file.size() - 48), 8);
+	if (params.encrypted) {
+		std::uint8_t key[32] = { 0 };
+		for (std::size_t i = 0; i < params.password.size() && i < sizeof(key); ++i) { key[i] = std::uint8_t(params.password[i]); }
+		AES_ctx ctx;
+		AES_init_ctx_iv(&ctx, key, iv);
+		AES_CBC_encrypt_buffer(&ctx, file.data(48), file.size() - 48);
+	}
+	return file;
+}
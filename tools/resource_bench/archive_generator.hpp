@@ -0,0 +1,39 @@
+#pragma once
+
+#include <luna/luna.hpp>
+
+/// <summary>
+/// Sound stored in a synthetic ARC file, its PCM split into separately compressed chunks.
+/// </summary>
+struct archive_sound {
+	std::string name;
+	SDL_AudioSpec spec = {};
+	std::vector<std::uint8_t> pcm;
+	std::uint32_t chunk_size = 16384;
+	bool streamed = false;
+};
+
+/// <summary>
+/// Layout of a synthetic ARC file.
+/// </summary>
+struct archive_params {
+	std::uint32_t page_count = 1;
+	std::uint32_t assets_per_page = 16;
+	std::uint32_t page_size = 1024;
+	bool encrypted = false;
+	bool compressible = true;
+	std::uint32_t translucent_percent = 0;
+	std::string password = "luna";
+	std::uint32_t seed = 1;
+	std::vector<archive_sound> sounds;
+};
+
+/// <summary>
+/// Build an ARC file in memory, laid out the same way the asset packer writes them, with any sounds after the textures.
+/// Compressible pages hold flat colored textures on a transparent background, the first
+/// translucent_percent of each page's textures half transparent; incompressible pages hold
+/// random noise that LZ4 cannot shrink.
+/// </summary>
+/// <param name="params">File layout</param>
+/// <returns>Complete file contents</returns>
+luna::Buffer generate_archive(const archive_params& params);
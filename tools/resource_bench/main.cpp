@@ -0,0 +1,122 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <filesystem>
+#include <cmath>
+#include <vex/vex_cpp.hpp>
+#include "archive_generator.hpp"
+
+static void print_stage(const std::string& name, std::uint64_t ns, std::uint64_t bytes, int iterations) {
+	double ms = double(ns) / 1e6 / iterations;
+	double mb_per_sec = (ns > 0) ? (double(bytes) * iterations / (1024.0 * 1024.0)) / (double(ns) / 1e9) : 0.0;
+	std::cout << std::left << std::setw(12) << name
+		<< std::right << std::setw(12) << std::fixed << std::setprecision(3) << ms
+		<< std::setw(12) << std::setprecision(1) << mb_per_sec << std::endl;
+}
+
+int main(int argc, char** argv) {
+	// Read arguments
+	vex parser(
+		"luna_resource_bench",
+		"1.0",
+		"Generates synthetic ARC files and times each stage of loading them."
+	);
+	parser.add_arg("Texture pages to generate", VEX_ARG_TYPE_INT, "pages", 'p', 1);
+	parser.add_arg("Textures per page", VEX_ARG_TYPE_INT, "assets", 'a', 1);
+	parser.add_arg("Texture page width & height", VEX_ARG_TYPE_INT, "size", 's', 1);
+	parser.add_arg("Number of timed loads", VEX_ARG_TYPE_INT, "iterations", 'n', 1);
+	parser.add_arg("Encrypt the generated file", VEX_ARG_TYPE_FLAG, "encrypt", 'e');
+	parser.add_arg("Fill pages with incompressible noise", VEX_ARG_TYPE_FLAG, "noise", 'z');
+	parser.add_arg("Password for encrypted files", VEX_ARG_TYPE_STR, "password", 'k', 1);
+	parser.add_arg("Benchmark an existing file instead of generating one", VEX_ARG_TYPE_STR, "input", 'i', 1);
+	parser.add_arg("Keep the generated file (e.g. as a fuzzing seed)", VEX_ARG_TYPE_STR, "output", 'o', 1);
+	parser.parse(argc, argv);
+	if (parser.arg_found("h")) {
+		std::cout << parser.get_help() << std::endl;
+		return 0;
+	}
+	if (parser.arg_found("v")) {
+		std::cout << parser.get_version() << std::endl;
+		return 0;
+	}
+	archive_params params;
+	params.encrypted = parser.arg_found("e");
+	params.compressible = !parser.arg_found("z");
+	int iterations = 10;
+	std::string input_file_name;
+	std::string output_file_name;
+	for (auto& token : parser) {
+		switch (token.short_name) {
+		case 'p': params.page_count = std::uint32_t(std::max(1, token.arg[0].int_arg)); break;
+		case 'a': params.assets_per_page = std::uint32_t(std::max(1, token.arg[0].int_arg)); break;
+		case 's': params.page_size = std::uint32_t(std::max(1, token.arg[0].int_arg)); break;
+		case 'n': iterations = std::max(1, token.arg[0].int_arg); break;
+		case 'k': params.password = std::string(token.arg[0].str_arg); break;
+		case 'i': input_file_name = std::string(token.arg[0].str_arg); break;
+		case 'o': output_file_name = std::string(token.arg[0].str_arg); break;
+		default: break;
+		}
+	}
+
+	// Generate the file
+	bool remove_file = false;
+	if (input_file_name.empty()) {
+		std::uint32_t grid = std::uint32_t(std::ceil(std::sqrt(double(params.assets_per_page))));
+		if (params.page_size < grid * 3) {
+			std::cerr << "Texture pages are too small for " << params.assets_per_page << " textures" << std::endl;
+			return 1;
+		}
+		luna::Buffer archive = generate_archive(params);
+		input_file_name = output_file_name;
+		if (input_file_name.empty()) {
+			input_file_name = (std::filesystem::temp_directory_path() / "luna_resource_bench.arc").string();
+			remove_file = true;
+		}
+		std::ofstream output_file(input_file_name, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (output_file.fail()) {
+			std::cerr << "Failed to open output file (" << input_file_name << ")" << std::endl;
+			return 1;
+		}
+		output_file.write((const char*)archive.data(), std::streamsize(archive.size()));
+		output_file.close();
+		std::cout << "Generated " << params.page_count << " page(s) x " << params.assets_per_page << " texture(s), "
+			<< params.page_size << "px, " << (params.encrypted ? "encrypted" : "plain") << ", "
+			<< (params.compressible ? "compressible" : "incompressible") << std::endl;
+	}
+
+	// Load it repeatedly
+	luna::ResourceFileLoadStats total;
+	for (int i = 0; i < iterations; ++i) {
+		luna::ResourceFile file(luna::ResourceID(i + 1), input_file_name, params.password);
+		if (!file.IsValid()) {
+			std::cerr << "Failed to load file (" << input_file_name << "); " << file.ErrorMessage() << std::endl;
+			return 1;
+		}
+		const luna::ResourceFileLoadStats& stats = file.GetLoadStats();
+		total.fileBytes = stats.fileBytes;
+		total.compressedBytes = stats.compressedBytes;
+		total.uncompressedBytes = stats.uncompressedBytes;
+		total.readNS += stats.readNS;
+		total.decryptNS += stats.decryptNS;
+		total.crcNS += stats.crcNS;
+		total.decompressNS += stats.decompressNS;
+		total.processNS += stats.processNS;
+		total.indexNS += stats.indexNS;
+	}
+	if (remove_file) { std::filesystem::remove(input_file_name); }
+
+	// Report
+	std::uint64_t total_ns = total.readNS + total.decryptNS + total.crcNS + total.decompressNS + total.processNS + total.indexNS;
+	std::cout << total.fileBytes << " bytes on disk, " << total.compressedBytes << " compressed -> "
+		<< total.uncompressedBytes << " uncompressed, " << iterations << " iteration(s)" << std::endl;
+	std::cout << std::left << std::setw(12) << "stage" << std::right << std::setw(12) << "ms/load" << std::setw(12) << "MB/s" << std::endl;
+	print_stage("read", total.readNS, total.fileBytes, iterations);
+	print_stage("decrypt", total.decryptNS, total.fileBytes, iterations);
+	print_stage("crc", total.crcNS, total.fileBytes + total.uncompressedBytes, iterations);
+	print_stage("decompress", total.decompressNS, total.uncompressedBytes, iterations);
+	print_stage("process", total.processNS, total.uncompressedBytes, iterations);
+	print_stage("index", total.indexNS, total.fileBytes, iterations);
+	print_stage("total", total_ns, total.fileBytes, iterations);
+	return 0;
+}
@@ -0,0 +1,24 @@
+#include <luna/luna.hpp>
+
+// libFuzzer entry point for the ARCF/ATXG/ARFT parser. The library is built with
+// FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION so that checksums do not reject mutated
+// inputs; files written by `luna_resource_bench -o` make a good seed corpus.
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size) {
+	luna::Buffer fileBuffer(data, size);
+
+	// The password is only used if the header marks the file as encrypted
+	luna::ResourceFile file(luna::ResourceID(1), fileBuffer, "fuzz");
+	if (!file.IsValid()) { return 0; }
+
+	// Touch everything that was indexed
+	for (std::size_t i = 0; i < file.GetTexturePageCount(); ++i) {
+		const luna::TexturePage* page = file.GetTexturePage(luna::TexturePageID(i));
+		if (!page) { continue; }
+		for (std::uint32_t level = 0; level < page->GetMipLevelCount(); ++level) {
+			volatile std::uint8_t* mipData = page->GetMipData(level);
+			std::size_t mipSize = std::size_t(page->GetMipWidth(level)) * page->GetMipHeight(level) * SDL_BYTESPERPIXEL(page->GetFormat());
+			if (mipData && mipSize > 0) { mipData[mipSize - 1]; }
+		}
+	}
+	return 0;
+}
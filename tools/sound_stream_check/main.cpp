@@ -0,0 +1,172 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include <filesystem>
+#include <vex/vex_cpp.hpp>
+#include <luna/luna.hpp>
+#include "../resource_bench/archive_generator.hpp"
+
+// Samples the device mixed, copied out on the audio thread
+struct capture_state {
+	SDL_AudioSpec expected_spec = {};
+	std::mutex mutex;
+	std::vector<float> samples;
+	bool spec_mismatch = false;
+};
+
+static capture_state capture;
+
+static void SDLCALL capture_postmix(void* /*userdata*/, const SDL_AudioSpec* spec, float* buffer, int buflen) {
+	std::lock_guard<std::mutex> lock(capture.mutex);
+	if (spec->channels != capture.expected_spec.channels || spec->freq != capture.expected_spec.freq) {
+		capture.spec_mismatch = true;
+		return;
+	}
+	capture.samples.insert(capture.samples.end(), buffer, buffer + (std::size_t(buflen) / sizeof(float)));
+}
+
+// Tones a little apart on each channel, starting off zero so the first frame played can be found
+static std::vector<float> generate_signal(const SDL_AudioSpec& spec, float seconds) {
+	std::size_t frames = std::size_t(seconds * float(spec.freq));
+	std::vector<float> samples(frames * std::size_t(spec.channels));
+	for (std::size_t frame = 0; frame < frames; ++frame) {
+		for (int channel = 0; channel < spec.channels; ++channel) {
+			double t = double(frame) / double(spec.freq);
+			double pitch = 220.0 * double(channel + 1) + 3.0;
+			samples[frame * std::size_t(spec.channels) + std::size_t(channel)] = float(0.25 * std::sin(6.283185307179586 * pitch * t + 1.0));
+		}
+	}
+	return samples;
+}
+
+int main(int argc, char** argv) {
+	// Read arguments
+	vex parser(
+		"luna_sound_stream_check",
+		"1.0",
+		"Streams a generated sound through SDL's dummy audio driver, and checks the device played the same samples as the fully decoded sound."
+	);
+	parser.add_arg("Length of the sound in seconds", VEX_ARG_TYPE_INT, "length", 'l', 1);
+	parser.add_arg("Size of each compressed chunk in bytes", VEX_ARG_TYPE_INT, "chunk", 'c', 1);
+	parser.add_arg("Sample rate", VEX_ARG_TYPE_INT, "freq", 'f', 1);
+	parser.add_arg("Number of channels", VEX_ARG_TYPE_INT, "channels", 'n', 1);
+	parser.parse(argc, argv);
+	if (parser.arg_found("h")) {
+		std::cout << parser.get_help() << std::endl;
+		return 0;
+	}
+	if (parser.arg_found("v")) {
+		std::cout << parser.get_version() << std::endl;
+		return 0;
+	}
+	int seconds = 2;
+	archive_sound sound;
+	sound.spec = { SDL_AUDIO_F32, 2, 48000 };
+	for (auto& token : parser) {
+		switch (token.short_name) {
+		case 'l': seconds = std::max(1, token.arg[0].int_arg); break;
+		case 'c': sound.chunk_size = std::uint32_t(std::max(1, token.arg[0].int_arg)); break;
+		case 'f': sound.spec.freq = std::clamp(token.arg[0].int_arg, 8000, 192000); break;
+		case 'n': sound.spec.channels = std::clamp(token.arg[0].int_arg, 1, 8); break;
+		default: break;
+		}
+	}
+
+	// Store the same samples twice, once streamed & once decoded at load
+	std::vector<float> signal = generate_signal(sound.spec, float(seconds));
+	sound.pcm.assign((const std::uint8_t*)signal.data(), (const std::uint8_t*)(signal.data() + signal.size()));
+	archive_params params;
+	params.page_count = 0;
+	sound.name = "streamed";
+	sound.streamed = true;
+	params.sounds.push_back(sound);
+	sound.name = "decoded";
+	sound.streamed = false;
+	params.sounds.push_back(sound);
+	luna::Buffer archive = generate_archive(params);
+	std::string archive_file_name = (std::filesystem::temp_directory_path() / "luna_sound_stream_check.arc").string();
+	std::ofstream archive_file(archive_file_name, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (archive_file.fail()) {
+		std::cerr << "Failed to open output file (" << archive_file_name << ")" << std::endl;
+		return 1;
+	}
+	archive_file.write((const char*)archive.data(), std::streamsize(archive.size()));
+	archive_file.close();
+
+	// Play through the dummy driver, so no audio device is needed
+	luna::GameInit init = {};
+	init.appName = "luna_sound_stream_check";
+	init.appIdentifier = "com.luna_sound_stream_check";
+	init.audioDriver = "dummy";
+	init.headless = true;
+	luna::NullRendererFactory null_renderer_factory;
+	init.rendererFactory = &null_renderer_factory;
+	if (!luna::Game::Init(&init)) { return 1; }
+	luna::ResourceID file_id = luna::ResourceManager::LoadResourceFile(archive_file_name, params.password);
+	std::filesystem::remove(archive_file_name);
+	if (file_id == luna::RESOURCE_ID_NULL) {
+		std::cerr << luna::ResourceManager::ErrorMessage() << std::endl;
+		return 1;
+	}
+	luna::ResourceID streamed_id = luna::ResourceManager::GetSoundID("streamed");
+	const luna::ResourceSound* decoded = luna::ResourceManager::GetSound(luna::ResourceManager::GetSoundID("decoded"));
+	if (streamed_id == luna::RESOURCE_ID_NULL || !decoded || !decoded->GetData()) {
+		std::cerr << "Generated file is missing its sounds" << std::endl;
+		return 1;
+	}
+	if (decoded->GetSize() != sound.pcm.size() || memcmp(decoded->GetData(), sound.pcm.data(), sound.pcm.size()) != 0) {
+		std::cerr << "Decoded sound does not match the generated samples" << std::endl;
+		return 1;
+	}
+	const float* expected = (const float*)decoded->GetData();
+	std::size_t expected_count = std::size_t(decoded->GetSize() / sizeof(float));
+
+	// Capture what the device mixes until the sound has played out, or well past when it should have
+	luna::Sound player(streamed_id);
+	if (!player.IsValid()) { return 1; }
+	capture.expected_spec = sound.spec;
+	if (!SDL_SetAudioPostmixCallback(player.GetDeviceID(), capture_postmix, nullptr)) {
+		std::cerr << "SDL_SetAudioPostmixCallback failed; " << SDL_GetError() << std::endl;
+		return 1;
+	}
+	player.Play();
+	std::uint64_t deadline = SDL_GetTicks() + std::uint64_t(seconds + 5) * 1000;
+	while (SDL_GetTicks() < deadline && player.IsPlaying()) {
+		SDL_Delay(10);
+		std::lock_guard<std::mutex> lock(capture.mutex);
+		if (capture.spec_mismatch) { break; }
+	}
+
+	// The last of the sound may have left the stream but not yet reached the postmix callback
+	SDL_Delay(100);
+	player.Close();
+
+	// The device plays silence until the decoder has filled the ring, so line up on the first frame played
+	std::lock_guard<std::mutex> lock(capture.mutex);
+	if (capture.spec_mismatch) {
+		std::cerr << "The dummy device does not run at the sound's rate & channel count, so its mix can't be compared" << std::endl;
+		return 1;
+	}
+	std::size_t channels = std::size_t(sound.spec.channels);
+	std::size_t first = 0;
+	while (first < capture.samples.size() && capture.samples[first] == 0.f) { ++first; }
+	first -= first % channels;
+	std::size_t played = std::min(capture.samples.size() - first, expected_count);
+	std::size_t mismatch = 0;
+	while (mismatch < played && capture.samples[first + mismatch] == expected[mismatch]) { ++mismatch; }
+	std::cout << "chunks            " << decoded->GetChunkCount() << std::endl;
+	std::cout << "frames expected   " << (expected_count / channels) << std::endl;
+	std::cout << "frames played     " << (played / channels) << std::endl;
+	if (played < expected_count) {
+		std::cerr << "Stream stopped " << ((expected_count - played) / channels) << " frame(s) short" << std::endl;
+		return 1;
+	}
+	if (mismatch < played) {
+		std::cerr << "Streamed samples differ from the decoded sound at frame " << (mismatch / channels) << std::endl;
+		return 1;
+	}
+	std::cout << "streamed samples match the decoded sound" << std::endl;
+	return 0;
+}
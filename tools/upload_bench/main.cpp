@@ -0,0 +1,201 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <vex/vex_cpp.hpp>
+#include <luna/luna.hpp>
+
+// Exposes the renderer's instance layouts without creating a renderer
+struct bench_layouts : luna::SpriteRenderer {
+	using SpriteRenderer::SpriteBatchInfo;
+	using SpriteRenderer::PackedSpriteBatchInfo;
+	using SpriteRenderer::PACKED_SPRITE_FLAG_ADDITIVE;
+};
+
+// Everything the renderer reads out of a sprite when packing it
+struct bench_sprite {
+	float x, y, depth, rotation;
+	float w, h, scale_x, scale_y, origin_x, origin_y;
+	float u, v, tex_w, tex_h;
+	float r, g, b, a;
+	bool additive;
+};
+
+static const float TEXTURE_PAGE_SIZE = 4096.f;
+static const float TAU = 6.28318530718f;
+
+static std::vector<bench_sprite> generate_sprites(std::size_t count, std::uint32_t seed) {
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> unit_dist(0.f, 1.f);
+	std::uniform_int_distribution<int> size_dist(8, 256);
+	std::vector<bench_sprite> sprites(count);
+	for (auto& sprite : sprites) {
+		// Frames sit on whole texels of a texture page
+		sprite.w = float(size_dist(rng));
+		sprite.h = float(size_dist(rng));
+		sprite.x = unit_dist(rng) * 4000.f;
+		sprite.y = unit_dist(rng) * 4000.f;
+		sprite.depth = std::floor(unit_dist(rng) * 2000.f - 1000.f);
+		sprite.rotation = unit_dist(rng) * TAU;
+		sprite.scale_x = 0.5f + unit_dist(rng) * 2.f;
+		sprite.scale_y = sprite.scale_x;
+		sprite.origin_x = std::floor(sprite.w / 2.f);
+		sprite.origin_y = std::floor(sprite.h / 2.f);
+		sprite.u = std::floor(unit_dist(rng) * (TEXTURE_PAGE_SIZE - sprite.w)) / TEXTURE_PAGE_SIZE;
+		sprite.v = std::floor(unit_dist(rng) * (TEXTURE_PAGE_SIZE - sprite.h)) / TEXTURE_PAGE_SIZE;
+		sprite.tex_w = sprite.w / TEXTURE_PAGE_SIZE;
+		sprite.tex_h = sprite.h / TEXTURE_PAGE_SIZE;
+		sprite.r = unit_dist(rng);
+		sprite.g = unit_dist(rng);
+		sprite.b = unit_dist(rng);
+		sprite.a = unit_dist(rng);
+		sprite.additive = unit_dist(rng) < 0.1f;
+	}
+	return sprites;
+}
+
+static void pack_full(const std::vector<bench_sprite>& sprites, std::vector<bench_layouts::SpriteBatchInfo>& out) {
+	out.resize(sprites.size());
+	for (std::size_t i = 0; i < sprites.size(); ++i) {
+		const bench_sprite& sprite = sprites[i];
+		out[i] = {
+			sprite.x, sprite.y, -sprite.depth, sprite.rotation,
+			sprite.w, sprite.h, (sprite.additive) ? 1.f : 0.f, 0.f,
+			sprite.scale_x, sprite.scale_y, sprite.origin_x, sprite.origin_y,
+			sprite.u, sprite.v, sprite.tex_w, sprite.tex_h,
+			sprite.r, sprite.g, sprite.b, sprite.a
+		};
+	}
+}
+
+static void pack_compact(const std::vector<bench_sprite>& sprites, std::vector<bench_layouts::PackedSpriteBatchInfo>& out) {
+	out.resize(sprites.size());
+	for (std::size_t i = 0; i < sprites.size(); ++i) {
+		const bench_sprite& sprite = sprites[i];
+		float turns = sprite.rotation / TAU;
+		std::uint32_t rotation = std::uint32_t(std::int64_t(std::floor((turns - std::floor(turns)) * 65536.f + 0.5f)) & 0xFFFF);
+		std::uint32_t flags = (sprite.additive) ? bench_layouts::PACKED_SPRITE_FLAG_ADDITIVE : 0;
+		bench_layouts::PackedSpriteBatchInfo& info = out[i];
+		info.x = sprite.x;
+		info.y = sprite.y;
+		info.z = -sprite.depth;
+		info.rotationFlags = rotation | (flags << 16);
+		info.size = luna::detail::PackHalf2(sprite.w, sprite.h);
+		info.scale = luna::detail::PackHalf2(sprite.scale_x, sprite.scale_y);
+		info.origin = luna::detail::PackHalf2(sprite.origin_x, sprite.origin_y);
+		info.color = luna::detail::PackUnorm4x8(sprite.r, sprite.g, sprite.b, sprite.a);
+		info.texUV = luna::detail::PackUnorm2x16(sprite.u, sprite.v);
+		info.texWH = luna::detail::PackUnorm2x16(sprite.tex_w, sprite.tex_h);
+	}
+}
+
+static float unpack_half(std::uint32_t half) {
+	float mantissa = float(half & 0x3FF);
+	int exponent = int((half >> 10) & 0x1F);
+	float value = (exponent == 0) ? std::ldexp(mantissa, -24) : std::ldexp(mantissa + 1024.f, exponent - 25);
+	return (half & 0x8000) ? -value : value;
+}
+
+// Furthest any corner of a packed sprite's frame lands from where it should, in texels
+static float max_texel_error(const std::vector<bench_sprite>& sprites, const std::vector<bench_layouts::PackedSpriteBatchInfo>& packed) {
+	float error = 0.f;
+	for (std::size_t i = 0; i < sprites.size(); ++i) {
+		float u = float(packed[i].texUV & 0xFFFF) / 65535.f;
+		float v = float(packed[i].texUV >> 16) / 65535.f;
+		float w = float(packed[i].texWH & 0xFFFF) / 65535.f;
+		float h = float(packed[i].texWH >> 16) / 65535.f;
+		error = std::max(error, std::fabs(u - sprites[i].u));
+		error = std::max(error, std::fabs(v - sprites[i].v));
+		error = std::max(error, std::fabs((u + w) - (sprites[i].u + sprites[i].tex_w)));
+		error = std::max(error, std::fabs((v + h) - (sprites[i].v + sprites[i].tex_h)));
+	}
+	return error * TEXTURE_PAGE_SIZE;
+}
+
+// Largest relative error in the packed scale
+static float max_scale_error(const std::vector<bench_sprite>& sprites, const std::vector<bench_layouts::PackedSpriteBatchInfo>& packed) {
+	float error = 0.f;
+	for (std::size_t i = 0; i < sprites.size(); ++i) {
+		error = std::max(error, std::fabs(unpack_half(packed[i].scale & 0xFFFF) - sprites[i].scale_x) / sprites[i].scale_x);
+	}
+	return error;
+}
+
+template<typename Func>
+static double time_frames(Func func, int frames) {
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < frames; ++i) { func(); }
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(end - start).count() / frames;
+}
+
+int main(int argc, char** argv) {
+	// Read arguments
+	vex parser(
+		"luna_upload_bench",
+		"1.0",
+		"Compares the bytes uploaded per frame, and the time spent packing them, for the full & compact sprite instance and primitive vertex layouts."
+	);
+	parser.add_arg("Number of sprites (defaults to 10k, 100k & 1M)", VEX_ARG_TYPE_INT, "count", 'c', 1);
+	parser.add_arg("Primitive vertices per sprite", VEX_ARG_TYPE_INT, "vertices", 'p', 1);
+	parser.add_arg("Number of timed frames", VEX_ARG_TYPE_INT, "frames", 'n', 1);
+	parser.parse(argc, argv);
+	if (parser.arg_found("h")) {
+		std::cout << parser.get_help() << std::endl;
+		return 0;
+	}
+	if (parser.arg_found("v")) {
+		std::cout << parser.get_version() << std::endl;
+		return 0;
+	}
+	std::vector<std::size_t> counts = { 10000, 100000, 1000000 };
+	std::size_t vertices_per_sprite = 1;
+	int frames = 5;
+	for (auto& token : parser) {
+		switch (token.short_name) {
+		case 'c': counts = { std::size_t(std::max(1, token.arg[0].int_arg)) }; break;
+		case 'p': vertices_per_sprite = std::size_t(std::max(0, token.arg[0].int_arg)); break;
+		case 'n': frames = std::max(1, token.arg[0].int_arg); break;
+		default: break;
+		}
+	}
+
+	// Report
+	std::cout << std::left << std::setw(10) << "count"
+		<< std::right << std::setw(14) << "full KB" << std::setw(14) << "compact KB" << std::setw(10) << "ratio"
+		<< std::setw(12) << "full ms" << std::setw(12) << "compact ms"
+		<< std::setw(14) << "uv err texel" << std::setw(14) << "scale err" << std::endl;
+	for (std::size_t count : counts) {
+		std::vector<bench_sprite> sprites = generate_sprites(count, 1);
+		std::vector<bench_layouts::SpriteBatchInfo> full_sprites;
+		std::vector<bench_layouts::PackedSpriteBatchInfo> compact_sprites;
+		std::vector<luna::VertexPosColor> vertices;
+		vertices.reserve(count * vertices_per_sprite);
+		for (std::size_t i = 0; i < count * vertices_per_sprite; ++i) {
+			const bench_sprite& sprite = sprites[i % count];
+			vertices.emplace_back(sprite.x, sprite.y, -sprite.depth, sprite.r, sprite.g, sprite.b, sprite.a);
+		}
+		std::vector<luna::VertexPosColor> full_vertices;
+		std::vector<luna::VertexPosPackedColor> compact_vertices;
+
+		double full_ms = time_frames([&]() {
+			pack_full(sprites, full_sprites);
+			full_vertices.assign(vertices.begin(), vertices.end());
+		}, frames);
+		double compact_ms = time_frames([&]() {
+			pack_compact(sprites, compact_sprites);
+			compact_vertices.assign(vertices.begin(), vertices.end());
+		}, frames);
+		double full_kb = double(full_sprites.size() * sizeof(bench_layouts::SpriteBatchInfo) + full_vertices.size() * sizeof(luna::VertexPosColor)) / 1024.0;
+		double compact_kb = double(compact_sprites.size() * sizeof(bench_layouts::PackedSpriteBatchInfo) + compact_vertices.size() * sizeof(luna::VertexPosPackedColor)) / 1024.0;
+		std::cout << std::left << std::setw(10) << count
+			<< std::right << std::fixed << std::setprecision(1) << std::setw(14) << full_kb << std::setw(14) << compact_kb
+			<< std::setprecision(2) << std::setw(10) << (compact_kb / full_kb)
+			<< std::setprecision(3) << std::setw(12) << full_ms << std::setw(12) << compact_ms
+			<< std::setw(14) << max_texel_error(sprites, compact_sprites)
+			<< std::setprecision(5) << std::setw(14) << max_scale_error(sprites, compact_sprites) << std::endl;
+	}
+	return 0;
+}